@@ -0,0 +1,280 @@
+/*
+    AdvertBatch.cpp
+    This is the code file for the AdvertBatch Class.
+
+    The purpose of this class is to pack BLE advertisements into deduplicated, delta encoded batch
+    frames and to unpack them.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <AdvertBatch.h>
+#include <Varint.h>
+#include <string.h>
+
+#define FLAG_ADDRESS_REF 0x01
+#define FLAG_RANDOM 0x02
+#define COUNT_OFFSET 13
+
+/**
+ * Starts a new batch in the given buffer, writing its header.
+ *
+ * @param buffer - Where to write the frame as uint8_t*.
+ * @param size - The size of the buffer as size_t.
+ * @param node - The sending switch's id as uint32_t.
+ * @param sequence - The batch's sequence number as uint16_t.
+ * @param baseMillis - The time the batch's deltas start from as uint32_t.
+ */
+void AdvertBatch::begin(uint8_t *buffer, size_t size, uint32_t node, uint16_t sequence, uint32_t baseMillis) {
+    this->buffer = buffer;
+    this->size = size;
+    lastMillis = baseMillis;
+    advertCount = 0;
+    entryCount = 0;
+    addressCount = 0;
+
+    buffer[0] = MAGIC_0;
+    buffer[1] = MAGIC_1;
+    buffer[2] = VERSION;
+    buffer[3] = (uint8_t)node;
+    buffer[4] = (uint8_t)(node >> 8);
+    buffer[5] = (uint8_t)(node >> 16);
+    buffer[6] = (uint8_t)(node >> 24);
+    buffer[7] = (uint8_t)sequence;
+    buffer[8] = (uint8_t)(sequence >> 8);
+    buffer[9] = (uint8_t)baseMillis;
+    buffer[10] = (uint8_t)(baseMillis >> 8);
+    buffer[11] = (uint8_t)(baseMillis >> 16);
+    buffer[12] = (uint8_t)(baseMillis >> 24);
+    buffer[COUNT_OFFSET] = 0;
+    length = HEADER_SIZE;
+}
+
+/**
+ * Adds an advertisement to the batch, merging it into an earlier
+ * entry with the same address and payload if there is one.
+ *
+ * @param address - The advertiser's address as const uint8_t*.
+ * @param isRandom - Whether the address is random as bool.
+ * @param rssi - The RSSI as int.
+ * @param payload - The advertisement data as const uint8_t*.
+ * @param payloadLength - The length of the data as size_t.
+ * @param millis - When it was seen as uint32_t.
+ *
+ * @return Returns whether it was added, merged or the batch is full
+ * as Result.
+ */
+AdvertBatch::Result AdvertBatch::add(const uint8_t *address, bool isRandom, int rssi, const uint8_t *payload, size_t payloadLength, uint32_t millis) {
+    if (payloadLength > MAX_PAYLOAD) {
+        payloadLength = MAX_PAYLOAD;
+    }
+    int8_t clamped = (int8_t)(rssi < -128 ? -128 : (rssi > 127 ? 127 : rssi));
+    uint32_t key = hash(address, payload, payloadLength);
+
+    // Find the address, and the same advertisement, already in the batch
+    uint8_t addressIndex = addressCount;
+    for (uint8_t i = 0; i < addressCount; i++) {
+        if (memcmp(addresses[i], address, 6) == 0) {
+            addressIndex = i;
+            break;
+        }
+    }
+    if (addressIndex < addressCount) {
+        for (uint8_t i = 0; i < entryCount; i++) {
+            Entry &entry = entries[i];
+            if (
+                entry.key == key
+                && entry.addressIndex == addressIndex
+                && entry.payloadLength == payloadLength
+                && memcmp(buffer + entry.payloadOffset, payload, payloadLength) == 0
+            ) {
+                if (clamped > (int8_t)buffer[entry.rssiOffset]) {
+                    buffer[entry.rssiOffset] = (uint8_t)clamped;
+                }
+                if (buffer[entry.rssiOffset + 1] < 0xFF) {
+                    buffer[entry.rssiOffset + 1]++;
+                }
+                advertCount++;
+
+                return MERGED;
+            }
+        }
+    }
+
+    bool isReference = addressIndex < addressCount;
+    size_t needed = 1 + (isReference ? 1 : 6) + 2 + Varint::MAX_SIZE + 1 + payloadLength;
+    if (
+        entryCount == MAX_ENTRIES
+        || (!isReference && addressCount == MAX_ADDRESSES)
+        || length + needed > size
+    ) {
+        return FULL;
+    }
+
+    buffer[length++] = (isReference ? FLAG_ADDRESS_REF : 0x00) | (isRandom ? FLAG_RANDOM : 0x00);
+    if (isReference) {
+        buffer[length++] = addressIndex;
+    } else {
+        memcpy(buffer + length, address, 6);
+        memcpy(addresses[addressCount], address, 6);
+        addressIndex = addressCount++;
+        length += 6;
+    }
+
+    Entry &entry = entries[entryCount++];
+    entry.key = key;
+    entry.addressIndex = addressIndex;
+    entry.rssiOffset = (uint16_t)length;
+    buffer[length++] = (uint8_t)clamped;
+    buffer[length++] = 1; // <-- Count
+
+    length += Varint::put(buffer + length, size - length, millis >= lastMillis ? millis - lastMillis : 0UL);
+    lastMillis = millis >= lastMillis ? millis : lastMillis;
+
+    buffer[length++] = (uint8_t)payloadLength;
+    entry.payloadOffset = (uint16_t)length;
+    entry.payloadLength = (uint8_t)payloadLength;
+    memcpy(buffer + length, payload, payloadLength);
+    length += payloadLength;
+
+    buffer[COUNT_OFFSET] = entryCount;
+    advertCount++;
+
+    return ADDED;
+}
+
+/**
+ * Gets the length of the frame so far.
+ *
+ * @return Returns the length as size_t.
+ */
+size_t AdvertBatch::getLength() {
+    return length;
+}
+
+/**
+ * Gets the number of entries, after merging, in the batch.
+ *
+ * @return Returns the count as uint8_t.
+ */
+uint8_t AdvertBatch::getEntryCount() {
+    return entryCount;
+}
+
+/**
+ * Gets the number of advertisements added to the batch, merged or
+ * not.
+ *
+ * @return Returns the count as uint16_t.
+ */
+uint16_t AdvertBatch::getAdvertCount() {
+    return advertCount;
+}
+
+/**
+ * Decodes a batch frame, handing each entry to the visitor in order.
+ *
+ * @param frame - The frame as const uint8_t*.
+ * @param length - The length of the frame as size_t.
+ * @param node - Set to the sending switch's id as uint32_t&.
+ * @param sequence - Set to the batch's sequence number as uint16_t&.
+ * @param visitor - Called with each entry as Visitor.
+ * @param context - Passed to the visitor as void*.
+ *
+ * @return Returns true if the frame is valid otherwise false as bool.
+ */
+bool AdvertBatch::decode(const uint8_t *frame, size_t length, uint32_t &node, uint16_t &sequence, Visitor visitor, void *context) {
+    if (length < HEADER_SIZE || frame[0] != MAGIC_0 || frame[1] != MAGIC_1 || frame[2] != VERSION) {
+        return false;
+    }
+
+    node = (uint32_t)frame[3] | ((uint32_t)frame[4] << 8) | ((uint32_t)frame[5] << 16) | ((uint32_t)frame[6] << 24);
+    sequence = (uint16_t)(frame[7] | (frame[8] << 8));
+    uint32_t millis = (uint32_t)frame[9] | ((uint32_t)frame[10] << 8) | ((uint32_t)frame[11] << 16) | ((uint32_t)frame[12] << 24);
+    uint8_t count = frame[COUNT_OFFSET];
+
+    const uint8_t *addresses[MAX_ADDRESSES];
+    uint8_t addressCount = 0;
+    size_t offset = HEADER_SIZE;
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (offset >= length) {
+            return false;
+        }
+
+        Advert advert;
+        uint8_t flags = frame[offset++];
+        advert.isRandom = (flags & FLAG_RANDOM) != 0;
+        if ((flags & FLAG_ADDRESS_REF) != 0) {
+            if (offset >= length || frame[offset] >= addressCount) {
+                return false;
+            }
+            memcpy(advert.address, addresses[frame[offset++]], 6);
+        } else {
+            if (offset + 6 > length || addressCount == MAX_ADDRESSES) {
+                return false;
+            }
+            addresses[addressCount++] = frame + offset;
+            memcpy(advert.address, frame + offset, 6);
+            offset += 6;
+        }
+
+        if (offset + 2 > length) {
+            return false;
+        }
+        advert.rssi = (int8_t)frame[offset++];
+        advert.count = frame[offset++];
+
+        uint32_t delta = 0UL;
+        size_t used = Varint::get(frame + offset, length - offset, delta);
+        if (used == 0 || offset + used >= length) {
+            return false;
+        }
+        offset += used;
+        millis += delta;
+        advert.millis = millis;
+
+        advert.payloadLength = frame[offset++];
+        if (offset + advert.payloadLength > length) {
+            return false;
+        }
+        advert.payload = frame + offset;
+        offset += advert.payloadLength;
+
+        if (visitor != nullptr) {
+            visitor(advert, context);
+        }
+    }
+
+    return offset == length;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Hashes an advertisement's address and payload, FNV-1a, to make
+ * finding repeats quick.
+ *
+ * @param address - The address as const uint8_t*.
+ * @param payload - The payload as const uint8_t*.
+ * @param payloadLength - The length of the payload as size_t.
+ *
+ * @return Returns the hash as uint32_t.
+ */
+uint32_t AdvertBatch::hash(const uint8_t *address, const uint8_t *payload, size_t payloadLength) {
+    uint32_t value = 2166136261UL;
+    for (size_t i = 0; i < 6; i++) {
+        value = (value ^ address[i]) * 16777619UL;
+    }
+    for (size_t i = 0; i < payloadLength; i++) {
+        value = (value ^ payload[i]) * 16777619UL;
+    }
+
+    return value;
+}
@@ -0,0 +1,86 @@
+/*
+    AdvertBatch.h
+    This is the header file for the AdvertBatch Class.
+
+    The purpose of this class is to pack raw BLE advertisements into compact batch frames for the
+    proxy mode, and to unpack them again on the receiving side. Within a batch an advertisement
+    seen again from the same address with the same payload is merged into the first, keeping its
+    strongest RSSI and counting the repeats. An address already in the batch is sent as a one byte
+    reference to its first entry and times are sent as varint deltas from the entry before.
+
+        ['B']['A'][version][node x4][sequence x2][base millis x4][entry count] then per entry:
+        [flags][address x6 | address ref][peak rssi][count][millis delta (varint)][length][payload]
+
+    Flags: 0x01 the address is a reference, 0x02 the address is random.
+
+    Nothing here depends on the hardware so that the receiver and benchmark in tools/advert_proxy
+    build it too.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef AdvertBatch_h
+    #define AdvertBatch_h
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    class AdvertBatch {
+    public:
+        struct Advert {
+            uint8_t address[6];
+            bool isRandom;
+            int8_t rssi;
+            uint8_t count;
+            uint32_t millis;
+            uint8_t payloadLength;
+            const uint8_t *payload;
+        };
+
+        enum Result : uint8_t {
+            ADDED,
+            MERGED,
+            FULL
+        };
+
+        typedef void (*Visitor)(const Advert &advert, void *context);
+
+        static const uint8_t MAGIC_0 = 'B';
+        static const uint8_t MAGIC_1 = 'A';
+        static const uint8_t VERSION = 1;
+        static const size_t HEADER_SIZE = 14;
+        static const uint8_t MAX_ENTRIES = 64;
+        static const uint8_t MAX_ADDRESSES = 64;
+        static const uint8_t MAX_PAYLOAD = 62; // <-- Advertisement plus scan response
+
+        void begin(uint8_t *buffer, size_t size, uint32_t node, uint16_t sequence, uint32_t baseMillis);
+        Result add(const uint8_t *address, bool isRandom, int rssi, const uint8_t *payload, size_t payloadLength, uint32_t millis);
+        size_t getLength();
+        uint8_t getEntryCount();
+        uint16_t getAdvertCount();
+
+        static bool decode(const uint8_t *frame, size_t length, uint32_t &node, uint16_t &sequence, Visitor visitor, void *context);
+
+    private:
+        struct Entry {
+            uint32_t key;
+            uint16_t rssiOffset;
+            uint16_t payloadOffset;
+            uint8_t addressIndex;
+            uint8_t payloadLength;
+        };
+
+        uint8_t *buffer = nullptr;
+        size_t size = 0;
+        size_t length = 0;
+        uint32_t lastMillis = 0UL;
+        uint16_t advertCount = 0;
+
+        Entry entries[MAX_ENTRIES];
+        uint8_t entryCount = 0;
+        uint8_t addresses[MAX_ADDRESSES][6];
+        uint8_t addressCount = 0;
+
+        static uint32_t hash(const uint8_t *address, const uint8_t *payload, size_t payloadLength);
+    };
+#endif
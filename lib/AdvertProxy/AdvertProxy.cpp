@@ -0,0 +1,328 @@
+/*
+    AdvertProxy.cpp
+    This is the code file for the AdvertProxy Class.
+
+    The purpose of this class is to batch BLE advertisements into a bounded set of slots and send
+    them to a host on the network from a dedicated task.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <AdvertProxy.h>
+#include <lwip/sockets.h>
+
+#define SOCKET_TIMEOUT_MILLIS 2000
+#define MIN_BACK_OFF_MILLIS 1000UL
+#define MAX_BACK_OFF_MILLIS 60000UL
+
+/**
+ * Starts the proxy's task, or restarts it with the new host should it
+ * still be running or stopping. Advertisements may be added once the
+ * task has started; They are sent once the host is reached. Never
+ * waits on the task.
+ *
+ * @param host - The receiving host's name or address as const char*.
+ * @param port - The receiving port as uint16_t.
+ * @param isUdp - Whether to send over UDP rather than TCP as bool.
+ * @param node - This switch's id, put in every batch, as uint32_t.
+ * @param windowMillis - The longest a batch stays open as uint32_t.
+ *
+ * @return Returns true if started otherwise false as bool.
+ */
+bool AdvertProxy::begin(const char *host, uint16_t port, bool isUdp, uint32_t node, uint32_t windowMillis) {
+    portENTER_CRITICAL(&batchMux);
+    strlcpy(pending.host, host, sizeof(pending.host));
+    pending.port = port;
+    pending.isUdp = isUdp;
+    pending.node = node;
+    pending.windowMillis = windowMillis;
+    portEXIT_CRITICAL(&batchMux);
+
+    return startTask("advertProxy", TASK_STACK_SIZE, TASK_PRIORITY);
+}
+
+/**
+ * Stops the proxy. The task closes its socket and discards anything
+ * not yet sent once it is done with what it is sending; Never waits
+ * on the task.
+ *
+ */
+void AdvertProxy::stop() {
+    stopTask();
+}
+
+/**
+ * Adds an advertisement to the open batch, sealing the batch first
+ * if it is full. Never waits on the network; Meant to be called from
+ * the BLE scan's callback.
+ *
+ * @param address - The advertiser's address as const uint8_t*.
+ * @param isRandom - Whether the address is random as bool.
+ * @param rssi - The RSSI as int.
+ * @param payload - The advertisement data as const uint8_t*.
+ * @param payloadLength - The length of the data as size_t.
+ */
+void AdvertProxy::add(const uint8_t *address, bool isRandom, int rssi, const uint8_t *payload, size_t payloadLength) {
+    if (!isRunning()) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    uint32_t millis = (uint32_t)(now / 1000LL);
+
+    portENTER_CRITICAL(&batchMux);
+    if (!isBatchOpen) {
+        portEXIT_CRITICAL(&batchMux);
+        return; // <-- The task has yet to start
+    }
+    AdvertBatch::Result result = batch.add(address, isRandom, rssi, payload, payloadLength, millis);
+    if (result == AdvertBatch::FULL) {
+        sealBatch(now);
+        result = batch.add(address, isRandom, rssi, payload, payloadLength, millis);
+    }
+    stats.adverts++;
+    if (result == AdvertBatch::MERGED) {
+        stats.merged++;
+    }
+    portEXIT_CRITICAL(&batchMux);
+}
+
+/**
+ * Gets a copy of the proxy's statistics.
+ *
+ * @return Returns the statistics as Stats.
+ */
+AdvertProxy::Stats AdvertProxy::getStats() {
+    portENTER_CRITICAL(&batchMux);
+    Stats copy = stats;
+    copy.depth = sealedCount;
+    portEXIT_CRITICAL(&batchMux);
+    copy.isConnected = socketFd >= 0;
+
+    return copy;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Run by the task as it starts or restarts; Closes the socket to the
+ * host it was sending to, if any, takes the settings begin() left for
+ * it and opens an empty batch.
+ *
+ */
+void AdvertProxy::onStart() {
+    disconnectHost();
+    nextConnectMicros = 0LL;
+    backOffMillis = MIN_BACK_OFF_MILLIS;
+
+    portENTER_CRITICAL(&batchMux);
+    config = pending;
+    head = 0;
+    sealedCount = 0;
+    openBatch(esp_timer_get_time());
+    isBatchOpen = true;
+    portEXIT_CRITICAL(&batchMux);
+}
+
+/**
+ * #### PRIVATE ####
+ * Run by the task every window; Seals the open batch, connects if
+ * need be and sends what has been sealed.
+ *
+ * @return Returns how long to sleep before the next round as uint32_t.
+ */
+uint32_t AdvertProxy::onWork() {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&batchMux);
+    if (now - openedMicros >= config.windowMillis * 1000LL) {
+        sealBatch(now);
+    }
+    portEXIT_CRITICAL(&batchMux);
+
+    if (socketFd >= 0 || connectHost()) {
+        flush();
+    }
+
+    return config.windowMillis;
+}
+
+/**
+ * #### PRIVATE ####
+ * Run by the task as it stops; Closes the socket and discards every
+ * batch, open or sealed.
+ *
+ */
+void AdvertProxy::onStop() {
+    disconnectHost();
+
+    portENTER_CRITICAL(&batchMux);
+    head = 0;
+    sealedCount = 0;
+    isBatchOpen = false;
+    portEXIT_CRITICAL(&batchMux);
+}
+
+/**
+ * #### PRIVATE ####
+ * Opens the socket to the host unless still backing off from a
+ * failure. For UDP the socket is connected only to fix where its
+ * datagrams go.
+ *
+ * @return Returns true if connected otherwise false as bool.
+ */
+bool AdvertProxy::connectHost() {
+    int64_t now = esp_timer_get_time();
+    if (now < nextConnectMicros) {
+        return false;
+    }
+
+    socketFd = openSocket(config.host, config.port, config.isUdp, SOCKET_TIMEOUT_MILLIS);
+    if (socketFd < 0) {
+        portENTER_CRITICAL(&batchMux);
+        stats.connectFailures++;
+        portEXIT_CRITICAL(&batchMux);
+
+        nextConnectMicros = now + backOffMillis * 1000LL;
+        backOffMillis = min(backOffMillis * 2UL, MAX_BACK_OFF_MILLIS);
+
+        return false;
+    }
+
+    backOffMillis = MIN_BACK_OFF_MILLIS;
+
+    return true;
+}
+
+/**
+ * #### PRIVATE ####
+ * Closes the socket to the host.
+ *
+ */
+void AdvertProxy::disconnectHost() {
+    if (socketFd >= 0) {
+        lwip_close(socketFd);
+        socketFd = -1;
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Sends the sealed batches, oldest first, until none are left.
+ * Should a send fail the batch is counted as dropped and the socket
+ * is closed to be reopened.
+ *
+ */
+void AdvertProxy::flush() {
+    while (socketFd >= 0) {
+        // Copy out the oldest batch so the slot is free while it is sent
+        uint16_t length = 0;
+        uint16_t adverts = 0;
+        portENTER_CRITICAL(&batchMux);
+        if (sealedCount > 0) {
+            length = slotLengths[head];
+            adverts = slotAdverts[head];
+            memcpy(sendBuffer + 2, slots[head], length);
+            head = (head + 1) % SLOTS;
+            sealedCount--;
+        }
+        portEXIT_CRITICAL(&batchMux);
+
+        if (length == 0) {
+            return;
+        }
+
+        bool ok;
+        if (config.isUdp) {
+            ok = lwip_send(socketFd, sendBuffer + 2, length, 0) == (int)length;
+        } else {
+            sendBuffer[0] = (uint8_t)(length >> 8);
+            sendBuffer[1] = (uint8_t)length;
+            ok = sendAll(sendBuffer, 2 + length);
+        }
+
+        portENTER_CRITICAL(&batchMux);
+        if (ok) {
+            stats.sentBatches++;
+            stats.sentBytes += length;
+        } else {
+            stats.droppedBatches++;
+            stats.droppedAdverts += adverts;
+        }
+        portEXIT_CRITICAL(&batchMux);
+
+        if (!ok) {
+            disconnectHost();
+        }
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Opens a new batch in the slot after the sealed ones. Must be
+ * called holding the batch mux.
+ *
+ * @param now - The current time in micros as int64_t.
+ */
+void AdvertProxy::openBatch(int64_t now) {
+    uint8_t slot = (head + sealedCount) % SLOTS;
+    batch.begin(slots[slot], FRAME_SIZE, config.node, sequence++, (uint32_t)(now / 1000LL));
+    openedMicros = now;
+}
+
+/**
+ * #### PRIVATE ####
+ * Seals the open batch, if it has anything in it, and opens the
+ * next. When that leaves no free slot the oldest sealed batch is
+ * dropped. Must be called holding the batch mux.
+ *
+ * @param now - The current time in micros as int64_t.
+ */
+void AdvertProxy::sealBatch(int64_t now) {
+    if (batch.getEntryCount() == 0) {
+        openedMicros = now;
+        return;
+    }
+
+    uint8_t slot = (head + sealedCount) % SLOTS;
+    slotLengths[slot] = (uint16_t)batch.getLength();
+    slotAdverts[slot] = batch.getAdvertCount();
+    sealedCount++;
+    stats.batches++;
+
+    if (sealedCount == SLOTS) {
+        stats.droppedBatches++;
+        stats.droppedAdverts += slotAdverts[head];
+        head = (head + 1) % SLOTS;
+        sealedCount--;
+    }
+
+    openBatch(now);
+}
+
+/**
+ * #### PRIVATE ####
+ * Writes all of the given data to the host.
+ *
+ * @param data - The data to send as const uint8_t*.
+ * @param length - The length of the data as size_t.
+ *
+ * @return Returns true if all was sent otherwise false as bool.
+ */
+bool AdvertProxy::sendAll(const uint8_t *data, size_t length) {
+    while (length > 0) {
+        int sent = lwip_send(socketFd, data, length, 0);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        length -= sent;
+    }
+
+    return true;
+}
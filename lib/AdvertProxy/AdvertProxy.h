@@ -0,0 +1,91 @@
+/*
+    AdvertProxy.h
+    This is the header file for the AdvertProxy Class.
+
+    The purpose of this class is to forward the BLE advertisements the switch hears to a host on
+    the network, so that it can act as a BLE proxy for something like a home automation server.
+    Advertisements are added from the BLE task into the open AdvertBatch, which only takes a short
+    critical section. A batch is sealed when it fills or when its window has passed and waits with
+    the others in a bounded set of slots; when every slot is full the oldest sealed batch is
+    dropped so the newest advertisements always get through. A low priority SocketWorker task of
+    its own sends the sealed batches, one UDP datagram each or, over TCP, each behind a two byte
+    big-endian length. Neither begin() nor stop() waits on that task; Beginning again while it is
+    still stopping restarts it with the new host.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef AdvertProxy_h
+    #define AdvertProxy_h
+
+    #include <Arduino.h>
+    #include <AdvertBatch.h>
+    #include <SocketWorker.h>
+
+    class AdvertProxy : public SocketWorker {
+    public:
+        struct Stats {
+            unsigned long adverts;
+            unsigned long merged;
+            unsigned long batches;
+            unsigned long sentBatches;
+            unsigned long sentBytes;
+            unsigned long droppedBatches;
+            unsigned long droppedAdverts;
+            unsigned long connectFailures;
+            uint8_t depth;
+            bool isConnected;
+        };
+
+        static const size_t SLOTS = 4;
+        static const size_t FRAME_SIZE = 1400; // <-- Fits a datagram without fragmenting
+        static const size_t HOST_SIZE = 64;
+        static const uint32_t TASK_STACK_SIZE = 4096UL;
+        static const UBaseType_t TASK_PRIORITY = 1;
+
+        bool begin(const char *host, uint16_t port, bool isUdp, uint32_t node, uint32_t windowMillis);
+        void stop();
+        void add(const uint8_t *address, bool isRandom, int rssi, const uint8_t *payload, size_t payloadLength);
+        Stats getStats();
+
+    private:
+        struct Config {
+            char host[HOST_SIZE];
+            uint16_t port;
+            bool isUdp;
+            uint32_t node;
+            uint32_t windowMillis;
+        };
+
+        Config config = {}; // <-- The task's own
+        Config pending = {}; // <-- Taken by the task when it next starts
+
+        uint8_t slots[SLOTS][FRAME_SIZE];
+        uint16_t slotLengths[SLOTS];
+        uint16_t slotAdverts[SLOTS];
+        uint8_t head = 0;
+        uint8_t sealedCount = 0;
+        AdvertBatch batch;
+        bool isBatchOpen = false;
+        uint16_t sequence = 0;
+        int64_t openedMicros = 0LL;
+        uint8_t sendBuffer[2 + FRAME_SIZE];
+
+        int socketFd = -1;
+        int64_t nextConnectMicros = 0LL;
+        uint32_t backOffMillis = 0UL;
+
+        portMUX_TYPE batchMux = portMUX_INITIALIZER_UNLOCKED;
+        Stats stats = {};
+
+        void onStart() override;
+        uint32_t onWork() override;
+        void onStop() override;
+        bool connectHost();
+        void disconnectHost();
+        void flush();
+        void openBatch(int64_t now);
+        void sealBatch(int64_t now);
+        bool sendAll(const uint8_t *data, size_t length);
+    };
+#endif
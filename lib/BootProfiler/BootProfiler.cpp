@@ -0,0 +1,83 @@
+/*
+    BootProfiler.cpp
+    This is the code file for the BootProfiler Class.
+
+    The purpose of this class is to time the phases of starting up.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <BootProfiler.h>
+#include <Clock.h>
+
+/**
+ * Marks the end of a phase of starting up, the next starting from here.
+ * Once the table is full further marks are ignored.
+ *
+ * @param name - The phase's name, which must outlive the profiler, as
+ * const char*.
+ */
+void BootProfiler::mark(const char *name) {
+    if (count >= MAX_PHASES) {
+        return;
+    }
+    phases[count].name = name;
+    phases[count].endMicros = (uint32_t)Clock::nowMicros();
+    count++;
+}
+
+/**
+ * Gets how many phases have been marked.
+ *
+ * @return Returns the count as uint8_t.
+ */
+uint8_t BootProfiler::getCount() {
+    return count;
+}
+
+/**
+ * Gets a phase, in the order they were marked.
+ *
+ * @param index - Which phase as uint8_t.
+ *
+ * @return Returns the phase, or an empty one if there is no such phase,
+ * as Phase.
+ */
+BootProfiler::Phase BootProfiler::getPhase(uint8_t index) {
+    return index < count ? phases[index] : Phase{ "", 0UL };
+}
+
+/**
+ * Gets how long a phase took, from the end of the one before it or the
+ * start of the app.
+ *
+ * @param index - Which phase as uint8_t.
+ *
+ * @return Returns the microseconds as uint32_t.
+ */
+uint32_t BootProfiler::getPhaseMicros(uint8_t index) {
+    if (index >= count) {
+        return 0UL;
+    }
+
+    return phases[index].endMicros - (index == 0 ? 0UL : phases[index - 1].endMicros);
+}
+
+/**
+ * Gets when a phase ended.
+ *
+ * @param name - The phase's name as const char*.
+ *
+ * @return Returns the microseconds from the start of the app, or 0 if it
+ * hasn't been marked, as uint32_t.
+ */
+uint32_t BootProfiler::getEndMicros(const char *name) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (strcmp(phases[i].name, name) == 0) {
+            return phases[i].endMicros;
+        }
+    }
+
+    return 0UL;
+}
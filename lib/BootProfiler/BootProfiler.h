@@ -0,0 +1,37 @@
+/*
+    BootProfiler.h
+    This is the header file for the BootProfiler Class.
+
+    The purpose of this class is to time the phases of starting up, so that what stands between
+    reset and the first scan can be seen and kept short. Each phase is marked as it ends, timed
+    from the start of the app; The bootloader's time before that can't be seen from the app.
+    Marks are kept in a fixed table, so marking is cheap enough to leave in.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef BootProfiler_h
+    #define BootProfiler_h
+
+    #include <Arduino.h>
+
+    class BootProfiler {
+    public:
+        struct Phase {
+            const char *name;
+            uint32_t endMicros; // <-- From the start of the app
+        };
+
+        static const uint8_t MAX_PHASES = 12;
+
+        void mark(const char *name);
+        uint8_t getCount();
+        Phase getPhase(uint8_t index);
+        uint32_t getPhaseMicros(uint8_t index);
+        uint32_t getEndMicros(const char *name);
+
+    private:
+        Phase phases[MAX_PHASES];
+        uint8_t count = 0;
+    };
+#endif
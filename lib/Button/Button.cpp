@@ -0,0 +1,329 @@
+/*
+    Button.cpp
+    This is the code file for the Button Class.
+
+    The purpose of this class is to turn the raw edges of a push button into gestures. Edges are
+    timestamped by a GPIO interrupt and queued, so nothing needs to poll the button while it is idle.
+    The queued edges are then debounced and fed, along with timeouts, through a table-driven state
+    machine which emits press, hold, release and double press events.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <Button.h>
+
+/*
+    Gesture state machine; TRANSITIONS[state][input] gives the next state and the action to take.
+    The A_RELEASE action may redirect a SHORT release into S_GAP to wait for a double press. The
+    second press of a double press is held like any other, passing the hold thresholds as it goes.
+*/
+const Button::Transition Button::TRANSITIONS[STATE_COUNT][INPUT_COUNT] = {
+    /*                     IN_DOWN                      IN_UP                    IN_TIMEOUT           */
+    /* S_IDLE ....... */ { { S_HELD, A_PRESS },         { S_IDLE, A_NONE },      { S_IDLE, A_NONE }          },
+    /* S_HELD ....... */ { { S_HELD, A_NONE },          { S_IDLE, A_RELEASE },   { S_HELD, A_HOLD }          },
+    /* S_GAP ........ */ { { S_SECOND_HELD, A_DOUBLE }, { S_GAP, A_NONE },       { S_IDLE, A_SHORT }         },
+    /* S_SECOND_HELD  */ { { S_SECOND_HELD, A_NONE },   { S_IDLE, A_SECOND },    { S_SECOND_HELD, A_HOLD }   }
+};
+
+/**
+ * Starts the button by configuring its pin and attaching the
+ * edge interrupt.
+ * 
+ * @param pin - The GPIO pin of the button as uint8_t.
+ * @param activeLevel - The level of the pin while pressed, HIGH or LOW, as uint8_t.
+ * @param notifyFromISR - Function called from the ISR after each edge so 
+ * that poll() can be scheduled; may be nullptr. Must be safe to call from
+ * an ISR.
+ */
+void Button::begin(uint8_t pin, uint8_t activeLevel, Notifier notifyFromISR) {
+    this->pin = pin;
+    this->activeLevel = activeLevel;
+    this->notifyFromISR = notifyFromISR;
+
+    pinMode(pin, INPUT);
+    stableDown = digitalRead(pin) == activeLevel;
+    attachInterruptArg(digitalPinToInterrupt(pin), handleISR, this, CHANGE);
+}
+
+/**
+ * Sets the debounce and double press timing.
+ * 
+ * @param debounceMillis - How long the pin must be stable for an edge to count as uint32_t.
+ * @param doubleGapMillis - How soon after a SHORT press a second press counts as a 
+ * double press, or zero to disable double presses, as uint32_t.
+ */
+void Button::setTimings(uint32_t debounceMillis, uint32_t doubleGapMillis) {
+    debounceMicros = (int64_t)debounceMillis * 1000LL;
+    doubleGapMicros = (int64_t)doubleGapMillis * 1000LL;
+}
+
+/**
+ * Sets the hold thresholds, in ascending order, measured from the 
+ * start of a press. A threshold of zero ends the list. Changes take 
+ * effect from the next threshold armed.
+ * 
+ * @param longMillis - Hold time for LONG as uint64_t.
+ * @param veryLongMillis - Hold time for VERY_LONG as uint64_t.
+ * @param extraLongMillis - Hold time for EXTRA_LONG as uint64_t.
+ */
+void Button::setHoldThresholds(uint64_t longMillis, uint64_t veryLongMillis, uint64_t extraLongMillis) {
+    holdMicros[0] = (int64_t)longMillis * 1000LL;
+    holdMicros[1] = (int64_t)veryLongMillis * 1000LL;
+    holdMicros[2] = (int64_t)extraLongMillis * 1000LL;
+}
+
+/**
+ * Queues a raw edge as though it came from the interrupt. This is
+ * how edges are fed in when the button is exercised off the device.
+ * 
+ * @param isDown - True if the button is down after the edge as bool.
+ * @param atMicros - When the edge happened in Clock micros as int64_t.
+ */
+void Button::feedEdge(bool isDown, int64_t atMicros) {
+    portENTER_CRITICAL(&edgeMux);
+    uint8_t next = (edgeHead + 1) % EDGE_QUEUE_SIZE;
+    if (next != edgeTail) {
+        edges[edgeHead] = { isDown, atMicros };
+        edgeHead = next;
+    } else {
+        // Queue is full; keep the latest level so the button can't get stuck
+        edges[(edgeHead + EDGE_QUEUE_SIZE - 1) % EDGE_QUEUE_SIZE] = { isDown, atMicros };
+    }
+    portEXIT_CRITICAL(&edgeMux);
+}
+
+/**
+ * Processes queued edges and expired timeouts, then returns the 
+ * next gesture event if there is one. This should be called until
+ * it returns false whenever the notifier fires or the time given 
+ * by nextWakeMicros() is reached.
+ * 
+ * @param event - Receives the next event as Event.
+ * 
+ * @return Returns true if an event was returned otherwise false as bool.
+ */
+bool Button::poll(Event &event) {
+    if (eventHead == eventTail) {
+        Edge edge;
+        while (takeEdge(edge)) {
+            // A change pending from before this edge may have already settled
+            settle(edge.atMicros);
+
+            if (edge.atMicros - lastEdgeMicros > debounceMicros) {
+                candidateSinceMicros = edge.atMicros; // <-- Start of a new burst of edges
+            }
+            lastEdgeMicros = edge.atMicros;
+            candidatePending = edge.isDown != stableDown;
+            candidateDown = edge.isDown;
+        }
+
+        int64_t nowMicros = Clock::nowMicros();
+        settle(nowMicros);
+
+        // Timeouts after the start of a still unsettled change wait for it to settle
+        int64_t untilMicros = candidatePending && candidateSinceMicros < nowMicros ? candidateSinceMicros : nowMicros;
+        while (timeoutMicros != NO_WAKE && timeoutMicros <= untilMicros) {
+            int64_t atMicros = timeoutMicros;
+            timeoutMicros = NO_WAKE;
+            step(IN_TIMEOUT, atMicros);
+        }
+    }
+
+    if (eventHead == eventTail) {
+        return false;
+    }
+    event = events[eventTail];
+    eventTail = (eventTail + 1) % EVENT_QUEUE_SIZE;
+
+    return true;
+}
+
+/**
+ * Returns when poll() next needs to be called to handle a debounce
+ * or a timeout, even if no further edges happen.
+ * 
+ * @return Returns the Clock micros to wake at, or -1 if there is no
+ * need to wake, as int64_t.
+ */
+int64_t Button::nextWakeMicros() {
+    int64_t wake = timeoutMicros;
+    if (candidatePending) {
+        int64_t settleMicros = lastEdgeMicros + debounceMicros;
+        if (wake == NO_WAKE || settleMicros < wake) {
+            wake = settleMicros;
+        }
+    }
+
+    return wake;
+}
+
+/**
+ * Used to determine if the button is currently held down, after
+ * debouncing.
+ * 
+ * @return Returns true if held otherwise false as bool.
+ */
+bool Button::isHeld() {
+    return state == S_HELD || state == S_SECOND_HELD;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * The edge interrupt. Timestamps and queues the new level of the 
+ * pin then calls the notifier.
+ * 
+ * @param arg - The Button the interrupt belongs to.
+ */
+void IRAM_ATTR Button::handleISR(void *arg) {
+    Button *button = (Button *)arg;
+    bool isDown = digitalRead(button->pin) == button->activeLevel;
+    int64_t atMicros = esp_timer_get_time();
+
+    portENTER_CRITICAL_ISR(&button->edgeMux);
+    uint8_t next = (button->edgeHead + 1) % EDGE_QUEUE_SIZE;
+    if (next != button->edgeTail) {
+        button->edges[button->edgeHead] = { isDown, atMicros };
+        button->edgeHead = next;
+    } else {
+        // Queue is full; keep the latest level so the button can't get stuck
+        button->edges[(button->edgeHead + EDGE_QUEUE_SIZE - 1) % EDGE_QUEUE_SIZE] = { isDown, atMicros };
+    }
+    portEXIT_CRITICAL_ISR(&button->edgeMux);
+
+    if (button->notifyFromISR != nullptr) {
+        button->notifyFromISR();
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Takes the oldest queued edge.
+ * 
+ * @param edge - Receives the edge as Edge.
+ * 
+ * @return Returns true if an edge was taken otherwise false as bool.
+ */
+bool Button::takeEdge(Edge &edge) {
+    bool taken = false;
+    portENTER_CRITICAL(&edgeMux);
+    if (edgeTail != edgeHead) {
+        edge = edges[edgeTail];
+        edgeTail = (edgeTail + 1) % EDGE_QUEUE_SIZE;
+        taken = true;
+    }
+    portEXIT_CRITICAL(&edgeMux);
+
+    return taken;
+}
+
+/**
+ * #### PRIVATE ####
+ * The debounce filter. Once the pin has been stable for the debounce
+ * time a pending change is accepted and fed to the state machine as 
+ * having happened at the start of its burst of edges. Any timeouts 
+ * due before then are run first so events stay in order.
+ * 
+ * @param nowMicros - The time to settle up to as int64_t.
+ */
+void Button::settle(int64_t nowMicros) {
+    if (candidatePending && nowMicros - lastEdgeMicros >= debounceMicros) {
+        candidatePending = false;
+        stableDown = candidateDown;
+
+        while (timeoutMicros != NO_WAKE && timeoutMicros <= candidateSinceMicros) {
+            int64_t atMicros = timeoutMicros;
+            timeoutMicros = NO_WAKE;
+            step(IN_TIMEOUT, atMicros);
+        }
+        step(stableDown ? IN_DOWN : IN_UP, candidateSinceMicros);
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Runs a single input through the gesture state machine.
+ * 
+ * @param input - The input as Input.
+ * @param atMicros - When the input happened as int64_t.
+ */
+void Button::step(Input input, int64_t atMicros) {
+    const Transition &transition = TRANSITIONS[state][input];
+    state = transition.next;
+
+    switch (transition.action) {
+        case A_PRESS:
+            pressedAtMicros = atMicros;
+            level = SHORT;
+            emit(BTN_PRESSED, level);
+            armNextHold();
+            break;
+        case A_HOLD:
+            level++;
+            emit(BTN_HOLD, level);
+            armNextHold();
+            break;
+        case A_RELEASE:
+            timeoutMicros = NO_WAKE;
+            if (level == SHORT && doubleGapMicros > 0LL) {
+                // Hold back the SHORT release in case this is a double press
+                state = S_GAP;
+                timeoutMicros = atMicros + doubleGapMicros;
+            } else {
+                emit(BTN_RELEASED, level);
+            }
+            break;
+        case A_DOUBLE:
+            pressedAtMicros = atMicros;
+            level = SHORT;
+            emit(BTN_DOUBLE, level);
+            armNextHold();
+            break;
+        case A_SECOND:
+            timeoutMicros = NO_WAKE;
+            if (level > SHORT) {
+                emit(BTN_RELEASED, level); // <-- A SHORT second press was the double press, already reported
+            }
+            break;
+        case A_SHORT:
+            emit(BTN_RELEASED, SHORT);
+            break;
+        case A_NONE:
+        default:
+            break;
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Arms the timeout for the next hold threshold, if there is one.
+ */
+void Button::armNextHold() {
+    if (level < MAX_LEVELS && holdMicros[level] > 0LL) {
+        timeoutMicros = pressedAtMicros + holdMicros[level];
+    } else {
+        timeoutMicros = NO_WAKE;
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Queues an event to be returned by poll(). If the queue is full
+ * the event is dropped.
+ * 
+ * @param type - The type of event as EventType.
+ * @param level - The hold level of the event as uint8_t.
+ */
+void Button::emit(EventType type, uint8_t level) {
+    uint8_t next = (eventHead + 1) % EVENT_QUEUE_SIZE;
+    if (next != eventTail) {
+        events[eventHead] = { type, level };
+        eventHead = next;
+    }
+}
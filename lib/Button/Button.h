@@ -0,0 +1,145 @@
+/*
+    Button.h
+    This is the header file for the Button Class.
+
+    The purpose of this class is to turn the raw edges of a push button into gestures. Edges are
+    timestamped by a GPIO interrupt and queued, so nothing needs to poll the button while it is idle.
+    The queued edges are then debounced and fed, along with timeouts, through a table-driven state
+    machine which emits the following events:
+
+        BTN_PRESSED .... The button went down.
+        BTN_HOLD ....... The button has been held past a hold threshold; 'level' tells which.
+        BTN_RELEASED ... The button was released; 'level' tells how many thresholds were passed,
+                         where SHORT is none, LONG is the first and so on.
+        BTN_DOUBLE ..... A second press began shortly after a SHORT press was released.
+
+    A SHORT release is held back until the double press gap has passed so that it is not reported
+    when it turns out to be the first half of a double press. The second press is then held like
+    any other, so a tap followed by a hold still reports each BTN_HOLD and its BTN_RELEASED; Only
+    a SHORT second press goes unreleased, being the double press.
+
+    Edges may be fed in with feedEdge() instead of by the interrupt, which is how the host test in
+    tools/button_check exercises the state machine.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef Button_h
+    #define Button_h
+
+    #include <Arduino.h>
+    #include <Clock.h>
+
+    class Button {
+    public:
+        enum EventType : uint8_t {
+            BTN_NONE,
+            BTN_PRESSED,
+            BTN_HOLD,
+            BTN_RELEASED,
+            BTN_DOUBLE
+        };
+
+        enum HoldLevel : uint8_t {
+            SHORT,
+            LONG,
+            VERY_LONG,
+            EXTRA_LONG
+        };
+
+        struct Event {
+            EventType type;
+            uint8_t level;
+        };
+
+        typedef void (*Notifier)();
+
+        static const uint8_t MAX_LEVELS = 3;
+
+        void begin(uint8_t pin, uint8_t activeLevel, Notifier notifyFromISR);
+        void setTimings(uint32_t debounceMillis, uint32_t doubleGapMillis);
+        void setHoldThresholds(uint64_t longMillis, uint64_t veryLongMillis = 0ULL, uint64_t extraLongMillis = 0ULL);
+        void feedEdge(bool isDown, int64_t atMicros);
+        bool poll(Event &event);
+        int64_t nextWakeMicros();
+        bool isHeld();
+
+    private:
+        enum State : uint8_t { 
+            S_IDLE, 
+            S_HELD, 
+            S_GAP, 
+            S_SECOND_HELD, 
+            STATE_COUNT 
+        };
+
+        enum Input : uint8_t { 
+            IN_DOWN, 
+            IN_UP, 
+            IN_TIMEOUT, 
+            INPUT_COUNT 
+        };
+
+        enum Action : uint8_t { 
+            A_NONE, 
+            A_PRESS, 
+            A_RELEASE, 
+            A_HOLD, 
+            A_DOUBLE, 
+            A_SECOND, 
+            A_SHORT 
+        };
+
+        struct Transition {
+            State next;
+            Action action;
+        };
+
+        struct Edge {
+            bool isDown;
+            int64_t atMicros;
+        };
+
+        static const Transition TRANSITIONS[STATE_COUNT][INPUT_COUNT];
+        static const uint8_t EDGE_QUEUE_SIZE = 16;
+        static const uint8_t EVENT_QUEUE_SIZE = 8;
+        static const int64_t NO_WAKE = -1LL;
+
+        uint8_t pin = 0;
+        uint8_t activeLevel = HIGH;
+        Notifier notifyFromISR = nullptr;
+
+        portMUX_TYPE edgeMux = portMUX_INITIALIZER_UNLOCKED;
+        Edge edges[EDGE_QUEUE_SIZE];
+        volatile uint8_t edgeHead = 0;
+        volatile uint8_t edgeTail = 0;
+
+        int64_t debounceMicros = 30000LL;
+        int64_t doubleGapMicros = 400000LL;
+        int64_t holdMicros[MAX_LEVELS] = { 0LL, 0LL, 0LL };
+
+        // Debounce filter
+        bool stableDown = false;
+        bool candidatePending = false;
+        bool candidateDown = false;
+        int64_t candidateSinceMicros = 0LL;
+        int64_t lastEdgeMicros = 0LL;
+
+        // Gesture state machine
+        State state = S_IDLE;
+        uint8_t level = SHORT;
+        int64_t pressedAtMicros = 0LL;
+        int64_t timeoutMicros = NO_WAKE;
+
+        Event events[EVENT_QUEUE_SIZE];
+        uint8_t eventHead = 0;
+        uint8_t eventTail = 0;
+
+        static void IRAM_ATTR handleISR(void *arg);
+        bool takeEdge(Edge &edge);
+        void settle(int64_t nowMicros);
+        void step(Input input, int64_t atMicros);
+        void armNextHold();
+        void emit(EventType type, uint8_t level);
+    };
+#endif
@@ -0,0 +1,318 @@
+/*
+    CaptiveDns.cpp
+    This is the code file for the CaptiveDns Class.
+
+    The purpose of this class is to answer every DNS query with the device's own address from a
+    dedicated task, answering connectivity checks from a precomputed table.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <CaptiveDns.h>
+#include <lwip/sockets.h>
+
+#define DNS_HEADER_SIZE 12
+#define DNS_ANSWER_SIZE 16
+#define DNS_TYPE_A 1
+#define DNS_CLASS_IN 1
+#define RECEIVE_TIMEOUT_MILLIS 100
+#define REOPEN_WAIT_MILLIS 1000UL
+
+// Questions (name, type A, class IN) as they appear on the wire, for the connectivity checks
+static const char Q_APPLE_CAPTIVE[] = "\7captive\5apple\3com\0\0\1\0\1";
+static const char Q_APPLE_WWW[] = "\3www\5apple\3com\0\0\1\0\1";
+static const char Q_GSTATIC[] = "\21connectivitycheck\7gstatic\3com\0\0\1\0\1";
+static const char Q_ANDROID[] = "\21connectivitycheck\7android\3com\0\0\1\0\1";
+static const char Q_GOOGLE[] = "\10clients3\6google\3com\0\0\1\0\1";
+static const char Q_MSFT_TEST[] = "\3www\17msftconnecttest\3com\0\0\1\0\1";
+static const char Q_MSFT_NCSI[] = "\3www\10msftncsi\3com\0\0\1\0\1";
+static const char Q_MSFT_DNS[] = "\3dns\10msftncsi\3com\0\0\1\0\1";
+static const char Q_FIREFOX[] = "\14detectportal\7firefox\3com\0\0\1\0\1";
+
+#define FAST_NAME(question) { (const uint8_t *)question, sizeof(question) - 1 }
+
+const CaptiveDns::FastName CaptiveDns::FAST_NAMES[] = {
+    FAST_NAME(Q_APPLE_CAPTIVE),
+    FAST_NAME(Q_APPLE_WWW),
+    FAST_NAME(Q_GSTATIC),
+    FAST_NAME(Q_ANDROID),
+    FAST_NAME(Q_GOOGLE),
+    FAST_NAME(Q_MSFT_TEST),
+    FAST_NAME(Q_MSFT_NCSI),
+    FAST_NAME(Q_MSFT_DNS),
+    FAST_NAME(Q_FIREFOX)
+};
+const size_t CaptiveDns::FAST_NAME_COUNT = sizeof(FAST_NAMES) / sizeof(FAST_NAMES[0]);
+
+/**
+ * Starts answering DNS queries from the server's task, or restarts it
+ * with the new address should it still be running or stopping. Never
+ * waits on the task.
+ * 
+ * @param address - The address to answer with as IPAddress.
+ * @param port - The port to listen on as uint16_t.
+ * 
+ * @return Returns true if started otherwise false as bool.
+ */
+bool CaptiveDns::start(IPAddress address, uint16_t port) {
+    uint32_t raw = (uint32_t)address;
+
+    portENTER_CRITICAL(&statsMux);
+    memcpy(pendingAddress, &raw, sizeof(pendingAddress));
+    pendingPort = port;
+    portEXIT_CRITICAL(&statsMux);
+
+    return startTask("captiveDns", TASK_STACK_SIZE, TASK_PRIORITY);
+}
+
+/**
+ * Stops answering DNS queries. The task closes its socket once its
+ * wait for a query times out; Never waits on the task.
+ * 
+ */
+void CaptiveDns::stop() {
+    stopTask();
+}
+
+/**
+ * Gets a copy of the query statistics.
+ * 
+ * @return Returns the statistics as Stats.
+ */
+CaptiveDns::Stats CaptiveDns::getStats() {
+    portENTER_CRITICAL(&statsMux);
+    Stats copy = stats;
+    portEXIT_CRITICAL(&statsMux);
+
+    return copy;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Run by the task as it starts or restarts; Takes the address start()
+ * left for it and opens the socket afresh.
+ * 
+ */
+void CaptiveDns::onStart() {
+    closeSocket();
+
+    portENTER_CRITICAL(&statsMux);
+    memcpy(address, pendingAddress, sizeof(address));
+    port = pendingPort;
+    portEXIT_CRITICAL(&statsMux);
+
+    bindSocket();
+}
+
+/**
+ * #### PRIVATE ####
+ * Run by the task over and over; Receives a query into the packet
+ * buffer, answers it in place and sends it back. Should the socket
+ * not be open it is tried again after a while.
+ * 
+ * @return Returns how long to sleep before the next round as uint32_t.
+ */
+uint32_t CaptiveDns::onWork() {
+    if (socketFd < 0 && !bindSocket()) {
+        return REOPEN_WAIT_MILLIS;
+    }
+
+    struct sockaddr_in from;
+    socklen_t fromLength = sizeof(from);
+    int length = lwip_recvfrom(socketFd, packet, PACKET_BUFFER_SIZE, 0, (struct sockaddr *)&from, &fromLength);
+    if (length <= 0) {
+        return 0UL; // <-- Timed out
+    }
+
+    int64_t start = esp_timer_get_time();
+    bool isFast = false;
+    size_t size = answer((size_t)length, isFast);
+    if (size > 0) {
+        lwip_sendto(socketFd, packet, size, 0, (struct sockaddr *)&from, fromLength);
+    }
+    record(isFast, size == 0, (uint32_t)(esp_timer_get_time() - start));
+
+    return 0UL;
+}
+
+/**
+ * #### PRIVATE ####
+ * Run by the task as it stops; Closes the socket.
+ * 
+ */
+void CaptiveDns::onStop() {
+    closeSocket();
+}
+
+/**
+ * #### PRIVATE ####
+ * Opens the socket and binds it to the port.
+ * 
+ * @return Returns true if opened otherwise false as bool.
+ */
+bool CaptiveDns::bindSocket() {
+    socketFd = lwip_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (socketFd < 0) {
+        return false;
+    }
+
+    // Wakes the task now and then to see if it should stop
+    struct timeval timeout = { 0, RECEIVE_TIMEOUT_MILLIS * 1000 };
+    lwip_setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    struct sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (lwip_bind(socketFd, (struct sockaddr *)&local, sizeof(local)) < 0) {
+        closeSocket();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * #### PRIVATE ####
+ * Closes the socket, if open.
+ * 
+ */
+void CaptiveDns::closeSocket() {
+    if (socketFd >= 0) {
+        lwip_close(socketFd);
+        socketFd = -1;
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Turns the query in the packet buffer into its answer. Anything 
+ * following the question (e.g. EDNS records) is dropped.
+ * 
+ * @param length - The length of the query as size_t.
+ * @param isFast - Set to whether the precomputed table answered as bool&.
+ * 
+ * @return Returns the length of the answer, or zero if the packet 
+ * should be dropped, as size_t.
+ */
+size_t CaptiveDns::answer(size_t length, bool &isFast) {
+    if (
+        length < DNS_HEADER_SIZE 
+        || (packet[2] & 0xF8) != 0x00 // <-- Must be a standard query
+        || packet[4] != 0x00 || packet[5] != 0x01 // <-- With one question
+    ) {
+        return 0;
+    }
+
+    size_t questionEnd = 0;
+    for (size_t i = 0; i < FAST_NAME_COUNT; i++) {
+        const FastName &name = FAST_NAMES[i];
+        if (length >= (size_t)(DNS_HEADER_SIZE + name.length) && memcmp(packet + DNS_HEADER_SIZE, name.question, name.length) == 0) {
+            questionEnd = DNS_HEADER_SIZE + name.length;
+            isFast = true;
+            break;
+        }
+    }
+
+    if (!isFast) {
+        questionEnd = findQuestionEnd(length);
+        if (questionEnd == 0) {
+            return 0;
+        }
+    }
+
+    bool isA = packet[questionEnd - 4] == 0x00 && packet[questionEnd - 3] == DNS_TYPE_A;
+
+    packet[2] = 0x84 | (packet[2] & 0x01); // <-- Response, authoritative, keep recursion desired
+    packet[3] = 0x80; // <-- Recursion available, no error
+    packet[6] = 0x00;
+    packet[7] = isA ? 0x01 : 0x00;
+    memset(packet + 8, 0, 4); // <-- No authority or additional records
+
+    return isA ? appendAnswer(questionEnd) : questionEnd;
+}
+
+/**
+ * #### PRIVATE ####
+ * Walks the labels of the question's name to find where the 
+ * question ends.
+ * 
+ * @param length - The length of the query as size_t.
+ * 
+ * @return Returns the offset just past the question, or zero if it
+ * is malformed, as size_t.
+ */
+size_t CaptiveDns::findQuestionEnd(size_t length) {
+    size_t offset = DNS_HEADER_SIZE;
+    while (offset < length && packet[offset] != 0) {
+        if ((packet[offset] & 0xC0) != 0) {
+            return 0; // <-- Compression isn't used in questions
+        }
+        offset += packet[offset] + 1;
+    }
+
+    offset += 1 + 4; // <-- Root label, type and class
+    
+    return offset <= length ? offset : 0;
+}
+
+/**
+ * #### PRIVATE ####
+ * Appends the A record answer, pointing back to the question's 
+ * name, after the question.
+ * 
+ * @param offset - The end of the question as size_t.
+ * 
+ * @return Returns the length of the answer, or zero if it doesn't
+ * fit, as size_t.
+ */
+size_t CaptiveDns::appendAnswer(size_t offset) {
+    if (offset + DNS_ANSWER_SIZE > PACKET_BUFFER_SIZE) {
+        return 0;
+    }
+
+    const uint8_t record[DNS_ANSWER_SIZE] = {
+        0xC0, DNS_HEADER_SIZE, // <-- Name is the question's
+        0x00, DNS_TYPE_A,
+        0x00, DNS_CLASS_IN,
+        (uint8_t)(ANSWER_TTL_SECONDS >> 24), (uint8_t)(ANSWER_TTL_SECONDS >> 16), 
+        (uint8_t)(ANSWER_TTL_SECONDS >> 8), (uint8_t)ANSWER_TTL_SECONDS,
+        0x00, 0x04,
+        address[0], address[1], address[2], address[3]
+    };
+    memcpy(packet + offset, record, DNS_ANSWER_SIZE);
+
+    return offset + DNS_ANSWER_SIZE;
+}
+
+/**
+ * #### PRIVATE ####
+ * Records a query in the statistics.
+ * 
+ * @param isFast - Whether the precomputed table answered as bool.
+ * @param isDropped - Whether the query was dropped as bool.
+ * @param micros - The time taken to answer as uint32_t.
+ */
+void CaptiveDns::record(bool isFast, bool isDropped, uint32_t micros) {
+    portENTER_CRITICAL(&statsMux);
+    stats.queries++;
+    if (isFast) {
+        stats.fastAnswers++;
+    }
+    if (isDropped) {
+        stats.dropped++;
+    }
+    stats.lastMicros = micros;
+    stats.totalMicros += micros;
+    if (micros > stats.worstMicros) {
+        stats.worstMicros = micros;
+    }
+    portEXIT_CRITICAL(&statsMux);
+}
@@ -0,0 +1,76 @@
+/*
+    CaptiveDns.h
+    This is the header file for the CaptiveDns Class.
+
+    The purpose of this class is to answer every DNS query with the device's own address so that
+    phones and laptops joining the AP open the captive portal. It is served from its own low priority
+    SocketWorker task, blocking on the socket, so answers never wait on the main loop. Neither
+    start() nor stop() waits on that task; Starting again while it is still stopping restarts it.
+    Packets are handled in a single preallocated buffer.
+
+    The hostnames which Apple, Android and Windows probe to detect a captive portal are answered
+    from a table of precomputed questions; a probe is recognised by comparing its question to the
+    table byte for byte and is answered without parsing the name. Anything else is parsed just far
+    enough to find the end of its question. A queries get the device's address, other types get an
+    empty answer so that clients don't sit waiting on them.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef CaptiveDns_h
+    #define CaptiveDns_h
+
+    #include <Arduino.h>
+    #include <IPAddress.h>
+    #include <SocketWorker.h>
+
+    class CaptiveDns : public SocketWorker {
+    public:
+        struct Stats {
+            unsigned long queries;
+            unsigned long fastAnswers;
+            unsigned long dropped;
+            uint32_t lastMicros;
+            uint32_t worstMicros;
+            uint64_t totalMicros;
+        };
+
+        static const size_t PACKET_BUFFER_SIZE = 512;
+        static const uint32_t TASK_STACK_SIZE = 3072UL;
+        static const UBaseType_t TASK_PRIORITY = 1;
+        static const uint32_t ANSWER_TTL_SECONDS = 60UL;
+
+        bool start(IPAddress address, uint16_t port = 53);
+        void stop();
+        Stats getStats();
+
+    private:
+        struct FastName {
+            const uint8_t *question;
+            uint8_t length;
+        };
+
+        static const FastName FAST_NAMES[];
+        static const size_t FAST_NAME_COUNT;
+
+        uint8_t packet[PACKET_BUFFER_SIZE];
+        uint8_t address[4] = { 0, 0, 0, 0 }; // <-- The task's own
+        uint16_t port = 53;
+        uint8_t pendingAddress[4] = { 0, 0, 0, 0 }; // <-- Taken by the task when it next starts
+        uint16_t pendingPort = 53;
+        int socketFd = -1;
+
+        portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+        Stats stats = {};
+
+        void onStart() override;
+        uint32_t onWork() override;
+        void onStop() override;
+        bool bindSocket();
+        void closeSocket();
+        size_t answer(size_t length, bool &isFast);
+        size_t findQuestionEnd(size_t length);
+        size_t appendAnswer(size_t offset);
+        void record(bool isFast, bool isDropped, uint32_t micros);
+    };
+#endif
@@ -0,0 +1,188 @@
+/*
+    Clock.cpp
+    This is the code file for the Clock, ClockDomain and Deadline Classes.
+
+    The purpose of these classes is to be the one source of time for the firmware. Time is kept
+    as 64-bit microseconds from esp_timer_get_time() so that, unlike the 32-bit millis() counter
+    which wraps after about 49.7 days, it will not wrap for the life of the device.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <Clock.h>
+#include <esp_timer.h>
+
+Clock::MicrosSource Clock::source = nullptr;
+
+/**
+ * Returns the microseconds elapsed since boot.
+ * 
+ * @return Returns the elapsed microseconds as int64_t.
+ */
+int64_t Clock::nowMicros() {
+    return source == nullptr ? esp_timer_get_time() : source();
+}
+
+/**
+ * Returns the milliseconds elapsed since boot. Unlike millis()
+ * this value does not wrap.
+ * 
+ * @return Returns the elapsed milliseconds as uint64_t.
+ */
+uint64_t Clock::nowMillis() {
+    return (uint64_t)(nowMicros() / 1000LL);
+}
+
+/**
+ * Replaces the time source of the clock. This allows a virtual
+ * clock to be injected, such as when exercising timing code off
+ * of the device. Passing nullptr restores esp_timer_get_time().
+ * 
+ * @param source - The function providing microseconds as MicrosSource.
+ */
+void Clock::setSource(MicrosSource source) {
+    Clock::source = source;
+}
+
+/**
+ * Pauses the domain so that its time stands still until 
+ * resumed. Pausing an already paused domain does nothing.
+ */
+void ClockDomain::pause() {
+    if (pausedAtMicros < 0LL) {
+        pausedAtMicros = Clock::nowMicros();
+    }
+}
+
+/**
+ * Resumes the domain after a pause. The time spent paused is
+ * excluded from the domain's time from then on.
+ */
+void ClockDomain::resume() {
+    if (pausedAtMicros >= 0LL) {
+        pausedTotalMicros += Clock::nowMicros() - pausedAtMicros;
+        pausedAtMicros = -1LL;
+    }
+}
+
+/**
+ * Used to determine if the domain is currently paused.
+ * 
+ * @return Returns true if paused otherwise false as bool.
+ */
+bool ClockDomain::isPaused() {
+    return pausedAtMicros >= 0LL;
+}
+
+/**
+ * Returns the domain's time, which is the system time less all
+ * time spent paused. While paused the time returned is frozen.
+ * 
+ * @return Returns the domain's microseconds as int64_t.
+ */
+int64_t ClockDomain::nowMicros() {
+    int64_t now = pausedAtMicros >= 0LL ? pausedAtMicros : Clock::nowMicros();
+
+    return now - pausedTotalMicros;
+}
+
+/**
+ * Returns the domain's time in milliseconds.
+ * 
+ * @return Returns the domain's milliseconds as uint64_t.
+ */
+uint64_t ClockDomain::nowMillis() {
+    return (uint64_t)(nowMicros() / 1000LL);
+}
+
+/**
+ * Constructs a Deadline measured against the given domain.
+ * 
+ * @param domain - The ClockDomain to measure against or nullptr 
+ * for the system clock.
+ */
+Deadline::Deadline(ClockDomain *domain) : domain(domain) {}
+
+/**
+ * Starts, or restarts, the deadline such that it expires the 
+ * given number of milliseconds from now.
+ * 
+ * @param durationMillis - The duration until expiry in milliseconds as uint64_t.
+ */
+void Deadline::start(uint64_t durationMillis) {
+    startMicros = now();
+    expiresMicros = startMicros + (int64_t)(durationMillis * 1000ULL);
+}
+
+/**
+ * Stops the deadline so that it is no longer active and will
+ * never report as expired.
+ */
+void Deadline::stop() {
+    startMicros = INACTIVE;
+    expiresMicros = INACTIVE;
+}
+
+/**
+ * Used to determine if the deadline has been started and not stopped.
+ * 
+ * @return Returns true if active otherwise false as bool.
+ */
+bool Deadline::isActive() {
+    return expiresMicros != INACTIVE;
+}
+
+/**
+ * Used to determine if an active deadline has been reached.
+ * 
+ * @return Returns true if active and expired otherwise false as bool.
+ */
+bool Deadline::isExpired() {
+    return isActive() && now() >= expiresMicros;
+}
+
+/**
+ * Returns the time left before the deadline expires.
+ * 
+ * @return Returns the remaining milliseconds, or zero if expired or 
+ * inactive, as uint64_t.
+ */
+uint64_t Deadline::remainingMillis() {
+    if (!isActive()) {
+        return 0ULL;
+    }
+    int64_t remaining = expiresMicros - now();
+
+    return remaining > 0LL ? (uint64_t)(remaining / 1000LL) : 0ULL;
+}
+
+/**
+ * Returns the time since the deadline was last started.
+ * 
+ * @return Returns the elapsed milliseconds, or zero if inactive, as uint64_t.
+ */
+uint64_t Deadline::elapsedMillis() {
+    if (!isActive()) {
+        return 0ULL;
+    }
+
+    return (uint64_t)((now() - startMicros) / 1000LL);
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Returns the current time of the domain this deadline is 
+ * measured against.
+ * 
+ * @return Returns the current microseconds as int64_t.
+ */
+int64_t Deadline::now() {
+    return domain == nullptr ? Clock::nowMicros() : domain->nowMicros();
+}
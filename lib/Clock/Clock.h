@@ -0,0 +1,68 @@
+/*
+    Clock.h
+    This is the header file for the Clock, ClockDomain and Deadline Classes.
+
+    The purpose of these classes is to be the one source of time for the firmware. Time is kept
+    as 64-bit microseconds from esp_timer_get_time() so that, unlike the 32-bit millis() counter
+    which wraps after about 49.7 days, it will not wrap for the life of the device.
+
+    A ClockDomain is a pausable view of the clock. While a domain is paused its time stands still,
+    which is how "presence time" ignores the periods where Bluetooth scanning is suspended.
+
+    A Deadline is a cheap timer which expires a given duration after it is started, measured
+    against either the system clock or a ClockDomain.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef Clock_h
+    #define Clock_h
+
+    #include <stdint.h>
+
+    class Clock {
+    public:
+        typedef int64_t (*MicrosSource)();
+
+        static int64_t nowMicros();
+        static uint64_t nowMillis();
+        static void setSource(MicrosSource source);
+
+    private:
+        static MicrosSource source;
+    };
+
+    class ClockDomain {
+    public:
+        void pause();
+        void resume();
+        bool isPaused();
+        int64_t nowMicros();
+        uint64_t nowMillis();
+
+    private:
+        int64_t pausedTotalMicros = 0LL;
+        int64_t pausedAtMicros = -1LL;
+    };
+
+    class Deadline {
+    public:
+        Deadline(ClockDomain *domain = nullptr);
+
+        void start(uint64_t durationMillis);
+        void stop();
+        bool isActive();
+        bool isExpired();
+        uint64_t remainingMillis();
+        uint64_t elapsedMillis();
+
+    private:
+        static const int64_t INACTIVE = -1LL;
+
+        ClockDomain *domain;
+        int64_t startMicros = INACTIVE;
+        int64_t expiresMicros = INACTIVE;
+
+        int64_t now();
+    };
+#endif
@@ -0,0 +1,380 @@
+/*
+    CounterLog.cpp
+    This is the code file for the CounterLog Class.
+
+    The purpose of this class is to keep counters across restarts as an append-only log of their
+    values in flash, wearing it a sector erase per few hundred changes.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <CounterLog.h>
+#include <Crc32.h>
+#include <string.h>
+
+#define SEALED_OFFSET 12
+#define SEALED 0x00000000UL
+#define READ_RECORDS 16 // <-- Records read at a time while reading a page through
+
+/**
+ * Writes a number into bytes, least significant first.
+ *
+ * @param bytes - Where to as uint8_t*.
+ * @param value - The number as uint32_t.
+ */
+static void put32(uint8_t *bytes, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        bytes[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+/**
+ * Reads a number from bytes, least significant first.
+ *
+ * @param bytes - Where from as const uint8_t*.
+ *
+ * @return Returns the number as uint32_t.
+ */
+static uint32_t get32(const uint8_t *bytes) {
+    uint32_t value = 0UL;
+    for (uint8_t i = 0; i < 4; i++) {
+        value |= (uint32_t)bytes[i] << (8 * i);
+    }
+
+    return value;
+}
+
+/**
+ * Starts the log, reading the counters back from the newest sealed
+ * page. Should the flash hold no log yet, one is started with every
+ * counter at zero.
+ *
+ * @param flash - The flash the log is kept in as Flash&.
+ * @param counterCount - How many counters there are, up to MAX_COUNTERS,
+ * as uint8_t.
+ *
+ * @return Returns true if started otherwise false as bool.
+ */
+bool CounterLog::begin(Flash &flash, uint8_t counterCount) {
+    this->flash = &flash;
+    this->counterCount = counterCount < MAX_COUNTERS ? counterCount : MAX_COUNTERS;
+    pageCount = flash.getSize() / PAGE_SIZE;
+    isStarted = false;
+    isNew = false;
+    skippedRecords = 0UL;
+    memset(values, 0, sizeof(values));
+
+    if (pageCount < 2) {
+        return false; // <-- There must be a page to move to when one fills
+    }
+
+    if (findPage()) {
+        isStarted = readPage();
+    } else {
+        isNew = true;
+        isStarted = startPage(0, 1UL);
+    }
+
+    return isStarted;
+}
+
+/**
+ * Used to determine if the log was started and can be used.
+ *
+ * @return Returns true if ready otherwise false as bool.
+ */
+bool CounterLog::isReady() {
+    return isStarted;
+}
+
+/**
+ * Used to determine if the log was started afresh, there being none
+ * before, so that counters kept elsewhere until now can be carried
+ * over.
+ *
+ * @return Returns true if new otherwise false as bool.
+ */
+bool CounterLog::isFresh() {
+    return isNew;
+}
+
+/**
+ * Gets a counter's value.
+ *
+ * @param counter - Which counter as uint8_t.
+ *
+ * @return Returns its value, or 0 if there is no such counter, as uint32_t.
+ */
+uint32_t CounterLog::get(uint8_t counter) {
+    return counter < counterCount ? values[counter] : 0UL;
+}
+
+/**
+ * Sets a counter, appending its new value to the log if it changed.
+ * When the page is full the next one is started, with every counter.
+ *
+ * @param counter - Which counter as uint8_t.
+ * @param value - Its new value as uint32_t.
+ *
+ * @return Returns true if kept otherwise false as bool.
+ */
+bool CounterLog::set(uint8_t counter, uint32_t value) {
+    if (!isStarted || counter >= counterCount) {
+        return false;
+    }
+    if (values[counter] == value) {
+        return true;
+    }
+    values[counter] = value;
+
+    return append(counter, value);
+}
+
+/**
+ * Adds to a counter.
+ *
+ * @param counter - Which counter as uint8_t.
+ * @param amount - How much to add as uint32_t.
+ *
+ * @return Returns true if kept otherwise false as bool.
+ */
+bool CounterLog::add(uint8_t counter, uint32_t amount) {
+    return set(counter, get(counter) + amount);
+}
+
+/**
+ * Gets the generation of the page in use, which goes up by one each
+ * time a page fills.
+ *
+ * @return Returns the generation as uint32_t.
+ */
+uint32_t CounterLog::getGeneration() {
+    return generation;
+}
+
+/**
+ * Gets how many more changes fit the page in use.
+ *
+ * @return Returns the records free as size_t.
+ */
+size_t CounterLog::getFreeRecords() {
+    return isStarted ? (PAGE_SIZE - writeOffset) / RECORD_SIZE : 0;
+}
+
+/**
+ * Gets how many records were skipped as failing their check when the
+ * page was read through; Each is a change cut short by power loss.
+ *
+ * @return Returns the count as unsigned long.
+ */
+unsigned long CounterLog::getSkippedRecords() {
+    return skippedRecords;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Finds the sealed page with the highest generation.
+ *
+ * @return Returns true if one was found otherwise false as bool.
+ */
+bool CounterLog::findPage() {
+    bool isFound = false;
+    for (size_t candidate = 0; candidate < pageCount; candidate++) {
+        uint8_t header[HEADER_SIZE];
+        if (!flash->read(candidate * PAGE_SIZE, header, sizeof(header))) {
+            continue;
+        }
+
+        uint32_t magic = get32(header);
+        uint32_t pageGeneration = get32(header + 4);
+        if (
+            magic != MAGIC
+            || get32(header + 8) != headerCheck(magic, pageGeneration)
+            || get32(header + SEALED_OFFSET) != SEALED
+        ) {
+            continue;
+        }
+
+        if (!isFound || pageGeneration > generation) {
+            isFound = true;
+            page = candidate;
+            generation = pageGeneration;
+        }
+    }
+
+    return isFound;
+}
+
+/**
+ * #### PRIVATE ####
+ * Reads the page in use through once, the last record of each counter
+ * giving its value, and finds where the next record goes.
+ *
+ * @return Returns true if read otherwise false as bool.
+ */
+bool CounterLog::readPage() {
+    uint8_t records[READ_RECORDS * RECORD_SIZE];
+    static const uint8_t ERASED[RECORD_SIZE] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+    size_t offset = HEADER_SIZE;
+    while (offset + RECORD_SIZE <= PAGE_SIZE) {
+        size_t length = PAGE_SIZE - offset < sizeof(records) ? PAGE_SIZE - offset : sizeof(records);
+        length -= length % RECORD_SIZE;
+        if (!flash->read(page * PAGE_SIZE + offset, records, length)) {
+            return false;
+        }
+
+        for (size_t i = 0; i < length; i += RECORD_SIZE, offset += RECORD_SIZE) {
+            if (memcmp(records + i, ERASED, RECORD_SIZE) == 0) {
+                writeOffset = offset; // <-- Records are written in order, so the rest are erased too
+
+                return true;
+            }
+
+            uint8_t counter = 0;
+            uint32_t value = 0UL;
+            if (decode(records + i, counter, value) && counter < counterCount) {
+                values[counter] = value;
+            } else {
+                skippedRecords++;
+            }
+        }
+    }
+    writeOffset = PAGE_SIZE;
+
+    return true;
+}
+
+/**
+ * #### PRIVATE ####
+ * Erases a page and starts it with every counter's value, sealing it
+ * last; Until sealed the page in use stays the one before it.
+ *
+ * @param nextPage - The page to start as size_t.
+ * @param nextGeneration - Its generation as uint32_t.
+ *
+ * @return Returns true if started otherwise false as bool.
+ */
+bool CounterLog::startPage(size_t nextPage, uint32_t nextGeneration) {
+    size_t base = nextPage * PAGE_SIZE;
+    if (!flash->eraseSector(base)) {
+        return false;
+    }
+
+    uint8_t header[SEALED_OFFSET];
+    put32(header, MAGIC);
+    put32(header + 4, nextGeneration);
+    put32(header + 8, headerCheck(MAGIC, nextGeneration));
+    if (!flash->write(base, header, sizeof(header))) {
+        return false;
+    }
+
+    for (uint8_t counter = 0; counter < counterCount; counter++) {
+        uint8_t record[RECORD_SIZE];
+        encode(record, counter, values[counter]);
+        if (!flash->write(base + HEADER_SIZE + counter * RECORD_SIZE, record, RECORD_SIZE)) {
+            return false;
+        }
+    }
+
+    uint8_t sealed[4];
+    put32(sealed, SEALED);
+    if (!flash->write(base + SEALED_OFFSET, sealed, sizeof(sealed))) {
+        return false;
+    }
+
+    page = nextPage;
+    generation = nextGeneration;
+    writeOffset = HEADER_SIZE + counterCount * RECORD_SIZE;
+
+    return true;
+}
+
+/**
+ * #### PRIVATE ####
+ * Appends a counter's new value to the page in use, moving on to the
+ * next page if it is full.
+ *
+ * @param counter - Which counter as uint8_t.
+ * @param value - Its value as uint32_t.
+ *
+ * @return Returns true if written otherwise false as bool.
+ */
+bool CounterLog::append(uint8_t counter, uint32_t value) {
+    if (writeOffset + RECORD_SIZE > PAGE_SIZE) {
+        return startPage((page + 1) % pageCount, generation + 1UL); // <-- Its values include this one
+    }
+
+    uint8_t record[RECORD_SIZE];
+    encode(record, counter, value);
+    bool ok = flash->write(page * PAGE_SIZE + writeOffset, record, RECORD_SIZE);
+    writeOffset += RECORD_SIZE; // <-- Even if it failed, as it may be partly written
+
+    return ok;
+}
+
+/**
+ * #### PRIVATE ####
+ * Lays out a record of a counter's value.
+ *
+ * @param record - Where to, RECORD_SIZE bytes, as uint8_t*.
+ * @param counter - Which counter as uint8_t.
+ * @param value - Its value as uint32_t.
+ */
+void CounterLog::encode(uint8_t *record, uint8_t counter, uint32_t value) {
+    put32(record, value);
+    record[4] = counter;
+    uint32_t check = Crc32::calculate(record, 5);
+    record[5] = (uint8_t)check;
+    record[6] = (uint8_t)(check >> 8);
+    record[7] = (uint8_t)(check >> 16);
+}
+
+/**
+ * #### PRIVATE ####
+ * Reads a record, checking it is intact.
+ *
+ * @param record - The record as const uint8_t*.
+ * @param counter - Set to which counter as uint8_t&.
+ * @param value - Set to its value as uint32_t&.
+ *
+ * @return Returns true if intact otherwise false as bool.
+ */
+bool CounterLog::decode(const uint8_t *record, uint8_t &counter, uint32_t &value) {
+    uint32_t check = Crc32::calculate(record, 5);
+    if (
+        record[5] != (uint8_t)check
+        || record[6] != (uint8_t)(check >> 8)
+        || record[7] != (uint8_t)(check >> 16)
+    ) {
+        return false;
+    }
+    value = get32(record);
+    counter = record[4];
+
+    return true;
+}
+
+/**
+ * #### PRIVATE ####
+ * Works out the check of a page's header.
+ *
+ * @param magic - The header's magic as uint32_t.
+ * @param pageGeneration - The page's generation as uint32_t.
+ *
+ * @return Returns the check as uint32_t.
+ */
+uint32_t CounterLog::headerCheck(uint32_t magic, uint32_t pageGeneration) {
+    uint8_t bytes[8];
+    put32(bytes, magic);
+    put32(bytes + 4, pageGeneration);
+
+    return Crc32::calculate(bytes, sizeof(bytes));
+}
@@ -0,0 +1,79 @@
+/*
+    CounterLog.h
+    This is the header file for the CounterLog Class.
+
+    The purpose of this class is to keep a few counters, such as startups, across restarts without
+    wearing the flash. Each change is appended to a log in a flash partition of its own as a small
+    record holding the counter's new value, so a change costs an 8 byte write and no erase:
+
+        page:   [magic x4][generation x4][CRC-32 of the two x4][sealed x4] then records
+        record: [value x4][counter][low 24 bits of the CRC-32 of value and counter x3]
+
+    Each 4K sector is a page, of which one is in use. When it fills the next page round is erased
+    and started with a record of every counter's value, then sealed by clearing its sealed word. On
+    starting the sealed page with the highest generation is read through once, the last record of
+    each counter giving its value; An erased record ends the log. A write cut short by power loss
+    leaves a record which fails its check and is skipped, or a page which isn't sealed and is
+    ignored, so each change is either kept whole or not at all.
+
+    Nothing here depends on the hardware; The flash is reached through a Flash so that the host
+    test in tools/counter_log_bench builds this too.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef CounterLog_h
+    #define CounterLog_h
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    class CounterLog {
+    public:
+        class Flash {
+        public:
+            virtual ~Flash() {}
+            virtual size_t getSize() = 0;
+            virtual bool read(size_t offset, void *data, size_t length) = 0;
+            virtual bool write(size_t offset, const void *data, size_t length) = 0; // <-- Can only clear bits
+            virtual bool eraseSector(size_t offset) = 0;
+        };
+
+        static const uint8_t MAX_COUNTERS = 8;
+        static const size_t PAGE_SIZE = 4096;   // <-- A flash sector
+        static const size_t HEADER_SIZE = 16;
+        static const size_t RECORD_SIZE = 8;
+        static const size_t RECORDS_PER_PAGE = (PAGE_SIZE - HEADER_SIZE) / RECORD_SIZE;
+        static const uint32_t MAGIC = 0x4C435850UL; // <-- "PXCL"
+
+        bool begin(Flash &flash, uint8_t counterCount);
+        bool isReady();
+        bool isFresh();
+        uint32_t get(uint8_t counter);
+        bool set(uint8_t counter, uint32_t value);
+        bool add(uint8_t counter, uint32_t amount = 1UL);
+        uint32_t getGeneration();
+        size_t getFreeRecords();
+        unsigned long getSkippedRecords();
+
+    private:
+        Flash *flash = nullptr;
+        uint8_t counterCount = 0;
+        size_t pageCount = 0;
+        size_t page = 0;
+        size_t writeOffset = 0;  // <-- Within the page
+        uint32_t generation = 0UL;
+        bool isStarted = false;
+        bool isNew = false;
+        unsigned long skippedRecords = 0UL;
+        uint32_t values[MAX_COUNTERS];
+
+        bool findPage();
+        bool readPage();
+        bool startPage(size_t nextPage, uint32_t nextGeneration);
+        bool append(uint8_t counter, uint32_t value);
+        static void encode(uint8_t *record, uint8_t counter, uint32_t value);
+        static bool decode(const uint8_t *record, uint8_t &counter, uint32_t &value);
+        static uint32_t headerCheck(uint32_t magic, uint32_t pageGeneration);
+    };
+#endif
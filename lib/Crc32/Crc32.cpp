@@ -0,0 +1,49 @@
+/*
+    Crc32.cpp
+    This is the code file for the Crc32 Class.
+
+    The purpose of this class is to work out the CRC-32 of a run of bytes.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <Crc32.h>
+
+#define POLYNOMIAL 0xEDB88320UL // <-- Reflected 0x04C11DB7
+
+struct Crc32Table {
+    uint32_t entries[256];
+
+    constexpr Crc32Table() : entries() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                crc = (crc & 1UL) ? (crc >> 1) ^ POLYNOMIAL : crc >> 1;
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+static constexpr Crc32Table TABLE;
+
+/**
+ * Works out the CRC-32 of some bytes. Passing in the CRC of the bytes 
+ * before them carries it on, so a record can be checked in pieces.
+ *
+ * @param data - The bytes as const void*.
+ * @param length - How many bytes as size_t.
+ * @param crc - The CRC of the bytes before, if any, as uint32_t.
+ *
+ * @return Returns the CRC as uint32_t.
+ */
+uint32_t Crc32::calculate(const void *data, size_t length, uint32_t crc) {
+    const uint8_t *bytes = (const uint8_t*)data;
+    crc = ~crc;
+    while (length-- > 0) {
+        crc = TABLE.entries[(crc ^ *bytes++) & 0xFFUL] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
@@ -0,0 +1,24 @@
+/*
+    Crc32.h
+    This is the header file for the Crc32 Class.
+
+    The purpose of this class is to work out the CRC-32 (the one zlib and Ethernet use) of a
+    run of bytes, a byte at a time through a 256 entry table which is built at compile time. It
+    is how records kept in flash are checked as being intact.
+
+    Nothing here depends on the hardware so that the host tools in tools/ build it too.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef Crc32_h
+    #define Crc32_h
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    class Crc32 {
+    public:
+        static uint32_t calculate(const void *data, size_t length, uint32_t crc = 0UL);
+    };
+#endif
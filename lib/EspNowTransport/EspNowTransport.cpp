@@ -0,0 +1,155 @@
+/*
+    EspNowTransport.cpp
+    This is the code file for the EspNowTransport Class.
+
+    The purpose of this class is to broadcast gossip frames over ESP-NOW and queue the frames heard
+    from other switches.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <EspNowTransport.h>
+#include <esp_now.h>
+
+static const uint8_t BROADCAST_ADDRESS[ESP_NOW_ETH_ALEN] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+EspNowTransport *EspNowTransport::instance = nullptr;
+
+/**
+ * Starts ESP-NOW and registers the broadcast peer. The WiFi radio
+ * must already be on in station mode, connected or not.
+ *
+ * @param notify - Called from the WiFi driver's task when a frame
+ * arrives as Notify.
+ *
+ * @return Returns true if started otherwise false as bool.
+ */
+bool EspNowTransport::begin(Notify notify) {
+    if (isStarted) {
+        return true;
+    }
+
+    this->notify = notify;
+    instance = this;
+    if (esp_now_init() != ESP_OK) {
+        return false;
+    }
+
+    esp_now_peer_info_t peer = {};
+    memcpy(peer.peer_addr, BROADCAST_ADDRESS, ESP_NOW_ETH_ALEN);
+    peer.channel = 0; // <-- Whatever channel the radio is on
+    peer.ifidx = WIFI_IF_STA;
+    peer.encrypt = false;
+    if (esp_now_add_peer(&peer) != ESP_OK || esp_now_register_recv_cb(handleReceive) != ESP_OK) {
+        esp_now_deinit();
+        return false;
+    }
+    isStarted = true;
+
+    return true;
+}
+
+/**
+ * Stops ESP-NOW, discarding any frames not yet polled.
+ *
+ */
+void EspNowTransport::end() {
+    if (!isStarted) {
+        return;
+    }
+
+    esp_now_unregister_recv_cb();
+    esp_now_deinit();
+    isStarted = false;
+
+    portENTER_CRITICAL(&slotMux);
+    head = 0;
+    count = 0;
+    portEXIT_CRITICAL(&slotMux);
+}
+
+/**
+ * Broadcasts a frame to every switch in range.
+ *
+ * @param frame - The frame as const uint8_t*.
+ * @param length - The length of the frame as size_t.
+ *
+ * @return Returns true if queued for sending otherwise false as bool.
+ */
+bool EspNowTransport::send(const uint8_t *frame, size_t length) {
+    return isStarted && esp_now_send(BROADCAST_ADDRESS, frame, length) == ESP_OK;
+}
+
+/**
+ * Takes the oldest received frame.
+ *
+ * @param frame - Where to copy the frame, Gossip::MAX_FRAME_SIZE
+ * long, as uint8_t*.
+ * @param length - Set to the length of the frame as size_t&.
+ *
+ * @return Returns true if there was a frame otherwise false as bool.
+ */
+bool EspNowTransport::poll(uint8_t *frame, size_t &length) {
+    bool isFound = false;
+
+    portENTER_CRITICAL(&slotMux);
+    if (count > 0) {
+        Slot &slot = slots[head];
+        memcpy(frame, slot.frame, slot.length);
+        length = slot.length;
+        head = (head + 1) % RECEIVE_SLOTS;
+        count--;
+        isFound = true;
+    }
+    portEXIT_CRITICAL(&slotMux);
+
+    return isFound;
+}
+
+/**
+ * Gets the number of frames dropped because the ring was full.
+ *
+ * @return Returns the count as unsigned long.
+ */
+unsigned long EspNowTransport::getDroppedFrames() {
+    return droppedFrames;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Called from the WiFi driver's task with each frame received; It
+ * is queued for poll().
+ *
+ * @param mac - The sender's address as const uint8_t*.
+ * @param data - The frame as const uint8_t*.
+ * @param length - The length of the frame as int.
+ */
+void EspNowTransport::handleReceive(const uint8_t *mac, const uint8_t *data, int length) {
+    EspNowTransport *transport = instance;
+    if (transport == nullptr || length <= 0 || length > (int)Gossip::MAX_FRAME_SIZE) {
+        return;
+    }
+
+    portENTER_CRITICAL(&transport->slotMux);
+    if (transport->count == RECEIVE_SLOTS) {
+        transport->droppedFrames++;
+        portEXIT_CRITICAL(&transport->slotMux);
+        return;
+    }
+    Slot &slot = transport->slots[(transport->head + transport->count) % RECEIVE_SLOTS];
+    memcpy(slot.frame, data, length);
+    slot.length = (size_t)length;
+    transport->count++;
+    portEXIT_CRITICAL(&transport->slotMux);
+
+    if (transport->notify != nullptr) {
+        transport->notify();
+    }
+}
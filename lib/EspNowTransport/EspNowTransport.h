@@ -0,0 +1,49 @@
+/*
+    EspNowTransport.h
+    This is the header file for the EspNowTransport Class.
+
+    The purpose of this class is to carry gossip frames between switches over ESP-NOW broadcasts,
+    which needs neither an AP nor a router; Only that the switches' radios are on the same channel.
+    Frames arrive on the WiFi driver's task, so they are copied into a small ring and the owner is
+    notified to poll() them from its own loop.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef EspNowTransport_h
+    #define EspNowTransport_h
+
+    #include <Arduino.h>
+    #include <Gossip.h>
+
+    class EspNowTransport : public Gossip::Transport {
+    public:
+        typedef void (*Notify)();
+
+        static const size_t RECEIVE_SLOTS = 4;
+
+        bool begin(Notify notify);
+        void end();
+        bool send(const uint8_t *frame, size_t length) override;
+        bool poll(uint8_t *frame, size_t &length);
+        unsigned long getDroppedFrames();
+
+    private:
+        struct Slot {
+            uint8_t frame[Gossip::MAX_FRAME_SIZE];
+            size_t length;
+        };
+
+        static EspNowTransport *instance;
+
+        Notify notify = nullptr;
+        bool isStarted = false;
+        Slot slots[RECEIVE_SLOTS];
+        uint8_t head = 0;
+        uint8_t count = 0;
+        unsigned long droppedFrames = 0UL;
+        portMUX_TYPE slotMux = portMUX_INITIALIZER_UNLOCKED;
+
+        static void handleReceive(const uint8_t *mac, const uint8_t *data, int length);
+    };
+#endif
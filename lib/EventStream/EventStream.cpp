@@ -0,0 +1,417 @@
+/*
+    EventStream.cpp
+    This is the code file for the EventStream Class.
+
+    The purpose of this class is to push live events to browsers as Server-Sent Events from a
+    preallocated ring, coalescing and rate limiting them per client.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <EventStream.h>
+
+/**
+ * Constructs the stream.
+ * 
+ * @param path - The URL path of the stream as const char*.
+ */
+EventStream::EventStream(const char *path) : path(path) {}
+
+/**
+ * Initializes the stream.
+ * 
+ * @param eventNames - The SSE event name of each event type, indexed
+ * by type, as const char* const*.
+ * @param eventCount - The number of event types, at most
+ * MAX_EVENT_TYPES, as uint8_t.
+ * @param minIntervalMillis - The least time between sends to a client
+ * as uint32_t.
+ */
+void EventStream::begin(const char * const *eventNames, uint8_t eventCount, uint32_t minIntervalMillis) {
+    this->eventNames = eventNames;
+    this->eventCount = eventCount < MAX_EVENT_TYPES ? eventCount : MAX_EVENT_TYPES;
+    this->minIntervalMillis = minIntervalMillis;
+    clientMutex = xSemaphoreCreateRecursiveMutex();
+}
+
+/**
+ * Sets the handler called, from the web server's task, once a client
+ * has connected.
+ * 
+ * @param handler - The handler as ConnectHandler.
+ */
+void EventStream::onConnect(ConnectHandler handler) {
+    connectHandler = handler;
+}
+
+/**
+ * Publishes an event to all clients. This only records the event in
+ * the ring; It is sent from service().
+ * 
+ * @param type - The type of the event as uint8_t.
+ * @param value - The value of the event as int32_t.
+ */
+void EventStream::publish(uint8_t type, int32_t value) {
+    if (clientCount == 0 || type >= eventCount) {
+        return;
+    }
+
+    ring[head % RING_SIZE] = { type, value, Clock::nowMillis() };
+    head++;
+}
+
+/**
+ * Services every client; Pulls its new events and sends what its
+ * socket has room for. Meant to be run periodically, from the same
+ * task as publish(), while there are clients.
+ * 
+ */
+void EventStream::service() {
+    if (clientMutex == nullptr) {
+        return;
+    }
+
+    uint64_t nowMillis = Clock::nowMillis();
+
+    xSemaphoreTakeRecursive(clientMutex, portMAX_DELAY);
+    for (StreamClient &streamClient : clients) {
+        if (streamClient.client == nullptr) {
+            continue;
+        }
+
+        pull(streamClient);
+        if (streamClient.outLength == 0 && nowMillis - streamClient.lastSendMillis >= minIntervalMillis) {
+            fill(streamClient, nowMillis);
+        }
+        drain(streamClient);
+    }
+    xSemaphoreGiveRecursive(clientMutex);
+}
+
+/**
+ * Disconnects all clients.
+ * 
+ */
+void EventStream::closeAll() {
+    if (clientMutex == nullptr) {
+        return;
+    }
+
+    xSemaphoreTakeRecursive(clientMutex, portMAX_DELAY);
+    for (StreamClient &streamClient : clients) {
+        if (streamClient.client != nullptr) {
+            streamClient.client->close(true); // <-- Its disconnect handler frees the slot
+        }
+    }
+    xSemaphoreGiveRecursive(clientMutex);
+}
+
+/**
+ * Gets the number of connected clients.
+ * 
+ * @return Returns the client count as uint8_t.
+ */
+uint8_t EventStream::getClientCount() {
+    return clientCount;
+}
+
+/**
+ * Gets the number of events which a client fell too far behind to
+ * pull from the ring.
+ * 
+ * @return Returns the dropped event count as unsigned long.
+ */
+unsigned long EventStream::getDroppedEvents() {
+    return droppedEvents;
+}
+
+/**
+ * Used by the web server to determine if the request is for this
+ * stream.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ * 
+ * @return Returns true if it is otherwise false as bool.
+ */
+bool EventStream::canHandle(AsyncWebServerRequest *request) {
+    return request->method() == HTTP_GET && request->url().equals(path);
+}
+
+/**
+ * Handles a request for the stream; Reserves a slot for the client,
+ * or answers with a 503 if there is none free. Called from the web
+ * server's task.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ */
+void EventStream::handleRequest(AsyncWebServerRequest *request) {
+    int slot = reserve();
+    if (slot < 0) {
+        request->send(503, F("text/plain"), F("Busy"));
+        return;
+    }
+
+    request->send(new StreamResponse(this, (uint8_t)slot));
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Reserves a free slot for a client which is being connected.
+ * 
+ * @return Returns the slot, or -1 if there is none free, as int.
+ */
+int EventStream::reserve() {
+    if (clientMutex == nullptr) {
+        return -1;
+    }
+
+    int slot = -1;
+    xSemaphoreTakeRecursive(clientMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < MAX_CLIENTS && slot < 0; i++) {
+        if (!clients[i].isReserved) {
+            clients[i].isReserved = true;
+            slot = i;
+        }
+    }
+    xSemaphoreGiveRecursive(clientMutex);
+
+    return slot;
+}
+
+/**
+ * #### PRIVATE ####
+ * Frees a slot whose client went before it was connected.
+ * 
+ * @param slot - The slot as uint8_t.
+ */
+void EventStream::release(uint8_t slot) {
+    xSemaphoreTakeRecursive(clientMutex, portMAX_DELAY);
+    clients[slot].isReserved = false;
+    xSemaphoreGiveRecursive(clientMutex);
+}
+
+/**
+ * #### PRIVATE ####
+ * Takes the connection of a request over, once its response headers
+ * have been sent, and connects it to its slot. The request is deleted
+ * here, as AsyncEventSource does, since the connection is no longer
+ * the request's. The client only receives events published from now
+ * on. Called from the web server's task.
+ * 
+ * @param slot - The slot reserved for the client as uint8_t.
+ * @param request - The request as AsyncWebServerRequest*.
+ */
+void EventStream::attach(uint8_t slot, AsyncWebServerRequest *request) {
+    AsyncClient *client = request->client();
+    client->setRxTimeout(0);
+    client->onError(nullptr, nullptr);
+    client->onAck(nullptr, nullptr);
+    client->onPoll(nullptr, nullptr);
+    client->onData(nullptr, nullptr);
+    client->onTimeout([](void *arg, AsyncClient *client, uint32_t time) {
+        client->close(true); // <-- Nothing acked for too long
+    }, nullptr);
+    client->onDisconnect([this, slot](void *arg, AsyncClient *client) {
+        detach(slot, client);
+    }, nullptr);
+    delete request;
+
+    xSemaphoreTakeRecursive(clientMutex, portMAX_DELAY);
+    StreamClient &streamClient = clients[slot];
+    streamClient.client = client;
+    streamClient.cursor = head;
+    streamClient.pendingTypes = 0;
+    streamClient.outOffset = 0;
+    streamClient.outLength = snprintf(streamClient.out, OUT_BUFFER_SIZE, "retry: 2000\n\n");
+    streamClient.lastSendMillis = Clock::nowMillis();
+    clientCount++;
+    xSemaphoreGiveRecursive(clientMutex);
+
+    if (connectHandler != nullptr) {
+        connectHandler();
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Frees the slot of a client which has disconnected, and the client
+ * itself.
+ * 
+ * @param slot - The client's slot as uint8_t.
+ * @param client - The client as AsyncClient*.
+ */
+void EventStream::detach(uint8_t slot, AsyncClient *client) {
+    xSemaphoreTakeRecursive(clientMutex, portMAX_DELAY);
+    clients[slot].client = nullptr;
+    clients[slot].isReserved = false;
+    clientCount--;
+    xSemaphoreGiveRecursive(clientMutex);
+
+    delete client;
+}
+
+/**
+ * #### PRIVATE ####
+ * Pulls the client's unseen events from the ring, keeping only the
+ * newest of each type.
+ * 
+ * @param streamClient - The client to pull for as StreamClient&.
+ */
+void EventStream::pull(StreamClient &streamClient) {
+    uint32_t newest = head;
+    if (newest - streamClient.cursor > RING_SIZE) {
+        droppedEvents += newest - streamClient.cursor - RING_SIZE;
+        streamClient.cursor = newest - RING_SIZE;
+    }
+
+    while (streamClient.cursor != newest) {
+        const Event &event = ring[streamClient.cursor % RING_SIZE];
+        streamClient.latest[event.type] = event;
+        streamClient.pendingTypes |= (1 << event.type);
+        streamClient.cursor++;
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Formats the client's pending events into its out buffer, or a
+ * keep-alive comment if it has been quiet for a while.
+ * 
+ * @param streamClient - The client to fill for as StreamClient&.
+ * @param nowMillis - The current time in millis as uint64_t.
+ */
+void EventStream::fill(StreamClient &streamClient, uint64_t nowMillis) {
+    for (uint8_t type = 0; type < eventCount && streamClient.pendingTypes != 0; type++) {
+        if ((streamClient.pendingTypes & (1 << type)) == 0) {
+            continue;
+        }
+
+        const Event &event = streamClient.latest[type];
+        size_t space = OUT_BUFFER_SIZE - streamClient.outLength;
+        int length = snprintf(
+            streamClient.out + streamClient.outLength, space,
+            "event: %s\ndata: {\"value\":%ld,\"at\":%llu}\n\n",
+            eventNames[type], (long)event.value, (unsigned long long)event.atMillis
+        );
+        if (length < 0 || (size_t)length >= space) {
+            break; // <-- Full; Rest are sent next time
+        }
+
+        streamClient.outLength += length;
+        streamClient.pendingTypes &= ~(1 << type);
+    }
+
+    if (streamClient.outLength == 0 && nowMillis - streamClient.lastSendMillis >= KEEP_ALIVE_MILLIS) {
+        // Lets a dead connection be noticed
+        streamClient.outLength = snprintf(streamClient.out, OUT_BUFFER_SIZE, ":\n\n");
+    }
+
+    if (streamClient.outLength > 0) {
+        streamClient.lastSendMillis = nowMillis;
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Sends as much of the client's out buffer as its socket has room
+ * for, without waiting.
+ * 
+ * @param streamClient - The client to send for as StreamClient&.
+ */
+void EventStream::drain(StreamClient &streamClient) {
+    size_t length = streamClient.outLength - streamClient.outOffset;
+    size_t space = streamClient.client->space();
+    if (length == 0 || space == 0) {
+        return; // <-- Nothing to send, or the socket is full; Try again later
+    }
+
+    size_t added = streamClient.client->add(streamClient.out + streamClient.outOffset, length < space ? length : space);
+    if (added > 0) {
+        streamClient.outOffset += added;
+        streamClient.client->send();
+    }
+
+    if (streamClient.outOffset == streamClient.outLength) {
+        streamClient.outOffset = 0;
+        streamClient.outLength = 0;
+    }
+}
+
+/*
+=================================================================
+StreamResponse BELOW
+=================================================================
+*/
+
+/**
+ * Constructs the response which sends a client the stream's headers
+ * and then hands its connection to the stream.
+ * 
+ * @param stream - The stream as EventStream*.
+ * @param slot - The slot reserved for the client as uint8_t.
+ */
+EventStream::StreamResponse::StreamResponse(EventStream *stream, uint8_t slot) : stream(stream), slot(slot) {
+    _code = 200;
+    _contentType = "text/event-stream";
+    _sendContentLength = false;
+    addHeader("Cache-Control", "no-cache");
+    addHeader("Connection", "keep-alive");
+}
+
+/**
+ * Frees the reserved slot, should the client have gone before its
+ * connection was handed to the stream.
+ * 
+ */
+EventStream::StreamResponse::~StreamResponse() {
+    if (!isAttached) {
+        stream->release(slot);
+    }
+}
+
+/**
+ * Used by the web server to determine the response has something to
+ * send.
+ * 
+ * @return Returns true as bool.
+ */
+bool EventStream::StreamResponse::_sourceValid() const {
+    return true;
+}
+
+/**
+ * Sends the response headers.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ */
+void EventStream::StreamResponse::_respond(AsyncWebServerRequest *request) {
+    String head = _assembleHead(request->version());
+    request->client()->write(head.c_str(), _headLength);
+    _state = RESPONSE_WAIT_ACK;
+}
+
+/**
+ * Hands the connection to the stream once the headers are acked.
+ * This deletes the request and so this response.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ * @param len - The count of bytes acked as size_t.
+ * @param time - Unused as uint32_t.
+ * 
+ * @return Returns 0 as size_t.
+ */
+size_t EventStream::StreamResponse::_ack(AsyncWebServerRequest *request, size_t len, uint32_t time) {
+    if (len > 0 && !isAttached) {
+        isAttached = true;
+        stream->attach(slot, request);
+    }
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+/*
+    EventStream.h
+    This is the header file for the EventStream Class.
+
+    The purpose of this class is to push live events to browsers as Server-Sent Events from the
+    async web server. Events are published into a preallocated ring and each connected client pulls
+    them from the ring at its own pace. Pulled events are coalesced per client so that only the
+    newest event of each type is waiting to be sent, and a client is sent to no more often than the
+    minimum interval. A client is only ever written what its socket has room for; The rest is kept
+    in the client's own fixed buffer and retried later. A slow or stalled browser therefore only
+    ever misses intermediate values and can never stall the loop or grow the heap.
+
+    The stream is its own handler rather than an AsyncEventSource, which would queue each message
+    on the heap for every client. It takes each client's connection over once the response headers
+    are sent, much as AsyncEventSource does. There are MAX_CLIENTS slots; Further browsers are
+    answered with a 503 so that the streams' memory is capped as well.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef EventStream_h
+    #define EventStream_h
+
+    #include <Arduino.h>
+    #include <ESPAsyncWebServer.h>
+    #include <Clock.h>
+
+    class EventStream : public AsyncWebHandler {
+    public:
+        static const uint8_t MAX_CLIENTS = 4;
+        static const uint8_t MAX_EVENT_TYPES = 8;
+        static const uint8_t RING_SIZE = 32;
+        static const size_t OUT_BUFFER_SIZE = 256;
+        static const uint64_t KEEP_ALIVE_MILLIS = 15000ULL;
+
+        typedef void (*ConnectHandler)();
+
+        EventStream(const char *path);
+
+        void begin(const char * const *eventNames, uint8_t eventCount, uint32_t minIntervalMillis);
+        void onConnect(ConnectHandler handler);
+        void publish(uint8_t type, int32_t value);
+        void service();
+        void closeAll();
+        uint8_t getClientCount();
+        unsigned long getDroppedEvents();
+
+        bool canHandle(AsyncWebServerRequest *request) override;
+        void handleRequest(AsyncWebServerRequest *request) override;
+
+    private:
+        struct Event {
+            uint8_t type;
+            int32_t value;
+            uint64_t atMillis;
+        };
+
+        struct StreamClient {
+            AsyncClient *client = nullptr; // <-- Set once the connection is taken over
+            bool isReserved = false;
+            uint32_t cursor = 0UL;
+            uint8_t pendingTypes = 0;
+            Event latest[MAX_EVENT_TYPES];
+            char out[OUT_BUFFER_SIZE];
+            size_t outLength = 0;
+            size_t outOffset = 0;
+            uint64_t lastSendMillis = 0ULL;
+        };
+
+        class StreamResponse : public AsyncWebServerResponse {
+        public:
+            StreamResponse(EventStream *stream, uint8_t slot);
+            ~StreamResponse();
+
+            bool _sourceValid() const override;
+            void _respond(AsyncWebServerRequest *request) override;
+            size_t _ack(AsyncWebServerRequest *request, size_t len, uint32_t time) override;
+
+        private:
+            EventStream *stream;
+            uint8_t slot;
+            bool isAttached = false;
+        };
+
+        String path;
+        const char * const *eventNames = nullptr;
+        uint8_t eventCount = 0;
+        uint32_t minIntervalMillis = 0UL;
+        ConnectHandler connectHandler = nullptr;
+        SemaphoreHandle_t clientMutex = nullptr; // <-- Recursive, as closing a client runs its disconnect handler
+
+        Event ring[RING_SIZE];
+        volatile uint32_t head = 0UL; // <-- Count of events ever published
+        StreamClient clients[MAX_CLIENTS];
+        volatile uint8_t clientCount = 0;
+        unsigned long droppedEvents = 0UL;
+
+        int reserve();
+        void release(uint8_t slot);
+        void attach(uint8_t slot, AsyncWebServerRequest *request);
+        void detach(uint8_t slot, AsyncClient *client);
+        void pull(StreamClient &streamClient);
+        void fill(StreamClient &streamClient, uint64_t nowMillis);
+        void drain(StreamClient &streamClient);
+    };
+#endif
@@ -0,0 +1,434 @@
+/*
+    Gossip.cpp
+    This is the code file for the Gossip Class.
+
+    The purpose of this class is to exchange sighting digests with other switches and decide whether
+    this switch is the one nearest to a beacon.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <Gossip.h>
+#include <Varint.h>
+#include <string.h>
+#include <ctype.h>
+
+#define FLAG_CLAIMING 0x01
+
+Gossip::Gossip(Transport &transport) : transport(transport) {}
+
+/**
+ * Starts gossiping as the given node.
+ *
+ * @param node - This switch's id, unique among the switches, as uint32_t.
+ * @param marginDb - How much stronger a peer must be to win as uint8_t.
+ * @param maxAgeMillis - How long a sighting counts for as uint32_t.
+ */
+void Gossip::begin(uint32_t node, uint8_t marginDb, uint32_t maxAgeMillis) {
+    this->node = node;
+    this->marginDb = marginDb;
+    this->maxAgeMillis = maxAgeMillis;
+    localCount = 0;
+    peerCount = 0;
+}
+
+/**
+ * Sets how much stronger a peer's signal must be for it to take the
+ * beacon from a switch which has its device on.
+ *
+ * @param marginDb - The margin in dB as uint8_t.
+ */
+void Gossip::setMargin(uint8_t marginDb) {
+    this->marginDb = marginDb;
+}
+
+/**
+ * Records this switch seeing a beacon, folding the sample into the
+ * beacon's filtered RSSI. A sighting which has gone stale starts the
+ * filter over.
+ *
+ * @param identity - The beacon's identity as uint32_t.
+ * @param rssi - The sampled RSSI as int.
+ * @param nowMillis - The current time as uint64_t.
+ */
+void Gossip::recordLocal(uint32_t identity, int rssi, uint64_t nowMillis) {
+    Sighting *sighting = findLocal(identity);
+    if (sighting == nullptr) {
+        if (localCount < MAX_LOCAL_SIGHTINGS) {
+            sighting = &local[localCount++];
+        } else {
+            // Replace the longest unseen
+            sighting = &local[0];
+            for (uint8_t i = 1; i < localCount; i++) {
+                if (local[i].seenMillis < sighting->seenMillis) {
+                    sighting = &local[i];
+                }
+            }
+        }
+        sighting->identity = identity;
+        sighting->isClaiming = false;
+        sighting->seenMillis = 0ULL;
+    }
+
+    if (sighting->seenMillis == 0ULL || !isFresh(*sighting, nowMillis)) {
+        sighting->filteredRssi = (int16_t)(rssi * RSSI_FILTER_SCALE);
+    } else {
+        // In fixed point, so that samples less than a step away still move it
+        sighting->filteredRssi = (int16_t)(sighting->filteredRssi + (rssi * RSSI_FILTER_SCALE - sighting->filteredRssi) / (1 << RSSI_FILTER_SHIFT));
+    }
+    int rounding = sighting->filteredRssi < 0 ? -RSSI_FILTER_SCALE / 2 : RSSI_FILTER_SCALE / 2;
+    sighting->rssi = (int8_t)((sighting->filteredRssi + rounding) / RSSI_FILTER_SCALE);
+    sighting->node = node;
+    sighting->seenMillis = nowMillis;
+}
+
+/**
+ * Sets whether this switch currently has its device on for a beacon,
+ * which lets it keep the beacon against peers within the margin.
+ *
+ * @param identity - The beacon's identity as uint32_t.
+ * @param isClaiming - Whether the device is on as bool.
+ */
+void Gossip::setClaiming(uint32_t identity, bool isClaiming) {
+    Sighting *sighting = findLocal(identity);
+    if (sighting != nullptr) {
+        sighting->isClaiming = isClaiming;
+    }
+}
+
+/**
+ * Sends this switch's fresh sightings to its peers.
+ *
+ * @param nowMillis - The current time as uint64_t.
+ *
+ * @return Returns true if sent otherwise false as bool.
+ */
+bool Gossip::broadcast(uint64_t nowMillis) {
+    Sighting fresh[MAX_LOCAL_SIGHTINGS];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < localCount; i++) {
+        if (isFresh(local[i], nowMillis)) {
+            fresh[count++] = local[i];
+        }
+    }
+
+    uint8_t frame[MAX_FRAME_SIZE];
+    size_t length = encode(frame, node, sequence++, fresh, count, nowMillis);
+    if (length == 0 || !transport.send(frame, length)) {
+        return false;
+    }
+    stats.sent++;
+
+    return true;
+}
+
+/**
+ * Takes in a frame from a peer; Its sightings replace whatever was
+ * last heard from that peer. Frames from this switch are ignored.
+ *
+ * @param frame - The frame as const uint8_t*.
+ * @param length - The length of the frame as size_t.
+ * @param nowMillis - The current time as uint64_t.
+ *
+ * @return Returns true if the frame was from a peer and valid
+ * otherwise false as bool.
+ */
+bool Gossip::receive(const uint8_t *frame, size_t length, uint64_t nowMillis) {
+    Sighting sightings[MAX_PEER_SIGHTINGS];
+    uint8_t count = 0;
+    if (!decode(frame, length, sightings, MAX_PEER_SIGHTINGS, count, nowMillis)) {
+        stats.rejected++;
+        return false;
+    }
+
+    uint32_t sender = (uint32_t)frame[2] | ((uint32_t)frame[3] << 8) | ((uint32_t)frame[4] << 16) | ((uint32_t)frame[5] << 24);
+    if (sender == node) {
+        return false;
+    }
+    stats.received++;
+
+    // Forget what the peer said before
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < peerCount; i++) {
+        if (peers[i].node != sender) {
+            peers[kept++] = peers[i];
+        }
+    }
+    peerCount = kept;
+
+    for (uint8_t i = 0; i < count; i++) {
+        storePeer(sightings[i], nowMillis);
+    }
+
+    return true;
+}
+
+/**
+ * Used to determine if this switch is the nearest to a beacon. With
+ * no fresh sighting of its own, or none from peers, it is.
+ *
+ * @param identity - The beacon's identity as uint32_t.
+ * @param nowMillis - The current time as uint64_t.
+ *
+ * @return Returns true if nearest otherwise false as bool.
+ */
+bool Gossip::isNearest(uint32_t identity, uint64_t nowMillis) {
+    Sighting *mine = findLocal(identity);
+    if (mine == nullptr || !isFresh(*mine, nowMillis)) {
+        return true;
+    }
+
+    for (uint8_t i = 0; i < peerCount; i++) {
+        const Sighting &peer = peers[i];
+        if (peer.identity != identity || !isFresh(peer, nowMillis)) {
+            continue;
+        }
+
+        int difference = (int)peer.rssi - (int)mine->rssi;
+        if (difference > (int)marginDb) {
+            return false; // <-- Clearly nearer
+        }
+        if (difference >= -(int)marginDb) {
+            // Too close to call on signal alone
+            if (peer.isClaiming && !mine->isClaiming) {
+                return false;
+            }
+            if (
+                peer.isClaiming == mine->isClaiming
+                && (difference > 0 || (difference == 0 && peer.node < node))
+            ) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Counts the peers which have sent fresh sightings.
+ *
+ * @param nowMillis - The current time as uint64_t.
+ *
+ * @return Returns the number of peers as uint8_t.
+ */
+uint8_t Gossip::getPeerCount(uint64_t nowMillis) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < peerCount; i++) {
+        if (!isFresh(peers[i], nowMillis)) {
+            continue;
+        }
+
+        bool isCounted = false;
+        for (uint8_t j = 0; j < i && !isCounted; j++) {
+            isCounted = peers[j].node == peers[i].node && isFresh(peers[j], nowMillis);
+        }
+        if (!isCounted) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Gets a copy of the gossip statistics.
+ *
+ * @return Returns the statistics as Stats.
+ */
+Gossip::Stats Gossip::getStats() {
+    return stats;
+}
+
+/**
+ * Derives a beacon's identity from its address, ignoring case; The
+ * 32 bit FNV-1a hash of the address.
+ *
+ * @param address - The beacon's address as const char*.
+ *
+ * @return Returns the identity as uint32_t.
+ */
+uint32_t Gossip::identityOf(const char *address) {
+    uint32_t hash = 2166136261UL;
+    for (const char *c = address; *c != '\0'; c++) {
+        hash ^= (uint8_t)tolower((unsigned char)*c);
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+/**
+ * Encodes sightings into a frame.
+ *
+ * @param frame - Where to encode, MAX_FRAME_SIZE long, as uint8_t*.
+ * @param node - The sending node as uint32_t.
+ * @param sequence - The frame's sequence number as uint8_t.
+ * @param sightings - The sightings as const Sighting*.
+ * @param count - The number of sightings as uint8_t.
+ * @param nowMillis - The current time as uint64_t.
+ *
+ * @return Returns the length of the frame, or zero if the sightings
+ * don't fit, as size_t.
+ */
+size_t Gossip::encode(uint8_t *frame, uint32_t node, uint8_t sequence, const Sighting *sightings, uint8_t count, uint64_t nowMillis) {
+    // Identities go out in order so each is sent as a small difference
+    uint8_t order[MAX_PEER_SIGHTINGS];
+    if (count > MAX_PEER_SIGHTINGS) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t j = i;
+        for (; j > 0 && sightings[order[j - 1]].identity > sightings[i].identity; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+
+    frame[0] = FRAME_MAGIC;
+    frame[1] = FRAME_VERSION;
+    frame[2] = (uint8_t)node;
+    frame[3] = (uint8_t)(node >> 8);
+    frame[4] = (uint8_t)(node >> 16);
+    frame[5] = (uint8_t)(node >> 24);
+    frame[6] = sequence;
+    frame[7] = count;
+
+    size_t offset = FRAME_HEADER_SIZE;
+    uint32_t previous = 0UL;
+    for (uint8_t i = 0; i < count; i++) {
+        const Sighting &sighting = sightings[order[i]];
+        if (offset + Varint::MAX_SIZE * 2 + 2 > MAX_FRAME_SIZE) {
+            return 0;
+        }
+
+        uint64_t age = nowMillis > sighting.seenMillis ? nowMillis - sighting.seenMillis : 0ULL;
+        offset += Varint::put(frame + offset, MAX_FRAME_SIZE - offset, sighting.identity - previous);
+        frame[offset++] = (uint8_t)sighting.rssi;
+        frame[offset++] = sighting.isClaiming ? FLAG_CLAIMING : 0x00;
+        offset += Varint::put(frame + offset, MAX_FRAME_SIZE - offset, age > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t)age);
+        previous = sighting.identity;
+    }
+
+    return offset;
+}
+
+/**
+ * Decodes the sightings in a frame, turning their ages back into
+ * times on this switch's clock.
+ *
+ * @param frame - The frame as const uint8_t*.
+ * @param length - The length of the frame as size_t.
+ * @param sightings - Where to decode the sightings as Sighting*.
+ * @param maxCount - The room in sightings as uint8_t.
+ * @param count - Set to the number of sightings as uint8_t&.
+ * @param nowMillis - The current time as uint64_t.
+ *
+ * @return Returns true if the frame is valid otherwise false as bool.
+ */
+bool Gossip::decode(const uint8_t *frame, size_t length, Sighting *sightings, uint8_t maxCount, uint8_t &count, uint64_t nowMillis) {
+    if (
+        length < FRAME_HEADER_SIZE
+        || frame[0] != FRAME_MAGIC
+        || frame[1] != FRAME_VERSION
+        || frame[7] > maxCount
+    ) {
+        return false;
+    }
+
+    uint32_t sender = (uint32_t)frame[2] | ((uint32_t)frame[3] << 8) | ((uint32_t)frame[4] << 16) | ((uint32_t)frame[5] << 24);
+    count = frame[7];
+
+    size_t offset = FRAME_HEADER_SIZE;
+    uint32_t identity = 0UL;
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t delta = 0UL;
+        uint32_t age = 0UL;
+        size_t used = Varint::get(frame + offset, length - offset, delta);
+        if (used == 0 || offset + used + 2 > length) {
+            return false;
+        }
+        offset += used;
+        identity += delta;
+
+        Sighting &sighting = sightings[i];
+        sighting.node = sender;
+        sighting.identity = identity;
+        sighting.rssi = (int8_t)frame[offset++];
+        sighting.isClaiming = (frame[offset++] & FLAG_CLAIMING) != 0;
+
+        used = Varint::get(frame + offset, length - offset, age);
+        if (used == 0) {
+            return false;
+        }
+        offset += used;
+        sighting.seenMillis = nowMillis > age ? nowMillis - age : 0ULL;
+    }
+
+    return offset == length;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Used to determine if a sighting is recent enough to count.
+ *
+ * @param sighting - The sighting as const Sighting&.
+ * @param nowMillis - The current time as uint64_t.
+ *
+ * @return Returns true if fresh otherwise false as bool.
+ */
+bool Gossip::isFresh(const Sighting &sighting, uint64_t nowMillis) {
+    return nowMillis - sighting.seenMillis <= maxAgeMillis;
+}
+
+/**
+ * #### PRIVATE ####
+ * Finds this switch's sighting of a beacon.
+ *
+ * @param identity - The beacon's identity as uint32_t.
+ *
+ * @return Returns the sighting or nullptr if none as Sighting*.
+ */
+Gossip::Sighting *Gossip::findLocal(uint32_t identity) {
+    for (uint8_t i = 0; i < localCount; i++) {
+        if (local[i].identity == identity) {
+            return &local[i];
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * #### PRIVATE ####
+ * Stores a peer's sighting, taking the place of a stale one or else
+ * the oldest when the table is full.
+ *
+ * @param sighting - The sighting as const Sighting&.
+ * @param nowMillis - The current time as uint64_t.
+ */
+void Gossip::storePeer(const Sighting &sighting, uint64_t nowMillis) {
+    if (peerCount < MAX_PEER_SIGHTINGS) {
+        peers[peerCount++] = sighting;
+        return;
+    }
+
+    uint8_t slot = 0;
+    for (uint8_t i = 0; i < peerCount; i++) {
+        if (!isFresh(peers[i], nowMillis)) {
+            slot = i;
+            break;
+        }
+        if (peers[i].seenMillis < peers[slot].seenMillis) {
+            slot = i;
+        }
+    }
+    peers[slot] = sighting;
+}
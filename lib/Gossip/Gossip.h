@@ -0,0 +1,99 @@
+/*
+    Gossip.h
+    This is the header file for the Gossip Class.
+
+    The purpose of this class is to let several switches which track the same beacon agree on which
+    of them is nearest to it, so that only the lamp in the room the beacon is in stays on. Each
+    switch broadcasts a compact digest of its own sightings (paired identity, filtered RSSI, age and
+    whether it currently has its device on) and keeps the latest digest heard from each peer.
+
+    A switch is nearest unless a peer with a fresh sighting of the same identity beats it. Within the
+    margin the switch which already has its device on keeps it, which stops two switches at about
+    the same distance from taking turns; Otherwise the stronger signal wins, ties going to the lower
+    node id.
+
+    Frames are delta encoded: identities are sorted and sent as differences from the one before, and
+    sighting times are sent as ages relative to the frame so the switches' clocks needn't agree.
+
+        [magic][version][node x4][sequence][count] then per sighting:
+        [identity delta (varint)][rssi][flags][age millis (varint)]
+
+    Nothing here depends on the hardware; Frames go out through a Transport and times are passed in,
+    so the protocol and arbitration can be run on a host against a simulated transport.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef Gossip_h
+    #define Gossip_h
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    class Gossip {
+    public:
+        class Transport {
+        public:
+            virtual ~Transport() {}
+            virtual bool send(const uint8_t *frame, size_t length) = 0;
+        };
+
+        struct Sighting {
+            uint32_t node;
+            uint32_t identity;
+            int8_t rssi;
+            int16_t filteredRssi; // <-- This switch's own, in 1/RSSI_FILTER_SCALE dB
+            bool isClaiming;
+            uint64_t seenMillis;
+        };
+
+        struct Stats {
+            unsigned long sent;
+            unsigned long received;
+            unsigned long rejected;
+        };
+
+        static const uint8_t FRAME_MAGIC = 0xB5;
+        static const uint8_t FRAME_VERSION = 1;
+        static const size_t FRAME_HEADER_SIZE = 8;
+        static const size_t MAX_FRAME_SIZE = 250; // <-- Largest ESP-NOW payload
+        static const size_t MAX_LOCAL_SIGHTINGS = 4;
+        static const size_t MAX_PEER_SIGHTINGS = 16;
+        static const uint8_t RSSI_FILTER_SHIFT = 3; // <-- Each sample moves the filter an eighth of the way
+        static const int RSSI_FILTER_SCALE = 16;
+
+        Gossip(Transport &transport);
+
+        void begin(uint32_t node, uint8_t marginDb, uint32_t maxAgeMillis);
+        void setMargin(uint8_t marginDb);
+        void recordLocal(uint32_t identity, int rssi, uint64_t nowMillis);
+        void setClaiming(uint32_t identity, bool isClaiming);
+        bool broadcast(uint64_t nowMillis);
+        bool receive(const uint8_t *frame, size_t length, uint64_t nowMillis);
+        bool isNearest(uint32_t identity, uint64_t nowMillis);
+        uint8_t getPeerCount(uint64_t nowMillis);
+        Stats getStats();
+
+        static uint32_t identityOf(const char *address);
+        static size_t encode(uint8_t *frame, uint32_t node, uint8_t sequence, const Sighting *sightings, uint8_t count, uint64_t nowMillis);
+        static bool decode(const uint8_t *frame, size_t length, Sighting *sightings, uint8_t maxCount, uint8_t &count, uint64_t nowMillis);
+
+    private:
+        Transport &transport;
+        uint32_t node = 0UL;
+        uint8_t marginDb = 0;
+        uint32_t maxAgeMillis = 0UL;
+        uint8_t sequence = 0;
+
+        Sighting local[MAX_LOCAL_SIGHTINGS];
+        uint8_t localCount = 0;
+        Sighting peers[MAX_PEER_SIGHTINGS];
+        uint8_t peerCount = 0;
+
+        Stats stats = {};
+
+        bool isFresh(const Sighting &sighting, uint64_t nowMillis);
+        Sighting *findLocal(uint32_t identity);
+        void storePeer(const Sighting &sighting, uint64_t nowMillis);
+    };
+#endif
@@ -0,0 +1,229 @@
+/*
+    HealthFrame.cpp
+    This is the code file for the HealthFrame Class.
+
+    The purpose of this class is to write and read the switches' binary health frames.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <HealthFrame.h>
+#include <Varint.h>
+#include <string.h>
+
+/**
+ * Constructor for writing a frame.
+ *
+ * @param buffer - Where to write the frame as uint8_t*.
+ * @param size - The size of the buffer as size_t.
+ */
+HealthFrame::HealthFrame(uint8_t *buffer, size_t size) : buffer(buffer), size(size) {}
+
+/**
+ * Starts a new frame, writing its header.
+ *
+ * @param device - The sending device's id as uint32_t.
+ * @param sequence - The frame's sequence number as uint32_t.
+ *
+ * @return Returns true if it fit otherwise false as bool.
+ */
+bool HealthFrame::begin(uint32_t device, uint32_t sequence) {
+    length = 0;
+    isOverflow = size < 3;
+    if (!isOverflow) {
+        buffer[length++] = MAGIC_0;
+        buffer[length++] = MAGIC_1;
+        buffer[length++] = VERSION;
+    }
+
+    return put(device) && put(sequence);
+}
+
+/**
+ * Writes a counter or gauge field.
+ *
+ * @param field - The field as Field.
+ * @param value - The value as uint32_t.
+ *
+ * @return Returns true if it fit otherwise false as bool.
+ */
+bool HealthFrame::value(Field field, uint32_t value) {
+    return put((uint32_t)field << 1) && put(value);
+}
+
+/**
+ * Writes a histogram field.
+ *
+ * @param field - The field as Field.
+ * @param buckets - The bucket counts as const uint32_t*.
+ * @param count - The number of buckets as uint8_t.
+ *
+ * @return Returns true if it fit otherwise false as bool.
+ */
+bool HealthFrame::histogram(Field field, const uint32_t *buckets, uint8_t count) {
+    bool ok = put(((uint32_t)field << 1) | 1UL) && put(count);
+    for (uint8_t i = 0; ok && i < count; i++) {
+        ok = put(buckets[i]);
+    }
+
+    return ok;
+}
+
+/**
+ * Gets the length of the frame written so far.
+ *
+ * @return Returns the length, or zero if anything didn't fit, as size_t.
+ */
+size_t HealthFrame::getLength() {
+    return isOverflow ? 0 : length;
+}
+
+/**
+ * Decodes a frame. Fields which aren't known are skipped, as are
+ * histogram buckets beyond those known.
+ *
+ * @param frame - The frame as const uint8_t*.
+ * @param length - The length of the frame as size_t.
+ * @param decoded - Set to what the frame holds as Decoded&.
+ *
+ * @return Returns true if the frame is valid otherwise false as bool.
+ */
+bool HealthFrame::decode(const uint8_t *frame, size_t length, Decoded &decoded) {
+    memset(&decoded, 0, sizeof(decoded));
+    if (length < 5 || frame[0] != MAGIC_0 || frame[1] != MAGIC_1 || frame[2] != VERSION) {
+        return false;
+    }
+    decoded.version = frame[2];
+
+    size_t offset = 3;
+    size_t used = Varint::get(frame + offset, length - offset, decoded.device);
+    if (used == 0) {
+        return false;
+    }
+    offset += used;
+    used = Varint::get(frame + offset, length - offset, decoded.sequence);
+    if (used == 0) {
+        return false;
+    }
+    offset += used;
+
+    while (offset < length) {
+        uint32_t tag = 0UL;
+        used = Varint::get(frame + offset, length - offset, tag);
+        if (used == 0) {
+            return false;
+        }
+        offset += used;
+
+        uint32_t field = tag >> 1;
+        if ((tag & 1UL) == 0UL) {
+            uint32_t value = 0UL;
+            used = Varint::get(frame + offset, length - offset, value);
+            if (used == 0) {
+                return false;
+            }
+            offset += used;
+
+            if (field < FIELD_COUNT) {
+                decoded.values[field] = value;
+                decoded.fieldMask |= 1UL << field;
+            }
+            continue;
+        }
+
+        uint32_t count = 0UL;
+        used = Varint::get(frame + offset, length - offset, count);
+        if (used == 0) {
+            return false;
+        }
+        offset += used;
+
+        uint32_t *buckets = nullptr;
+        if (field == FIELD_RSSI_HISTOGRAM) {
+            buckets = decoded.rssiHistogram;
+        } else if (field == FIELD_DWELL_HISTOGRAM) {
+            buckets = decoded.dwellHistogram;
+        }
+        if (buckets != nullptr) {
+            decoded.fieldMask |= 1UL << field;
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t bucket = 0UL;
+            used = Varint::get(frame + offset, length - offset, bucket);
+            if (used == 0) {
+                return false;
+            }
+            offset += used;
+
+            if (buckets != nullptr && i < MAX_BUCKETS) {
+                buckets[i] = bucket;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Finds the RSSI histogram bucket for a sample.
+ *
+ * @param rssi - The sample as int.
+ *
+ * @return Returns the bucket as uint8_t.
+ */
+uint8_t HealthFrame::rssiBucket(int rssi) {
+    if (rssi < -90) {
+        return 0;
+    }
+    if (rssi >= -30) {
+        return RSSI_BUCKETS - 1;
+    }
+
+    return (uint8_t)(1 + (rssi + 90) / 10);
+}
+
+/**
+ * Finds the dwell histogram bucket for how long presence held.
+ *
+ * @param seconds - How long presence held as uint32_t.
+ *
+ * @return Returns the bucket as uint8_t.
+ */
+uint8_t HealthFrame::dwellBucket(uint32_t seconds) {
+    const uint32_t limits[DWELL_BUCKETS - 1] = { 10UL, 60UL, 600UL, 3600UL, 86400UL };
+    for (uint8_t i = 0; i < DWELL_BUCKETS - 1; i++) {
+        if (seconds < limits[i]) {
+            return i;
+        }
+    }
+
+    return DWELL_BUCKETS - 1;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Appends a value as a varint, marking the frame as overflowed should
+ * it not fit.
+ *
+ * @param value - The value as uint32_t.
+ *
+ * @return Returns true if it fit otherwise false as bool.
+ */
+bool HealthFrame::put(uint32_t value) {
+    size_t used = isOverflow ? 0 : Varint::put(buffer + length, size - length, value);
+    if (used == 0) {
+        isOverflow = true;
+        return false;
+    }
+    length += used;
+
+    return true;
+}
@@ -0,0 +1,81 @@
+/*
+    HealthFrame.h
+    This is the header file for the HealthFrame Class.
+
+    The purpose of this class is to encode and decode the compact binary health frames which the
+    switches multicast for the fleet collector. A frame is a small header followed by tagged fields,
+    every number written as a varint:
+
+        ['P']['H'][version][device][sequence] then per field:
+        [tag = field << 1 | isHistogram][value]  or  [tag][bucket count][bucket]...
+
+    Fields the reader doesn't know are skipped, so new ones can be added without bumping the version;
+    The version only changes if the layout itself does.
+
+    Nothing here depends on the hardware so that the collector in tools/collector builds it too.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef HealthFrame_h
+    #define HealthFrame_h
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    class HealthFrame {
+    public:
+        enum Field : uint8_t {
+            FIELD_UPTIME_SECONDS = 1,
+            FIELD_STARTUPS = 2,
+            FIELD_FREE_HEAP = 3,
+            FIELD_MIN_FREE_HEAP = 4,
+            FIELD_SCAN_WATCHDOGS = 5,
+            FIELD_SCANS = 6,
+            FIELD_PRESENCE_CHANGES = 7,
+            FIELD_SEEN_DEVICES = 8,
+            FIELD_MQTT_DROPPED = 9,
+            FIELD_GOSSIP_PEERS = 10,
+            FIELD_RSSI_HISTOGRAM = 11,     // <-- Paired RSSI samples since the last frame
+            FIELD_DWELL_HISTOGRAM = 12,    // <-- How long presence held before each change
+            FIELD_COUNT = 13
+        };
+
+        static const uint8_t MAGIC_0 = 'P';
+        static const uint8_t MAGIC_1 = 'H';
+        static const uint8_t VERSION = 1;
+        static const size_t MAX_FRAME_SIZE = 256;
+        static const uint8_t MAX_BUCKETS = 8;
+        static const uint8_t RSSI_BUCKETS = 8;     // <-- Below -90, then 10 dB wide, to -30 and up
+        static const uint8_t DWELL_BUCKETS = 6;    // <-- Under 10s, 1m, 10m, 1h, 1d, then longer
+
+        struct Decoded {
+            uint8_t version;
+            uint32_t device;
+            uint32_t sequence;
+            uint32_t fieldMask;
+            uint32_t values[FIELD_COUNT];
+            uint32_t rssiHistogram[MAX_BUCKETS];
+            uint32_t dwellHistogram[MAX_BUCKETS];
+        };
+
+        HealthFrame(uint8_t *buffer, size_t size);
+
+        bool begin(uint32_t device, uint32_t sequence);
+        bool value(Field field, uint32_t value);
+        bool histogram(Field field, const uint32_t *buckets, uint8_t count);
+        size_t getLength();
+
+        static bool decode(const uint8_t *frame, size_t length, Decoded &decoded);
+        static uint8_t rssiBucket(int rssi);
+        static uint8_t dwellBucket(uint32_t seconds);
+
+    private:
+        uint8_t *buffer;
+        size_t size;
+        size_t length = 0;
+        bool isOverflow = false;
+
+        bool put(uint32_t value);
+    };
+#endif
@@ -0,0 +1,112 @@
+/*
+    JsonResponse.cpp
+    This is the code file for the JsonResponse Class.
+
+    The purpose of this class is to stream JSON from the async web server a step at a time, as the
+    connection has room for it, using fixed buffers.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <JsonResponse.h>
+
+/**
+ * Constructs a chunked JSON response.
+ * 
+ * @param producer - Writes the next step of the document and tells
+ * if there are more, as Producer.
+ */
+JsonResponse::JsonResponse(Producer producer) 
+    : producer(producer), json(writerBuffer, sizeof(writerBuffer), handleOutput, this) {
+    _code = 200;
+    _contentType = F("application/json");
+    _contentLength = 0;
+    _sendContentLength = false;
+    _chunked = true;
+    addHeader(F("Cache-Control"), F("no-store"));
+}
+
+/**
+ * Gets the cursor, so a request's arguments can set where the 
+ * producer starts.
+ * 
+ * @return Returns the cursor as Cursor&.
+ */
+JsonResponse::Cursor& JsonResponse::getCursor() {
+    return cursor;
+}
+
+/**
+ * Tells the server the body can be read.
+ * 
+ * @return Returns true as bool.
+ */
+bool JsonResponse::_sourceValid() const {
+    return true;
+}
+
+/**
+ * Called by the server to get the next part of the body. Steps of 
+ * the producer are run until the buffer is full.
+ * 
+ * @param buffer - The buffer to fill as uint8_t*.
+ * @param maxLength - The size of the buffer as size_t.
+ * 
+ * @return Returns the number of bytes written, zero once the 
+ * document is complete, as size_t.
+ */
+size_t JsonResponse::_fillBuffer(uint8_t *buffer, size_t maxLength) {
+    size_t written = 0;
+    while (written < maxLength) {
+        if (pendingOffset < pendingLength) {
+            size_t length = std::min(pendingLength - pendingOffset, maxLength - written);
+            memcpy(buffer + written, pending + pendingOffset, length);
+            written += length;
+            pendingOffset += length;
+            continue;
+        }
+
+        pendingOffset = 0;
+        pendingLength = 0;
+        if (isDone) {
+            break;
+        }
+
+        bool hasMore = producer(json, cursor);
+        cursor.step++;
+        json.flush();
+        if (!hasMore) {
+            isDone = true;
+        }
+    }
+
+    return written;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * The JsonWriter sink; Collects a step's output as pending.
+ * 
+ * @param data - The JSON written as const char*.
+ * @param length - The length of the JSON as size_t.
+ * @param context - The response as void*.
+ */
+void JsonResponse::handleOutput(const char *data, size_t length, void *context) {
+    JsonResponse *response = (JsonResponse *)context;
+    size_t space = PENDING_BUFFER_SIZE - response->pendingLength;
+    if (length > space) {
+        // A step wrote too much; End the document rather than send it corrupted
+        length = space;
+        response->isDone = true;
+    }
+
+    memcpy(response->pending + response->pendingLength, data, length);
+    response->pendingLength += length;
+}
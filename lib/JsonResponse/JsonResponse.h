@@ -0,0 +1,56 @@
+/*
+    JsonResponse.h
+    This is the header file for the JsonResponse Class.
+
+    The purpose of this class is to stream JSON from the async web server without ever building
+    the document in memory. The async server pulls a response's body a socket's worth at a time,
+    so rather than writing the whole document up front a Producer is called to write it a step at a
+    time (e.g. the header, then one device per step) only as the socket has room for it. A Cursor
+    carries the producer's place between steps.
+
+    Each response owns fixed buffers, which caps the memory of a connection no matter how large
+    the document is. A single step must never write more than PENDING_BUFFER_SIZE bytes.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef JsonResponse_h
+    #define JsonResponse_h
+
+    #include <Arduino.h>
+    #include <ESPAsyncWebServer.h>
+    #include <JsonWriter.h>
+
+    class JsonResponse : public AsyncAbstractResponse {
+    public:
+        struct Cursor {
+            uint32_t step = 0UL;
+            long offset = 0L;
+            long remaining = 0L;
+            char lastKey[24] = "";
+        };
+
+        typedef bool (*Producer)(JsonWriter &json, Cursor &cursor);
+
+        static const size_t WRITER_BUFFER_SIZE = 128;
+        static const size_t PENDING_BUFFER_SIZE = 768;
+
+        JsonResponse(Producer producer);
+        Cursor& getCursor();
+
+        bool _sourceValid() const override;
+        size_t _fillBuffer(uint8_t *buffer, size_t maxLength) override;
+
+    private:
+        Producer producer;
+        Cursor cursor;
+        char writerBuffer[WRITER_BUFFER_SIZE];
+        JsonWriter json;
+        char pending[PENDING_BUFFER_SIZE];
+        size_t pendingLength = 0;
+        size_t pendingOffset = 0;
+        bool isDone = false;
+
+        static void handleOutput(const char *data, size_t length, void *context);
+    };
+#endif
@@ -0,0 +1,404 @@
+/*
+    JsonWriter.cpp
+    This is the code file for the JsonWriter Class.
+
+    The purpose of this class is to produce JSON a buffer at a time, handing each full buffer to a
+    Sink so that the document is never held in memory as a whole.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <JsonWriter.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Constructs a writer over the given buffer.
+ * 
+ * @param buffer - The buffer output is collected in as char*.
+ * @param size - The size of the buffer as size_t.
+ * @param sink - Receives the buffer's content each time it fills 
+ * and on flush() as Sink.
+ * @param context - Passed along to the sink as void*.
+ */
+JsonWriter::JsonWriter(char *buffer, size_t size, Sink sink, void *context) 
+    : buffer(buffer), size(size), sink(sink), context(context) {}
+
+/**
+ * Opens an object.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::beginObject() {
+    open('{');
+
+    return *this;
+}
+
+/**
+ * Closes the current object.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::endObject() {
+    close('}');
+
+    return *this;
+}
+
+/**
+ * Opens an array.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::beginArray() {
+    open('[');
+
+    return *this;
+}
+
+/**
+ * Closes the current array.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::endArray() {
+    close(']');
+
+    return *this;
+}
+
+/**
+ * Writes the key of the next member of the current object.
+ * 
+ * @param name - The name of the member as const char*.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::key(const char *name) {
+    separate();
+    writeEscaped(name);
+    write(':');
+    isAfterKey = true;
+
+    return *this;
+}
+
+/**
+ * Writes a string value, escaping it as needed. A null pointer 
+ * is written as null.
+ * 
+ * @param string - The value as const char*.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::value(const char *string) {
+    if (string == nullptr) {
+        return nullValue();
+    }
+
+    separate();
+    writeEscaped(string);
+
+    return *this;
+}
+
+/**
+ * Writes a boolean value.
+ * 
+ * @param boolean - The value as bool.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::value(bool boolean) {
+    separate();
+    if (boolean) {
+        write("true", 4);
+    } else {
+        write("false", 5);
+    }
+
+    return *this;
+}
+
+/**
+ * Writes an integer value.
+ * 
+ * @param number - The value as int.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::value(int number) {
+    return value((long long)number);
+}
+
+/**
+ * Writes an integer value.
+ * 
+ * @param number - The value as unsigned int.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::value(unsigned int number) {
+    return value((unsigned long long)number);
+}
+
+/**
+ * Writes an integer value.
+ * 
+ * @param number - The value as long.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::value(long number) {
+    return value((long long)number);
+}
+
+/**
+ * Writes an integer value.
+ * 
+ * @param number - The value as unsigned long.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::value(unsigned long number) {
+    return value((unsigned long long)number);
+}
+
+/**
+ * Writes an integer value.
+ * 
+ * @param number - The value as long long.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::value(long long number) {
+    separate();
+    if (number < 0) {
+        writeInteger(0ULL - (unsigned long long)number, true);
+    } else {
+        writeInteger((unsigned long long)number, false);
+    }
+
+    return *this;
+}
+
+/**
+ * Writes an integer value.
+ * 
+ * @param number - The value as unsigned long long.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::value(unsigned long long number) {
+    separate();
+    writeInteger(number, false);
+
+    return *this;
+}
+
+/**
+ * Writes a decimal value with a fixed number of decimal places.
+ * Values JSON can't represent (NaN, Infinity) are written as null.
+ * 
+ * @param number - The value as double.
+ * @param decimals - The number of decimal places as uint8_t.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::value(double number, uint8_t decimals) {
+    if (number != number || number > 1.0e15 || number < -1.0e15) {
+        return nullValue();
+    }
+
+    char text[32];
+    int count = snprintf(text, sizeof(text), "%.*f", (int)decimals, number);
+    separate();
+    write(text, count < 0 ? 0 : ((size_t)count < sizeof(text) ? (size_t)count : sizeof(text) - 1));
+
+    return *this;
+}
+
+/**
+ * Writes a null value.
+ * 
+ * @return Returns this writer for chaining as JsonWriter&.
+ */
+JsonWriter& JsonWriter::nullValue() {
+    separate();
+    write("null", 4);
+
+    return *this;
+}
+
+/**
+ * Hands whatever is in the buffer to the sink. Must be called once
+ * the document is complete.
+ * 
+ */
+void JsonWriter::flush() {
+    if (length > 0) {
+        sink(buffer, length, context);
+        flushedBytes += length;
+        length = 0;
+    }
+}
+
+/**
+ * Gets the number of bytes written so far, including those still 
+ * in the buffer.
+ * 
+ * @return Returns the byte count as size_t.
+ */
+size_t JsonWriter::getTotalBytes() {
+    return flushedBytes + length;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Opens a container with the given bracket.
+ * 
+ * @param bracket - The opening bracket as char.
+ */
+void JsonWriter::open(char bracket) {
+    separate();
+    write(bracket);
+    if (depth < MAX_DEPTH) {
+        depth++;
+        hasItems &= ~(1UL << (depth - 1));
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Closes the current container with the given bracket.
+ * 
+ * @param bracket - The closing bracket as char.
+ */
+void JsonWriter::close(char bracket) {
+    if (depth > 0) {
+        depth--;
+    }
+    write(bracket);
+    isAfterKey = false;
+}
+
+/**
+ * #### PRIVATE ####
+ * Writes the comma before an item when it isn't the first item of 
+ * its container. A value following its key needs no separator.
+ * 
+ */
+void JsonWriter::separate() {
+    if (isAfterKey) {
+        isAfterKey = false;
+        return;
+    }
+
+    if (depth > 0) {
+        uint32_t bit = 1UL << (depth - 1);
+        if (hasItems & bit) {
+            write(',');
+        }
+        hasItems |= bit;
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Writes an integer's digits without going through printf.
+ * 
+ * @param magnitude - The absolute value as unsigned long long.
+ * @param isNegative - Whether a minus sign is needed as bool.
+ */
+void JsonWriter::writeInteger(unsigned long long magnitude, bool isNegative) {
+    char digits[21];
+    size_t start = sizeof(digits);
+    do {
+        digits[--start] = (char)('0' + (magnitude % 10ULL));
+        magnitude /= 10ULL;
+    } while (magnitude > 0ULL);
+
+    if (isNegative) {
+        digits[--start] = '-';
+    }
+    write(digits + start, sizeof(digits) - start);
+}
+
+/**
+ * #### PRIVATE ####
+ * Writes a quoted string, escaping quotes, backslashes and control
+ * characters. Runs of plain characters are copied as a block.
+ * 
+ * @param string - The string to write as const char*.
+ */
+void JsonWriter::writeEscaped(const char *string) {
+    static const char hex[] = "0123456789abcdef";
+
+    write('"');
+    const char *run = string;
+    for (const char *c = string; ; c++) {
+        uint8_t byte = (uint8_t)*c;
+        if (byte >= 0x20 && byte != '"' && byte != '\\') {
+            continue;
+        }
+
+        write(run, c - run);
+        if (byte == '\0') {
+            break;
+        }
+
+        if (byte == '"' || byte == '\\') {
+            write('\\');
+            write((char)byte);
+        } else if (byte == '\n') {
+            write("\\n", 2);
+        } else {
+            char escaped[6] = { '\\', 'u', '0', '0', hex[byte >> 4], hex[byte & 0x0F] };
+            write(escaped, sizeof(escaped));
+        }
+        run = c + 1;
+    }
+    write('"');
+}
+
+/**
+ * #### PRIVATE ####
+ * Writes a character to the buffer, flushing it first if full.
+ * 
+ * @param c - The character to write as char.
+ */
+void JsonWriter::write(char c) {
+    if (length >= size) {
+        flush();
+    }
+    buffer[length++] = c;
+}
+
+/**
+ * #### PRIVATE ####
+ * Writes characters to the buffer, flushing it as it fills.
+ * 
+ * @param data - The characters to write as const char*.
+ * @param count - The number of characters as size_t.
+ */
+void JsonWriter::write(const char *data, size_t count) {
+    while (count > 0) {
+        if (length >= size) {
+            flush();
+        }
+
+        size_t part = size - length < count ? size - length : count;
+        memcpy(buffer + length, data, part);
+        length += part;
+        data += part;
+        count -= part;
+    }
+}
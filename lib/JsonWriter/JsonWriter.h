@@ -0,0 +1,84 @@
+/*
+    JsonWriter.h
+    This is the header file for the JsonWriter Class.
+
+    The purpose of this class is to produce JSON without ever building it up in memory. Output is
+    written into a small fixed buffer supplied by the caller and, each time that buffer fills, it
+    is handed to a Sink which sends it on (e.g. as a chunk of an HTTP response). This keeps the
+    memory used constant no matter how large the document is, and avoids String allocations.
+
+    The writer tracks nesting so that commas and colons are placed automatically; the caller only
+    has to open and close objects and arrays in the right order. Strings are escaped as written.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef JsonWriter_h
+    #define JsonWriter_h
+
+    #include <stddef.h>
+    #include <stdint.h>
+
+    class JsonWriter {
+    public:
+        typedef void (*Sink)(const char *data, size_t length, void *context);
+
+        static const uint8_t MAX_DEPTH = 32;
+
+        JsonWriter(char *buffer, size_t size, Sink sink, void *context = nullptr);
+
+        JsonWriter& beginObject();
+        JsonWriter& endObject();
+        JsonWriter& beginArray();
+        JsonWriter& endArray();
+        JsonWriter& key(const char *name);
+
+        JsonWriter& value(const char *string);
+        JsonWriter& value(bool boolean);
+        JsonWriter& value(int number);
+        JsonWriter& value(unsigned int number);
+        JsonWriter& value(long number);
+        JsonWriter& value(unsigned long number);
+        JsonWriter& value(long long number);
+        JsonWriter& value(unsigned long long number);
+        JsonWriter& value(double number, uint8_t decimals = 2);
+        JsonWriter& nullValue();
+
+        /**
+         * Writes a key and its value as a member of the current object.
+         * 
+         * @param name - The name of the member as const char*.
+         * @param member - The value of the member as any type value() accepts.
+         * 
+         * @return Returns this writer for chaining as JsonWriter&.
+         */
+        template <typename T>
+        JsonWriter& field(const char *name, T member) {
+            key(name);
+            return value(member);
+        }
+
+        void flush();
+        size_t getTotalBytes();
+
+    private:
+        char *buffer;
+        size_t size;
+        size_t length = 0;
+        Sink sink;
+        void *context;
+
+        size_t flushedBytes = 0;
+        uint8_t depth = 0;
+        uint32_t hasItems = 0UL; // <-- Bit per depth; set once the container has an item
+        bool isAfterKey = false;
+
+        void open(char bracket);
+        void close(char bracket);
+        void separate();
+        void writeInteger(unsigned long long magnitude, bool isNegative);
+        void writeEscaped(const char *string);
+        void write(char c);
+        void write(const char *data, size_t count);
+    };
+#endif
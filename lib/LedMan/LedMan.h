@@ -13,6 +13,30 @@
     and flash it as dessired. When finished process 'B' can set the LED to off and release the lock.
     At that point the state of process 'A' would take over and the LED would go back to remaining lit.
 
+    LEDs and callers are compile-time enums, where the order of the caller enum is the priority 
+    order, first being the highest priority. For each LED the state of every caller is kept as a 
+    pair of bitmasks, one of callers wanting the LED on and one of callers holding a lock. A caller
+    has a say in the LED if it wants it on or holds a lock, and the highest priority caller with a 
+    say decides; that is simply the lowest set bit of the two masks combined. The LED is resolved 
+    whenever a caller changes its state, and the pin is only written when its level changes.
+
+    Instead of a steady on or off a caller may give an LED a pattern; a period, a duty, a number of
+    repeats and a priority. A pattern gives the caller a say just like wanting the LED on does, so the
+    same lock and priority rules decide whose pattern or state is shown. By default a pattern has its
+    caller's priority, but it may be given the priority of a higher caller instead, so that a pattern
+    such as a warning flash can show over callers its own caller would otherwise give way to. Only
+    when such a pattern is set does resolving an LED look past the lowest set bit, to each caller
+    with a say. The pattern of the winning caller is
+    played by an esp_timer which wakes only at each on/off edge, so blinking costs no loop time and
+    does not jitter with loop load. A pattern which is preempted starts over when it regains the LED,
+    and once a pattern has played its repeats the caller no longer has a say through it.
+
+    The state of the callers is guarded by a spinlock as patterns are played from the esp_timer task.
+    Only the bitmasks and what the pin and timer should be are changed inside it; the pin writes and
+    timer calls are made after it is left, by whichever caller gets to them first, which carries on
+    until the pin and timer have caught up with every change made meanwhile. The LedMan which the
+    firmware released with is compared against this one in tools/ledman_bench.
+
     Written by: ... Scott Griffis
     Date: ......... 07/07/2025
 */
@@ -20,26 +44,410 @@
     #define LedMan_h    
     
     #include <Arduino.h>
-    #include <WString.h>
-    #include <map>
-    #include <algorithm>
+    #include <esp_timer.h>
+
+    struct LedPattern {
+        uint32_t periodMillis;
+        uint8_t dutyPercent;
+        uint16_t repeats; // <-- Zero repeats forever
+        uint8_t priority; // <-- Plays at the priority of caller (priority - 1); Zero for its own caller's
+    };
     
+    template <typename Led, Led LED_COUNT, typename Caller, Caller CALLER_COUNT>
     class LedMan {
     public:
-        void addLed(int ledPin, String ledId);
-        void setCallerPriority(String caller, int priority);
-        void lockLed(String ledId, String caller);
-        void releaseLed(String ledId, String caller);
-        void ledOn(String ledId, String caller);
-        void ledOff(String ledId, String caller);
-        void ledToggle(String ledId, String caller);
-        int currentState(String ledId, String caller);
-        void loop();
+        static_assert(CALLER_COUNT <= 32, "LedMan supports at most 32 callers");
+
+        /**
+         * Constructs the LedMan for the given LED pins.
+         * 
+         * @param pins - The device pin of each LED, in the order of the LED enum.
+         */
+        LedMan(const uint8_t (&pins)[LED_COUNT]) {
+            for (uint8_t led = 0; led < LED_COUNT; led++) {
+                this->pins[led] = pins[led];
+            }
+        }
+
+        /**
+         * Configures the LED pins as outputs, turns all LEDs off and 
+         * creates the timers which play patterns.
+         */
+        void begin() {
+            for (uint8_t led = 0; led < LED_COUNT; led++) {
+                pinMode(pins[led], OUTPUT);
+                digitalWrite(pins[led], LOW);
+                levels[led] = LOW;
+                pinLevels[led] = LOW;
+                playingCaller[led] = NOT_PLAYING;
+
+                timerArgs[led] = { this, led };
+                esp_timer_create_args_t args = {};
+                args.callback = handlePatternTimer;
+                args.arg = &timerArgs[led];
+                args.dispatch_method = ESP_TIMER_TASK;
+                args.name = "led_pattern";
+                esp_timer_create(&args, &timers[led]);
+            }
+        }
+
+        /**
+         * Used to obtain a lock for an LED. 
+         * This isn't an exclusive access kind of lock, it is more of a lock that 
+         * says both on and off states of the LED are important to this process/caller
+         * so as long as it has the priority to do so it may force the LED to be off 
+         * even if a lower priority processs/caller wants it on. Without a lock, when 
+         * a process sets the led to off another lower priority process can turn it on.
+         * 
+         * @param led - The LED to lock as Led.
+         * @param caller - The caller taking the lock as Caller.
+         */
+        void lockLed(Led led, Caller caller) {
+            portENTER_CRITICAL(&mux);
+            locked[led] |= callerBit(caller);
+            resolve(led);
+            portEXIT_CRITICAL(&mux);
+            apply(led);
+        }
+
+        /**
+         * Releases a lock on an LED for a given caller.
+         * 
+         * @param led - The LED to release as Led.
+         * @param caller - The caller releasing the lock as Caller.
+         */
+        void releaseLed(Led led, Caller caller) {
+            portENTER_CRITICAL(&mux);
+            locked[led] &= ~callerBit(caller);
+            resolve(led);
+            portEXIT_CRITICAL(&mux);
+            apply(led);
+        }
+
+        /**
+         * Sets the LED state for a given caller to on/high. This 
+         * replaces any pattern the caller had for the LED.
+         * 
+         * @param led - The LED to turn on as Led.
+         * @param caller - The caller wanting it on as Caller.
+         */
+        void ledOn(Led led, Caller caller) {
+            portENTER_CRITICAL(&mux);
+            patterned[led] &= ~callerBit(caller);
+            on[led] |= callerBit(caller);
+            resolve(led);
+            portEXIT_CRITICAL(&mux);
+            apply(led);
+        }
+
+        /**
+         * Sets the LED state for a given caller to off/low.
+         * If the caller is locked on the LED then its LOW state
+         * still holds the LED off, otherwise the caller no longer
+         * has a say so any other caller may turn the LED on if
+         * so desired. This replaces any pattern the caller had for
+         * the LED.
+         * 
+         * @param led - The LED to turn off as Led.
+         * @param caller - The caller wanting it off as Caller.
+         */
+        void ledOff(Led led, Caller caller) {
+            portENTER_CRITICAL(&mux);
+            patterned[led] &= ~callerBit(caller);
+            on[led] &= ~callerBit(caller);
+            resolve(led);
+            portEXIT_CRITICAL(&mux);
+            apply(led);
+        }
+
+        /**
+         * Toggles the LED state for a given LED and Caller. This 
+         * replaces any pattern the caller had for the LED.
+         * 
+         * @param led - The LED to toggle as Led.
+         * @param caller - The caller toggling it as Caller.
+         */
+        void ledToggle(Led led, Caller caller) {
+            portENTER_CRITICAL(&mux);
+            patterned[led] &= ~callerBit(caller);
+            on[led] ^= callerBit(caller);
+            resolve(led);
+            portEXIT_CRITICAL(&mux);
+            apply(led);
+        }
+
+        /**
+         * Gives the LED a pattern for a given caller, replacing the
+         * caller's on/off state for the LED. Giving a caller the pattern
+         * it is already playing starts the pattern over. A pattern may
+         * only raise its caller's priority, never lower it.
+         * 
+         * @param led - The LED to play the pattern on as Led.
+         * @param caller - The caller wanting the pattern as Caller.
+         * @param pattern - The pattern to play as LedPattern.
+         */
+        void ledPattern(Led led, Caller caller, const LedPattern &pattern) {
+            uint8_t duty = pattern.dutyPercent > 100 ? 100 : pattern.dutyPercent;
+            uint64_t periodMicros = (uint64_t)pattern.periodMillis * 1000ULL;
+
+            portENTER_CRITICAL(&mux);
+            onMicros[led][caller] = periodMicros * duty / 100ULL;
+            offMicros[led][caller] = periodMicros - onMicros[led][caller];
+            repeats[led][caller] = pattern.repeats;
+            if (pattern.priority > 0 && pattern.priority - 1 < caller) {
+                ranks[led][caller] = pattern.priority - 1;
+                raised[led] |= callerBit(caller);
+            } else {
+                ranks[led][caller] = caller;
+                raised[led] &= ~callerBit(caller);
+            }
+            on[led] &= ~callerBit(caller);
+            patterned[led] |= callerBit(caller);
+            if (playingCaller[led] == caller) {
+                playingCaller[led] = NOT_PLAYING;
+            }
+            resolve(led);
+            portEXIT_CRITICAL(&mux);
+            apply(led);
+        }
+
+        /**
+         * Returns the current on/off state for a given caller on a
+         * given LED. This may or not reflect the LED's actual state.
+         * 
+         * @param led - The LED to check as Led.
+         * @param caller - The caller to check as Caller.
+         * 
+         * @return Returns the High/Low state as int.
+         */
+        int currentState(Led led, Caller caller) {
+            return (on[led] & callerBit(caller)) != 0UL ? HIGH : LOW;
+        }
 
     private:
-        std::map<std::string/*LedId*/, int/*PinNumber*/> registeredLeds;
-        std::map<std::string/*Caller*/, int/*Priority*/> priorities;
-        std::map<std::string/*Caller*/, std::map<std::string/*LedId*/, int/*Junk*/>> locks;
-        std::map<std::string/*Caller*/, std::map<std::string/*LedId*/, int/*CallerState*/>> callerStates;
+        struct TimerArg {
+            LedMan *ledMan;
+            uint8_t led;
+        };
+
+        static const uint8_t NOT_PLAYING = 0xFF;
+
+        portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+        uint8_t pins[LED_COUNT];
+        uint8_t levels[LED_COUNT] = {};    // <-- What each pin should show
+        uint8_t pinLevels[LED_COUNT] = {}; // <-- What each pin was last written
+        uint32_t on[LED_COUNT] = {};
+        uint32_t locked[LED_COUNT] = {};
+        uint32_t patterned[LED_COUNT] = {};
+
+        // Patterns by LED and caller
+        uint64_t onMicros[LED_COUNT][CALLER_COUNT] = {};
+        uint64_t offMicros[LED_COUNT][CALLER_COUNT] = {};
+        uint16_t repeats[LED_COUNT][CALLER_COUNT] = {};
+        uint8_t ranks[LED_COUNT][CALLER_COUNT] = {}; // <-- Caller whose priority the pattern plays at
+        uint32_t raised[LED_COUNT] = {};             // <-- Callers whose pattern plays above them
+
+        // Pattern being played by LED
+        esp_timer_handle_t timers[LED_COUNT] = {};
+        TimerArg timerArgs[LED_COUNT];
+        uint8_t playingCaller[LED_COUNT];
+        bool isOnPhase[LED_COUNT] = {};
+        uint16_t cyclesPlayed[LED_COUNT] = {};
+
+        // What each timer should be doing; Zero micros is stopped
+        uint64_t timerMicros[LED_COUNT] = {};
+        uint32_t timerChanges[LED_COUNT] = {};
+        uint32_t appliedTimerChanges[LED_COUNT] = {};
+        bool isApplying[LED_COUNT] = {};
+
+        static uint32_t callerBit(Caller caller) {
+            return 1UL << caller;
+        }
+
+        /**
+         * #### PRIVATE ####
+         * Determines what the highest priority caller with a say wants
+         * for the LED. A pattern is started playing if it isn't already,
+         * otherwise the wanted level is set for the pin. 
+         * Must be called holding the lock.
+         * 
+         * @param led - The LED to resolve as uint8_t.
+         */
+        void resolve(uint8_t led) {
+            uint32_t say = on[led] | locked[led] | patterned[led];
+            uint8_t caller = say != 0UL ? __builtin_ctz(say) : NOT_PLAYING;
+            if ((patterned[led] & raised[led]) != 0UL) {
+                // A raised pattern may beat the lowest set bit, so rank everyone with a say
+                uint8_t rank = NOT_PLAYING;
+                for (uint32_t rest = say; rest != 0UL; rest &= rest - 1UL) {
+                    uint8_t next = __builtin_ctz(rest);
+                    uint8_t nextRank = (patterned[led] & callerBit((Caller)next)) != 0UL ? ranks[led][next] : next;
+                    if (nextRank < rank) {
+                        caller = next;
+                        rank = nextRank;
+                    }
+                }
+            }
+
+            if (caller != NOT_PLAYING && (patterned[led] & callerBit((Caller)caller)) != 0UL) {
+                if (playingCaller[led] != caller) {
+                    playingCaller[led] = caller;
+                    cyclesPlayed[led] = 0;
+                    playPhase(led, true);
+                }
+            } else {
+                stopPattern(led);
+                write(led, caller != NOT_PLAYING && (on[led] & callerBit((Caller)caller)) != 0UL ? HIGH : LOW);
+            }
+        }
+
+        /**
+         * #### PRIVATE ####
+         * Shows one phase of the playing pattern and has the timer armed
+         * for the end of the phase. A phase with no duration is skipped.
+         * Must be called holding the lock.
+         * 
+         * @param led - The LED as uint8_t.
+         * @param isOn - True for the on phase or false for the off phase as bool.
+         */
+        void playPhase(uint8_t led, bool isOn) {
+            uint8_t caller = playingCaller[led];
+            uint64_t micros = isOn ? onMicros[led][caller] : offMicros[led][caller];
+            if (micros == 0ULL) {
+                if (isOn && offMicros[led][caller] == 0ULL) {
+                    // Nothing to play
+                    stopPattern(led);
+                    write(led, LOW);
+                    return;
+                }
+                isOn = !isOn;
+                micros = isOn ? onMicros[led][caller] : offMicros[led][caller];
+            }
+
+            isOnPhase[led] = isOn;
+            write(led, isOn ? HIGH : LOW);
+            setTimer(led, micros);
+        }
+
+        /**
+         * #### PRIVATE ####
+         * Stops any pattern playing on the LED.
+         * Must be called holding the lock.
+         * 
+         * @param led - The LED as uint8_t.
+         */
+        void stopPattern(uint8_t led) {
+            if (playingCaller[led] != NOT_PLAYING) {
+                playingCaller[led] = NOT_PLAYING;
+                setTimer(led, 0ULL);
+            }
+        }
+
+        /**
+         * #### PRIVATE ####
+         * Sets what the LED's timer should be doing; It is armed or
+         * stopped by apply().
+         * Must be called holding the lock.
+         * 
+         * @param led - The LED as uint8_t.
+         * @param micros - When to fire from now, zero to stop, as uint64_t.
+         */
+        void setTimer(uint8_t led, uint64_t micros) {
+            timerMicros[led] = micros;
+            timerChanges[led]++;
+        }
+
+        /**
+         * #### PRIVATE ####
+         * Sets the level the LED's pin should show; It is written by
+         * apply() if it changed.
+         * Must be called holding the lock.
+         * 
+         * @param led - The LED as uint8_t.
+         * @param level - The level as uint8_t.
+         */
+        void write(uint8_t led, uint8_t level) {
+            levels[led] = level;
+        }
+
+        /**
+         * #### PRIVATE ####
+         * Brings the LED's pin and timer up to date with its state, outside
+         * of the lock. Should another caller already be doing so this leaves 
+         * it to them, as they carry on until nothing is left to change.
+         * Must be called NOT holding the lock.
+         * 
+         * @param led - The LED as uint8_t.
+         */
+        void apply(uint8_t led) {
+            portENTER_CRITICAL(&mux);
+            if (isApplying[led]) {
+                portEXIT_CRITICAL(&mux);
+                return;
+            }
+            isApplying[led] = true;
+            while (true) {
+                bool isLevelChanged = pinLevels[led] != levels[led];
+                bool isTimerChanged = appliedTimerChanges[led] != timerChanges[led];
+                if (!isLevelChanged && !isTimerChanged) {
+                    break;
+                }
+                uint8_t level = levels[led];
+                uint64_t micros = timerMicros[led];
+                pinLevels[led] = level;
+                appliedTimerChanges[led] = timerChanges[led];
+                portEXIT_CRITICAL(&mux);
+
+                if (isLevelChanged) {
+                    digitalWrite(pins[led], level);
+                }
+                if (isTimerChanged) {
+                    esp_timer_stop(timers[led]);
+                    if (micros != 0ULL) {
+                        esp_timer_start_once(timers[led], micros);
+                    }
+                }
+
+                portENTER_CRITICAL(&mux);
+            }
+            isApplying[led] = false;
+            portEXIT_CRITICAL(&mux);
+        }
+
+        /**
+         * #### PRIVATE ####
+         * Called from the esp_timer task at the end of each pattern phase.
+         * Moves to the next phase, or once the pattern has played all of
+         * its repeats takes away the caller's pattern and resolves the LED.
+         * 
+         * @param arg - The TimerArg of the LED.
+         */
+        static void handlePatternTimer(void *arg) {
+            TimerArg *timerArg = (TimerArg *)arg;
+            LedMan *self = timerArg->ledMan;
+            uint8_t led = timerArg->led;
+
+            portENTER_CRITICAL(&self->mux);
+            uint8_t caller = self->playingCaller[led];
+            bool isTimerCurrent = self->appliedTimerChanges[led] == self->timerChanges[led]; // <-- Else it's about to be rearmed or stopped
+            if (caller != NOT_PLAYING && isTimerCurrent) {
+                bool isCycleDone = !self->isOnPhase[led] || self->offMicros[led][caller] == 0ULL;
+                if (isCycleDone) {
+                    self->cyclesPlayed[led]++;
+                }
+
+                uint16_t repeats = self->repeats[led][caller];
+                if (isCycleDone && repeats > 0 && self->cyclesPlayed[led] >= repeats) {
+                    self->patterned[led] &= ~callerBit((Caller)caller);
+                    self->stopPattern(led);
+                    self->resolve(led);
+                } else {
+                    self->playPhase(led, !self->isOnPhase[led]);
+                }
+            }
+            portEXIT_CRITICAL(&self->mux);
+            self->apply(led);
+        }
     };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,107 @@
+/*
+    LogHistogram.cpp
+    This is the code file for the LogHistogram Class.
+
+    The purpose of this class is to keep the spread of a measurement in a fixed amount of memory.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <LogHistogram.h>
+
+/**
+ * Records a value.
+ *
+ * @param value - The value as uint32_t.
+ */
+void LogHistogram::record(uint32_t value) {
+    counts[bucketOf(value)]++;
+    if (count == 0UL || value < min) {
+        min = value;
+    }
+    if (value > max) {
+        max = value;
+    }
+    count++;
+}
+
+/**
+ * Forgets every value recorded.
+ *
+ */
+void LogHistogram::reset() {
+    for (uint8_t bucket = 0; bucket < BUCKETS; bucket++) {
+        counts[bucket] = 0UL;
+    }
+    count = 0UL;
+    min = 0UL;
+    max = 0UL;
+}
+
+uint32_t LogHistogram::getCount() { return count; }
+uint32_t LogHistogram::getMin() { return min; }
+uint32_t LogHistogram::getMax() { return max; }
+
+/**
+ * Gets the value which the given percent of the values recorded are at
+ * or below, to within its bucket.
+ *
+ * @param percent - The percent, 1 to 100, as uint8_t.
+ *
+ * @return Returns the top of the bucket it falls in, kept within the
+ * minimum and maximum, or 0 if nothing was recorded, as uint32_t.
+ */
+uint32_t LogHistogram::getPercentile(uint8_t percent) {
+    if (count == 0UL) {
+        return 0UL;
+    }
+
+    uint64_t rank = ((uint64_t)count * percent + 99ULL) / 100ULL; // <-- Rounded up, so the 100th is the maximum
+    rank = rank > 0ULL ? rank : 1ULL;
+    uint64_t seen = 0ULL;
+    for (uint8_t bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            uint32_t top = bucketTop(bucket);
+            top = top < max ? top : max;
+
+            return top > min ? top : min;
+        }
+    }
+
+    return max;
+}
+
+/**
+ * Works out which bucket a value goes in.
+ *
+ * @param value - The value as uint32_t.
+ *
+ * @return Returns the bucket as uint8_t.
+ */
+uint8_t LogHistogram::bucketOf(uint32_t value) {
+    if (value < 2UL) {
+        return (uint8_t)value;
+    }
+    uint8_t msb = (uint8_t)(31 - __builtin_clz(value));
+
+    return (uint8_t)(2 * msb + ((value >> (msb - 1)) & 1UL));
+}
+
+/**
+ * Works out the largest value which goes in a bucket.
+ *
+ * @param bucket - The bucket as uint8_t.
+ *
+ * @return Returns the value as uint32_t.
+ */
+uint32_t LogHistogram::bucketTop(uint8_t bucket) {
+    if (bucket < 2) {
+        return bucket;
+    }
+    uint8_t msb = bucket / 2;
+    uint32_t bottom = (1UL << msb) | ((uint32_t)(bucket % 2) << (msb - 1));
+
+    return bottom + ((1UL << (msb - 1)) - 1UL);
+}
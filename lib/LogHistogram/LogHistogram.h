@@ -0,0 +1,45 @@
+/*
+    LogHistogram.h
+    This is the header file for the LogHistogram Class.
+
+    The purpose of this class is to keep the spread of a measurement, such as how many CPU cycles
+    a handler takes, in a fixed amount of memory however many times it is recorded. Values go in
+    buckets which double in size every two buckets, so none spans more than half of its lowest
+    value and any uint32_t fits in the 64 of them:
+
+        0, 1, 2, 3, 4-5, 6-7, 8-11, 12-15, 16-23, 24-31, ... 3*2^30-2^32-1
+
+    Recording is a count leading zeros and an increment. The minimum, maximum and count are kept
+    exactly; Percentiles are read off the buckets, as the top of the bucket they fall in.
+
+    Nothing here depends on the hardware so that the host tools in tools/ build it too.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef LogHistogram_h
+    #define LogHistogram_h
+
+    #include <stdint.h>
+
+    class LogHistogram {
+    public:
+        static const uint8_t BUCKETS = 64;
+
+        void record(uint32_t value);
+        void reset();
+        uint32_t getCount();
+        uint32_t getMin();
+        uint32_t getMax();
+        uint32_t getPercentile(uint8_t percent);
+
+        static uint8_t bucketOf(uint32_t value);
+        static uint32_t bucketTop(uint8_t bucket);
+
+    private:
+        uint32_t counts[BUCKETS] = {};
+        uint32_t count = 0UL;
+        uint32_t min = 0UL;
+        uint32_t max = 0UL;
+    };
+#endif
@@ -0,0 +1,419 @@
+/*
+    MqttPublisher.cpp
+    This is the code file for the MqttPublisher Class.
+
+    The purpose of this class is to queue messages in a bounded ring and publish them to an MQTT
+    broker in batches from a dedicated task.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <MqttPublisher.h>
+#include <Varint.h>
+#include <lwip/sockets.h>
+
+#define MQTT_CONNECT 0x10
+#define MQTT_CONNACK 0x20
+#define MQTT_PUBLISH 0x30
+#define MQTT_PINGREQ 0xC0
+#define MQTT_DISCONNECT 0xE0
+#define MQTT_CLEAN_SESSION 0x02
+#define MQTT_MAX_LENGTH_SIZE 4 // <-- Remaining length is a varint of at most four bytes
+#define SOCKET_TIMEOUT_MILLIS 2000
+#define MIN_BACK_OFF_MILLIS 1000UL
+#define MAX_BACK_OFF_MILLIS 60000UL
+
+/**
+ * Starts the publishing task, or restarts it with the new broker and
+ * prefix should it still be running or stopping. Messages may be
+ * queued as soon as this returns; They are sent once the broker is
+ * reached. Never waits on the task.
+ *
+ * @param host - The broker's host name or address as const char*.
+ * @param port - The broker's port as uint16_t.
+ * @param clientId - The MQTT client id as const char*.
+ * @param topicPrefix - Put in front of every topic as const char*.
+ * @param flushIntervalMillis - How often queued messages are sent as uint32_t.
+ *
+ * @return Returns true if started otherwise false as bool.
+ */
+bool MqttPublisher::begin(const char *host, uint16_t port, const char *clientId, const char *topicPrefix, uint32_t flushIntervalMillis) {
+    portENTER_CRITICAL(&ringMux);
+    strlcpy(pending.host, host, sizeof(pending.host));
+    strlcpy(pending.clientId, clientId, sizeof(pending.clientId));
+    strlcpy(pending.prefix, topicPrefix, sizeof(pending.prefix));
+    pending.port = port;
+    pending.flushIntervalMillis = flushIntervalMillis;
+    portEXIT_CRITICAL(&ringMux);
+
+    return startTask("mqtt", TASK_STACK_SIZE, TASK_PRIORITY);
+}
+
+/**
+ * Stops publishing. The task disconnects from the broker and discards
+ * anything still queued once it is done with what it is sending; 
+ * Never waits on the task.
+ *
+ */
+void MqttPublisher::stop() {
+    stopTask();
+}
+
+/**
+ * Queues a message to be published with the next batch. Never waits
+ * on the network; If the queue is full the oldest message is dropped
+ * to make room.
+ *
+ * @param topic - The topic, below the prefix, as const char*.
+ * @param payload - The message as const char*.
+ *
+ * @return Returns true if queued without dropping otherwise false as bool.
+ */
+bool MqttPublisher::publish(const char *topic, const char *payload) {
+    if (!isRunning()) {
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+    bool isDropped = false;
+
+    portENTER_CRITICAL(&ringMux);
+    if (count == RING_SIZE) {
+        head = (head + 1) % RING_SIZE;
+        count--;
+        stats.dropped++;
+        isDropped = true;
+    }
+    Message &message = ring[(head + count) % RING_SIZE];
+    strlcpy(message.topic, topic, sizeof(message.topic));
+    strlcpy(message.payload, payload, sizeof(message.payload));
+    message.queuedMicros = now;
+    count++;
+    stats.queued++;
+    portEXIT_CRITICAL(&ringMux);
+
+    return !isDropped;
+}
+
+/**
+ * Gets a copy of the publishing statistics.
+ *
+ * @return Returns the statistics as Stats.
+ */
+MqttPublisher::Stats MqttPublisher::getStats() {
+    portENTER_CRITICAL(&ringMux);
+    Stats copy = stats;
+    copy.depth = count;
+    portEXIT_CRITICAL(&ringMux);
+    copy.isConnected = socketFd >= 0;
+
+    return copy;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Run by the task as it starts or restarts; Leaves the broker it was
+ * connected to, if any, and takes the settings begin() left for it,
+ * connecting without backing off. Anything queued is kept for the new
+ * broker.
+ *
+ */
+void MqttPublisher::onStart() {
+    hangUp();
+
+    portENTER_CRITICAL(&ringMux);
+    config = pending;
+    portEXIT_CRITICAL(&ringMux);
+
+    nextConnectMicros = 0LL;
+    backOffMillis = MIN_BACK_OFF_MILLIS;
+}
+
+/**
+ * #### PRIVATE ####
+ * Run by the task every flush interval; Connects if need be, sends
+ * what is queued and keeps the connection alive.
+ *
+ * @return Returns how long to sleep before the next round as uint32_t.
+ */
+uint32_t MqttPublisher::onWork() {
+    if (socketFd >= 0 || connectBroker()) {
+        flush();
+        keepAlive();
+    }
+
+    return config.flushIntervalMillis;
+}
+
+/**
+ * #### PRIVATE ####
+ * Run by the task as it stops; Leaves the broker and discards
+ * anything still queued.
+ *
+ */
+void MqttPublisher::onStop() {
+    hangUp();
+
+    portENTER_CRITICAL(&ringMux);
+    head = 0;
+    count = 0;
+    portEXIT_CRITICAL(&ringMux);
+}
+
+/**
+ * #### PRIVATE ####
+ * Connects to the broker unless still backing off from a failure.
+ *
+ * @return Returns true if connected otherwise false as bool.
+ */
+bool MqttPublisher::connectBroker() {
+    int64_t now = esp_timer_get_time();
+    if (now < nextConnectMicros) {
+        return false;
+    }
+
+    socketFd = openSocket(config.host, config.port, false, SOCKET_TIMEOUT_MILLIS);
+    bool ok = socketFd >= 0;
+
+    if (ok) {
+        size_t length = encodeConnect(batchBuffer);
+        uint8_t ack[4] = { 0, 0, 0, 0 };
+        ok = sendAll(batchBuffer, length)
+            && lwip_recv(socketFd, ack, sizeof(ack), MSG_WAITALL) == (int)sizeof(ack)
+            && ack[0] == MQTT_CONNACK && ack[3] == 0x00; // <-- Connection accepted
+    }
+
+    portENTER_CRITICAL(&ringMux);
+    if (ok) {
+        stats.connects++;
+    } else {
+        stats.connectFailures++;
+    }
+    portEXIT_CRITICAL(&ringMux);
+
+    if (!ok) {
+        disconnectBroker();
+        nextConnectMicros = now + backOffMillis * 1000LL;
+        backOffMillis = min(backOffMillis * 2UL, MAX_BACK_OFF_MILLIS);
+
+        return false;
+    }
+
+    backOffMillis = MIN_BACK_OFF_MILLIS;
+
+    return true;
+}
+
+/**
+ * #### PRIVATE ####
+ * Closes the connection to the broker.
+ *
+ */
+void MqttPublisher::disconnectBroker() {
+    if (socketFd >= 0) {
+        lwip_close(socketFd);
+        socketFd = -1;
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Tells the broker it is leaving, if connected, and closes the
+ * connection.
+ *
+ */
+void MqttPublisher::hangUp() {
+    if (socketFd >= 0) {
+        const uint8_t packet[2] = { MQTT_DISCONNECT, 0x00 };
+        sendAll(packet, sizeof(packet));
+        disconnectBroker();
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Sends queued messages in batches, each filling the batch buffer
+ * and going out in a single write, until the queue is empty. Should
+ * a write fail the batch is counted as dropped and the connection is
+ * closed to be retried.
+ *
+ */
+void MqttPublisher::flush() {
+    while (socketFd >= 0) {
+        // Take as many messages as are sure to fit
+        uint8_t taken = 0;
+        portENTER_CRITICAL(&ringMux);
+        while (count > 0 && taken < BATCH_SIZE) {
+            batch[taken++] = ring[head];
+            head = (head + 1) % RING_SIZE;
+            count--;
+        }
+        portEXIT_CRITICAL(&ringMux);
+
+        if (taken == 0) {
+            return;
+        }
+
+        size_t length = 0;
+        for (uint8_t i = 0; i < taken; i++) {
+            length += encodePublish(batchBuffer + length, batch[i]);
+        }
+
+        bool ok = sendAll(batchBuffer, length);
+        int64_t now = esp_timer_get_time();
+
+        portENTER_CRITICAL(&ringMux);
+        if (ok) {
+            stats.batches++;
+            stats.published += taken;
+            for (uint8_t i = 0; i < taken; i++) {
+                uint32_t latency = (uint32_t)(now - batch[i].queuedMicros);
+                stats.lastLatencyMicros = latency;
+                stats.totalLatencyMicros += latency;
+                if (latency > stats.worstLatencyMicros) {
+                    stats.worstLatencyMicros = latency;
+                }
+            }
+        } else {
+            stats.dropped += taken;
+        }
+        portEXIT_CRITICAL(&ringMux);
+
+        if (!ok) {
+            disconnectBroker();
+        }
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Pings the broker when nothing has been sent for half the keep
+ * alive and discards whatever the broker has sent, which for a
+ * publisher is only ping responses. Closes the connection if the
+ * broker has.
+ *
+ */
+void MqttPublisher::keepAlive() {
+    if (socketFd < 0) {
+        return;
+    }
+
+    uint8_t discard[16];
+    int received;
+    while ((received = lwip_recv(socketFd, discard, sizeof(discard), MSG_DONTWAIT)) > 0) {}
+    if (received == 0) {
+        disconnectBroker();
+        return;
+    }
+
+    if (esp_timer_get_time() - lastSendMicros > KEEP_ALIVE_SECONDS * 500000LL) {
+        const uint8_t packet[2] = { MQTT_PINGREQ, 0x00 };
+        if (!sendAll(packet, sizeof(packet))) {
+            disconnectBroker();
+        }
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Writes all of the given data to the broker.
+ *
+ * @param data - The data to send as const uint8_t*.
+ * @param length - The length of the data as size_t.
+ *
+ * @return Returns true if all was sent otherwise false as bool.
+ */
+bool MqttPublisher::sendAll(const uint8_t *data, size_t length) {
+    while (length > 0) {
+        int sent = lwip_send(socketFd, data, length, 0);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        length -= sent;
+    }
+    lastSendMicros = esp_timer_get_time();
+
+    return true;
+}
+
+/**
+ * #### PRIVATE ####
+ * Encodes the CONNECT packet; A clean session with no will or
+ * credentials.
+ *
+ * @param buffer - Where to encode the packet as uint8_t*.
+ *
+ * @return Returns the length of the packet as size_t.
+ */
+size_t MqttPublisher::encodeConnect(uint8_t *buffer) {
+    size_t idLength = strlen(config.clientId);
+    size_t offset = 0;
+
+    buffer[offset++] = MQTT_CONNECT;
+    offset += Varint::put(buffer + offset, MQTT_MAX_LENGTH_SIZE, 10 + 2 + idLength);
+    offset += encodeString(buffer + offset, "MQTT", 4);
+    buffer[offset++] = 0x04; // <-- Protocol level 3.1.1
+    buffer[offset++] = MQTT_CLEAN_SESSION;
+    buffer[offset++] = (uint8_t)(KEEP_ALIVE_SECONDS >> 8);
+    buffer[offset++] = (uint8_t)KEEP_ALIVE_SECONDS;
+    offset += encodeString(buffer + offset, config.clientId, idLength);
+
+    return offset;
+}
+
+/**
+ * #### PRIVATE ####
+ * Encodes a QoS 0 PUBLISH packet for the message, its topic below
+ * the prefix.
+ *
+ * @param buffer - Where to encode the packet as uint8_t*.
+ * @param message - The message to encode as const Message&.
+ *
+ * @return Returns the length of the packet as size_t.
+ */
+size_t MqttPublisher::encodePublish(uint8_t *buffer, const Message &message) {
+    size_t prefixLength = strlen(config.prefix);
+    size_t topicLength = strlen(message.topic);
+    size_t payloadLength = strlen(message.payload);
+    size_t offset = 0;
+
+    buffer[offset++] = MQTT_PUBLISH;
+    offset += Varint::put(buffer + offset, MQTT_MAX_LENGTH_SIZE, 2 + prefixLength + 1 + topicLength + payloadLength);
+    buffer[offset++] = (uint8_t)((prefixLength + 1 + topicLength) >> 8);
+    buffer[offset++] = (uint8_t)(prefixLength + 1 + topicLength);
+    memcpy(buffer + offset, config.prefix, prefixLength);
+    offset += prefixLength;
+    buffer[offset++] = '/';
+    memcpy(buffer + offset, message.topic, topicLength);
+    offset += topicLength;
+    memcpy(buffer + offset, message.payload, payloadLength);
+    offset += payloadLength;
+
+    return offset;
+}
+
+/**
+ * #### PRIVATE ####
+ * Encodes a length prefixed string.
+ *
+ * @param buffer - Where to encode the string as uint8_t*.
+ * @param value - The string as const char*.
+ * @param length - The length of the string as size_t.
+ *
+ * @return Returns the number of bytes written as size_t.
+ */
+size_t MqttPublisher::encodeString(uint8_t *buffer, const char *value, size_t length) {
+    buffer[0] = (uint8_t)(length >> 8);
+    buffer[1] = (uint8_t)length;
+    memcpy(buffer + 2, value, length);
+
+    return length + 2;
+}
@@ -0,0 +1,107 @@
+/*
+    MqttPublisher.h
+    This is the header file for the MqttPublisher Class.
+
+    The purpose of this class is to publish messages to an MQTT broker without ever making the
+    caller wait on the network. Messages are copied into a fixed-size ring by publish(), which only
+    takes a short critical section; when the ring is full the oldest message is dropped so the most
+    recent state always gets through. A low priority SocketWorker task of its own wakes on an
+    interval, drains as many queued messages as fit into one buffer and sends them to the broker
+    with a single write. Neither begin() nor stop() waits on that task; Beginning again while it
+    is still stopping restarts it with the new broker and prefix.
+
+    Only what a publisher needs of MQTT 3.1.1 is spoken: CONNECT, PUBLISH at QoS 0 and PINGREQ.
+    The connection is retried with a growing back off while the broker can't be reached; Connecting
+    is bounded by a timeout so a broker that doesn't answer can't hold the task for long.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef MqttPublisher_h
+    #define MqttPublisher_h
+
+    #include <Arduino.h>
+    #include <SocketWorker.h>
+
+    class MqttPublisher : public SocketWorker {
+    public:
+        struct Stats {
+            unsigned long queued;
+            unsigned long published;
+            unsigned long dropped;
+            unsigned long batches;
+            unsigned long connects;
+            unsigned long connectFailures;
+            uint8_t depth;
+            bool isConnected;
+            uint32_t lastLatencyMicros;
+            uint32_t worstLatencyMicros;
+            uint64_t totalLatencyMicros;
+        };
+
+        static const size_t RING_SIZE = 32;
+        static const size_t HOST_SIZE = 64;
+        static const size_t CLIENT_ID_SIZE = 24;
+        static const size_t PREFIX_SIZE = 40;
+        static const size_t TOPIC_SIZE = 24;
+        static const size_t PAYLOAD_SIZE = 160;
+        static const size_t BATCH_BUFFER_SIZE = 1460;
+
+        // Largest a PUBLISH can be; Header, length, topic length, prefix, '/', topic and payload
+        static const size_t MAX_PUBLISH_SIZE = 1 + 2 + 2 + PREFIX_SIZE + 1 + TOPIC_SIZE + PAYLOAD_SIZE;
+        static const size_t BATCH_SIZE = BATCH_BUFFER_SIZE / MAX_PUBLISH_SIZE;
+        static const uint32_t TASK_STACK_SIZE = 4096UL;
+        static const UBaseType_t TASK_PRIORITY = 1;
+        static const uint16_t KEEP_ALIVE_SECONDS = 60;
+
+        bool begin(const char *host, uint16_t port, const char *clientId, const char *topicPrefix, uint32_t flushIntervalMillis);
+        void stop();
+        bool publish(const char *topic, const char *payload);
+        Stats getStats();
+
+    private:
+        struct Message {
+            char topic[TOPIC_SIZE];
+            char payload[PAYLOAD_SIZE];
+            int64_t queuedMicros;
+        };
+
+        struct Config {
+            char host[HOST_SIZE];
+            char clientId[CLIENT_ID_SIZE];
+            char prefix[PREFIX_SIZE];
+            uint16_t port;
+            uint32_t flushIntervalMillis;
+        };
+
+        Config config = {}; // <-- The task's own
+        Config pending = {}; // <-- Taken by the task when it next starts
+
+        Message ring[RING_SIZE];
+        uint8_t head = 0;
+        uint8_t count = 0;
+        Message batch[BATCH_SIZE];
+        uint8_t batchBuffer[BATCH_BUFFER_SIZE];
+
+        int socketFd = -1;
+        int64_t lastSendMicros = 0LL;
+        int64_t nextConnectMicros = 0LL;
+        uint32_t backOffMillis = 0UL;
+
+        portMUX_TYPE ringMux = portMUX_INITIALIZER_UNLOCKED;
+        Stats stats = {};
+
+        void onStart() override;
+        uint32_t onWork() override;
+        void onStop() override;
+        bool connectBroker();
+        void disconnectBroker();
+        void hangUp();
+        void flush();
+        void keepAlive();
+        bool sendAll(const uint8_t *data, size_t length);
+        size_t encodeConnect(uint8_t *buffer);
+        size_t encodePublish(uint8_t *buffer, const Message &message);
+        size_t encodeString(uint8_t *buffer, const char *value, size_t length);
+    };
+#endif
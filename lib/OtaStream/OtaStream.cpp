@@ -0,0 +1,341 @@
+/*
+    OtaStream.cpp
+    This is the code file for the OtaStream Class.
+
+    The purpose of this class is to decompress and verify an uploaded firmware image as it streams
+    in, handing it on in flash sized chunks.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <OtaStream.h>
+#include <string.h>
+
+#define MIN_WINDOW_BITS 4
+#define MIN_LOOKAHEAD_BITS 3
+
+OtaStream::~OtaStream() {
+    abort();
+}
+
+/**
+ * Starts a new image, which is handed to the given sink in chunks.
+ *
+ * @param sink - Where the image is written as Sink&.
+ */
+void OtaStream::begin(Sink &sink) {
+    abort();
+    this->sink = &sink;
+    error = NONE;
+    isStarted = false;
+    isPackedImage = false;
+    headerLength = 0;
+    compression = COMPRESSION_NONE;
+    imageSize = 0;
+    written = 0;
+    windowMask = 0;
+    windowHead = 0;
+    bits = 0UL;
+    bitCount = 0;
+    step = TAG;
+    chunkLength = 0;
+    memset(window, 0, sizeof(window));
+    memset(digest, 0, sizeof(digest));
+
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    isHashing = true;
+}
+
+/**
+ * Takes in the next piece of the upload, which may be any size.
+ *
+ * @param data - The piece as const uint8_t*.
+ * @param length - The length of the piece as size_t.
+ *
+ * @return Returns true if all is well so far otherwise false as bool.
+ */
+bool OtaStream::write(const uint8_t *data, size_t length) {
+    if (error != NONE) {
+        return false;
+    }
+
+    size_t offset = 0;
+    if (!isStarted && length > 0) {
+        isStarted = true;
+        isPackedImage = data[0] != ESP_IMAGE_MAGIC;
+    }
+
+    if (isPackedImage && headerLength < HEADER_SIZE) {
+        // Gather the header, which may arrive split
+        while (headerLength < HEADER_SIZE && offset < length) {
+            header[headerLength++] = data[offset++];
+        }
+        if (headerLength < HEADER_SIZE) {
+            return true;
+        }
+        if (!parseHeader()) {
+            return false;
+        }
+    }
+
+    if (isPackedImage && compression == COMPRESSION_HEATSHRINK) {
+        for (; offset < length; offset++) {
+            if (!decode(data[offset])) {
+                return false;
+            }
+        }
+    } else {
+        for (; offset < length; offset++) {
+            if (!emit(data[offset])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Ends the image, writing out the last chunk and checking the image
+ * is whole and, if packed, that its digest matches.
+ *
+ * @return Returns true if the image is good otherwise false as bool.
+ */
+bool OtaStream::finish() {
+    if (error != NONE || !flushChunk()) {
+        abort();
+        return false;
+    }
+
+    mbedtls_sha256_finish(&sha, digest);
+    abort();
+
+    if (isPackedImage) {
+        if (headerLength < HEADER_SIZE || written < imageSize) {
+            return fail(TOO_SHORT);
+        }
+        if (memcmp(digest, header + 12, DIGEST_SIZE) != 0) {
+            return fail(DIGEST_MISMATCH);
+        }
+    } else if (written == 0) {
+        return fail(TOO_SHORT);
+    }
+
+    return true;
+}
+
+/**
+ * Gives up on the image, freeing what hashing it holds. Called by
+ * finish() and when the stream is deleted, so needed only where an image
+ * is given up on before then.
+ */
+void OtaStream::abort() {
+    if (isHashing) {
+        mbedtls_sha256_free(&sha);
+        isHashing = false;
+    }
+}
+
+/**
+ * Gets what went wrong, if anything.
+ *
+ * @return Returns the error as Error.
+ */
+OtaStream::Error OtaStream::getError() {
+    return error;
+}
+
+/**
+ * Used to determine if the image is a packed one rather than plain.
+ *
+ * @return Returns true if packed otherwise false as bool.
+ */
+bool OtaStream::isPacked() {
+    return isPackedImage;
+}
+
+/**
+ * Gets the size of the image once unpacked, as packed with it.
+ *
+ * @return Returns the size, zero if plain or not yet known, as size_t.
+ */
+size_t OtaStream::getImageSize() {
+    return imageSize;
+}
+
+/**
+ * Gets how much of the image has been handed to the sink so far.
+ *
+ * @return Returns the bytes written as size_t.
+ */
+size_t OtaStream::getWritten() {
+    return written - chunkLength;
+}
+
+/**
+ * Gets the SHA-256 of the image; Set by finish().
+ *
+ * @return Returns the digest as const uint8_t*.
+ */
+const uint8_t* OtaStream::getDigest() {
+    return digest;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Checks the packed image's header and sets up decoding.
+ *
+ * @return Returns true if the header is good otherwise false as bool.
+ */
+bool OtaStream::parseHeader() {
+    if (header[0] != 'P' || header[1] != 'X' || header[2] != 'O' || header[3] != 'T') {
+        return fail(BAD_HEADER);
+    }
+    if (header[4] != VERSION) {
+        return fail(UNSUPPORTED);
+    }
+
+    compression = header[5];
+    windowBits = header[6];
+    lookaheadBits = header[7];
+    imageSize = (size_t)header[8] | ((size_t)header[9] << 8) | ((size_t)header[10] << 16) | ((size_t)header[11] << 24);
+
+    if (compression == COMPRESSION_HEATSHRINK) {
+        if (
+            windowBits < MIN_WINDOW_BITS || windowBits > MAX_WINDOW_BITS
+            || lookaheadBits < MIN_LOOKAHEAD_BITS || lookaheadBits >= windowBits
+        ) {
+            return fail(UNSUPPORTED);
+        }
+        windowMask = (uint16_t)((1 << windowBits) - 1);
+    } else if (compression != COMPRESSION_NONE) {
+        return fail(UNSUPPORTED);
+    }
+
+    return true;
+}
+
+/**
+ * #### PRIVATE ####
+ * Feeds one byte of the compressed stream through the decoder,
+ * emitting whatever it completes.
+ *
+ * @param byte - The next byte as uint8_t.
+ *
+ * @return Returns true if all is well otherwise false as bool.
+ */
+bool OtaStream::decode(uint8_t byte) {
+    if (written == imageSize) {
+        return true; // <-- Padding of the last byte
+    }
+
+    bits = (bits << 8) | byte;
+    bitCount += 8;
+
+    while (written < imageSize) {
+        uint8_t needed = step == TAG ? 1 : (step == LITERAL ? 8 : (step == INDEX ? windowBits : lookaheadBits));
+        if (bitCount < needed) {
+            return true;
+        }
+        bitCount -= needed;
+        uint16_t value = (uint16_t)((bits >> bitCount) & ((1UL << needed) - 1UL));
+
+        switch (step) {
+            case TAG:
+                step = value != 0 ? LITERAL : INDEX;
+                break;
+
+            case LITERAL:
+                if (!emit((uint8_t)value)) {
+                    return false;
+                }
+                step = TAG;
+                break;
+
+            case INDEX:
+                backIndex = value + 1;
+                step = COUNT;
+                break;
+
+            case COUNT:
+                for (uint16_t count = value + 1; count > 0; count--) {
+                    if (written == imageSize) {
+                        return fail(TOO_LONG);
+                    }
+                    if (!emit(window[(uint16_t)(windowHead - backIndex) & windowMask])) {
+                        return false;
+                    }
+                }
+                step = TAG;
+                break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * #### PRIVATE ####
+ * Adds a byte of the image to the window and the current chunk,
+ * writing the chunk out when full.
+ *
+ * @param byte - The byte as uint8_t.
+ *
+ * @return Returns true if all is well otherwise false as bool.
+ */
+bool OtaStream::emit(uint8_t byte) {
+    if (isPackedImage && written == imageSize) {
+        return fail(TOO_LONG);
+    }
+
+    window[windowHead & windowMask] = byte;
+    windowHead++;
+    chunk[chunkLength++] = byte;
+    written++;
+
+    return chunkLength < CHUNK_SIZE || flushChunk();
+}
+
+/**
+ * #### PRIVATE ####
+ * Hashes the current chunk and writes it to the sink.
+ *
+ * @return Returns true if written otherwise false as bool.
+ */
+bool OtaStream::flushChunk() {
+    if (chunkLength == 0) {
+        return true;
+    }
+
+    mbedtls_sha256_update(&sha, chunk, chunkLength);
+    if (!sink->write(chunk, chunkLength)) {
+        return fail(SINK_FAILED);
+    }
+    chunkLength = 0;
+
+    return true;
+}
+
+/**
+ * #### PRIVATE ####
+ * Records the first thing to go wrong.
+ *
+ * @param error - What went wrong as Error.
+ *
+ * @return Returns false, for convenience, as bool.
+ */
+bool OtaStream::fail(Error error) {
+    if (this->error == NONE) {
+        this->error = error;
+    }
+
+    return false;
+}
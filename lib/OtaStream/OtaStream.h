@@ -0,0 +1,112 @@
+/*
+    OtaStream.h
+    This is the header file for the OtaStream Class.
+
+    The purpose of this class is to turn an uploaded firmware image, as it arrives in pieces of
+    any size, into fixed-size chunks ready to write to flash, never holding more than one chunk.
+    Images packed by scripts/pack_firmware.py are heatshrink compressed and decompressed on the
+    fly, and the SHA-256 of what comes out is checked against the one packed with the image:
+
+        ['P']['X']['O']['T'][version][compression][window bits][lookahead bits]
+        [image size x4][SHA-256 of the image x32] then the (compressed) image
+
+    A plain image, as built, is passed through in chunks as is; Its own appended digest is left
+    for the OTA partition's checks.
+
+    The decoder reads the bit stream of the heatshrink library's encoder: a 1 bit then a literal
+    byte, or a 0 bit then a back reference of window bits (distance - 1) and lookahead bits
+    (length - 1), most significant bit first. Its window is the only other buffer.
+
+    Only mbedtls' SHA-256 is needed beyond the C library, so tools/ota_bench builds this too.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef OtaStream_h
+    #define OtaStream_h
+
+    #include <stdint.h>
+    #include <stddef.h>
+    #include <mbedtls/sha256.h>
+
+    class OtaStream {
+    public:
+        class Sink {
+        public:
+            virtual bool write(const uint8_t *data, size_t length) = 0;
+        };
+
+        enum Error : uint8_t {
+            NONE,
+            BAD_HEADER,
+            UNSUPPORTED,
+            SINK_FAILED,
+            TOO_LONG,
+            TOO_SHORT,
+            DIGEST_MISMATCH
+        };
+
+        static const uint8_t VERSION = 1;
+        static const uint8_t COMPRESSION_NONE = 0;
+        static const uint8_t COMPRESSION_HEATSHRINK = 1;
+        static const uint8_t ESP_IMAGE_MAGIC = 0xE9;
+        static const size_t HEADER_SIZE = 44;
+        static const size_t DIGEST_SIZE = 32;
+        static const size_t CHUNK_SIZE = 4096; // <-- A flash sector
+        static const uint8_t MAX_WINDOW_BITS = 12;
+
+        ~OtaStream();
+
+        void begin(Sink &sink);
+        bool write(const uint8_t *data, size_t length);
+        bool finish();
+        void abort();
+        Error getError();
+        bool isPacked();
+        size_t getImageSize();
+        size_t getWritten();
+        const uint8_t* getDigest();
+
+    private:
+        enum Step : uint8_t {
+            TAG,
+            LITERAL,
+            INDEX,
+            COUNT
+        };
+
+        Sink *sink = nullptr;
+        Error error = NONE;
+        bool isStarted = false;
+        bool isPackedImage = false;
+
+        uint8_t header[HEADER_SIZE];
+        size_t headerLength = 0;
+        uint8_t compression = COMPRESSION_NONE;
+        size_t imageSize = 0;
+        size_t written = 0;
+
+        uint8_t window[1 << MAX_WINDOW_BITS];
+        uint16_t windowMask = 0;
+        uint16_t windowHead = 0;
+        uint8_t windowBits = 0;
+        uint8_t lookaheadBits = 0;
+        uint32_t bits = 0UL;
+        uint8_t bitCount = 0;
+        Step step = TAG;
+        uint16_t backIndex = 0;
+
+        uint8_t chunk[CHUNK_SIZE];
+        size_t chunkLength = 0;
+
+        mbedtls_sha256_context sha;
+        bool isHashing = false; // <-- The SHA-256 context is set up and needs freeing
+        uint8_t digest[DIGEST_SIZE];
+
+        bool parseHeader();
+        bool decode(uint8_t byte);
+        bool emit(uint8_t byte);
+        bool flushChunk();
+        bool fail(Error error);
+    };
+#endif
@@ -0,0 +1,362 @@
+/*
+    OtaUpdater.cpp
+    This is the code file for the OtaUpdater Class.
+
+    The purpose of this class is to stream an uploaded firmware image into the inactive app
+    partition and to boot it on trial, falling back to the previous firmware if it fails.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <OtaUpdater.h>
+#include <Preferences.h>
+#include <new>
+
+#define NVS_NAMESPACE "ota"
+#define KEY_PREVIOUS "prev"
+#define KEY_BOOTS "boots"
+
+const char *STREAM_ERRORS[] = {
+    "Installed",
+    "Not a firmware image",
+    "Unsupported image format",
+    "Unable to write to flash",
+    "Image is longer than it claims",
+    "Image is incomplete",
+    "Image failed its SHA-256 check"
+};
+
+/**
+ * Lets the firmware confirm itself rather than the core doing so as
+ * soon as it starts, should the bootloader's rollback be enabled.
+ *
+ * @return Returns true to confirm later as bool.
+ */
+extern "C" bool verifyRollbackLater() {
+    return true;
+}
+
+/**
+ * Starts an update for the given owner, readying the inactive app
+ * partition. An update owned by another is refused unless it has been
+ * left alone for a while, in which case it is abandoned in favor of
+ * the new one.
+ *
+ * @param owner - The request updating as const void*.
+ *
+ * @return Returns true if ready for the image otherwise false as bool.
+ */
+bool OtaUpdater::begin(const void *owner) {
+    if (this->owner != nullptr) {
+        if (esp_timer_get_time() - lastReceiveMicros < STALE_UPLOAD_MILLIS * 1000LL) {
+            return false; // <-- Leave the update in progress be
+        }
+        abandon(this->owner);
+    }
+    this->owner = owner;
+
+    portENTER_CRITICAL(&statsMux);
+    stats = {};
+    portEXIT_CRITICAL(&statsMux);
+    startMicros = esp_timer_get_time();
+    lastReceiveMicros = startMicros;
+
+    partition = esp_ota_get_next_update_partition(nullptr);
+    if (partition == nullptr) {
+        return fail("No partition to update");
+    }
+
+    stream = new (std::nothrow) OtaStream();
+    if (stream == nullptr) {
+        return fail("Not enough memory to update");
+    }
+
+    if (esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &handle) != ESP_OK) {
+        handle = 0;
+        return fail("Unable to start the update");
+    }
+    stream->begin(*this);
+
+    portENTER_CRITICAL(&statsMux);
+    stats.isActive = true;
+    portEXIT_CRITICAL(&statsMux);
+    result = "Receiving";
+
+    return true;
+}
+
+/**
+ * Takes in the next piece of the upload.
+ *
+ * @param data - The piece as const uint8_t*.
+ * @param length - The length of the piece as size_t.
+ *
+ * @return Returns true if all is well so far otherwise false as bool.
+ */
+bool OtaUpdater::receive(const uint8_t *data, size_t length) {
+    if (stream == nullptr) {
+        return false;
+    }
+
+    lastReceiveMicros = esp_timer_get_time();
+    if (!stream->write(data, length)) {
+        return fail(STREAM_ERRORS[stream->getError()]);
+    }
+
+    portENTER_CRITICAL(&statsMux);
+    stats.received += length;
+    stats.written = stream->getWritten();
+    portEXIT_CRITICAL(&statsMux);
+
+    return true;
+}
+
+/**
+ * Ends the update. If the image checks out it is made the one to
+ * boot, on trial, at the next restart.
+ *
+ * @return Returns true if installed otherwise false as bool.
+ */
+bool OtaUpdater::end() {
+    if (stream == nullptr) {
+        return false;
+    }
+
+    if (!stream->finish()) {
+        return fail(STREAM_ERRORS[stream->getError()]);
+    }
+    size_t written = stream->getWritten();
+
+    esp_err_t err = esp_ota_end(handle);
+    handle = 0;
+    if (err != ESP_OK) {
+        return fail("Image failed verification");
+    }
+    if (esp_ota_set_boot_partition(partition) != ESP_OK) {
+        return fail("Unable to boot the new image");
+    }
+
+    Preferences prefs;
+    prefs.begin(NVS_NAMESPACE, false);
+    prefs.putString(KEY_PREVIOUS, esp_ota_get_running_partition()->label);
+    prefs.putUChar(KEY_BOOTS, 0);
+    prefs.end();
+
+    release();
+    result = STREAM_ERRORS[OtaStream::NONE];
+
+    portENTER_CRITICAL(&statsMux);
+    stats.written = written;
+    stats.micros = (uint32_t)(esp_timer_get_time() - startMicros);
+    stats.isActive = false;
+    stats.isInstalled = true;
+    portEXIT_CRITICAL(&statsMux);
+
+    return true;
+}
+
+/**
+ * Abandons the update in progress, if any.
+ *
+ */
+void OtaUpdater::abort() {
+    if (handle != 0) {
+        esp_ota_abort(handle);
+        handle = 0;
+    }
+    release();
+
+    portENTER_CRITICAL(&statsMux);
+    stats.isActive = false;
+    portEXIT_CRITICAL(&statsMux);
+}
+
+/**
+ * Lets go of the owner's update, abandoning it should it still be
+ * receiving. Called once the owning request has gone away.
+ *
+ * @param owner - The request that was updating as const void*.
+ */
+void OtaUpdater::abandon(const void *owner) {
+    if (owner != this->owner) {
+        return;
+    }
+    if (stream != nullptr) {
+        abort();
+        result = "Upload was cut short";
+    }
+    this->owner = nullptr;
+}
+
+/**
+ * Used to determine if the given request owns the update.
+ *
+ * @param owner - The request as const void*.
+ *
+ * @return Returns true if it owns the update otherwise false as bool.
+ */
+bool OtaUpdater::isOwner(const void *owner) {
+    return owner != nullptr && owner == this->owner;
+}
+
+/**
+ * Used to determine if some request owns an update.
+ *
+ * @return Returns true if an update is owned otherwise false as bool.
+ */
+bool OtaUpdater::isBusy() {
+    return owner != nullptr;
+}
+
+/**
+ * Used to determine if an update has been installed and awaits a
+ * restart.
+ *
+ * @return Returns true if installed otherwise false as bool.
+ */
+bool OtaUpdater::isInstalled() {
+    portENTER_CRITICAL(&statsMux);
+    bool installed = stats.isInstalled;
+    portEXIT_CRITICAL(&statsMux);
+
+    return installed;
+}
+
+/**
+ * Gets a description of how the last update went.
+ *
+ * @return Returns the description as const char*.
+ */
+const char* OtaUpdater::getResult() {
+    return result;
+}
+
+/**
+ * Gets a copy of the update's statistics.
+ *
+ * @return Returns the statistics as Stats.
+ */
+OtaUpdater::Stats OtaUpdater::getStats() {
+    portENTER_CRITICAL(&statsMux);
+    Stats copy = stats;
+    portEXIT_CRITICAL(&statsMux);
+
+    return copy;
+}
+
+/**
+ * Counts a boot of firmware on trial, booting the previous firmware
+ * again once it has had MAX_TRIAL_BOOTS without confirming itself.
+ * Should be called first thing at startup.
+ *
+ */
+void OtaUpdater::checkBoot() {
+    Preferences prefs;
+    prefs.begin(NVS_NAMESPACE, false);
+    String previous = prefs.getString(KEY_PREVIOUS, "");
+    if (previous.isEmpty()) {
+        prefs.end();
+        return;
+    }
+
+    // Already back on the previous firmware, the bootloader having rolled back
+    if (previous.equals(esp_ota_get_running_partition()->label)) {
+        prefs.remove(KEY_PREVIOUS);
+        prefs.remove(KEY_BOOTS);
+        prefs.end();
+        return;
+    }
+
+    uint8_t boots = prefs.getUChar(KEY_BOOTS, 0) + 1;
+    if (boots <= MAX_TRIAL_BOOTS) {
+        prefs.putUChar(KEY_BOOTS, boots);
+        prefs.end();
+        return;
+    }
+
+    prefs.remove(KEY_PREVIOUS);
+    prefs.remove(KEY_BOOTS);
+    prefs.end();
+
+    const esp_partition_t *fallback = esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, previous.c_str());
+    if (fallback != nullptr && esp_ota_set_boot_partition(fallback) == ESP_OK) {
+        ESP.restart();
+    }
+}
+
+/**
+ * Used to determine if the running firmware is on trial.
+ *
+ * @return Returns true if on trial otherwise false as bool.
+ */
+bool OtaUpdater::isTrialBoot() {
+    Preferences prefs;
+    prefs.begin(NVS_NAMESPACE, true);
+    bool isTrial = !prefs.getString(KEY_PREVIOUS, "").isEmpty();
+    prefs.end();
+
+    return isTrial;
+}
+
+/**
+ * Confirms the running firmware, ending its trial.
+ *
+ */
+void OtaUpdater::confirmBoot() {
+    Preferences prefs;
+    prefs.begin(NVS_NAMESPACE, false);
+    prefs.remove(KEY_PREVIOUS);
+    prefs.remove(KEY_BOOTS);
+    prefs.end();
+
+    esp_ota_mark_app_valid_cancel_rollback();
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Writes a chunk of the image to the partition; Called by the stream.
+ *
+ * @param data - The chunk as const uint8_t*.
+ * @param length - The length of the chunk as size_t.
+ *
+ * @return Returns true if written otherwise false as bool.
+ */
+bool OtaUpdater::write(const uint8_t *data, size_t length) {
+    return esp_ota_write(handle, data, length) == ESP_OK;
+}
+
+/**
+ * #### PRIVATE ####
+ * Abandons the update for the given reason.
+ *
+ * @param reason - Why as const char*.
+ *
+ * @return Returns false, for convenience, as bool.
+ */
+bool OtaUpdater::fail(const char *reason) {
+    abort();
+    result = reason;
+
+    return false;
+}
+
+/**
+ * #### PRIVATE ####
+ * Frees the stream, which is only needed while updating, along with the
+ * hashing it holds if the update didn't finish.
+ *
+ */
+void OtaUpdater::release() {
+    if (stream != nullptr) {
+        stream->abort();
+    }
+    delete stream;
+    stream = nullptr;
+}
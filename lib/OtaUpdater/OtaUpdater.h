@@ -0,0 +1,72 @@
+/*
+    OtaUpdater.h
+    This is the header file for the OtaUpdater Class.
+
+    The purpose of this class is to install a firmware update uploaded to the config portal. The
+    upload is fed through an OtaStream, allocated only while updating, which hands it on in flash
+    sector sized chunks that are written straight into the inactive app partition; Sectors are
+    erased as they are reached, rather than the whole partition up front, so nothing blocks the
+    web server's task for long. Once the image checks out it is made the boot partition. Each
+    update is owned by the request that began it until that request goes away, so that a second
+    upload can neither feed its pieces into the first nor be told the first's result.
+
+    The new firmware then boots on trial. Its boots are counted in NVS and, should it fail to
+    confirm itself within MAX_TRIAL_BOOTS of them, the previous firmware is booted again. This
+    works with the stock bootloader; Where the bootloader's own rollback is enabled it is
+    confirmed too.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef OtaUpdater_h
+    #define OtaUpdater_h
+
+    #include <Arduino.h>
+    #include <OtaStream.h>
+    #include <esp_ota_ops.h>
+
+    class OtaUpdater : private OtaStream::Sink {
+    public:
+        struct Stats {
+            size_t received;
+            size_t written;
+            uint32_t micros;
+            bool isActive;
+            bool isInstalled;
+        };
+
+        static const uint8_t MAX_TRIAL_BOOTS = 3;
+        static const uint32_t STALE_UPLOAD_MILLIS = 10000UL;
+
+        bool begin(const void *owner);
+        bool receive(const uint8_t *data, size_t length);
+        bool end();
+        void abort();
+        void abandon(const void *owner);
+        bool isOwner(const void *owner);
+        bool isBusy();
+        bool isInstalled();
+        const char* getResult();
+        Stats getStats();
+
+        static void checkBoot();
+        static bool isTrialBoot();
+        static void confirmBoot();
+
+    private:
+        OtaStream *stream = nullptr;
+        const void *owner = nullptr;
+        const esp_partition_t *partition = nullptr;
+        esp_ota_handle_t handle = 0;
+        const char *result = "";
+        int64_t startMicros = 0LL;
+        int64_t lastReceiveMicros = 0LL;
+
+        portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+        Stats stats = {};
+
+        bool write(const uint8_t *data, size_t length) override;
+        bool fail(const char *reason);
+        void release();
+    };
+#endif
@@ -0,0 +1,71 @@
+/*
+    PartitionFlash.cpp
+    This is the code file for the PartitionFlash Class.
+
+    The purpose of this class is to read, write and erase a data partition for the CounterLog.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <PartitionFlash.h>
+
+/**
+ * Finds the data partition to use. Devices last flashed with an older
+ * partition table may not have it.
+ *
+ * @param label - The partition's label as const char*.
+ *
+ * @return Returns true if found otherwise false as bool.
+ */
+bool PartitionFlash::begin(const char *label) {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+
+    return partition != nullptr;
+}
+
+/**
+ * Gets the size of the partition.
+ *
+ * @return Returns the size in bytes, or 0 if there is none, as size_t.
+ */
+size_t PartitionFlash::getSize() {
+    return partition != nullptr ? partition->size : 0;
+}
+
+/**
+ * Reads from the partition.
+ *
+ * @param offset - Where in the partition as size_t.
+ * @param data - Where to as void*.
+ * @param length - How much as size_t.
+ *
+ * @return Returns true if read otherwise false as bool.
+ */
+bool PartitionFlash::read(size_t offset, void *data, size_t length) {
+    return partition != nullptr && esp_partition_read(partition, offset, data, length) == ESP_OK;
+}
+
+/**
+ * Writes to the partition, which can only clear bits.
+ *
+ * @param offset - Where in the partition as size_t.
+ * @param data - What to write as const void*.
+ * @param length - How much as size_t.
+ *
+ * @return Returns true if written otherwise false as bool.
+ */
+bool PartitionFlash::write(size_t offset, const void *data, size_t length) {
+    return partition != nullptr && esp_partition_write(partition, offset, data, length) == ESP_OK;
+}
+
+/**
+ * Erases a sector of the partition, setting all its bits.
+ *
+ * @param offset - Where the sector starts in the partition as size_t.
+ *
+ * @return Returns true if erased otherwise false as bool.
+ */
+bool PartitionFlash::eraseSector(size_t offset) {
+    return partition != nullptr && esp_partition_erase_range(partition, offset, CounterLog::PAGE_SIZE) == ESP_OK;
+}
@@ -0,0 +1,29 @@
+/*
+    PartitionFlash.h
+    This is the header file for the PartitionFlash Class.
+
+    The purpose of this class is to give the CounterLog a data partition of the flash, found by its
+    label in the partition table, to keep its log in.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef PartitionFlash_h
+    #define PartitionFlash_h
+
+    #include <Arduino.h>
+    #include <CounterLog.h>
+    #include <esp_partition.h>
+
+    class PartitionFlash : public CounterLog::Flash {
+    public:
+        bool begin(const char *label);
+        size_t getSize() override;
+        bool read(size_t offset, void *data, size_t length) override;
+        bool write(size_t offset, const void *data, size_t length) override;
+        bool eraseSector(size_t offset) override;
+
+    private:
+        const esp_partition_t *partition = nullptr;
+    };
+#endif
@@ -36,25 +36,52 @@ String Utils::genDeviceIdFromMacAddr(String macAddress) {
     return result;
 }
 
+/**
+ * Parses a MAC or BlueTooth address, such as "a4:c1:38:5e:2b:07", into
+ * its six bytes as the radio gives them. Case is ignored, so it tells
+ * devices apart the same way however the address was written.
+ * 
+ * @param macAddress The address as String.
+ * @param bytes Where to put the six bytes as uint8_t*.
+ * 
+ * @return Returns true if it was an address otherwise false, leaving 
+ * the bytes as they were, as bool.
+*/
+bool Utils::parseMacAddress(String macAddress, uint8_t *bytes) {
+    unsigned int parsed[6];
+    char end;
+    if (sscanf(
+        macAddress.c_str(), "%2x:%2x:%2x:%2x:%2x:%2x%c",
+        &parsed[0], &parsed[1], &parsed[2], &parsed[3], &parsed[4], &parsed[5], &end
+    ) != 6) {
+        return false;
+    }
+    for (uint8_t i = 0; i < 6; i++) {
+        bytes[i] = (uint8_t)parsed[i];
+    }
+
+    return true;
+}
+
 /**
  * Used to generate a user friendly human readable string which is
  * capable of telling the number of Weeks, Days, Hours, Mins, Secs of 
  * a given elapsed time in milliseconds.
  * 
- * @param elapsedMillis - The elapsed milliseconds as unsigned long value.
+ * @param elapsedMillis - The elapsed milliseconds as uint64_t value.
  * 
  * @return Returns a user friendly String representation of the elapsed time.
  */
-String Utils::userFriendlyElapsedTime(unsigned long elapsedMillis) {
-    static const unsigned long minMillis = 60000UL;
-    static const unsigned long hourMillis = minMillis * 60UL;
-    static const unsigned long dayMillis = hourMillis * 24UL;
-    static const unsigned long weekMillis = dayMillis * 7UL;
+String Utils::userFriendlyElapsedTime(uint64_t elapsedMillis) {
+    static const uint64_t minMillis = 60000ULL;
+    static const uint64_t hourMillis = minMillis * 60ULL;
+    static const uint64_t dayMillis = hourMillis * 24ULL;
+    static const uint64_t weekMillis = dayMillis * 7ULL;
 
     String result = "";
-    unsigned long timeLeftMillis = elapsedMillis;
+    uint64_t timeLeftMillis = elapsedMillis;
     
-    unsigned long refVal = timeLeftMillis / weekMillis;
+    uint64_t refVal = timeLeftMillis / weekMillis;
     if (refVal > 0) {
         result += (String(refVal) + " Week, ");
         timeLeftMillis -= (refVal * weekMillis);
@@ -78,10 +105,10 @@ String Utils::userFriendlyElapsedTime(unsigned long elapsedMillis) {
         timeLeftMillis -= (refVal * minMillis);
     }
 
-    refVal  = timeLeftMillis / 1000UL;
+    refVal  = timeLeftMillis / 1000ULL;
     if (refVal > 0) {
         result += (String(refVal) + " Sec");
-        timeLeftMillis -= (refVal * 1000UL);
+        timeLeftMillis -= (refVal * 1000ULL);
     }
 
     return result;
@@ -9,7 +9,8 @@
         public:
             static String hashString(String string);
             static String genDeviceIdFromMacAddr(String macAddress);
-            static String userFriendlyElapsedTime(unsigned long elapsedMillis);
+            static bool parseMacAddress(String macAddress, uint8_t *bytes);
+            static String userFriendlyElapsedTime(uint64_t elapsedMillis);
     };
 
 #endif
\ No newline at end of file
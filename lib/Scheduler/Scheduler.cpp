@@ -0,0 +1,391 @@
+/*
+    Scheduler.cpp
+    This is the code file for the Scheduler Class.
+
+    The purpose of this class is to drive the firmware's main loop from events and timers rather
+    than by polling every subsystem on every pass. When there is nothing to do the loop task blocks
+    on its FreeRTOS notification until the next event is posted or the next timer is due.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <Scheduler.h>
+
+/**
+ * Binds the scheduler to the calling task. This must be called 
+ * from the task which will call runOnce(), before any events are
+ * posted.
+ */
+void Scheduler::begin() {
+    loopTask = xTaskGetCurrentTaskHandle();
+    stateMutex = xSemaphoreCreateMutex();
+    resetStats();
+}
+
+/**
+ * Registers the handler to be run when the given event is posted.
+ * Each event has a single handler.
+ * 
+ * @param event - The ID of the event, less than MAX_EVENTS, as uint8_t.
+ * @param handler - The function to run for the event as Handler.
+ * @param name - What the handler is profiled as, which must outlive the
+ * scheduler, as const char*.
+ */
+void Scheduler::on(uint8_t event, Handler handler, const char *name) {
+    if (event < MAX_EVENTS) {
+        handlers[event] = handler;
+        #ifdef LOOP_PROFILE
+            addProfile(event, name);
+        #else
+            (void)name;
+        #endif
+    }
+}
+
+/**
+ * Posts an event and wakes the loop task. Posting an event which
+ * is already pending does nothing more, so a burst of posts results
+ * in a single run of the handler.
+ * This is safe to call from any task but not from an ISR.
+ * 
+ * @param event - The ID of the event to post as uint8_t.
+ */
+void Scheduler::post(uint8_t event) {
+    portENTER_CRITICAL(&pendingMux);
+    pendingEvents |= (1UL << event);
+    portEXIT_CRITICAL(&pendingMux);
+
+    if (loopTask != nullptr) {
+        xTaskNotifyGive(loopTask);
+    }
+}
+
+/**
+ * Posts an event and wakes the loop task from within an ISR.
+ * 
+ * @param event - The ID of the event to post as uint8_t.
+ */
+void IRAM_ATTR Scheduler::postFromISR(uint8_t event) {
+    portENTER_CRITICAL_ISR(&pendingMux);
+    pendingEvents |= (1UL << event);
+    portEXIT_CRITICAL_ISR(&pendingMux);
+
+    if (loopTask != nullptr) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(loopTask, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+/**
+ * Registers a timer which runs the given handler when it expires.
+ * The timer is created stopped.
+ * 
+ * @param handler - The function to run on expiry as Handler.
+ * @param name - What the handler is profiled as, which must outlive the
+ * scheduler, as const char*.
+ * 
+ * @return Returns the ID of the timer, or NO_TIMER if all timers are 
+ * in use, as uint8_t.
+ */
+uint8_t Scheduler::addTimer(Handler handler, const char *name) {
+    if (timerCount >= MAX_TIMERS) {
+        return NO_TIMER;
+    }
+    timers[timerCount].handler = handler;
+    timers[timerCount].periodMillis = 0ULL;
+    #ifdef LOOP_PROFILE
+        addProfile(MAX_EVENTS + timerCount, name);
+    #else
+        (void)name;
+    #endif
+
+    return timerCount++;
+}
+
+/**
+ * Starts, or restarts, a timer. This is safe to call from any task
+ * but not from an ISR; When called from another task the loop task is
+ * woken, as it may be sleeping until a later timer.
+ * 
+ * @param timer - The ID of the timer as uint8_t.
+ * @param delayMillis - The milliseconds until the first expiry as uint64_t.
+ * @param periodMillis - The milliseconds between later expiries, or zero 
+ * for a one-shot timer, as uint64_t.
+ */
+void Scheduler::startTimer(uint8_t timer, uint64_t delayMillis, uint64_t periodMillis) {
+    if (timer >= timerCount) {
+        return;
+    }
+    portENTER_CRITICAL(&timerMux);
+    timers[timer].periodMillis = periodMillis;
+    timers[timer].deadline.start(delayMillis);
+    portEXIT_CRITICAL(&timerMux);
+
+    if (loopTask != nullptr && xTaskGetCurrentTaskHandle() != loopTask) {
+        xTaskNotifyGive(loopTask);
+    }
+}
+
+/**
+ * Stops a timer so its handler will not be run. This is safe to call
+ * from any task but not from an ISR.
+ * 
+ * @param timer - The ID of the timer as uint8_t.
+ */
+void Scheduler::stopTimer(uint8_t timer) {
+    if (timer < timerCount) {
+        portENTER_CRITICAL(&timerMux);
+        timers[timer].deadline.stop();
+        portEXIT_CRITICAL(&timerMux);
+    }
+}
+
+/**
+ * Used to determine if a timer is started and waiting to expire.
+ * 
+ * @param timer - The ID of the timer as uint8_t.
+ * 
+ * @return Returns true if the timer is active otherwise false as bool.
+ */
+bool Scheduler::isTimerActive(uint8_t timer) {
+    if (timer >= timerCount) {
+        return false;
+    }
+    portENTER_CRITICAL(&timerMux);
+    bool isActive = timers[timer].deadline.isActive();
+    portEXIT_CRITICAL(&timerMux);
+
+    return isActive;
+}
+
+/**
+ * Runs one pass of the scheduler. If no event is pending the loop
+ * task sleeps until one is posted or the next timer is due. Then 
+ * the handlers of all pending events and all expired timers are run.
+ * Ideally a call to this would be the only thing in the firmware's
+ * main loop method.
+ */
+void Scheduler::runOnce() {
+    uint32_t pending = takePending();
+    if (pending == 0UL) {
+        TickType_t waitTicks = ticksUntilNextTimer();
+        if (waitTicks > 0) {
+            int64_t idleStart = Clock::nowMicros();
+            ulTaskNotifyTake(pdTRUE, waitTicks);
+            idleMicros += (uint64_t)(Clock::nowMicros() - idleStart);
+        }
+        pending = takePending();
+    }
+
+    for (uint8_t event = 0; pending != 0UL && event < MAX_EVENTS; event++) {
+        if ((pending & (1UL << event)) != 0UL) {
+            pending &= ~(1UL << event);
+            if (handlers[event] != nullptr) {
+                runHandler(handlers[event], event);
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < timerCount; i++) {
+        Timer &timer = timers[i];
+        portENTER_CRITICAL(&timerMux);
+        bool isExpired = timer.deadline.isExpired();
+        if (isExpired) {
+            if (timer.periodMillis > 0ULL) {
+                timer.deadline.start(timer.periodMillis);
+            } else {
+                timer.deadline.stop();
+            }
+        }
+        portEXIT_CRITICAL(&timerMux);
+        if (isExpired) {
+            runHandler(timer.handler, MAX_EVENTS + i);
+        }
+    }
+
+    iterations++;
+}
+
+unsigned long Scheduler::getIterations() { return iterations; }
+uint64_t Scheduler::getIdleMicros() { return idleMicros; }
+uint64_t Scheduler::getStatsMicros() { return (uint64_t)(Clock::nowMicros() - statsStartMicros); }
+uint32_t Scheduler::getWorstHandlerMicros() { return worstHandlerMicros; }
+
+/**
+ * Clears the loop statistics and starts a new measuring period.
+ */
+void Scheduler::resetStats() {
+    iterations = 0UL;
+    idleMicros = 0ULL;
+    worstHandlerMicros = 0UL;
+    statsStartMicros = Clock::nowMicros();
+    #ifdef LOOP_PROFILE
+        resetProfiles();
+    #endif
+}
+
+#ifdef LOOP_PROFILE
+    uint8_t Scheduler::getProfileCount() { return profileCount; }
+
+    /**
+     * Gets the name a profiled handler was registered with.
+     *
+     * @param profile - Which profile, less than getProfileCount(), as uint8_t.
+     *
+     * @return Returns the name as const char*.
+     */
+    const char* Scheduler::getProfileName(uint8_t profile) {
+        return profile < profileCount ? profileNames[profile] : "";
+    }
+
+    /**
+     * Gets the CPU cycles a handler has taken, each time it was run, since
+     * the profiles were last reset. Other tasks must hold the lock.
+     *
+     * @param profile - Which profile, less than getProfileCount(), as uint8_t.
+     *
+     * @return Returns a copy of the histogram as LogHistogram.
+     */
+    LogHistogram Scheduler::getProfile(uint8_t profile) {
+        return profile < profileCount ? profiles[profile] : LogHistogram();
+    }
+
+    /**
+     * Forgets the cycles every handler has taken, starting each profile
+     * afresh. Other tasks must hold the lock.
+     *
+     */
+    void Scheduler::resetProfiles() {
+        for (uint8_t profile = 0; profile < profileCount; profile++) {
+            profiles[profile].reset();
+        }
+    }
+#endif
+
+/**
+ * Takes the scheduler's lock, waiting for any running handler to 
+ * finish. Used by other tasks before touching state owned by the 
+ * loop; Must not be called from a handler.
+ * 
+ */
+void Scheduler::lock() {
+    xSemaphoreTake(stateMutex, portMAX_DELAY);
+}
+
+/**
+ * Releases the scheduler's lock taken by lock().
+ * 
+ */
+void Scheduler::unlock() {
+    xSemaphoreGive(stateMutex);
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * Atomically takes and clears the set of pending events.
+ * 
+ * @return Returns the pending events as a bitmask as uint32_t.
+ */
+uint32_t Scheduler::takePending() {
+    portENTER_CRITICAL(&pendingMux);
+    uint32_t pending = pendingEvents;
+    pendingEvents = 0UL;
+    portEXIT_CRITICAL(&pendingMux);
+
+    return pending;
+}
+
+/**
+ * #### PRIVATE ####
+ * Determines how long the loop task may sleep before a timer is 
+ * due. A timer due in less than a tick still gets a tick of sleep
+ * so that the loop does not spin waiting on it.
+ * 
+ * @return Returns the ticks to sleep, zero if a timer has already 
+ * expired, or portMAX_DELAY if no timer is active, as TickType_t.
+ */
+TickType_t Scheduler::ticksUntilNextTimer() {
+    bool anyActive = false;
+    bool anyExpired = false;
+    uint64_t minRemaining = UINT64_MAX;
+
+    portENTER_CRITICAL(&timerMux);
+    for (uint8_t i = 0; i < timerCount && !anyExpired; i++) {
+        Timer &timer = timers[i];
+        if (timer.deadline.isActive()) {
+            anyExpired = timer.deadline.isExpired();
+            anyActive = true;
+            minRemaining = std::min(minRemaining, timer.deadline.remainingMillis());
+        }
+    }
+    portEXIT_CRITICAL(&timerMux);
+
+    if (anyExpired) {
+        return 0;
+    }
+    if (!anyActive) {
+        return portMAX_DELAY;
+    }
+
+    // Capped so the tick conversion cannot overflow; a longer wait simply wakes and sleeps again
+    TickType_t ticks = pdMS_TO_TICKS((uint32_t)std::min(minRemaining, (uint64_t)60000ULL));
+
+    return ticks > 0 ? ticks : 1;
+}
+
+#ifdef LOOP_PROFILE
+    /**
+     * #### PRIVATE ####
+     * Gives a handler a profile of its own, or renames the one it has.
+     *
+     * @param slot - The event, or MAX_EVENTS plus the timer, as uint8_t.
+     * @param name - What the handler is profiled as as const char*.
+     */
+    void Scheduler::addProfile(uint8_t slot, const char *name) {
+        if (profileOf[slot] == 0) {
+            if (profileCount >= MAX_PROFILES) {
+                return;
+            }
+            profileOf[slot] = ++profileCount;
+        }
+        profileNames[profileOf[slot] - 1] = name;
+    }
+#endif
+
+/**
+ * #### PRIVATE ####
+ * Runs a handler while keeping track of the longest any handler 
+ * has taken to run and, if profiling, the cycles it took.
+ * 
+ * @param handler - The handler to run as Handler.
+ * @param slot - The event, or MAX_EVENTS plus the timer, as uint8_t.
+ */
+void Scheduler::runHandler(Handler handler, uint8_t slot) {
+    lock();
+    int64_t start = Clock::nowMicros();
+    #ifdef LOOP_PROFILE
+        uint32_t startCycles = ESP.getCycleCount();
+    #endif
+    handler();
+    #ifdef LOOP_PROFILE
+        uint32_t cycles = ESP.getCycleCount() - startCycles; // <-- Wraps only after 17 s at 240 MHz
+        if (profileOf[slot] != 0) {
+            profiles[profileOf[slot] - 1].record(cycles);
+        }
+    #else
+        (void)slot;
+    #endif
+    uint32_t took = (uint32_t)(Clock::nowMicros() - start);
+    unlock();
+    if (took > worstHandlerMicros) {
+        worstHandlerMicros = took;
+    }
+}
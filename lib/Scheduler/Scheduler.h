@@ -0,0 +1,117 @@
+/*
+    Scheduler.h
+    This is the header file for the Scheduler Class.
+
+    The purpose of this class is to drive the firmware's main loop from events and timers rather
+    than by polling every subsystem on every pass. Subsystems register a handler for an event and
+    post that event, from any task or from an ISR, when something has happened. Timers run a handler
+    once or periodically after a delay. When there is nothing to do the loop task blocks on its
+    FreeRTOS notification until the next event is posted or the next timer is due, so the CPU idles
+    rather than spinning.
+
+    Handlers are run one at a time from the loop task and must never block. Anything which needs to
+    wait should register a timer and continue from its handler instead.
+
+    Handlers run while holding the scheduler's lock. Code running in another task (e.g. the async
+    web server) takes the same lock, with a Scheduler::Guard, before it touches state owned by the
+    loop, so it never sees that state part way through a handler. Timers may be started and stopped
+    from any task; Their state is kept under a spinlock of its own, as the lock is held by handlers
+    which start timers too, and starting one from another task wakes the loop to take it into account.
+
+    Built with LOOP_PROFILE defined, the CPU cycles each handler takes are recorded in a LogHistogram
+    of its own, named when it is registered, to find which handler the loop's time goes to. Without
+    it none of the profiling is built.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef Scheduler_h
+    #define Scheduler_h
+
+    #include <Arduino.h>
+    #include <Clock.h>
+    #ifdef LOOP_PROFILE
+        #include <LogHistogram.h>
+    #endif
+
+    class Scheduler {
+    public:
+        typedef void (*Handler)();
+
+        class Guard {
+        public:
+            Guard(Scheduler &scheduler) : scheduler(scheduler) { scheduler.lock(); }
+            ~Guard() { scheduler.unlock(); }
+        private:
+            Scheduler &scheduler;
+        };
+
+        static const uint8_t MAX_EVENTS = 32;
+        static const uint8_t MAX_TIMERS = 24;
+        static const uint8_t NO_TIMER = 0xFF;
+
+        void begin();
+        void on(uint8_t event, Handler handler, const char *name = "");
+        void post(uint8_t event);
+        void IRAM_ATTR postFromISR(uint8_t event);
+
+        uint8_t addTimer(Handler handler, const char *name = "");
+        void startTimer(uint8_t timer, uint64_t delayMillis, uint64_t periodMillis = 0ULL);
+        void stopTimer(uint8_t timer);
+        bool isTimerActive(uint8_t timer);
+
+        void runOnce();
+        void lock();
+        void unlock();
+
+        unsigned long getIterations();
+        uint64_t getIdleMicros();
+        uint64_t getStatsMicros();
+        uint32_t getWorstHandlerMicros();
+        void resetStats();
+
+        #ifdef LOOP_PROFILE
+            static const uint8_t MAX_PROFILES = 32;
+
+            uint8_t getProfileCount();
+            const char* getProfileName(uint8_t profile);
+            LogHistogram getProfile(uint8_t profile);
+            void resetProfiles();
+        #endif
+
+    private:
+        struct Timer {
+            Handler handler;
+            Deadline deadline;
+            uint64_t periodMillis;
+        };
+
+        TaskHandle_t loopTask = nullptr;
+        SemaphoreHandle_t stateMutex = nullptr;
+        portMUX_TYPE pendingMux = portMUX_INITIALIZER_UNLOCKED;
+        portMUX_TYPE timerMux = portMUX_INITIALIZER_UNLOCKED;  // <-- Guards timers[], which other tasks may start
+        volatile uint32_t pendingEvents = 0UL;
+
+        Handler handlers[MAX_EVENTS] = {};
+        Timer timers[MAX_TIMERS];
+        uint8_t timerCount = 0;
+
+        unsigned long iterations = 0UL;
+        uint64_t idleMicros = 0ULL;
+        int64_t statsStartMicros = 0LL;
+        uint32_t worstHandlerMicros = 0UL;
+
+        #ifdef LOOP_PROFILE
+            uint8_t profileOf[MAX_EVENTS + MAX_TIMERS] = {}; // <-- Each one's profile plus one, or 0 for none; By event then by timer
+            const char *profileNames[MAX_PROFILES];
+            LogHistogram profiles[MAX_PROFILES];
+            uint8_t profileCount = 0;
+
+            void addProfile(uint8_t slot, const char *name);
+        #endif
+
+        uint32_t takePending();
+        TickType_t ticksUntilNextTimer();
+        void runHandler(Handler handler, uint8_t slot);
+    };
+#endif
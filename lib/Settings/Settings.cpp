@@ -12,6 +12,70 @@
 
 #include <Settings.h>
 
+#define NVS_NAMESPACE "settings"
+#define KEY_SCHEMA "schema"
+#define EEPROM_NAMESPACE "eeprom" // <-- Where the EEPROM library keeps its record, as a blob
+#define EEPROM_KEY "eeprom"
+
+/* The EEPROM record released firmware kept, SCHEMA_EEPROM */
+struct EepromRecord {
+    int              maxNearRssi              ;
+    int              closeRssi                ;
+    unsigned long    startups                 ;
+    unsigned long    lastStartMillis          ;
+    unsigned long    maxNotSeenMillis         ;
+    unsigned long    learnDurationMillis      ;
+    unsigned long    triggerLearnMillis       ;
+    unsigned long    triggerFactoryMillis     ;
+    unsigned long    triggerWiFiOnMillis      ;
+    unsigned long    triggerWiFiOffMillis     ;
+    char             pairedAddress    [18]    ;
+    char             apPwd            [64]    ;
+    char             sentinel         [33]    ; // Holds a 32 MD5 hash + 1
+};
+
+/**
+ * Builds up the text the EEPROM record's sentinel is the MD5 of, which
+ * is each of its settings but the startup counters, in order.
+ * 
+ * @param record - The record as const EepromRecord&.
+ * 
+ * @return Returns the text as String.
+*/
+static String sentinelContent(const EepromRecord &record) {
+    String content = "";
+    content = content + String(record.maxNearRssi);
+    content = content + String(record.closeRssi);
+    content = content + String(record.maxNotSeenMillis);
+    content = content + String(record.learnDurationMillis);
+    content = content + String(record.triggerLearnMillis);
+    content = content + String(record.triggerFactoryMillis);
+    content = content + String(record.triggerWiFiOnMillis);
+    content = content + String(record.triggerWiFiOffMillis);
+    content = content + record.pairedAddress;
+    content = content + record.apPwd;
+
+    return content;
+}
+
+/**
+ * Used to determine if an EEPROM record's sentinel matches its content.
+ * 
+ * @param content - What the sentinel is the MD5 of as const String&.
+ * @param sentinel - The sentinel as char*.
+ * 
+ * @return Returns true if it matches otherwise false as bool.
+*/
+static bool isSentinelValid(const String &content, char *sentinel) {
+    MD5Builder builder = MD5Builder();
+    builder.begin();
+    builder.add(content);
+    builder.calculate();
+    sentinel[32] = '\0';
+
+    return strcmp(sentinel, builder.toString().c_str()) == 0;
+}
+
 Settings::Settings() {
     defaultSettings();
 }
@@ -26,98 +90,253 @@ Settings::Settings() {
 */
 bool Settings::factoryDefault() {
     defaultSettings();
+    dirtyFields = ALL_FIELDS;
     bool ok = saveSettings();
 
     return ok;
 }
 
 /**
- * Used to save or persist the current value of the non-volatile settings
- * into flash memory.
+ * Used to save or persist the non-volatile settings which have changed
+ * since they were last saved. Each setting is its own NVS key so only 
+ * those which changed are written, and NVS appends them rather than 
+ * erasing flash. Settings which fail to save remain pending.
+ *
+ * Each key holds its setting with the setting's own CRC-32, and NVS 
+ * writes a key whole or not at all, so a save cut short by a power cut
+ * leaves each setting as it was or as the save made it; Changing one 
+ * setting is one write. Once all are saved the schema they are kept in
+ * is saved too, if it changed.
+ *
+ * As a save still takes a few milliseconds it is best batched up and 
+ * run after the changes rather than where they are made.
  *
  * @return Returns a true if save was successful otherwise a false as bool.
 */
 bool Settings::saveSettings() {
-    strcpy(nvSettings.sentinel, hashNvSettings(nvSettings).c_str()); // Ensure accurate Sentinel Value.
-    EEPROM.begin(sizeof(NVSettings));
-    EEPROM.put(0, nvSettings);    
-    bool ok = EEPROM.commit();
-    EEPROM.end();
-    
+    if (!isSavePending()) {
+        return true;
+    }
+    if (!openPrefs()) {
+        return false;
+    }
+
+    bool ok = true;
+    for (uint8_t field = 0; field < FIELD_COUNT; field++) {
+        if ((dirtyFields & (1UL << field)) == 0UL) {
+            continue;
+        }
+        if (writeField(field)) {
+            dirtyFields &= ~(1UL << field);
+        } else {
+            ok = false;
+        }
+    }
+    if (!ok) {
+        return false;
+    }
+
+    if (savedSchema != SCHEMA_VERSION) {
+        ok = prefs.putUChar(KEY_SCHEMA, SCHEMA_VERSION) > 0;
+        savedSchema = ok ? SCHEMA_VERSION : savedSchema;
+    }
+
     return ok;
 }
 
+/**
+ * Used to determine if there are changed settings yet to be saved.
+ *
+ * @return Returns true if a save is pending otherwise false as bool.
+*/
+bool Settings::isSavePending() {
+    return dirtyFields != 0UL || savedSchema != SCHEMA_VERSION;
+}
+
 /**
  * Used to load the settings from flash memory.
- * After the settings are loaded from flash memory the sentinel value is 
- * checked to ensure the integrity of the loaded data. If the sentinel 
- * value is wrong then the contents of the memory are deemed invalid and
- * the memory is wiped and then a factory default is instead performed.
+ * Settings are read in whichever schema they were kept in, those kept by
+ * earlier firmware being migrated to the current one by the next save. 
+ * Settings in the current schema are each checked against their own 
+ * CRC-32 and those of the EEPROM record against its sentinel value. 
+ * Should any be found corrupt or missing, or should there be none, the
+ * factory defaults are used and saved by the next save instead. Those 
+ * outside the range the schema now gives them, as earlier firmware 
+ * didn't check, are brought within it and saved by the next save.
  * 
- * @return Returns true if data was loaded from memory and the sentinel 
- * value was valid.
+ * @return Returns true if data was loaded from memory otherwise false
+ * as bool.
 */
 bool Settings::loadSettings() {
-    bool ok = false;
-    // Setup EEPROM for loading and saving...
-    EEPROM.begin(sizeof(NVSettings));
+    defaultSettings();
+    dirtyFields = 0UL;
+    savedSchema = openPrefs() ? findSchema() : (uint8_t)SCHEMA_NONE;
 
-    // Persist default settings or load settings...
-    delay(15);
+    bool ok = false;
+    switch (savedSchema) {
+        case SCHEMA_NONE:
+            break;
+        case SCHEMA_EEPROM:
+            ok = loadEepromRecord();
+            dirtyFields = ALL_FIELDS; // <-- None are kept as keys yet
+            break;
+        case SCHEMA_KEYS:
+            ok = loadFields();
+            break;
+        default:
+            // A later schema, left by firmware since rolled back; Its keys are kept as they were
+            ok = loadFields();
+            break;
+    }
 
-    /* Load from EEPROM if applicable... */
-    EEPROM.get(0, nvSettings);
-    if (strcmp(nvSettings.sentinel, hashNvSettings(nvSettings).c_str()) != 0) { // Memory is corrupt...
-        factoryDefault();
-    } else { // Memory seems ok...
-        ok = true;
+    if (ok) {
+        clampFields();
+    } else {
+        defaultSettings();
+        dirtyFields = ALL_FIELDS;
     }
-    
-    EEPROM.end();
 
     return ok;
 }
 
+/**
+ * Gets a number or bool setting, for when which is only known at runtime.
+ * 
+ * @param field - Which setting as uint8_t.
+ * 
+ * @return Returns the setting, or 0 if text, as long long.
+*/
+long long Settings::getNumber(uint8_t field) {
+    return FIELDS[field].type == TYPE_TEXT ? 0LL : numbers[field];
+}
+
+/**
+ * Gets a text setting, for when which is only known at runtime.
+ * 
+ * @param field - Which setting as uint8_t.
+ * 
+ * @return Returns the setting, or empty if not text, as const char*.
+*/
+const char* Settings::getText(uint8_t field) {
+    return FIELDS[field].type == TYPE_TEXT ? texts + TEXT_LAYOUT.offsets[field] : "";
+}
+
+/**
+ * Used to determine if text, as entered in the web form or API, is a 
+ * valid value for a setting: A whole number within the setting's range,
+ * 0 or 1 for a bool, or text of a length within its range.
+ * 
+ * @param field - Which setting as uint8_t.
+ * @param value - The value as const String&.
+ * 
+ * @return Returns true if valid otherwise false as bool.
+*/
+bool Settings::isAcceptable(uint8_t field, const String &value) {
+    long long number = 0LL;
+
+    return parseField(field, value, number);
+}
+
+/**
+ * Sets a setting from text, as entered in the web form or API, marking
+ * it to be saved only if it changed. Values which aren't acceptable are
+ * ignored.
+ * 
+ * @param field - Which setting as uint8_t.
+ * @param value - The value as const String&.
+ * 
+ * @return Returns true if the setting changed otherwise false as bool.
+*/
+bool Settings::setFromText(uint8_t field, const String &value) {
+    long long number = 0LL;
+    if (!parseField(field, value, number)) {
+        return false;
+    }
+
+    // Acceptable text fits the setting, so is kept as given
+    bool isChanged = false;
+    if (FIELDS[field].type == TYPE_TEXT) {
+        isChanged = strcmp(getText(field), value.c_str()) != 0;
+        setText(field, value.c_str());
+    } else {
+        isChanged = numbers[field] != number;
+        setNumber(field, number);
+    }
+
+    return isChanged;
+}
+
 bool Settings::isOnState() { return vSettings.onState; }
 void Settings::setOnState(bool onState) { vSettings.onState = onState; }
 
-int Settings::getMaxNearRssi() { return nvSettings.maxNearRssi; }
-void Settings::setMaxNearRssi(int rssi) { nvSettings.maxNearRssi = rssi; }
+int Settings::getMaxNearRssi() { return get<FIELD_MAX_NEAR_RSSI>(); }
+void Settings::setMaxNearRssi(int rssi) { set<FIELD_MAX_NEAR_RSSI>(rssi); }
+
+int Settings::getCloseRssi() { return get<FIELD_CLOSE_RSSI>(); }
+void Settings::setCloseRssi(int rssi) { set<FIELD_CLOSE_RSSI>(rssi); }
+
+unsigned long Settings::getMaxNotSeenMillis() { return get<FIELD_MAX_NOT_SEEN_MILLIS>(); }
+void Settings::setMaxNotSeenMillis(unsigned long millis) { set<FIELD_MAX_NOT_SEEN_MILLIS>(millis); }
+
+unsigned long Settings::getLearnDurationMillis() { return get<FIELD_LEARN_DURATION_MILLIS>(); }
+void Settings::setLearnDurationMillis(unsigned long millis) { set<FIELD_LEARN_DURATION_MILLIS>(millis); }
+
+unsigned long Settings::getTriggerLearnMillis() { return get<FIELD_TRIGGER_LEARN_MILLIS>(); }
+void Settings::setTriggerLearnMillis(unsigned long millis) { set<FIELD_TRIGGER_LEARN_MILLIS>(millis); }
+
+unsigned long Settings::getTriggerFactoryMillis() { return get<FIELD_TRIGGER_FACTORY_MILLIS>(); }
+void Settings::setTriggerFactoryMillis(unsigned long millis) { set<FIELD_TRIGGER_FACTORY_MILLIS>(millis); }
+
+unsigned long Settings::getTriggerWiFiOnMillis() { return get<FIELD_TRIGGER_WIFI_ON_MILLIS>(); }
+void Settings::setTriggerWiFiOnMillis(unsigned long millis) { set<FIELD_TRIGGER_WIFI_ON_MILLIS>(millis); }
 
-int Settings::getCloseRssi() { return nvSettings.closeRssi; }
-void Settings::setCloseRssi(int rssi) { nvSettings.closeRssi = rssi; }
+unsigned long Settings::getTriggerWiFiOffMillis() { return get<FIELD_TRIGGER_WIFI_OFF_MILLIS>(); }
+void Settings::setTriggerWiFiOffMillis(unsigned long millis) { set<FIELD_TRIGGER_WIFI_OFF_MILLIS>(millis); }
 
-unsigned long Settings::getMaxNotSeenMillis() { return nvSettings.maxNotSeenMillis; }
-void Settings::setMaxNotSeenMillis(unsigned long millis) { nvSettings.maxNotSeenMillis = millis; }
+String Settings::getParedAddress() { return String(get<FIELD_PAIRED_ADDRESS>()); }
+void Settings::setParedAddress(String address) { set<FIELD_PAIRED_ADDRESS>(address.c_str()); }
 
-unsigned long Settings::getLearnDurationMillis() { return nvSettings.learnDurationMillis; }
-void Settings::setLearnDurationMillis(unsigned long millis) { nvSettings.learnDurationMillis = millis; }
+String Settings::getApPwd() { return String(get<FIELD_AP_PWD>()); }
+void Settings::setApPwd(String apPwd) { set<FIELD_AP_PWD>(apPwd.c_str()); }
 
-unsigned long Settings::getTriggerLearnMillis() { return nvSettings.triggerLearnMillis; }
-void Settings::setTriggerLearnMillis(unsigned long millis) { nvSettings.triggerLearnMillis = millis; }
+String Settings::getStaSsid() { return String(get<FIELD_STA_SSID>()); }
+void Settings::setStaSsid(String ssid) { set<FIELD_STA_SSID>(ssid.c_str()); }
 
-unsigned long Settings::getTriggerFactoryMillis() { return nvSettings.triggerFactoryMillis; }
-void Settings::setTriggerFactoryMillis(unsigned long millis) { nvSettings.triggerFactoryMillis = millis; }
+String Settings::getStaPwd() { return String(get<FIELD_STA_PWD>()); }
+void Settings::setStaPwd(String staPwd) { set<FIELD_STA_PWD>(staPwd.c_str()); }
 
-unsigned long Settings::getTriggerWiFiOnMillis() { return nvSettings.triggerWiFiOnMillis; }
-void Settings::setTriggerWiFiOnMillis(unsigned long millis) { nvSettings.triggerWiFiOnMillis = millis; }
+String Settings::getMqttHost() { return String(get<FIELD_MQTT_HOST>()); }
+void Settings::setMqttHost(String host) { set<FIELD_MQTT_HOST>(host.c_str()); }
 
-unsigned long Settings::getTriggerWiFiOffMillis() { return nvSettings.triggerWiFiOffMillis; }
-void Settings::setTriggerWiFiOffMillis(unsigned long millis) { nvSettings.triggerWiFiOffMillis = millis; }
+unsigned long Settings::getMqttPort() { return get<FIELD_MQTT_PORT>(); }
+void Settings::setMqttPort(unsigned long port) { set<FIELD_MQTT_PORT>(port); }
 
-String Settings::getParedAddress() { return String(nvSettings.pairedAddress); }
-void Settings::setParedAddress(String address) { strcpy(nvSettings.pairedAddress, address.c_str()); }
+bool Settings::isGossip() { return get<FIELD_GOSSIP>(); }
+void Settings::setGossip(bool gossip) { set<FIELD_GOSSIP>(gossip); }
 
-String Settings::getApPwd() { return String(nvSettings.apPwd); }
-void Settings::setApPwd(String apPwd) { strcpy(nvSettings.apPwd, apPwd.c_str()); }
+int Settings::getGossipMarginDb() { return get<FIELD_GOSSIP_MARGIN_DB>(); }
+void Settings::setGossipMarginDb(int marginDb) { set<FIELD_GOSSIP_MARGIN_DB>(marginDb); }
 
-unsigned long Settings::getStartups() { return nvSettings.startups;}
-unsigned long Settings::getLastStartMillis() { return nvSettings.lastStartMillis; }
+String Settings::getProxyHost() { return String(get<FIELD_PROXY_HOST>()); }
+void Settings::setProxyHost(String host) { set<FIELD_PROXY_HOST>(host.c_str()); }
 
+unsigned long Settings::getProxyPort() { return get<FIELD_PROXY_PORT>(); }
+void Settings::setProxyPort(unsigned long port) { set<FIELD_PROXY_PORT>(port); }
+
+bool Settings::isProxyUdp() { return get<FIELD_PROXY_UDP>(); }
+void Settings::setProxyUdp(bool udp) { set<FIELD_PROXY_UDP>(udp); }
+
+unsigned long Settings::getStartups() { return get<FIELD_STARTUPS>(); }
+unsigned long Settings::getLastStartMillis() { return get<FIELD_LAST_START_MILLIS>(); }
+
+/**
+ * Counts a startup. Like any change it is saved by the next save, which
+ * writes just these two keys.
+ * 
+*/
 void Settings::logStartup() {
-    nvSettings.startups = nvSettings.startups + 1UL;
-    nvSettings.lastStartMillis = millis();
-    saveSettings();
+    set<FIELD_STARTUPS>(get<FIELD_STARTUPS>() + 1UL);
+    set<FIELD_LAST_START_MILLIS>((unsigned long)Clock::nowMillis());
 }
 
 /*
@@ -133,47 +352,262 @@ Private Functions BELOW
  * changes to flash.
 */
 void Settings::defaultSettings() {
-    // Default the settings...
-    nvSettings.startups = factorySettings.startups;
-    nvSettings.lastStartMillis = factorySettings.lastStartMillis;
-    nvSettings.maxNearRssi = factorySettings.maxNearRssi;
-    nvSettings.closeRssi = factorySettings.closeRssi;
-    nvSettings.maxNotSeenMillis = factorySettings.maxNotSeenMillis;
-    nvSettings.learnDurationMillis = factorySettings.learnDurationMillis;
-    nvSettings.triggerLearnMillis = factorySettings.triggerLearnMillis;
-    nvSettings.triggerFactoryMillis = factorySettings.triggerFactoryMillis;
-    nvSettings.triggerWiFiOnMillis = factorySettings.triggerWiFiOnMillis;
-    nvSettings.triggerWiFiOffMillis = factorySettings.triggerWiFiOffMillis;
-    strcpy(nvSettings.pairedAddress, factorySettings.pairedAddress);
-    strcpy(nvSettings.apPwd, factorySettings.apPwd);
+    for (uint8_t field = 0; field < FIELD_COUNT; field++) {
+        numbers[field] = FIELDS[field].number;
+        if (FIELDS[field].type == TYPE_TEXT) {
+            strlcpy(texts + TEXT_LAYOUT.offsets[field], FIELDS[field].text, FIELDS[field].maximum + 1);
+        }
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Opens the settings' NVS namespace, which is then kept open.
+ * 
+ * @return Returns true if open otherwise false as bool.
+*/
+bool Settings::openPrefs() {
+    if (!isPrefsOpen) {
+        isPrefsOpen = prefs.begin(NVS_NAMESPACE, false);
+    }
+
+    return isPrefsOpen;
 }
 
 /**
  * #### PRIVATE ####
- * Used to provide a hash of the given NonVolatileSettings.
+ * Works out which schema the settings are kept in.
  * 
- * @param nvSet An instance of NonVolatileSettings to calculate a hash for.
+ * @return Returns the schema as uint8_t.
+*/
+uint8_t Settings::findSchema() {
+    if (prefs.isKey(KEY_SCHEMA)) {
+        return prefs.getUChar(KEY_SCHEMA, SCHEMA_NONE);
+    }
+
+    // Read through Preferences; The EEPROM library would resize the record to fit
+    Preferences eeprom;
+    size_t length = eeprom.begin(EEPROM_NAMESPACE, true) ? eeprom.getBytesLength(EEPROM_KEY) : 0;
+    eeprom.end();
+
+    return length == sizeof(EepromRecord) ? SCHEMA_EEPROM : SCHEMA_NONE;
+}
+
+/**
+ * #### PRIVATE ####
+ * Reads the settings from their NVS keys.
  * 
- * @return Returns the calculated hash value as String.
+ * @return Returns true if each was there and intact otherwise false 
+ * as bool.
 */
-String Settings::hashNvSettings(NVSettings nvSet) {
-    String content = "";
-    content = content + String(nvSet.maxNearRssi);
-    content = content + String(nvSet.closeRssi);
-    content = content + String(nvSet.maxNotSeenMillis);
-    content = content + String(nvSet.learnDurationMillis);
-    content = content + String(nvSet.triggerLearnMillis);
-    content = content + String(nvSet.triggerFactoryMillis);
-    content = content + String(nvSet.triggerWiFiOnMillis);
-    content = content + String(nvSet.triggerWiFiOffMillis);
-    content = content + nvSet.pairedAddress;
-    content = content + nvSet.apPwd;
-    
-    MD5Builder builder = MD5Builder();
-    builder.begin();
-    builder.add(content);
-    builder.calculate();
+bool Settings::loadFields() {
+    for (uint8_t field = 0; field < FIELD_COUNT; field++) {
+        if (!readField(field)) {
+            return false;
+        }
+    }
 
-    return builder.toString();
+    return true;
 }
 
+/**
+ * #### PRIVATE ####
+ * Reads a setting from its NVS key, checking it against the CRC-32 kept
+ * with it. A number or bool is kept in the low half of a 64 bit key, as
+ * its 32 bits, and its CRC-32 in the high half; Text is kept as a blob,
+ * without its terminator, followed by its CRC-32. Each CRC-32 starts
+ * from the setting's field so that one setting's key can't pass for 
+ * another's.
+ * 
+ * @param field - Which setting as uint8_t.
+ * 
+ * @return Returns true if there and intact otherwise false as bool.
+*/
+bool Settings::readField(uint8_t field) {
+    const FieldInfo &info = FIELDS[field];
+    if (!prefs.isKey(info.key)) {
+        return false;
+    }
+
+    if (info.type == TYPE_TEXT) {
+        uint8_t kept[TEXT_LAYOUT.longest + sizeof(uint32_t)];
+        size_t length = prefs.getBytesLength(info.key);
+        if (length < sizeof(uint32_t) || length > sizeof(kept) || prefs.getBytes(info.key, kept, length) != length) {
+            return false;
+        }
+
+        length -= sizeof(uint32_t);
+        uint32_t crc = 0UL;
+        memcpy(&crc, kept + length, sizeof(crc));
+        if (length > (size_t)info.maximum || Crc32::calculate(kept, length, field) != crc) {
+            return false;
+        }
+        char *slot = texts + TEXT_LAYOUT.offsets[field];
+        memcpy(slot, kept, length);
+        slot[length] = '\0';
+
+        return true;
+    }
+
+    uint64_t kept = prefs.getULong64(info.key, 0ULL);
+    uint32_t value = (uint32_t)kept;
+    if (Crc32::calculate(&value, sizeof(value), field) != (uint32_t)(kept >> 32)) {
+        return false;
+    }
+    switch (info.type) {
+        case TYPE_INT:
+            numbers[field] = (int32_t)value;
+            break;
+        case TYPE_BOOL:
+            numbers[field] = value != 0UL;
+            break;
+        default:
+            numbers[field] = (long long)value;
+            break;
+    }
+
+    return true;
+}
+
+/**
+ * #### PRIVATE ####
+ * Reads the settings from the EEPROM record released firmware kept, which
+ * is left in place for firmware which might be rolled back to. Settings
+ * the record doesn't have are left at their defaults.
+ * 
+ * @return Returns true if the record was intact otherwise false as bool.
+*/
+bool Settings::loadEepromRecord() {
+    Preferences eeprom;
+    if (!eeprom.begin(EEPROM_NAMESPACE, true)) {
+        return false;
+    }
+
+    EepromRecord record;
+    bool ok = eeprom.getBytes(EEPROM_KEY, &record, sizeof(record)) == sizeof(record)
+        && isSentinelValid(sentinelContent(record), record.sentinel);
+    eeprom.end();
+    if (ok) {
+        set<FIELD_MAX_NEAR_RSSI>(record.maxNearRssi);
+        set<FIELD_CLOSE_RSSI>(record.closeRssi);
+        set<FIELD_STARTUPS>(record.startups);
+        set<FIELD_LAST_START_MILLIS>(record.lastStartMillis);
+        set<FIELD_MAX_NOT_SEEN_MILLIS>(record.maxNotSeenMillis);
+        set<FIELD_LEARN_DURATION_MILLIS>(record.learnDurationMillis);
+        set<FIELD_TRIGGER_LEARN_MILLIS>(record.triggerLearnMillis);
+        set<FIELD_TRIGGER_FACTORY_MILLIS>(record.triggerFactoryMillis);
+        set<FIELD_TRIGGER_WIFI_ON_MILLIS>(record.triggerWiFiOnMillis);
+        set<FIELD_TRIGGER_WIFI_OFF_MILLIS>(record.triggerWiFiOffMillis);
+        set<FIELD_PAIRED_ADDRESS>(record.pairedAddress);
+        set<FIELD_AP_PWD>(record.apPwd);
+    }
+
+    return ok;
+}
+
+/**
+ * #### PRIVATE ####
+ * Writes a setting to its NVS key, with its CRC-32, as readField() reads
+ * it.
+ * 
+ * @param field - Which setting as uint8_t.
+ * 
+ * @return Returns true if written otherwise false as bool.
+*/
+bool Settings::writeField(uint8_t field) {
+    const FieldInfo &info = FIELDS[field];
+    if (info.type == TYPE_TEXT) {
+        uint8_t kept[TEXT_LAYOUT.longest + sizeof(uint32_t)];
+        size_t length = strlen(getText(field));
+        memcpy(kept, getText(field), length);
+        uint32_t crc = Crc32::calculate(kept, length, field);
+        memcpy(kept + length, &crc, sizeof(crc));
+        length += sizeof(crc);
+
+        return prefs.putBytes(info.key, kept, length) == length;
+    }
+
+    uint32_t value = (uint32_t)numbers[field]; // <-- An int keeps its bits
+    uint64_t kept = ((uint64_t)Crc32::calculate(&value, sizeof(value), field) << 32) | value;
+
+    return prefs.putULong64(info.key, kept) > 0;
+}
+
+/**
+ * #### PRIVATE ####
+ * Brings the settings within the range the schema gives them, marking 
+ * those changed to be saved. A number is moved to the nearest end of its
+ * range and text of a length outside its range is set to its default.
+*/
+void Settings::clampFields() {
+    for (uint8_t field = 0; field < FIELD_COUNT; field++) {
+        const FieldInfo &info = FIELDS[field];
+        if (info.type == TYPE_TEXT) {
+            long long length = (long long)strlen(getText(field));
+            if (length < info.minimum || length > info.maximum) {
+                setText(field, info.text);
+            }
+        } else {
+            long long value = numbers[field] < info.minimum ? info.minimum : numbers[field];
+            setNumber(field, value > info.maximum ? info.maximum : value);
+        }
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Parses text as a value for a setting, checking it against the 
+ * setting's range.
+ * 
+ * @param field - Which setting as uint8_t.
+ * @param value - The text as const String&.
+ * @param number - Set to the number, or the length of text, as long long&.
+ * 
+ * @return Returns true if a valid value otherwise false as bool.
+*/
+bool Settings::parseField(uint8_t field, const String &value, long long &number) {
+    const FieldInfo &info = FIELDS[field];
+    if (info.type == TYPE_TEXT) {
+        number = (long long)value.length();
+    } else {
+        char *end = nullptr;
+        number = strtoll(value.c_str(), &end, 10);
+        if (value.isEmpty() || *end != '\0') {
+            return false;
+        }
+    }
+
+    return number >= info.minimum && number <= info.maximum;
+}
+
+/**
+ * #### PRIVATE ####
+ * Sets a number or bool setting, marking it to be saved only if it 
+ * changed.
+ * 
+ * @param field - Which setting as uint8_t.
+ * @param value - Its new value as long long.
+*/
+void Settings::setNumber(uint8_t field, long long value) {
+    if (numbers[field] != value) {
+        numbers[field] = value;
+        dirtyFields |= 1UL << field;
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Sets a text setting, marking it to be saved only if it changed. Text
+ * too long for the setting is cut short.
+ * 
+ * @param field - Which setting as uint8_t.
+ * @param value - Its new value as const char*.
+*/
+void Settings::setText(uint8_t field, const char *value) {
+    char *slot = texts + TEXT_LAYOUT.offsets[field];
+    size_t size = (size_t)FIELDS[field].maximum + 1;
+    if (strncmp(slot, value, size - 1) != 0) {
+        strlcpy(slot, value, size);
+        dirtyFields |= 1UL << field;
+    }
+}
@@ -2,17 +2,27 @@
     #define Settings_h
 
     #include <WString.h>
-    #include <EEPROM.h>
     #include <MD5Builder.h>
+    #include <Preferences.h>
+    #include <Crc32.h>
+    #include <Clock.h>
+    #include <SettingsSchema.h>
 
-    class Settings {
+    class Settings : public SettingsSchema {
         public:
             Settings();
 
             bool loadSettings();
             bool saveSettings();
+            bool isSavePending();
             bool factoryDefault();
 
+            // Any setting, by its field
+            long long getNumber(uint8_t field);
+            const char* getText(uint8_t field);
+            bool isAcceptable(uint8_t field, const String &value);
+            bool setFromText(uint8_t field, const String &value);
+
             // Getters and Setters
             bool isOnState();
             void setOnState(bool onState);
@@ -51,39 +61,83 @@
             String getApPwd();
             void setApPwd(String apPwd);
 
+            String getStaSsid();
+            void setStaSsid(String ssid);
+
+            String getStaPwd();
+            void setStaPwd(String staPwd);
+
+            String getMqttHost();
+            void setMqttHost(String host);
+
+            unsigned long getMqttPort();
+            void setMqttPort(unsigned long port);
+
+            bool isGossip();
+            void setGossip(bool gossip);
+
+            int getGossipMarginDb();
+            void setGossipMarginDb(int marginDb);
+
+            String getProxyHost();
+            void setProxyHost(String host);
+
+            unsigned long getProxyPort();
+            void setProxyPort(unsigned long port);
+
+            bool isProxyUdp();
+            void setProxyUdp(bool udp);
+
+            /**
+             * Gets a setting, as the type its schema gives it.
+             *
+             * @return Returns the setting as FieldTraits<type>::Type.
+            */
+            template <Field FIELD>
+            typename FieldTraits<FIELDS[FIELD].type>::Type get() {
+                if constexpr (FIELDS[FIELD].type == TYPE_TEXT) {
+                    return texts + TEXT_LAYOUT.offsets[FIELD];
+                } else {
+                    return (typename FieldTraits<FIELDS[FIELD].type>::Type)numbers[FIELD];
+                }
+            }
+
+            /**
+             * Sets a setting, marking it to be saved only if it changed.
+             *
+             * @param value - Its new value as FieldTraits<type>::Type.
+            */
+            template <Field FIELD>
+            void set(typename FieldTraits<FIELDS[FIELD].type>::Type value) {
+                if constexpr (FIELDS[FIELD].type == TYPE_TEXT) {
+                    setText(FIELD, value);
+                } else {
+                    setNumber(FIELD, (long long)value);
+                }
+            }
+
         private:
-            struct NVSettings {
-                int              maxNearRssi              ;
-                int              closeRssi                ;
-                unsigned long    startups                 ;
-                unsigned long    lastStartMillis          ;
-                unsigned long    maxNotSeenMillis         ;
-                unsigned long    learnDurationMillis      ;
-                unsigned long    triggerLearnMillis       ;
-                unsigned long    triggerFactoryMillis     ;
-                unsigned long    triggerWiFiOnMillis      ;
-                unsigned long    triggerWiFiOffMillis     ;
-                char             pairedAddress    [18]    ;
-                char             apPwd            [64]    ;
-                char             sentinel         [33]    ; // Holds a 32 MD5 hash + 1
-            } nvSettings;
-
-            struct NVSettings factorySettings = {
-                -80, // <-------------------- maxNearRssi
-                -50, // <-------------------- closeRssi
-                0UL, // <-------------------- startups
-                0UL, // <-------------------- lastStartMillis
-                60000UL, // <---------------- maxNotSeenMillis
-                10000UL, // <---------------- learnDurationMillis
-                5000UL, // <----------------- triggerLearnMillis
-                30000UL, // <----------------- triggerFactoryMillis
-                10000UL, // <----------------- triggerWiFiOnMillis
-                5000UL, // <----------------- triggerWiFiOffMillis
-                "xx:xx:xx:xx:xx:xx", // <---- pairedAddress
-                "P@ssw0rd123", // <---------- apPwd
-                "NA" // <-------------------- sentinel
+            // The layouts settings have been kept in; Older ones are migrated to the newest
+            enum Schema : uint8_t {
+                SCHEMA_NONE = 0,   // <-- Nothing kept yet
+                SCHEMA_EEPROM = 1, // <-- EEPROM record, as released
+                SCHEMA_KEYS = 2    // <-- A key per setting, each with its CRC-32, and this schema
             };
 
+            static const uint8_t SCHEMA_VERSION = SCHEMA_KEYS;
+            static const uint32_t ALL_FIELDS = (1UL << FIELD_COUNT) - 1UL;
+            static constexpr TextLayout TEXT_LAYOUT = layoutText();
+
+            static_assert(FIELD_COUNT < 32, "Each setting needs a bit of dirtyFields");
+
+            Preferences prefs;
+            bool isPrefsOpen = false;
+            uint32_t dirtyFields = 0UL;
+            uint8_t savedSchema = SCHEMA_NONE;
+
+            long long numbers[FIELD_COUNT]; // <-- Numbers and bools, by field
+            char texts[TEXT_LAYOUT.size];   // <-- Text, where TEXT_LAYOUT places it
+
             struct VSettings {
                 bool             onState                  ;
             } vSettings = {
@@ -91,6 +145,15 @@
             };
 
             void defaultSettings();
-            String hashNvSettings(struct NVSettings nvSet);
+            bool openPrefs();
+            uint8_t findSchema();
+            bool loadFields();
+            bool readField(uint8_t field);
+            bool loadEepromRecord();
+            bool writeField(uint8_t field);
+            void clampFields();
+            bool parseField(uint8_t field, const String &value, long long &number);
+            void setNumber(uint8_t field, long long value);
+            void setText(uint8_t field, const char *value);
     };
-#endif
\ No newline at end of file
+#endif
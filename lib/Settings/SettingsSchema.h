@@ -0,0 +1,136 @@
+/*
+    SettingsSchema.h
+    This is the header file for the SettingsSchema Class.
+
+    The purpose of this class is to describe every setting once, in a table fixed at compile time:
+    Its name in the web form and API, its NVS key, its type, its range, its default, what changing
+    it takes and how the form labels it. Settings keeps, defaults, saves and checks the settings
+    from the table, and the web interface validates, reports and renders them from it, so adding
+    a setting is a line of SETTINGS_SCHEMA.
+
+    The table is constexpr so that lookups by a field known at compile time fold away entirely.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef SettingsSchema_h
+    #define SettingsSchema_h
+
+    #include <stdint.h>
+
+    /*
+      Each setting as SETTING(id, name, key, type, flags, minimum, maximum, default, label). The
+      range of text is its length, which sizes where it is kept. NVS keys are at most 15
+      characters. Settings are kept and checked in this order, so new ones go at the end.
+    */
+    #define SETTINGS_SCHEMA(SETTING) \
+        SETTING(MAX_NEAR_RSSI,          "max_rssi",         "maxNearRssi",  TYPE_INT,   FLAG_NONE,                            -100, 0,          -80,                 "On Max RSSI") \
+        SETTING(CLOSE_RSSI,             "close_rssi",       "closeRssi",    TYPE_INT,   FLAG_NONE,                            -100, 0,          -50,                 "Close RSSI") \
+        SETTING(STARTUPS,               "startups",         "startups",     TYPE_ULONG, FLAG_HIDDEN,                          0,    UINT32_MAX, 0LL,                 "Startups") \
+        SETTING(LAST_START_MILLIS,      "last_start",       "lastStart",    TYPE_ULONG, FLAG_HIDDEN,                          0,    UINT32_MAX, 0LL,                 "Last Start Millis") \
+        SETTING(MAX_NOT_SEEN_MILLIS,    "max_seen",         "maxNotSeen",   TYPE_ULONG, FLAG_NONE,                            0,    86400000,   60000UL,             "Max Not Seen Millis") \
+        SETTING(LEARN_DURATION_MILLIS,  "learn_wait",       "learnDur",     TYPE_ULONG, FLAG_SECTION,                         0,    86400000,   10000UL,             "Learn Duration Millis") \
+        SETTING(TRIGGER_LEARN_MILLIS,   "learn_trigger",    "trigLearn",    TYPE_ULONG, FLAG_SECTION,                         0,    20000,      5000UL,              "Learn Trigger Millis") \
+        SETTING(TRIGGER_FACTORY_MILLIS, "factory_trigger",  "trigFactory",  TYPE_ULONG, FLAG_NONE,                            10000, 60000,     30000UL,             "Factory Reset Trigger Millis") \
+        SETTING(TRIGGER_WIFI_ON_MILLIS, "wifi_on_trigger",  "trigWiFiOn",   TYPE_ULONG, FLAG_NONE,                            6000, 30000,      10000UL,             "WiFi-On Trigger Millis") \
+        SETTING(TRIGGER_WIFI_OFF_MILLIS,"wifi_off_trigger", "trigWiFiOff",  TYPE_ULONG, FLAG_NONE,                            0,    30000,      5000UL,              "WiFi-Off Trigger Millis") \
+        SETTING(PAIRED_ADDRESS,         "pared_address",    "pairedAddr",   TYPE_TEXT,  FLAG_SECTION | FLAG_READ_ONLY,        0,    17,         "xx:xx:xx:xx:xx:xx", "Paired Address") \
+        SETTING(AP_PWD,                 "ap_pwd",           "apPwd",        TYPE_TEXT,  FLAG_SECTION | FLAG_SECRET | FLAG_REBOOT, 8, 63,        "P@ssw0rd123",       "AP Password (min 8 chars)") \
+        SETTING(STA_SSID,               "sta_ssid",         "staSsid",      TYPE_TEXT,  FLAG_SECTION | FLAG_STATION,          0,    32,         "",                  "Station SSID (blank for none)") \
+        SETTING(STA_PWD,                "sta_pwd",          "staPwd",       TYPE_TEXT,  FLAG_SECRET | FLAG_STATION,           0,    63,         "",                  "Station Password") \
+        SETTING(MQTT_HOST,              "mqtt_host",        "mqttHost",     TYPE_TEXT,  FLAG_STATION,                         0,    63,         "",                  "MQTT Broker (blank for none)") \
+        SETTING(MQTT_PORT,              "mqtt_port",        "mqttPort",     TYPE_ULONG, FLAG_STATION,                         1,    65535,      1883UL,              "MQTT Port") \
+        SETTING(GOSSIP,                 "gossip",           "gossip",       TYPE_BOOL,  FLAG_SECTION | FLAG_STATION,          0,    1,          false,               "Nearest Switch Wins (ESP-NOW)") \
+        SETTING(GOSSIP_MARGIN_DB,       "gossip_margin",    "gossipMargin", TYPE_INT,   FLAG_NONE,                            0,    30,         6,                   "Nearest Margin dB") \
+        SETTING(PROXY_HOST,             "proxy_host",       "proxyHost",    TYPE_TEXT,  FLAG_SECTION | FLAG_STATION,          0,    63,         "",                  "BLE Proxy Host (blank for none)") \
+        SETTING(PROXY_PORT,             "proxy_port",       "proxyPort",    TYPE_ULONG, FLAG_STATION,                         1,    65535,      47778UL,             "BLE Proxy Port") \
+        SETTING(PROXY_UDP,              "proxy_udp",        "proxyUdp",     TYPE_BOOL,  FLAG_STATION,                         0,    1,          true,                "BLE Proxy over UDP")
+
+    class SettingsSchema {
+    public:
+        #define SETTINGS_ENUM(id, name, key, type, flags, minimum, maximum, value, label) FIELD_##id,
+        enum Field : uint8_t {
+            SETTINGS_SCHEMA(SETTINGS_ENUM)
+            FIELD_COUNT
+        };
+        #undef SETTINGS_ENUM
+
+        enum FieldType : uint8_t {
+            TYPE_INT,
+            TYPE_ULONG,
+            TYPE_BOOL,
+            TYPE_TEXT
+        };
+
+        enum FieldFlag : uint8_t {
+            FLAG_NONE = 0x00,
+            FLAG_HIDDEN = 0x01,    // <-- Kept, but not a setting to be shown or changed
+            FLAG_READ_ONLY = 0x02, // <-- Shown but not changed through the web
+            FLAG_SECRET = 0x04,    // <-- Entered as a password
+            FLAG_REBOOT = 0x08,    // <-- Takes WiFi restarting to apply
+            FLAG_STATION = 0x10,   // <-- Takes the station and its services restarting to apply
+            FLAG_SECTION = 0x20    // <-- Starts a new section of the form
+        };
+
+        struct FieldInfo {
+            const char *name;
+            const char *key;
+            FieldType type;
+            uint8_t flags;
+            long long minimum;
+            long long maximum;
+            long long number;   // <-- The default of a number or bool
+            const char *text;   // <-- The default of text
+            const char *label;
+
+            constexpr FieldInfo(const char *name, const char *key, FieldType type, uint8_t flags, long long minimum, long long maximum, long long number, const char *label)
+                : name(name), key(key), type(type), flags(flags), minimum(minimum), maximum(maximum), number(number), text(""), label(label) {}
+
+            constexpr FieldInfo(const char *name, const char *key, FieldType type, uint8_t flags, long long minimum, long long maximum, const char *text, const char *label)
+                : name(name), key(key), type(type), flags(flags), minimum(minimum), maximum(maximum), number(0LL), text(text), label(label) {}
+        };
+
+        static const FieldInfo FIELDS[FIELD_COUNT];
+
+        /* The type a setting of each FieldType is read and written as */
+        template <FieldType TYPE> struct FieldTraits;
+
+        /* Where each text setting starts in the text kept for them all, its total size and the longest */
+        struct TextLayout {
+            uint16_t offsets[FIELD_COUNT];
+            uint16_t size;
+            uint16_t longest;
+        };
+
+        /**
+         * Lays out the text settings one after another, each sized for its
+         * longest value plus its terminator.
+         *
+         * @return Returns the layout as TextLayout.
+         */
+        static constexpr TextLayout layoutText() {
+            TextLayout layout = {};
+            for (uint8_t field = 0; field < FIELD_COUNT; field++) {
+                layout.offsets[field] = layout.size;
+                if (FIELDS[field].type == TYPE_TEXT) {
+                    layout.size += (uint16_t)(FIELDS[field].maximum + 1);
+                    layout.longest = FIELDS[field].maximum > layout.longest ? (uint16_t)FIELDS[field].maximum : layout.longest;
+                }
+            }
+
+            return layout;
+        }
+    };
+
+    // Defined once FieldInfo is complete, so that its constructors can be run at compile time
+    #define SETTINGS_INFO(id, name, key, type, flags, minimum, maximum, value, label) FieldInfo(name, key, type, flags, minimum, maximum, value, label),
+    inline constexpr SettingsSchema::FieldInfo SettingsSchema::FIELDS[FIELD_COUNT] = {
+        SETTINGS_SCHEMA(SETTINGS_INFO)
+    };
+    #undef SETTINGS_INFO
+
+    template <> struct SettingsSchema::FieldTraits<SettingsSchema::TYPE_INT> { typedef int Type; };
+    template <> struct SettingsSchema::FieldTraits<SettingsSchema::TYPE_ULONG> { typedef unsigned long Type; };
+    template <> struct SettingsSchema::FieldTraits<SettingsSchema::TYPE_BOOL> { typedef bool Type; };
+    template <> struct SettingsSchema::FieldTraits<SettingsSchema::TYPE_TEXT> { typedef const char *Type; };
+#endif
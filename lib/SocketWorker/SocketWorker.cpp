@@ -0,0 +1,216 @@
+/*
+    SocketWorker.cpp
+    This is the code file for the SocketWorker Class.
+
+    The purpose of this class is to run a network client or server in a task of its own which is started,
+    restarted and stopped by notification, without the caller ever waiting on it.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <SocketWorker.h>
+#include <lwip/sockets.h>
+#include <lwip/netdb.h>
+
+/**
+ * Used to determine if the task is running and hasn't been asked to
+ * stop.
+ *
+ * @return Returns true if running otherwise false as bool.
+ */
+bool SocketWorker::isRunning() {
+    return task != nullptr && !isStopping;
+}
+
+/*
+=================================================================
+Protected Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PROTECTED ####
+ * Starts the task, or restarts it should it still be alive, even if
+ * stopping; Either way onStart() is run by the task before its next
+ * round of work, so it must let go of any connection it finds open.
+ * Never waits on the task.
+ *
+ * @param name - The task's name as const char*.
+ * @param stackSize - The task's stack size as uint32_t.
+ * @param priority - The task's priority as UBaseType_t.
+ *
+ * @return Returns true if started otherwise false as bool.
+ */
+bool SocketWorker::startTask(const char *name, uint32_t stackSize, UBaseType_t priority) {
+    portENTER_CRITICAL(&taskMux);
+    TaskHandle_t alive = task;
+    isStopping = false;
+    isRestarting = true;
+    portEXIT_CRITICAL(&taskMux);
+
+    if (alive != nullptr) {
+        xTaskNotifyGive(alive);
+        return true;
+    }
+
+    if (xTaskCreate(runTask, name, stackSize, this, priority, &task) != pdPASS) {
+        task = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * #### PROTECTED ####
+ * Asks the task to stop; It runs onStop() and ends once its round of
+ * work, if it is in one, is done. Never waits on the task.
+ *
+ */
+void SocketWorker::stopTask() {
+    portENTER_CRITICAL(&taskMux);
+    TaskHandle_t alive = task;
+    if (alive != nullptr) {
+        isStopping = true;
+        isRestarting = false;
+    }
+    portEXIT_CRITICAL(&taskMux);
+
+    if (alive != nullptr) {
+        xTaskNotifyGive(alive);
+    }
+}
+
+/**
+ * #### PROTECTED ####
+ * Opens a socket to the given host, connected so that sends need no
+ * address. The connect is made non-blocking for the length of the
+ * timeout, which also bounds each send and receive; The host name
+ * lookup is bounded only by the resolver's own timeout.
+ *
+ * @param host - The host's name or address as const char*.
+ * @param port - The host's port as uint16_t.
+ * @param isUdp - Whether to use UDP rather than TCP as bool.
+ * @param timeoutMillis - How long to wait on the host as uint32_t.
+ *
+ * @return Returns the socket, or -1 if it couldn't be opened, as int.
+ */
+int SocketWorker::openSocket(const char *host, uint16_t port, bool isUdp, uint32_t timeoutMillis) {
+    struct addrinfo hints = {};
+    struct addrinfo *found = nullptr;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = isUdp ? SOCK_DGRAM : SOCK_STREAM;
+
+    char service[6];
+    snprintf(service, sizeof(service), "%u", port);
+
+    if (lwip_getaddrinfo(host, service, &hints, &found) != 0 || found == nullptr) {
+        return -1;
+    }
+
+    int socketFd = lwip_socket(AF_INET, isUdp ? SOCK_DGRAM : SOCK_STREAM, isUdp ? IPPROTO_UDP : IPPROTO_TCP);
+    if (socketFd >= 0) {
+        struct timeval timeout = { (time_t)(timeoutMillis / 1000UL), (suseconds_t)((timeoutMillis % 1000UL) * 1000UL) };
+        lwip_setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        lwip_setsockopt(socketFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if (!isUdp) {
+            int noDelay = 1;
+            lwip_setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        }
+
+        if (!connectSocket(socketFd, found->ai_addr, found->ai_addrlen, timeoutMillis)) {
+            lwip_close(socketFd);
+            socketFd = -1;
+        }
+    }
+    lwip_freeaddrinfo(found);
+
+    return socketFd;
+}
+
+/*
+=================================================================
+Private Functions BELOW
+=================================================================
+*/
+
+/**
+ * #### PRIVATE ####
+ * The task; Sleeps until notified or until the last round of work
+ * asked to be woken, then stops, restarts or works as it has been
+ * asked.
+ *
+ * @param parameter - The worker as void*.
+ */
+void SocketWorker::runTask(void *parameter) {
+    SocketWorker *worker = (SocketWorker *)parameter;
+    uint32_t sleepMillis = 0UL;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleepMillis));
+
+        portENTER_CRITICAL(&worker->taskMux);
+        bool stopping = worker->isStopping;
+        bool restarting = worker->isRestarting;
+        worker->isRestarting = false;
+        portEXIT_CRITICAL(&worker->taskMux);
+
+        if (stopping) {
+            worker->onStop();
+
+            // Only ends if it wasn't started again while stopping
+            portENTER_CRITICAL(&worker->taskMux);
+            bool isDone = worker->isStopping;
+            if (isDone) {
+                worker->task = nullptr;
+            }
+            portEXIT_CRITICAL(&worker->taskMux);
+
+            if (isDone) {
+                vTaskDelete(nullptr);
+            }
+            sleepMillis = 0UL;
+            continue;
+        }
+
+        if (restarting) {
+            worker->onStart();
+        }
+        sleepMillis = worker->onWork();
+    }
+}
+
+/**
+ * #### PRIVATE ####
+ * Connects the socket, waiting no longer than the timeout.
+ *
+ * @param socketFd - The socket as int.
+ * @param address - The address to connect to as const void*.
+ * @param addressLength - The length of the address as size_t.
+ * @param timeoutMillis - The longest to wait as uint32_t.
+ *
+ * @return Returns true if connected otherwise false as bool.
+ */
+bool SocketWorker::connectSocket(int socketFd, const void *address, size_t addressLength, uint32_t timeoutMillis) {
+    int flags = lwip_fcntl(socketFd, F_GETFL, 0);
+    lwip_fcntl(socketFd, F_SETFL, flags | O_NONBLOCK);
+
+    bool ok = lwip_connect(socketFd, (const struct sockaddr *)address, (socklen_t)addressLength) == 0;
+    if (!ok && errno == EINPROGRESS) {
+        fd_set writable;
+        FD_ZERO(&writable);
+        FD_SET(socketFd, &writable);
+        struct timeval timeout = { (time_t)(timeoutMillis / 1000UL), (suseconds_t)((timeoutMillis % 1000UL) * 1000UL) };
+
+        if (lwip_select(socketFd + 1, nullptr, &writable, nullptr, &timeout) == 1) {
+            int error = -1;
+            socklen_t length = sizeof(error);
+            ok = lwip_getsockopt(socketFd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0;
+        }
+    }
+
+    lwip_fcntl(socketFd, F_SETFL, flags);
+
+    return ok;
+}
@@ -0,0 +1,49 @@
+/*
+    SocketWorker.h
+    This is the header file for the SocketWorker Class.
+
+    The purpose of this class is to run a network client or server, such as the MQTT publisher,
+    the BLE proxy or the captive DNS, in a low priority task of its own so that the loop never
+    waits on a socket. The class using it supplies what is done when the task starts, on each
+    round of work and when it stops; Work is done in rounds, the task sleeping between them for as
+    long as the last round asked.
+
+    Starting and stopping never wait on the task. Each only asks it, by task notification, which
+    wakes it from its sleep; A round of work that is blocked on the network is left to finish
+    first. Starting while the task is still alive, stopping or not, restarts it in place, so that
+    new settings always take rather than a second task being started or the start being lost.
+    The stop, start and round callbacks are all run by the task, so its sockets and buffers are
+    only ever used by the task.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef SocketWorker_h
+    #define SocketWorker_h
+
+    #include <Arduino.h>
+
+    class SocketWorker {
+    public:
+        bool isRunning();
+
+    protected:
+        bool startTask(const char *name, uint32_t stackSize, UBaseType_t priority);
+        void stopTask();
+
+        virtual void onStart() = 0;
+        virtual uint32_t onWork() = 0; // <-- Returns how long to sleep before the next round
+        virtual void onStop() = 0;
+
+        static int openSocket(const char *host, uint16_t port, bool isUdp, uint32_t timeoutMillis);
+
+    private:
+        TaskHandle_t task = nullptr;
+        volatile bool isStopping = false;
+        volatile bool isRestarting = false;
+        portMUX_TYPE taskMux = portMUX_INITIALIZER_UNLOCKED;
+
+        static void runTask(void *parameter);
+        static bool connectSocket(int socketFd, const void *address, size_t addressLength, uint32_t timeoutMillis);
+    };
+#endif
@@ -0,0 +1,57 @@
+/*
+    Varint.cpp
+    This is the code file for the Varint Class.
+
+    The purpose of this class is to write and read unsigned numbers seven bits to a byte.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <Varint.h>
+
+/**
+ * Writes a value seven bits to a byte, low bits first.
+ *
+ * @param buffer - Where to write as uint8_t*.
+ * @param room - The room in the buffer as size_t.
+ * @param value - The value as uint32_t.
+ *
+ * @return Returns the number of bytes written, or zero if out of
+ * room, as size_t.
+ */
+size_t Varint::put(uint8_t *buffer, size_t room, uint32_t value) {
+    size_t offset = 0;
+    do {
+        if (offset >= room) {
+            return 0;
+        }
+        uint8_t digit = value & 0x7F;
+        value >>= 7;
+        buffer[offset++] = value > 0 ? (digit | 0x80) : digit;
+    } while (value > 0);
+
+    return offset;
+}
+
+/**
+ * Reads a value written by put().
+ *
+ * @param buffer - Where to read from as const uint8_t*.
+ * @param room - The bytes left in the buffer as size_t.
+ * @param value - Set to the value as uint32_t&.
+ *
+ * @return Returns the number of bytes read, or zero if malformed, as
+ * size_t.
+ */
+size_t Varint::get(const uint8_t *buffer, size_t room, uint32_t &value) {
+    value = 0UL;
+    for (size_t offset = 0; offset < room && offset < MAX_SIZE; offset++) {
+        value |= (uint32_t)(buffer[offset] & 0x7F) << (7 * offset);
+        if ((buffer[offset] & 0x80) == 0) {
+            return offset + 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,28 @@
+/*
+    Varint.h
+    This is the header file for the Varint Class.
+
+    The purpose of this class is to write and read unsigned numbers as varints; Seven bits to a
+    byte, low bits first, the top bit of each byte set while more follow. Small numbers, which
+    most counts, deltas and lengths are, take a single byte. It is the encoding the gossip, health
+    and proxy frames use for their numbers, and MQTT's remaining length is the same encoding.
+
+    Nothing here depends on the hardware so that the host tools in tools/ build it too.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef Varint_h
+    #define Varint_h
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    class Varint {
+    public:
+        static const size_t MAX_SIZE = 5; // <-- Of a uint32_t
+
+        static size_t put(uint8_t *buffer, size_t room, uint32_t value);
+        static size_t get(const uint8_t *buffer, size_t room, uint32_t &value);
+    };
+#endif
@@ -0,0 +1,67 @@
+/*
+    WarmRestart.cpp
+    This is the code file for the WarmRestart Class.
+
+    The purpose of this class is to carry the paired device's presence across a restart.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+
+#include <WarmRestart.h>
+#include <Crc32.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+
+struct Checkpoint {
+    uint32_t magic;
+    WarmRestart::Presence presence;
+    uint32_t crc; // <-- Of everything before it
+};
+
+RTC_NOINIT_ATTR static Checkpoint saved;
+
+/**
+ * Reads back the checkpoint made before restarting. There is none after
+ * a power on, or a deep sleep, or if it fails its check.
+ *
+ * @param presence - Set to the presence checkpointed as Presence&.
+ *
+ * @return Returns true if there was one otherwise false as bool.
+ */
+bool WarmRestart::restore(Presence &presence) {
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (reason == ESP_RST_POWERON || reason == ESP_RST_DEEPSLEEP || reason == ESP_RST_UNKNOWN) {
+        return false;
+    }
+
+    Checkpoint copy = saved;
+    if (copy.magic != MAGIC || copy.crc != Crc32::calculate(&copy, offsetof(Checkpoint, crc))) {
+        return false;
+    }
+    presence = copy.presence;
+
+    return true;
+}
+
+/**
+ * Checkpoints the presence, replacing the one before. It costs a few
+ * microseconds, so can be done whenever the presence changes.
+ *
+ * @param presence - The presence as const Presence&.
+ */
+void WarmRestart::checkpoint(const Presence &presence) {
+    Checkpoint copy = {};
+    copy.magic = MAGIC;
+    copy.presence = presence;
+    copy.crc = Crc32::calculate(&copy, offsetof(Checkpoint, crc));
+    saved = copy;
+}
+
+/**
+ * Forgets the checkpoint, as when the pairing is reset.
+ *
+ */
+void WarmRestart::clear() {
+    saved.magic = 0UL;
+}
@@ -0,0 +1,35 @@
+/*
+    WarmRestart.h
+    This is the header file for the WarmRestart Class.
+
+    The purpose of this class is to carry the paired device's presence across a restart which
+    doesn't lose power, such as ESP.restart(), a watchdog or a brownout, so that the controlled
+    device can be put back as it was within milliseconds of booting instead of once a scan has
+    found the paired device again. A checkpoint of the presence is kept in RTC memory left alone
+    by the startup code (RTC_NOINIT), checked by a CRC-32, and only trusted after a reset which
+    didn't cut the power; After a power on the memory holds whatever it came up with.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef WarmRestart_h
+    #define WarmRestart_h
+
+    #include <Arduino.h>
+
+    class WarmRestart {
+    public:
+        struct Presence {
+            uint8_t address[6];     // <-- The paired address, so a new pairing isn't given the old presence
+            uint32_t seenAgoMillis; // <-- How long before the checkpoint it was last seen
+            int16_t rssi;
+            bool isPresent;
+        };
+
+        static const uint32_t MAGIC = 0x57524D32UL; // <-- "WRM2"
+
+        static bool restore(Presence &presence);
+        static void checkpoint(const Presence &presence);
+        static void clear();
+    };
+#endif
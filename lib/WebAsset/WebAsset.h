@@ -0,0 +1,49 @@
+/*
+    WebAsset.h
+    This is the header file for the WebAsset structure.
+
+    A WebAsset is a static file of the web interface which was gzip compressed at build time
+    by scripts/build_web_assets.py and stored in flash. The generated WebAssets.h holds the
+    table of assets; this header only describes them so that code serving the assets does not
+    depend on the generated file's layout.
+
+    Written by: ... Scott Griffis
+    Date: ......... 10/16/2026
+*/
+#ifndef WebAsset_h
+    #define WebAsset_h
+
+    #include <stddef.h>
+    #include <stdint.h>
+    #include <string.h>
+
+    struct WebAsset {
+        const char *path;         // <-- Request path, without any query
+        const char *contentType;
+        const char *etag;         // <-- Quoted strong ETag of the uncompressed content
+        const char *cacheControl;
+        const uint8_t *data;      // <-- Gzip compressed content in flash
+        size_t length;            // <-- Compressed length
+        size_t rawLength;         // <-- Uncompressed length, for reporting
+    };
+
+    /**
+     * Finds the asset for the given request path.
+     * 
+     * @param assets - The table of assets to search as const WebAsset*.
+     * @param count - The number of assets in the table as size_t.
+     * @param path - The request path to find as const char*.
+     * 
+     * @return Returns the matching asset or nullptr as const WebAsset*.
+     */
+    inline const WebAsset* findWebAsset(const WebAsset *assets, size_t count, const char *path) {
+        for (size_t i = 0; i < count; i++) {
+            if (strcmp(assets[i].path, path) == 0) {
+                return &assets[i];
+            }
+        }
+
+        return nullptr;
+    }
+
+#endif
@@ -0,0 +1,116 @@
+"""
+build_web_assets.py
+Gzip compresses the static web interface files in web/ into flash arrays.
+
+Run by PlatformIO as a pre: extra script before every build, or by hand with
+`python3 scripts/build_web_assets.py`. The generated include/WebAssets.h is only
+rewritten when its content changes so that unchanged assets do not trigger a rebuild.
+
+Each asset gets a strong ETag from the hash of its uncompressed content. The
+page shell references the CSS and JS by a versioned URL, so those can be cached
+for a year while the shell itself is always revalidated (a cheap 304).
+
+Written by: ... Scott Griffis
+Date: ......... 10/16/2026
+"""
+import gzip
+import hashlib
+import os
+
+try:
+    Import("env")  # noqa: F821 - Provided by PlatformIO
+    PROJECT_DIR = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+WEB_DIR = os.path.join(PROJECT_DIR, "web")
+OUTPUT = os.path.join(PROJECT_DIR, "include", "WebAssets.h")
+
+CACHE_REVALIDATE = "no-cache"
+CACHE_IMMUTABLE = "public, max-age=31536000, immutable"
+
+# (file, request path, content type, cache control); The shell must be last so
+# that the versioned URLs of the other assets are known when it is built.
+ASSETS = [
+    ("app.css", "/app.css", "text/css", CACHE_IMMUTABLE),
+    ("app.js", "/app.js", "application/javascript", CACHE_IMMUTABLE),
+    ("index.html", "/", "text/html", CACHE_REVALIDATE),
+]
+
+
+def c_name(file_name):
+    return "WEB_" + file_name.upper().replace(".", "_")
+
+
+def c_array(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("        " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def build():
+    versioned = {}
+    sections = []
+    table = []
+    report = []
+
+    for file_name, path, content_type, cache_control in ASSETS:
+        with open(os.path.join(WEB_DIR, file_name), "rb") as file:
+            raw = file.read()
+
+        for name, url in versioned.items():
+            raw = raw.replace(("{{%s}}" % name).encode(), url.encode())
+
+        etag = hashlib.sha1(raw).hexdigest()[:16]
+        versioned[file_name] = "%s?v=%s" % (path, etag)
+        packed = gzip.compress(raw, compresslevel=9, mtime=0)
+        name = c_name(file_name)
+
+        sections.append(
+            "    const uint8_t %s[] PROGMEM = {\n%s\n    };\n" % (name, c_array(packed))
+        )
+        table.append(
+            '        { "%s", "%s", "\\"%s\\"", "%s", %s, sizeof(%s), %d },'
+            % (path, content_type, etag, cache_control, name, name, len(raw))
+        )
+        report.append((file_name, len(raw), len(packed)))
+
+    header = (
+        "/*\n"
+        "    WebAssets.h\n"
+        "    GENERATED by scripts/build_web_assets.py from the files in web/; DO NOT EDIT.\n"
+        "*/\n"
+        "#ifndef WebAssets_h\n"
+        "    #define WebAssets_h\n"
+        "\n"
+        "    #include <pgmspace.h>\n"
+        "    #include <WebAsset.h>\n"
+        "\n"
+        + "\n".join(sections)
+        + "\n"
+        "    const WebAsset WEB_ASSETS[] = {\n"
+        + "\n".join(table)
+        + "\n    };\n"
+        "    const size_t WEB_ASSET_COUNT = sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]);\n"
+        "\n"
+        "#endif\n"
+    )
+
+    current = None
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT, "r") as file:
+            current = file.read()
+
+    if header != current:
+        with open(OUTPUT, "w") as file:
+            file.write(header)
+
+        for file_name, raw_size, packed_size in report:
+            print("Web asset %-10s %6d -> %5d bytes" % (file_name, raw_size, packed_size))
+        raw_total = sum(raw_size for _, raw_size, _ in report)
+        packed_total = sum(packed_size for _, _, packed_size in report)
+        print("Web assets total    %6d -> %5d bytes (%.0f%%)" % (raw_total, packed_total, packed_total * 100.0 / raw_total))
+
+
+build()
@@ -0,0 +1,66 @@
+"""
+check_firmware_size.py
+Checks that the built firmware image fits the OTA app slots of partitions.csv.
+
+Run by PlatformIO as a post: extra script, once firmware.bin has been built, or
+by hand with `python3 scripts/check_firmware_size.py .pio/build/esp32dev/firmware.bin`.
+Reports the image's size and the headroom left in the smallest app slot, and
+fails the build if the image doesn't fit; An image too big for its slot would
+otherwise only be found when an OTA update of it fails on the switch. A warning
+is printed once the headroom falls below WARN_HEADROOM.
+
+Written by: ... Scott Griffis
+Date: ......... 10/16/2026
+"""
+import os
+import sys
+
+WARN_HEADROOM = 64 * 1024
+
+
+def app_slot_size(partitions_path):
+    sizes = []
+    with open(partitions_path, "r") as file:
+        for line in file:
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            fields = [field.strip() for field in line.split(",")]
+            if len(fields) >= 5 and fields[1] == "app":
+                sizes.append(int(fields[4], 0))
+
+    return min(sizes)
+
+
+def check(image_path, partitions_path):
+    image_size = os.path.getsize(image_path)
+    slot_size = app_slot_size(partitions_path)
+    headroom = slot_size - image_size
+
+    print("Firmware image %d bytes of a %d byte app slot; %d bytes (%.1f%%) free"
+          % (image_size, slot_size, headroom, headroom * 100.0 / slot_size))
+    if headroom < 0:
+        print("Firmware image is %d bytes too big for its app slot!" % -headroom)
+        return False
+    if headroom < WARN_HEADROOM:
+        print("Warning: Less than %dK left in the app slot" % (WARN_HEADROOM // 1024))
+
+    return True
+
+
+try:
+    Import("env")  # noqa: F821 - Provided by PlatformIO
+
+    def after_build(source, target, env):
+        if not check(str(target[0]), os.path.join(env.subst("$PROJECT_DIR"), env.GetProjectOption("board_build.partitions"))):
+            env.Exit(1)
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.bin", after_build)  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        if len(sys.argv) < 2:
+            print("Usage: python3 scripts/check_firmware_size.py firmware.bin [partitions.csv]")
+            sys.exit(2)
+        project_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        partitions = sys.argv[2] if len(sys.argv) > 2 else os.path.join(project_dir, "partitions.csv")
+        sys.exit(0 if check(sys.argv[1], partitions) else 1)
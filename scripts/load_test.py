@@ -0,0 +1,158 @@
+"""
+load_test.py
+Measures how the config portal holds up under concurrent clients.
+
+For each concurrency level the given paths are requested round robin by that
+many concurrent clients for a fixed duration. Requests/s, p50/p99 latency and
+errors (including 503s from the per-connection cap) are reported for each level.
+Only the standard library is used.
+
+With --keep-alive each client asks to keep its connection open and reuses it
+for as long as the server allows, so the connections column shows whether the
+server keeps connections alive: one per client if it does, one per request if
+it closes each after its response, as the async server on the device does.
+
+Usage: python3 scripts/load_test.py [--host 192.168.4.1] [--levels 1,4,16]
+           [--seconds 10] [--keep-alive] [--path /] [--path /api/status]
+
+Written by: ... Scott Griffis
+Date: ......... 10/16/2026
+"""
+import argparse
+import asyncio
+import time
+
+
+class Connection:
+    """One client's connection, opened when needed and kept while the server allows."""
+
+    def __init__(self, host, port, timeout, keep_alive):
+        self.host = host
+        self.port = port
+        self.timeout = timeout
+        self.keep_alive = keep_alive
+        self.reader = None
+        self.writer = None
+        self.opened = 0
+
+    async def fetch(self, path):
+        if self.writer is None:
+            self.reader, self.writer = await asyncio.wait_for(
+                asyncio.open_connection(self.host, self.port), self.timeout
+            )
+            self.opened += 1
+        try:
+            self.writer.write(
+                (
+                    "GET %s HTTP/1.1\r\nHost: %s\r\nAccept-Encoding: gzip\r\nConnection: %s\r\n\r\n"
+                    % (path, self.host, "keep-alive" if self.keep_alive else "close")
+                ).encode()
+            )
+            await self.writer.drain()
+            status, size, is_open = await asyncio.wait_for(self.read_response(), self.timeout)
+        except BaseException:
+            self.close()
+            raise
+        if not is_open:
+            self.close()
+
+        return status, size
+
+    async def read_response(self):
+        head = await self.reader.readuntil(b"\r\n\r\n")
+        lines = head.decode("latin-1").split("\r\n")
+        status = int(lines[0].split(" ", 2)[1])
+        headers = {}
+        for line in lines[1:]:
+            name, _, value = line.partition(":")
+            headers[name.strip().lower()] = value.strip().lower()
+
+        size = len(head)
+        if "chunked" in headers.get("transfer-encoding", ""):
+            while True:
+                line = await self.reader.readuntil(b"\r\n")
+                length = int(line.split(b";")[0], 16)
+                size += len(line) + len((await self.reader.readexactly(length + 2)))
+                if length == 0:
+                    break
+        elif "content-length" in headers:
+            size += len(await self.reader.readexactly(int(headers["content-length"])))
+        else:
+            size += len(await self.reader.read())  # <-- Ends when the server closes
+            return status, size, False
+
+        is_open = self.keep_alive and headers.get("connection") != "close" and lines[0].startswith("HTTP/1.1")
+        return status, size, is_open
+
+    def close(self):
+        if self.writer is not None:
+            self.writer.close()
+            self.reader = self.writer = None
+
+
+async def client(host, port, paths, deadline, timeout, keep_alive, results, connections, offset):
+    connection = Connection(host, port, timeout, keep_alive)
+    count = offset
+    while time.monotonic() < deadline:
+        path = paths[count % len(paths)]
+        count += 1
+        start = time.monotonic()
+        try:
+            status, size = await connection.fetch(path)
+        except (OSError, asyncio.TimeoutError, asyncio.IncompleteReadError, asyncio.LimitOverrunError, ValueError, IndexError):
+            status, size = 0, 0
+        results.append((time.monotonic() - start, status, size))
+    connection.close()
+    connections.append(connection.opened)
+
+
+async def run_level(host, port, paths, concurrency, seconds, timeout, keep_alive):
+    results = []
+    connections = []
+    start = time.monotonic()
+    deadline = start + seconds
+    await asyncio.gather(
+        *(client(host, port, paths, deadline, timeout, keep_alive, results, connections, i) for i in range(concurrency))
+    )
+    elapsed = time.monotonic() - start
+
+    ok = sorted(latency for latency, status, _ in results if 200 <= status < 400)
+    errors = len(results) - len(ok)
+    received = sum(size for _, _, size in results)
+
+    def percentile(fraction):
+        return ok[min(len(ok) - 1, int(len(ok) * fraction))] * 1000.0 if ok else float("nan")
+
+    print(
+        "clients=%-3d requests=%-6d req/s=%-8.1f p50=%-8.1fms p99=%-8.1fms errors=%-5d connections=%-6d KB/s=%.1f"
+        % (
+            concurrency,
+            len(results),
+            len(ok) / elapsed,
+            percentile(0.50),
+            percentile(0.99),
+            errors,
+            sum(connections),
+            received / elapsed / 1024.0,
+        )
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="192.168.4.1")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--levels", default="1,4,16")
+    parser.add_argument("--seconds", type=float, default=10.0)
+    parser.add_argument("--timeout", type=float, default=5.0)
+    parser.add_argument("--keep-alive", action="store_true", help="reuse each client's connection where allowed")
+    parser.add_argument("--path", action="append", dest="paths")
+    args = parser.parse_args()
+
+    paths = args.paths or ["/", "/api/status", "/api/settings"]
+    for level in (int(level) for level in args.levels.split(",")):
+        asyncio.run(run_level(args.host, args.port, paths, level, args.seconds, args.timeout, args.keep_alive))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,140 @@
+"""
+pack_firmware.py
+Packs a built firmware image for upload to the config portal's OTA update.
+
+The image is heatshrink compressed, as the heatshrink library's encoder would
+with the same window and lookahead, and put behind a header carrying its size
+and SHA-256 so the switch can decompress it as it streams in and check it before
+booting it (see lib/OtaStream). The window must not exceed the switch's own,
+2^12 bytes. The plain .bin may still be uploaded as is; Packing only makes the
+upload smaller.
+
+Usage: python3 scripts/pack_firmware.py .pio/build/esp32dev/firmware.bin firmware.ota
+           [--window 12] [--lookahead 4] [--store]
+
+Written by: ... Scott Griffis
+Date: ......... 10/16/2026
+"""
+import argparse
+import hashlib
+import struct
+import time
+
+VERSION = 1
+COMPRESSION_NONE = 0
+COMPRESSION_HEATSHRINK = 1
+MAX_WINDOW_BITS = 12
+MIN_MATCH = 3
+MAX_CANDIDATES = 16
+
+
+class BitWriter:
+    def __init__(self):
+        self.output = bytearray()
+        self.bits = 0
+        self.count = 0
+
+    def write(self, value, width):
+        self.bits = (self.bits << width) | value
+        self.count += width
+        while self.count >= 8:
+            self.count -= 8
+            self.output.append((self.bits >> self.count) & 0xFF)
+        self.bits &= (1 << self.count) - 1
+
+    def finish(self):
+        if self.count > 0:
+            self.output.append((self.bits << (8 - self.count)) & 0xFF)
+            self.count = 0
+        return bytes(self.output)
+
+
+def heatshrink(data, window_bits, lookahead_bits):
+    """Greedy LZSS in heatshrink's bit format, hashing three byte prefixes to find matches."""
+    window = 1 << window_bits
+    max_match = 1 << lookahead_bits
+    writer = BitWriter()
+    chains = {}
+    position = 0
+    length = len(data)
+
+    def remember(at):
+        if at + MIN_MATCH <= length:
+            chain = chains.setdefault(data[at:at + MIN_MATCH], [])
+            chain.append(at)
+            if len(chain) > MAX_CANDIDATES:
+                del chain[0]
+
+    while position < length:
+        best_length = 0
+        best_distance = 0
+        limit = min(max_match, length - position)
+        if limit >= MIN_MATCH:
+            for candidate in reversed(chains.get(data[position:position + MIN_MATCH], ())):
+                distance = position - candidate
+                if distance > window:
+                    break
+                match = MIN_MATCH
+                while match < limit and data[candidate + match] == data[position + match]:
+                    match += 1
+                if match > best_length:
+                    best_length = match
+                    best_distance = distance
+                    if match == limit:
+                        break
+
+        if best_length >= MIN_MATCH:
+            writer.write(0, 1)
+            writer.write(best_distance - 1, window_bits)
+            writer.write(best_length - 1, lookahead_bits)
+            for at in range(position, position + best_length):
+                remember(at)
+            position += best_length
+        else:
+            writer.write(1, 1)
+            writer.write(data[position], 8)
+            remember(position)
+            position += 1
+
+    return writer.finish()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack a firmware image for OTA upload.")
+    parser.add_argument("image")
+    parser.add_argument("output")
+    parser.add_argument("--window", type=int, default=MAX_WINDOW_BITS)
+    parser.add_argument("--lookahead", type=int, default=4)
+    parser.add_argument("--store", action="store_true", help="pack without compressing")
+    args = parser.parse_args()
+
+    if not 4 <= args.window <= MAX_WINDOW_BITS or not 3 <= args.lookahead < args.window:
+        parser.error("window must be 4-%d and lookahead 3 to window - 1" % MAX_WINDOW_BITS)
+
+    with open(args.image, "rb") as source:
+        image = source.read()
+
+    started = time.time()
+    if args.store:
+        body = image
+        compression = COMPRESSION_NONE
+    else:
+        body = heatshrink(image, args.window, args.lookahead)
+        compression = COMPRESSION_HEATSHRINK
+
+    header = b"PXOT" + struct.pack(
+        "<BBBBI", VERSION, compression, args.window, args.lookahead, len(image)
+    ) + hashlib.sha256(image).digest()
+
+    with open(args.output, "wb") as target:
+        target.write(header + body)
+
+    print(
+        "%s: %d -> %d bytes (%.1f%%) in %.1fs"
+        % (args.output, len(image), len(header) + len(body),
+           100.0 * (len(header) + len(body)) / max(len(image), 1), time.time() - started)
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -18,14 +18,31 @@
 #include <map>
 #include <vector>
 #include <WiFi.h>
-#include <DNSServer.h>
-#include <WebServer.h>
+#include <WiFiUdp.h>
+#include <ESPAsyncWebServer.h>
 #include <BLEDevice.h>
 
 #include "HtmlContent.h"
+#include "WebAssets.h"
 #include <Utils.h>
-#include <IpUtils.h>
 #include <LedMan.h>
+#include <Clock.h>
+#include <Scheduler.h>
+#include <Button.h>
+#include <JsonResponse.h>
+#include <EventStream.h>
+#include <CaptiveDns.h>
+#include <MqttPublisher.h>
+#include <Gossip.h>
+#include <EspNowTransport.h>
+#include <HealthFrame.h>
+#include <AdvertProxy.h>
+#include <OtaUpdater.h>
+#include <CounterLog.h>
+#include <PartitionFlash.h>
+#include <WarmRestart.h>
+#include <BootProfiler.h>
+#include <LogHistogram.h>
 
 #define PAIR_BTN_PIN 32
 #define LEARN_LED_PIN 13
@@ -34,35 +51,216 @@
 
 #define INIT_ON_STATE false
 
+#define SCAN_RESET_WAIT_MILLIS 500ULL
+#define SCAN_WATCHDOG_MILLIS 15000ULL
+#define PURGE_INTERVAL_MILLIS 1000ULL
+#define BUTTON_DEBOUNCE_MILLIS 30UL
+#define BUTTON_DOUBLE_GAP_MILLIS 0UL // <-- No double press function, so releases aren't held back for one
+#define FACTORY_FLASH_DURATION_MILLIS 3500ULL
+#define WIFI_START_TIMEOUT_MILLIS 3000ULL
+#define WIFI_DRAIN_MILLIS 250ULL
+#define MAX_HTTP_REQUESTS 8
+#define API_DEVICES_DEFAULT_LIMIT 50
+#define API_DEVICES_MAX_LIMIT 500
+#define STREAM_MIN_INTERVAL_MILLIS 250UL
+#define STREAM_SERVICE_MILLIS 50ULL
+#define MQTT_FLUSH_MILLIS 1000UL
+#define MQTT_SUMMARY_MILLIS 30000ULL
+#define GOSSIP_INTERVAL_MILLIS 2000ULL
+#define GOSSIP_MAX_AGE_MILLIS 15000UL
+#define HEALTH_INTERVAL_MILLIS 10000ULL
+#define HEALTH_PORT 47777
+#define PROXY_WINDOW_MILLIS 1000UL
+#define OTA_CONFIRM_MILLIS 60000ULL
+#define OTA_RESTART_WAIT_MILLIS 1000ULL
+#define SETTINGS_SAVE_DELAY_MILLIS 3000ULL
+#define ON_TIME_LOG_MILLIS 900000ULL
+#define COUNTERS_PARTITION "counters"
+#define WARM_GRACE_MILLIS 15000ULL
+#define PROFILE_DUMP_MILLIS 60000ULL
+
 #define FIRMWARE_VERSION "2.3.4"
 //#define DEBUG // <---- un-comment for debug
 
 Settings settings;
-DNSServer dnsServer;
-WebServer web(80);
+CaptiveDns captiveDns;
+MqttPublisher mqtt;
+EspNowTransport espNow;
+Gossip gossip(espNow);
+WiFiUDP healthUdp;
+AdvertProxy advertProxy;
+OtaUpdater ota;
+PartitionFlash counterFlash;
+CounterLog counterLog;
+AsyncWebServer web(80);
+BootProfiler bootProfiler;
+
+// Stamps paired device sightings and hands what the scan hears to handleProxyAdvert() from the BLE task
+class ProxyScanCallbacks : public BLEAdvertisedDeviceCallbacks {
+  void onResult(BLEAdvertisedDevice device) override;
+} proxyScanCallbacks;
 
 // Function Prototypes
 // --------------------------------------
 void doCheckLearnTask();
-void doBTScan();
-void doPurgeOldSeenDevices(unsigned long wifiOnMillis);
+void doCompleteLearnTask();
+void doResetBTScan();
+void doConfigureBTScan();
+void doStartBTScan();
+void doPurgeOldSeenDevices();
+void doHandlePresenceChange();
 void doHandleOnOffSwitching();
+void doCountPresenceChange();
 void doDeterminePairedDeviceProximity();
 void doCheckForCloseDevice();
+void doConfigureButton();
 void doHandleButtonPresses();
 void doCheckFactoryReset();
-void doHandleNetworkTasks();
+void doCompleteFactoryReset();
 void doActivateDeactivateWiFi();
-
+void doStartWiFi();
+void doStopWiFi();
+void doCompleteWiFiShutdown();
+void doStartStation();
+void doPublishMqtt(const char *topic, const char *format, ...);
+void doPublishTelemetry();
+void doStartGossip();
+void doBroadcastGossip();
+void doSendHealthFrame();
+void doStartProxy();
+void doConfirmFirmware();
+void doRestartForUpdate();
+void doScheduleSettingsSave();
+void doSaveSettings();
+void doStartCounters();
+void doLogOnTime();
+void doRestorePresence();
+void doCheckpointPresence();
+void doIdentifyDevice();
+void doWatchPairedDevice();
+void doRecordLatency(bool isOn);
+#ifdef LOOP_PROFILE
+  void doDumpLoopProfile();
+#endif
+
+void handleBTScanComplete(BLEScanResults);
 void handleBTScanResults(BLEScanResults);
-void handleSettingsPage();
-void handleSettingsPost();
-
-std::map<std::string, ulong> seenDevices;
+void handleProxyAdvert(BLEAdvertisedDevice &device);
+void handleScanCompleteEvent();
+void handleScanWatchdog();
+void handleButtonISR();
+void handleWiFiEvent(arduino_event_id_t event);
+void handleWiFiStarted();
+void handleWiFiTransitionTimer();
+void handleGossipFrame();
+void handleGossipFrameEvent();
+void handleWebAsset(AsyncWebServerRequest *request);
+void handleStatusApi(AsyncWebServerRequest *request);
+void handleDevicesApi(AsyncWebServerRequest *request);
+void handleSettingsApi(AsyncWebServerRequest *request);
+void handleSettingsPost(AsyncWebServerRequest *request);
+void handleSchemaApi(AsyncWebServerRequest *request);
+void handleProfileApi(AsyncWebServerRequest *request);
+void handleUpdateRequest(AsyncWebServerRequest *request);
+void handleUpdateUpload(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data, size_t length, bool isFinal);
+void handleStreamConnect();
+void handleStreamConnectEvent();
+void handleStreamService();
+bool doAdmitRequest(AsyncWebServerRequest *request, ArDisconnectHandler onDone = nullptr, bool isRefusalSent = true);
+bool doGetFormArg(AsyncWebServerRequest *request, const char *name, String &value);
+void doRegisterWebRoutes();
+bool writeStatusJson(JsonWriter &json, JsonResponse::Cursor &cursor);
+bool writeDevicesJson(JsonWriter &json, JsonResponse::Cursor &cursor);
+bool writeSettingsJson(JsonWriter &json, JsonResponse::Cursor &cursor);
+bool writeSchemaJson(JsonWriter &json, JsonResponse::Cursor &cursor);
+bool writeUpdateJson(JsonWriter &json, JsonResponse::Cursor &cursor);
+void writeHistogramJson(JsonWriter &json, const char *name, LogHistogram &histogram);
+#ifdef LOOP_PROFILE
+  bool writeProfileJson(JsonWriter &json, JsonResponse::Cursor &cursor);
+#endif
+
+std::map<std::string, uint64_t> seenDevices; // <-- Last seen in presenceClock millis
 std::map<std::string, int> seenRssis;
 
+// LEDs
+enum Led : uint8_t {
+  LEARN_LED,
+  CLOSE_LED,
+  LED_COUNT
+};
+
+// LED callers; Ordered by priority, highest first
+enum LedCaller : uint8_t {
+  FACTORY_RESET_CALLER, // <-- Learn LED
+  WIFI_DISABLE_CALLER,  // <-- Close LED
+  LEARN_CALLER,         // <-- Learn LED
+  WIFI_ENABLE_CALLER,   // <-- Close LED
+  CLOSE_CALLER,         // <-- Close LED
+  LED_CALLER_COUNT
+};
+
+// LED Patterns
+const LedPattern WIFI_BLINK_PATTERN = { 100UL, 50, 0, 0 };
+const LedPattern BUTTON_FACTORY_PATTERN = { 100UL, 50, 0, 0 };
+const LedPattern FACTORY_RESET_PATTERN = { 200UL, 50, 0, 0 };
+
 BLEScan *scan;
-LedMan ledMan;
+LedMan<Led, LED_COUNT, LedCaller, LED_CALLER_COUNT> ledMan({ LEARN_LED_PIN, CLOSE_LED_PIN });
+Scheduler scheduler;
+Button pairButton;
+
+// Button functions; Indexed by the button hold level which triggers them
+enum ButtonFunction : uint8_t {
+  BTN_FUNC_NONE,
+  BTN_FUNC_LEARN,
+  BTN_FUNC_WIFI,
+  BTN_FUNC_FACTORY
+};
+ButtonFunction buttonFunctions[Button::MAX_LEVELS + 1] = { BTN_FUNC_NONE };
+
+void doShowButtonFunction(ButtonFunction function);
+void doTriggerButtonFunction(ButtonFunction function);
+
+// Loop Events
+enum LoopEvent : uint8_t {
+  EVT_SCAN_COMPLETE,
+  EVT_BUTTON_EDGE,
+  EVT_STREAM_CONNECT,
+  EVT_WIFI_CHANGE,
+  EVT_WIFI_AP_START,
+  EVT_STATION_CHANGE,
+  EVT_GOSSIP_FRAME
+};
+
+// Live events sent to the settings page; Names are indexed by event
+enum StreamEvent : uint8_t {
+  STREAM_PRESENCE,
+  STREAM_RSSI,
+  STREAM_CLOSE,
+  STREAM_EVENT_COUNT
+};
+const char *STREAM_EVENT_NAMES[STREAM_EVENT_COUNT] = { "presence", "rssi", "close" };
+EventStream eventStream("/events");
+
+// Loop Timers
+uint8_t scanRestartTimer;
+uint8_t scanWatchdogTimer;
+uint8_t purgeTimer;
+uint8_t buttonTimer;
+uint8_t learnTimer;
+uint8_t factoryResetTimer;
+uint8_t wifiTransitionTimer;
+uint8_t streamTimer;
+uint8_t telemetryTimer;
+uint8_t gossipTimer;
+uint8_t healthTimer;
+uint8_t otaConfirmTimer;
+uint8_t otaRestartTimer;
+uint8_t settingsSaveTimer;
+uint8_t onTimeTimer;
+#ifdef LOOP_PROFILE
+  uint8_t profileDumpTimer;
+#endif
 
 // Action Trigger Flags
 bool triggerFactoryReset = false;
@@ -73,22 +271,78 @@ bool triggerWifiIsOn = false;
 bool isLearning = false;
 bool isScanning = false;
 bool isWifiIsOn = false;
-
-unsigned long scanningWatchdogMillis = 0UL;
+bool isCloseDevice = false;
+bool isWarmRestart = false;
+
+// WiFi AP; Services are set up once and only started/stopped on toggle
+enum WifiState : uint8_t {
+  WIFI_STATE_OFF,
+  WIFI_STATE_STARTING,
+  WIFI_STATE_ON,
+  WIFI_STATE_STOPPING
+};
+WifiState wifiState = WIFI_STATE_OFF;
+const IPAddress AP_ADDRESS(192, 168, 4, 1);
+const IPAddress AP_SUBNET(255, 255, 255, 0);
+const IPAddress HEALTH_GROUP(239, 255, 77, 77);
+
+// Toggle timings; Toggle to portal ready and toggle to scanning resumed
+int64_t wifiTransitionMicros = 0LL;
+int64_t wifiOnMicros = 0LL;
+int64_t wifiOffMicros = 0LL;
+bool isWifiOffTiming = false;
+
+// Paired device RSSI since the last MQTT summary
+struct RssiSummary {
+  int last;
+  int min;
+  int max;
+  unsigned long samples;
+} rssiSummary = { 0, 0, 0, 0UL };
+
+// Fleet health; Sent to the collector in station mode
+uint32_t healthSequence = 0UL;
+unsigned long scansCompleted = 0UL;
+unsigned long presenceChanges = 0UL;
+uint64_t presenceChangedMillis = 0ULL;
+uint32_t rssiHistogram[HealthFrame::RSSI_BUCKETS] = { 0UL }; // <-- Since the last frame
+uint32_t dwellHistogram[HealthFrame::DWELL_BUCKETS] = { 0UL };
+
+// Presence latency; The paired device's sightings are stamped in the BLE task as the radio reports them
+portMUX_TYPE sightingMux = portMUX_INITIALIZER_UNLOCKED;
+uint8_t pairedNative[6] = { 0 };    // <-- The paired address as the radio gives it
+bool isPairedNative = false;
+int pairedNearRssi = 0;             // <-- The max near RSSI, for the BLE task
+int64_t firstSightingMicros = 0LL;  // <-- First near sighting while off; Stamped by the BLE task
+int64_t lastSightingMicros = 0LL;   // <-- Latest near sighting; Stamped by the BLE task
+int64_t decisionMicros = 0LL;       // <-- When the on state last changed
+LogHistogram sightingDecisionMillis;
+LogHistogram decisionGpioMicros;
+LogHistogram firstSightingOnMillis;
+LogHistogram lastSightingOffMillis;
+
+// Counters kept across restarts in the counter log
+enum Counter : uint8_t {
+  COUNTER_STARTUPS,
+  COUNTER_SCAN_WATCHDOGS,
+  COUNTER_RELAY_CYCLES,
+  COUNTER_ON_SECONDS,
+  COUNTER_COUNT
+};
+uint64_t startedMillis = 0ULL;
+unsigned long startups = 0UL;
+uint64_t onTimeLoggedMillis = 0ULL; // <-- Time on is logged up to here
+
+// Presence time is paused while scanning is suspended so devices don't expire
+ClockDomain presenceClock;
 unsigned long btScanWDExpos = 0UL;
 
-String deviceId = Utils::genDeviceIdFromMacAddr(WiFi.macAddress());
-String deviceSsid = "ProxiSwitch_" + deviceId;
+String deviceId = ""; // <-- Set by doIdentifyDevice() once scanning has started
+String deviceSsid = "";
+uint32_t nodeId = (uint32_t)(ESP.getEfuseMac() >> 16); // <-- The MAC's last four bytes tell switches apart
+String mqttTopicPrefix = "";
 String settingsUpdateResult = "";
-
-const String LEARN_LED_ID = "learn_led";
-const String CLOSE_LED_ID = "close_led";
-
-const String LEARN_FUNCTION_ID = "learn";
-const String FACTORY_RESET_FUNCTION_ID = "factory";
-const String WIFI_ENABLE_FUNCTION_ID = "wifi";
-const String WIFI_DISABLE_FUNCTION_ID = "wifi_off";
-const String CLOSE_FUNCTION_ID = "close";
+uint8_t openRequests = 0; // <-- Only touched from the async web server's task
 
 /**
  * SETUP
@@ -97,53 +351,96 @@ const String CLOSE_FUNCTION_ID = "close";
  * 
  */
 void setup() {
-  WiFi.mode(WIFI_OFF);
+  // Firmware on trial which keeps failing to start goes back to the previous
+  OtaUpdater::checkBoot();
+  bootProfiler.mark("ota_check");
 
-  // Initialize inputs/outputs
+  // Load settings, putting the controlled device back as it was before a warm restart
   pinMode(PAIR_BTN_PIN, INPUT);
   pinMode(CONTROLLED_DEVICE_PIN, OUTPUT);
-  pinMode(LEARN_LED_PIN, OUTPUT);
-  pinMode(CLOSE_LED_PIN, OUTPUT);
-
-  // Load settings
   settings.loadSettings();
-  settings.logStartup();
-
-  // Initialize LED States
+  doWatchPairedDevice();
+  doRestorePresence();
   digitalWrite(CONTROLLED_DEVICE_PIN, settings.isOnState() ? HIGH : LOW);
-  digitalWrite(LEARN_LED_PIN, LOW);
-  digitalWrite(CLOSE_LED_PIN, LOW);
+  bootProfiler.mark("relay");
+
+  // Register loop events and timers
+  scheduler.begin();
+  scheduler.on(EVT_SCAN_COMPLETE, handleScanCompleteEvent, "scan_complete");
+  scheduler.on(EVT_BUTTON_EDGE, doHandleButtonPresses, "button_edge");
+  scheduler.on(EVT_STREAM_CONNECT, handleStreamConnectEvent, "stream_connect");
+  scheduler.on(EVT_WIFI_CHANGE, doActivateDeactivateWiFi, "wifi_change");
+  scheduler.on(EVT_WIFI_AP_START, handleWiFiStarted, "wifi_ap_start");
+  scheduler.on(EVT_STATION_CHANGE, doStartStation, "station_change");
+  scheduler.on(EVT_GOSSIP_FRAME, handleGossipFrameEvent, "gossip_frame");
+
+  scanRestartTimer = scheduler.addTimer(doStartBTScan, "scan_start");
+  scanWatchdogTimer = scheduler.addTimer(handleScanWatchdog, "scan_watchdog");
+  purgeTimer = scheduler.addTimer(doPurgeOldSeenDevices, "purge");
+  buttonTimer = scheduler.addTimer(doHandleButtonPresses, "button");
+  learnTimer = scheduler.addTimer(doCompleteLearnTask, "learn");
+  factoryResetTimer = scheduler.addTimer(doCompleteFactoryReset, "factory_reset");
+  wifiTransitionTimer = scheduler.addTimer(handleWiFiTransitionTimer, "wifi_transition");
+  streamTimer = scheduler.addTimer(handleStreamService, "stream");
+  telemetryTimer = scheduler.addTimer(doPublishTelemetry, "telemetry");
+  gossipTimer = scheduler.addTimer(doBroadcastGossip, "gossip");
+  healthTimer = scheduler.addTimer(doSendHealthFrame, "health");
+  otaConfirmTimer = scheduler.addTimer(doConfirmFirmware, "ota_confirm");
+  otaRestartTimer = scheduler.addTimer(doRestartForUpdate, "ota_restart");
+  settingsSaveTimer = scheduler.addTimer(doSaveSettings, "settings_save");
+  onTimeTimer = scheduler.addTimer(doLogOnTime, "on_time");
+  #ifdef LOOP_PROFILE
+    profileDumpTimer = scheduler.addTimer(doDumpLoopProfile, "profile_dump");
+  #endif
+  bootProfiler.mark("scheduler");
 
-  // Register LEDs
-  ledMan.addLed(LEARN_LED_PIN, LEARN_LED_ID);
-  ledMan.addLed(CLOSE_LED_PIN, CLOSE_LED_ID);
+  // Scan as soon as BlueTooth is up; Everything else can wait for it
+  BLEDevice::init("");
+  bootProfiler.mark("ble");
+  doConfigureBTScan();
+  doStartBTScan();
+  bootProfiler.mark("first_scan");
 
-  // Priorities for LEARN LED
-  ledMan.setCallerPriority(FACTORY_RESET_FUNCTION_ID, 1);
-  ledMan.setCallerPriority(LEARN_FUNCTION_ID, 2);
-  
-  // Priorities for CLOSE LED
-  ledMan.setCallerPriority(WIFI_DISABLE_FUNCTION_ID, 1);
-  ledMan.setCallerPriority(WIFI_ENABLE_FUNCTION_ID, 2);
-  ledMan.setCallerPriority(CLOSE_FUNCTION_ID, 3);
+  // Counting this startup is the first flash write
+  doStartCounters();
+  bootProfiler.mark("counters");
 
-  // Initialize Serial for Output
-  Serial.begin(115200);;
-  delay(1000UL);
-  if (!Serial) ESP.restart();
-  delay(1000UL);
+  ledMan.begin();
+  Serial.begin(115200);
+  doIdentifyDevice();
 
-  #ifdef DEBUG
-    Serial.print("Initializing bluetooth... ");
-  #endif
-  
-  BLEDevice::init("");
-  
-  #ifdef DEBUG
-    Serial.println("Complete.");
+  // WiFi settings which don't change between toggles
+  WiFi.mode(WIFI_OFF);
+  WiFi.setHostname((String(F("PxiSw_")) + deviceId).c_str());
+  WiFi.setMinSecurity(WIFI_AUTH_WPA2_PSK);
+  WiFi.onEvent(handleWiFiEvent, ARDUINO_EVENT_WIFI_AP_START);
+
+  eventStream.begin(STREAM_EVENT_NAMES, STREAM_EVENT_COUNT, STREAM_MIN_INTERVAL_MILLIS);
+  doRegisterWebRoutes();
+
+  pairButton.setTimings(BUTTON_DEBOUNCE_MILLIS, BUTTON_DOUBLE_GAP_MILLIS);
+  doConfigureButton();
+  pairButton.begin(PAIR_BTN_PIN, HIGH, handleButtonISR);
+
+  scheduler.startTimer(purgeTimer, PURGE_INTERVAL_MILLIS, PURGE_INTERVAL_MILLIS);
+  if (settings.isOnState()) {
+    scheduler.startTimer(onTimeTimer, ON_TIME_LOG_MILLIS, ON_TIME_LOG_MILLIS); // <-- Still on from before restarting
+  }
+  if (OtaUpdater::isTrialBoot()) {
+    scheduler.startTimer(otaConfirmTimer, OTA_CONFIRM_MILLIS);
+  }
+  doScheduleSettingsSave(); // <-- The startup count if kept in settings, once booted
+  doStartStation();
+  #ifdef LOOP_PROFILE
+    scheduler.startTimer(profileDumpTimer, PROFILE_DUMP_MILLIS, PROFILE_DUMP_MILLIS);
   #endif
+  bootProfiler.mark("services");
 
   #ifdef DEBUG
+    for (uint8_t i = 0; i < bootProfiler.getCount(); i++) {
+      BootProfiler::Phase phase = bootProfiler.getPhase(i);
+      Serial.printf("Boot %s: %lu us; At %lu us\n", phase.name, (unsigned long)bootProfiler.getPhaseMicros(i), (unsigned long)phase.endMicros);
+    }
     Serial.printf("Learn Hold: %d millis\n", settings.getTriggerLearnMillis());
     Serial.printf("Learn Wait: %d millis\n", settings.getLearnDurationMillis());
     Serial.printf("Max Not Seen: %d millis\n", settings.getMaxNotSeenMillis());
@@ -156,589 +453,1903 @@ void setup() {
  * MAIN LOOP
  * ======================================
  * The main looping part of the firmware.
+ * All work is driven by the scheduler's events and timers; when
+ * there is nothing to do the loop sleeps inside runOnce().
  * 
  */
 void loop() {
-  ledMan.loop();
-  doBTScan();
-  doHandleOnOffSwitching();
-  doCheckForCloseDevice();
-  doHandleButtonPresses();
-  doCheckFactoryReset();
-  doCheckLearnTask();
-  doHandleNetworkTasks();
+  scheduler.runOnce();
 }
 
 /**
- * This function handles all tasks related to network.
- * This includes turning on and off networking, web server and
- * DNS as well as the looping functons needed to answer requests.
+ * Handles transitioning the WiFi from active to inactive and 
+ * visa-versa. Besides being called directly, it is run by the
+ * EVT_WIFI_CHANGE event when a settings update turns WiFi off.
  * 
+ * Only starts a transition; While one is underway the request is
+ * checked again once it completes.
  */
-void doHandleNetworkTasks() {
-  doActivateDeactivateWiFi();
-  if (isWifiIsOn) {
-    dnsServer.processNextRequest();
-    web.handleClient();
+void doActivateDeactivateWiFi() {
+  if (triggerWifiIsOn && wifiState == WIFI_STATE_OFF) {
+    doStartWiFi();
+  } else if (!triggerWifiIsOn && wifiState == WIFI_STATE_ON) {
+    doStopWiFi();
   }
 }
 
 /**
- * Handles transitioning the WiFi from active to inactive and 
- * visa-versa.
+ * Starts bringing up the WiFi AP. The captive DNS and web server are
+ * started by handleWiFiStarted() once the AP reports it is up, so 
+ * the loop is never held waiting on the WiFi driver.
+ * 
  */
-void doActivateDeactivateWiFi() {
-  if (triggerWifiIsOn && !isWifiIsOn) {
-    ledMan.lockLed(CLOSE_LED_ID, WIFI_ENABLE_FUNCTION_ID);
+void doStartWiFi() {
+  wifiTransitionMicros = Clock::nowMicros();
+  wifiState = WIFI_STATE_STARTING;
+  isWifiIsOn = true;
 
-    // Need to turn on all networking and services
-    #ifdef DEBUG
-      Serial.print(F("Starting WiFi AP Mode... "));
-    #endif
+  doConfigureButton();
+  ledMan.lockLed(CLOSE_LED, WIFI_ENABLE_CALLER);
 
-    WiFi.setHostname((String(F("PxiSw_")) + deviceId).c_str());
-    WiFi.setMinSecurity(WIFI_AUTH_WPA2_PSK);
-    WiFi.softAPConfig(
-      IpUtils::stringIPv4ToIPAddress(F("192.168.4.1")), 
-      IpUtils::stringIPv4ToIPAddress(F("192.168.4.1")), 
-      IpUtils::stringIPv4ToIPAddress(F("255.255.255.0"))
-    );
+  // Scanning is suspended while WiFi is on
+  presenceClock.pause();
+  scheduler.stopTimer(scanRestartTimer);
+  scheduler.stopTimer(scanWatchdogTimer);
 
-    WiFi.softAP(deviceSsid, settings.getApPwd());
-    WiFi.enableAP(true);
-    
-    #ifdef DEBUG
-      Serial.println(F("Complete."));
-      Serial.println(F("Starting DNS for captive portal... "));
-    #endif
+  #ifdef DEBUG
+    Serial.println(F("Starting WiFi AP Mode..."));
+  #endif
 
-    dnsServer.start(53u, "*", IpUtils::stringIPv4ToIPAddress(F("192.168.4.1")));
-      
-    #ifdef DEBUG
-      Serial.println(F("Complete."));
-      Serial.print(F("Initializing Web Services... "));
-    #endif
+  WiFi.softAPConfig(AP_ADDRESS, AP_ADDRESS, AP_SUBNET);
+  WiFi.softAP(deviceSsid, settings.getApPwd());
 
-    web.on("/", handleSettingsPage);
-    web.onNotFound(handleSettingsPage);
-    web.begin();
+  // In case the AP start event is never seen
+  scheduler.startTimer(wifiTransitionTimer, WIFI_START_TIMEOUT_MILLIS);
+}
 
-    #ifdef DEBUG
-      Serial.println(F("Complete."));
-    #endif
+/**
+ * Finishes bringing up WiFi once the AP is up by starting the 
+ * captive DNS and web server. Run by the EVT_WIFI_AP_START event,
+ * or the transition timer should that event never arrive.
+ * 
+ */
+void handleWiFiStarted() {
+  if (wifiState != WIFI_STATE_STARTING) {
+    return;
+  }
+  scheduler.stopTimer(wifiTransitionTimer);
 
-    isWifiIsOn = true;
-  } else if (triggerWifiIsOn) {
-    // WiFi is supposed to be on and it is on.
-    static ulong timmerMillis = 0UL;
-    if (millis() - timmerMillis > 50UL) {
-      ledMan.ledToggle(CLOSE_LED_ID, WIFI_ENABLE_FUNCTION_ID);
-      timmerMillis = millis();
-    }
-  } else if (!triggerWifiIsOn && isWifiIsOn) {
-    ledMan.releaseLed(CLOSE_LED_ID, WIFI_ENABLE_FUNCTION_ID);
-    ledMan.ledOff(CLOSE_LED_ID, WIFI_ENABLE_FUNCTION_ID);
+  captiveDns.start(AP_ADDRESS);
+  web.begin();
 
-    // Need to turn off WiFi and Services
-    #ifdef DEBUG
-      Serial.print(F("Stopping DNS Server... "));
-    #endif
+  wifiState = WIFI_STATE_ON;
+  wifiOnMicros = Clock::nowMicros() - wifiTransitionMicros;
 
-    dnsServer.stop();
-    yield();
-    
-    #ifdef DEBUG
-      Serial.println(F("Complete."));
-      Serial.print(F("Stopping web Server... "));
-    #endif
+  #ifdef DEBUG
+    Serial.printf("WiFi AP ready in %lld us.\n", wifiOnMicros);
+  #endif
 
-    web.stop();
-    yield();
-    
-    #ifdef DEBUG
-      Serial.println(F("Complete."));
-      Serial.print(F("Stopping WiFi AP... "));
-    #endif
+  ledMan.ledPattern(CLOSE_LED, WIFI_ENABLE_CALLER, WIFI_BLINK_PATTERN);
 
-    delay(2000);
-    WiFi.softAPdisconnect(true);
-    
-    #ifdef DEBUG
-      Serial.println(F("Complete."));
-    #endif
-    
-    isWifiIsOn = false;
-  }
+  // WiFi may have been requested back off while starting
+  doActivateDeactivateWiFi();
 }
 
 /**
- * This function is the sole handler of the learn button's 
- * functionality. It notifies other functions when various tasks
- * need to be performed using boolean event flags.
- * 
- * NOTE: Wifi must be off for factory reset or learning to be able
- * to be triggered. Once factory reset or learning is in progress the
- * button's functionality is disabled.
+ * Starts taking down the WiFi AP. The services stop right away but
+ * the AP itself is kept up for a short drain so the last response, 
+ * such as a settings update's, can reach the browser.
  * 
  */
-void doHandleButtonPresses() {
-  if (!triggerDeviceLearn && !triggerFactoryReset) {
-    static ulong timerMillis = 0UL;
-    ulong elapsedMillis = millis() - timerMillis;
-
-    if (digitalRead(PAIR_BTN_PIN) == HIGH) {
-      // Button is held down
-      if (timerMillis == 0UL) {
-        // Start timer so we know how long button is held down
-        timerMillis = millis();
-        elapsedMillis = 0UL;
-      }
+void doStopWiFi() {
+  wifiTransitionMicros = Clock::nowMicros();
+  wifiState = WIFI_STATE_STOPPING;
 
-      if (!triggerWifiIsOn && elapsedMillis > settings.getTriggerFactoryMillis()) { // <------------------- [Factory Reset]
-        // Button held for longer than needed for factory reset; Disabled if wifi is on
-        ledMan.releaseLed(CLOSE_LED_ID, WIFI_ENABLE_FUNCTION_ID);
-        ledMan.ledOff(CLOSE_LED_ID, WIFI_ENABLE_FUNCTION_ID);
-        ledMan.lockLed(LEARN_LED_ID, FACTORY_RESET_FUNCTION_ID);
-        // Flashing learning LED to signal factory reset on release
-        for (int i = 0; i < 4; i++) {
-          ledMan.ledToggle(LEARN_LED_ID, FACTORY_RESET_FUNCTION_ID);
-          ledMan.loop();
-          delay(50UL);
-        }
-      } else if (
-        elapsedMillis > settings.getTriggerWiFiOnMillis() 
-        || (
-          triggerWifiIsOn 
-          && elapsedMillis > settings.getTriggerWiFiOffMillis() // Delay prevents accedental shut off
-        )
-      ) { // <--------------------------------------------------------------------------------------------- [WiFi On/Off]
-        // Flashing Close LED to signal WiFi on/off if released
-        ledMan.ledOff(LEARN_LED_ID, LEARN_FUNCTION_ID);
-        ledMan.lockLed(CLOSE_LED_ID, WIFI_ENABLE_FUNCTION_ID);
-        if (!triggerWifiIsOn) {
-          // WiFi is off currently and button press is long enough to switch state
-          static ulong subTimerMillis = 0UL;
-          if (millis() - subTimerMillis > 50UL) {
-            ledMan.ledToggle(CLOSE_LED_ID, WIFI_ENABLE_FUNCTION_ID);
-            subTimerMillis = millis();
-          }
-        } else {
-          // WiFi is on currently
-          ledMan.lockLed(CLOSE_LED_ID, WIFI_DISABLE_FUNCTION_ID); // Initial lock state is off; No need to set off state here.
-        }
-      } else if (!triggerWifiIsOn && elapsedMillis >= settings.getTriggerLearnMillis()) { // <------------- [Learn]
-        // Button held long enough too trigger learn
-        // Turn on learning LED Solid to signal function triggered if released
-        ledMan.ledOn(LEARN_LED_ID, LEARN_FUNCTION_ID);
-      } 
-    } else if (timerMillis > 0UL) {
-      // There was a button press; Evaluate the length for functionality
-      if (!triggerWifiIsOn && elapsedMillis > settings.getTriggerFactoryMillis()) { // <------------------- [TRIGGER: Factory Reset]
-        // Super Long Hold - Factory Reset
-        triggerFactoryReset = true;
-      } else if (
-        elapsedMillis > settings.getTriggerWiFiOnMillis()
-        || (
-          triggerWifiIsOn 
-          && elapsedMillis > settings.getTriggerWiFiOffMillis() // Delay prevents accedental shut off
-        )
-      ) { // <--------------------------------------------------------------------------------------------- [TRIGGER: WiFi On/Off]
-        // Medium Press - WiFi On/Off
-        triggerWifiIsOn = !triggerWifiIsOn;
-      } else if (!triggerWifiIsOn && elapsedMillis >= settings.getTriggerLearnMillis()) { // <------------- [TRIGGER: Learn]
-        // Short Press - Learning Mode
-        triggerDeviceLearn = true;
-      }
+  doConfigureButton();
+  scheduler.stopTimer(streamTimer);
+  eventStream.closeAll();
 
-      timerMillis = 0UL;
-      ledMan.ledOff(LEARN_LED_ID, LEARN_FUNCTION_ID);
-      ledMan.releaseLed(CLOSE_LED_ID, WIFI_ENABLE_FUNCTION_ID);
-      ledMan.ledOff(CLOSE_LED_ID, WIFI_ENABLE_FUNCTION_ID);
-      ledMan.releaseLed(LEARN_LED_ID, FACTORY_RESET_FUNCTION_ID);
-      ledMan.ledOff(LEARN_LED_ID, FACTORY_RESET_FUNCTION_ID);
-      ledMan.releaseLed(CLOSE_LED_ID, WIFI_DISABLE_FUNCTION_ID);
-    } 
-  }
+  ledMan.releaseLed(CLOSE_LED, WIFI_ENABLE_CALLER);
+  ledMan.ledOff(CLOSE_LED, WIFI_ENABLE_CALLER);
+
+  #ifdef DEBUG
+    Serial.println(F("Stopping WiFi AP Mode..."));
+  #endif
+
+  captiveDns.stop(); // <-- Its task is done well within the drain
+  web.end();
+
+  scheduler.startTimer(wifiTransitionTimer, WIFI_DRAIN_MILLIS);
 }
 
 /**
- * Checks to see if a device is close enough to be a good
- * pair candidate and if so turns on the close device indicator
- * LED. If not it ensures the LED is off.
+ * Completes the WiFi shutdown started by doStopWiFi() once the 
+ * drain has passed, then resumes scanning right away; The scan was
+ * left stopped cleanly so it needs no reset wait.
  * 
  */
-void doCheckForCloseDevice() {
-  bool isClose = false;
-  for (const auto& pair : seenRssis) {
-    if (pair.second >= settings.getCloseRssi()) {
-      isClose = true;
-      ledMan.ledOn(CLOSE_LED_ID, CLOSE_FUNCTION_ID);
+void doCompleteWiFiShutdown() {
+  WiFi.softAPdisconnect(true);
 
-      break;
-    }
-  }
+  wifiState = WIFI_STATE_OFF;
+  isWifiIsOn = false;
+  presenceClock.resume();
 
-  if (!isClose) {
-    ledMan.ledOff(CLOSE_LED_ID, CLOSE_FUNCTION_ID);
+  if (isScanning) {
+    // Kept scanning for the live stream
+    wifiOffMicros = Clock::nowMicros() - wifiTransitionMicros;
+  } else {
+    isWifiOffTiming = true;
+    scan->clearResults();
+    doStartBTScan();
   }
+
+  #ifdef DEBUG
+    Serial.printf("WiFi AP stopped in %lld us.\n", wifiOffMicros);
+  #endif
+
+  // WiFi may have been requested back on while shutting down
+  doActivateDeactivateWiFi();
 }
 
 /**
- * Checks for a factory reset condition then performs the reset.
+ * Handles expiry of the WiFi transition timer, which ends the drain
+ * while stopping or stands in for a missed AP start event.
  * 
  */
-void doCheckFactoryReset() {
-  if (triggerFactoryReset) {
-    #ifdef DEBUG
-      Serial.println(F("Device Factory Reset!"));
-    #endif
-    ulong startMillis = millis();
-    ledMan.lockLed(LEARN_LED_ID, FACTORY_RESET_FUNCTION_ID);
-    while (millis() - startMillis < 3500UL) {
-      yield();
-      ledMan.ledToggle(LEARN_LED_ID, FACTORY_RESET_FUNCTION_ID);
-      ledMan.loop();
-      delay(100UL);
-    }
-    ledMan.releaseLed(LEARN_LED_ID, FACTORY_RESET_FUNCTION_ID);
-    ledMan.ledOff(LEARN_LED_ID, FACTORY_RESET_FUNCTION_ID);
-    
-    settings.factoryDefault();
-    #ifdef DEBUG
-      Serial.println(F("Factory reset complete; Rebooting ESP now!"));
-    #endif
-    ESP.restart();
+void handleWiFiTransitionTimer() {
+  if (wifiState == WIFI_STATE_STARTING) {
+    handleWiFiStarted();
+  } else if (wifiState == WIFI_STATE_STOPPING) {
+    doCompleteWiFiShutdown();
   }
 }
 
 /**
- * Used to update the controlledOnState so that it reflects the current
- * proximity of the paired device.
+ * Called from the WiFi driver's event task when the AP starts; The
+ * start is finished from the main loop.
  * 
+ * @param event - The WiFi event as arduino_event_id_t.
  */
-void doDeterminePairedDeviceProximity() {
-  bool sState = settings.isOnState();
-  settings.setOnState(seenDevices.count(settings.getParedAddress().c_str()) > 0);
+void handleWiFiEvent(arduino_event_id_t event) {
+  scheduler.post(EVT_WIFI_AP_START);
 }
 
 /**
- * This function handles the on/off switching of the controlled device
- * such that the state of the device is made to match the desired state of the
- * device.
+ * Joins the configured network in station mode and starts publishing
+ * to the configured MQTT broker, or stops both if no network is 
+ * configured, then starts or stops gossip. Station mode runs 
+ * alongside the AP and, unlike it, doesn't suspend scanning. Run at
+ * startup and by the EVT_STATION_CHANGE event when the station or
+ * gossip settings change.
  * 
  */
-void doHandleOnOffSwitching() {
-  doDeterminePairedDeviceProximity();
+void doStartStation() {
+  mqtt.stop();
+  scheduler.stopTimer(telemetryTimer);
+  scheduler.stopTimer(healthTimer);
+
+  if (settings.getStaSsid().isEmpty()) {
+    doStartProxy();
+    if (WiFi.getMode() & WIFI_STA) {
+      // Gossip needs the station radio even with no network
+      WiFi.disconnect(!settings.isGossip());
+    }
+    doStartGossip();
+    return;
+  }
 
-  if (settings.isOnState() && digitalRead(CONTROLLED_DEVICE_PIN) == LOW) {
-    // Device is off but should be on; Turn it on
-    digitalWrite(CONTROLLED_DEVICE_PIN, HIGH);
-    #ifdef DEBUG
-      Serial.println(F("Device: ON!!!"));
-    #endif
-  } else if (!settings.isOnState() && digitalRead(CONTROLLED_DEVICE_PIN) == HIGH) {
-    // Device is on but should be off; Turn it off
-    digitalWrite(CONTROLLED_DEVICE_PIN, LOW);
-    #ifdef DEBUG
-      Serial.println(F("Device: OFF!!!"));
-    #endif
+  #ifdef DEBUG
+    Serial.printf("Joining WiFi network [%s]...\n", settings.getStaSsid().c_str());
+  #endif
+
+  WiFi.setAutoReconnect(true);
+  WiFi.begin(settings.getStaSsid().c_str(), settings.getStaPwd().c_str());
+  scheduler.startTimer(healthTimer, HEALTH_INTERVAL_MILLIS, HEALTH_INTERVAL_MILLIS);
+
+  if (!settings.getMqttHost().isEmpty()) {
+    mqtt.begin(
+      settings.getMqttHost().c_str(), 
+      (uint16_t)settings.getMqttPort(), 
+      deviceSsid.c_str(), 
+      mqttTopicPrefix.c_str(), 
+      MQTT_FLUSH_MILLIS
+    );
+    scheduler.startTimer(telemetryTimer, MQTT_SUMMARY_MILLIS, MQTT_SUMMARY_MILLIS);
   }
+  doStartProxy();
+  doStartGossip();
 }
 
 /**
- * Used to purge expired seen devices which are no longer considered
- * to be in-range.
+ * Starts forwarding scanned advertisements to the configured proxy
+ * host, or stops if none is configured. Only runs in station mode.
  * 
  */
-void doPurgeOldSeenDevices(unsigned long wifiOnMillis) {
-  // Purge seenDevices that are expired
-  int devCount = seenDevices.size();
-  if (devCount > 0) {
-    std::vector<std::string> purgeList;
+void doStartProxy() {
+  advertProxy.stop();
 
-    if (wifiOnMillis != 0UL) {  // WiFi was on so we compensate expos for that time...
-      // Bump the time for all seenDevices to erase the lapse while wifi was on
-      for (const auto& pair : seenDevices) {
-        seenDevices[pair.first] += wifiOnMillis;
-      }
-    } else { // Normal operation do purge routine because wifi is off...
-      // Locate expired devices which need purged
-      for (const auto& pair : seenDevices) {
-        if (millis() - pair.second > settings.getMaxNotSeenMillis()) {
-          purgeList.push_back(pair.first);
-        }
-      }
+  if (settings.getStaSsid().isEmpty() || settings.getProxyHost().isEmpty()) {
+    return;
+  }
 
-      // Purge the identified expired devices
-      for (std::string id : purgeList) {
-        seenDevices.erase(id);
-        seenRssis.erase(id);
-        #ifdef DEBUG
-          if (
-            settings.getParedAddress().equalsIgnoreCase(F("xx:xx:xx:xx:xx:xx")) 
-            || settings.getParedAddress().equalsIgnoreCase(String(id.c_str()))
-          ) { 
-            Serial.printf("Purged 'seen' device; device=[%s]\n", id.c_str());
-          }
-        #endif
-      }
-      purgeList.clear();
-    }
+  if (advertProxy.begin(
+    settings.getProxyHost().c_str(), 
+    (uint16_t)settings.getProxyPort(), 
+    settings.isProxyUdp(), 
+    nodeId, 
+    PROXY_WINDOW_MILLIS
+  )) {
+    return;
   }
+  #ifdef DEBUG
+    Serial.println(F("BLE proxy failed to start!"));
+  #endif
 }
 
 /**
- * Handles tasks related to BlueTooth scans by first
- * purging stored devices not seen past their expiration
- * time, then it kicks off the scan again if it has completed.
+ * Called from the BLE task for each device a scan reports, handing
+ * its advertisement to the proxy when proxying. Not for use by the
+ * loop.
  * 
- * BlueTooth scanning is suspended while wifi is on to improve 
- * stability.
+ * @param device - The device and its advertisement as BLEAdvertisedDevice&.
  */
-void doBTScan() {
-  static bool firstRun = true;
-  static unsigned long wifiOnStartMillis = 0UL;
-  bool wdExpired = millis() - scanningWatchdogMillis > 15000UL;
-  
-  if (!isWifiIsOn) {
-    if (!isScanning || wdExpired) {
-      // Start scanning when it is done or if watchdog expires
-      if (wdExpired || firstRun) {
-        if (!firstRun) {
-          btScanWDExpos ++;
-          #ifdef DEBUG
-            Serial.println("WARN: BT Scan watchdog exipred!");
-          #endif
-        }
-
-        scan = BLEDevice::getScan();
-        scan->clearResults();
-        scan->stop();
-        yield();
-        delay(500);
-        scan->setActiveScan(true);  //active scan uses more power, but get results faster
-        scan->setInterval(100);
-        scan->setWindow(99);  // less or equal setInterval value
-        firstRun = false;
-      }
-      
-      isScanning = true;
-      scan->start(5, handleBTScanResults);
-
-      scanningWatchdogMillis = millis();
-    }
-
-    unsigned long wifiOnMillis = wifiOnStartMillis == 0UL ? 0UL : millis() - wifiOnStartMillis;
-    wifiOnStartMillis = 0UL;
-
-    doPurgeOldSeenDevices(wifiOnMillis);
-  } else {
-    if (wifiOnStartMillis == 0UL) {
-      wifiOnStartMillis = millis();
-    }
-    scanningWatchdogMillis = millis();
+void handleProxyAdvert(BLEAdvertisedDevice &device) {
+  if (!advertProxy.isRunning()) {
+    return;
   }
+
+  BLEAddress address = device.getAddress();
+  advertProxy.add(
+    *address.getNative(), 
+    device.getAddressType() == BLE_ADDR_TYPE_RANDOM, 
+    device.getRSSI(), 
+    device.getPayload(), 
+    device.getPayloadLength()
+  );
 }
 
 /**
- * Handles the learning task. The learning task allows
- * for the device to identify and track the device which is nearest 
- * to it at the time the learning is performed.
+ * Called by the scan from the BLE task for each device it reports.
+ * A near sighting of the paired device is stamped here, as it is heard,
+ * rather than when the scan's results are gone through at its end; 
+ * As the latest one, and as the first one if the controlled device is
+ * off and none has been since it was last switched.
  * 
+ * @param device - The device and its advertisement as BLEAdvertisedDevice.
  */
-void doCheckLearnTask() {
-  static ulong learnStartMillis = 0L;
-  
-  if (triggerDeviceLearn) {
-    // Do start of learning tasks
-    if (!isLearning) {
-      ledMan.ledOn(LEARN_LED_ID, LEARN_FUNCTION_ID);
-      learnStartMillis = millis();
-      #ifdef DEBUG
-        Serial.println(F("Learning started..."));
-      #endif
-      isLearning = true;
+void ProxyScanCallbacks::onResult(BLEAdvertisedDevice device) {
+  int64_t nowMicros = Clock::nowMicros();
+  BLEAddress address = device.getAddress();
+  int rssi = device.getRSSI();
+  bool isOff = digitalRead(CONTROLLED_DEVICE_PIN) == LOW;
+  portENTER_CRITICAL(&sightingMux);
+  if (isPairedNative && rssi > pairedNearRssi && memcmp(*address.getNative(), pairedNative, sizeof(pairedNative)) == 0) {
+    lastSightingMicros = nowMicros;
+    if (firstSightingMicros == 0LL && isOff) {
+      firstSightingMicros = nowMicros;
     }
+  }
+  portEXIT_CRITICAL(&sightingMux);
 
-    // Wait 10 Seconds to allow nearest discovery then pair with nearest
-    if (millis() - learnStartMillis > settings.getLearnDurationMillis()) {
-      std::string nearestId = "";
-      int nearestRssi = -999;
+  handleProxyAdvert(device);
+}
 
-      // Check known devices for nearest
-      for (const auto& pair : seenDevices) {
-        if (String(nearestId.c_str()).isEmpty() || seenRssis[pair.first] > nearestRssi) {
-          nearestId = pair.first;
-          nearestRssi = seenRssis[pair.first];
-        }
-      }
+/**
+ * Starts or stops exchanging sightings with other switches over 
+ * ESP-NOW, as set. ESP-NOW rides on the station radio, so it is 
+ * turned on if no network is configured; Switches must be on the 
+ * same channel to hear each other, which they are with no network 
+ * or all on the same one.
+ * 
+ */
+void doStartGossip() {
+  scheduler.stopTimer(gossipTimer);
+  espNow.end();
 
-      // Pair with identified ID
-      if (!settings.getParedAddress().equalsIgnoreCase(String(nearestId.c_str()))) {
-        settings.setParedAddress(String(nearestId.c_str()));
-        settings.saveSettings();
-        #ifdef DEBUG
-          Serial.printf("Learning Complete! Paired Device is '%s', with RSSI of: %d\n\n", nearestId.c_str(), nearestRssi);
-        #endif
-      } else {
-        #ifdef DEBUG
-          Serial.println(F("Learning Complete! Paired Device is same as previous!\n"));
-        #endif
-      }
+  if (!settings.isGossip()) {
+    return;
+  }
 
-      // Do end of learning tasks
-      isLearning = false;
-      triggerDeviceLearn = false;
+  if (!(WiFi.getMode() & WIFI_STA)) {
+    WiFi.enableSTA(true);
+  }
 
-      ledMan.ledOff(LEARN_LED_ID, LEARN_FUNCTION_ID);
+  gossip.begin(nodeId, (uint8_t)settings.getGossipMarginDb(), GOSSIP_MAX_AGE_MILLIS);
+  if (espNow.begin(handleGossipFrame)) {
+    scheduler.startTimer(gossipTimer, GOSSIP_INTERVAL_MILLIS, GOSSIP_INTERVAL_MILLIS);
+  }
+  #ifdef DEBUG
+    else {
+      Serial.println(F("ESP-NOW failed to start!"));
     }
+  #endif
+}
+
+/**
+ * Sends this switch's sightings to the other switches; Run from a
+ * timer while gossiping and right away when the device switches so
+ * peers learn of the claim quickly.
+ * 
+ */
+void doBroadcastGossip() {
+  if (scheduler.isTimerActive(gossipTimer)) {
+    gossip.broadcast(Clock::nowMillis());
   }
 }
 
 /**
- * Handles showing the settings page and filling out all
- * the dynamic content on the page.
+ * Multicasts a binary health frame for the fleet collector (see 
+ * tools/collector) while joined to a network. Run from a timer in 
+ * station mode.
  * 
  */
-void handleSettingsPage() {
-  if (web.method() == HTTP_POST) {
-    handleSettingsPost();
+void doSendHealthFrame() {
+  if (WiFi.status() != WL_CONNECTED) {
+    return;
   }
 
-  String page = String(SETTINGS_PAGE);
+  uint8_t buffer[HealthFrame::MAX_FRAME_SIZE];
+  HealthFrame frame(buffer, sizeof(buffer));
+  frame.begin(nodeId, ++healthSequence);
+  frame.value(HealthFrame::FIELD_UPTIME_SECONDS, (uint32_t)((Clock::nowMillis() - startedMillis) / 1000ULL));
+  frame.value(HealthFrame::FIELD_STARTUPS, startups);
+  frame.value(HealthFrame::FIELD_FREE_HEAP, ESP.getFreeHeap());
+  frame.value(HealthFrame::FIELD_MIN_FREE_HEAP, ESP.getMinFreeHeap());
+  frame.value(HealthFrame::FIELD_SCAN_WATCHDOGS, btScanWDExpos);
+  frame.value(HealthFrame::FIELD_SCANS, scansCompleted);
+  frame.value(HealthFrame::FIELD_PRESENCE_CHANGES, presenceChanges);
+  frame.value(HealthFrame::FIELD_SEEN_DEVICES, seenDevices.size());
+  frame.value(HealthFrame::FIELD_MQTT_DROPPED, mqtt.getStats().dropped);
+  frame.value(HealthFrame::FIELD_GOSSIP_PEERS, gossip.getPeerCount(Clock::nowMillis()));
+  frame.histogram(HealthFrame::FIELD_RSSI_HISTOGRAM, rssiHistogram, HealthFrame::RSSI_BUCKETS);
+  frame.histogram(HealthFrame::FIELD_DWELL_HISTOGRAM, dwellHistogram, HealthFrame::DWELL_BUCKETS);
+
+  if (frame.getLength() > 0 && healthUdp.beginPacket(HEALTH_GROUP, HEALTH_PORT)) {
+    healthUdp.write(buffer, frame.getLength());
+    healthUdp.endPacket();
+  }
+  memset(rssiHistogram, 0, sizeof(rssiHistogram));
+}
 
-  page.replace(F("${message}"), settingsUpdateResult);
-  settingsUpdateResult = "";
+/**
+ * Called from the WiFi driver's task when a gossip frame arrives; 
+ * Frames are taken in from the loop.
+ * 
+ */
+void handleGossipFrame() {
+  scheduler.post(EVT_GOSSIP_FRAME);
+}
 
-  page.replace(F("${version}"), FIRMWARE_VERSION);
-  page.replace(F("${ap_pwd}"), settings.getApPwd());
-  page.replace(F("${close_rssi}"), String(settings.getCloseRssi()));
-  page.replace(F("${max_rssi}"), String(settings.getMaxNearRssi()));
-  page.replace(F("${max_seen}"), String(settings.getMaxNotSeenMillis()));
-  page.replace(F("${learn_trigger}"), String(settings.getTriggerLearnMillis()));
-  page.replace(F("${factory_trigger}"), String(settings.getTriggerFactoryMillis()));
-  page.replace(F("${wifi_on_trigger}"), String(settings.getTriggerWiFiOnMillis()));
-  page.replace(F("${wifi_off_trigger}"), String(settings.getTriggerWiFiOffMillis()));
-  page.replace(F("${learn_wait}"), String(settings.getLearnDurationMillis()));
-  page.replace(F("${pared_address}"), settings.getParedAddress());
-  page.replace(F("${startups}"), String(settings.getStartups()));
-  page.replace(F("${uptime}"), Utils::userFriendlyElapsedTime((millis() - settings.getLastStartMillis())));
-  page.replace(F("${free_heap}"), String(ESP.getFreeHeap()));
-  page.replace(F("${seen_devices}"), String(seenDevices.size()));
-  page.replace(F("${seen_rssis}"), String(seenRssis.size()));
-  page.replace(F("${scan_watchdogs}"), String(btScanWDExpos));
+/**
+ * Takes in the gossip frames which have arrived then brings the 
+ * controlled device up to date, as a peer may now be nearer.
+ * 
+ */
+void handleGossipFrameEvent() {
+  uint8_t frame[Gossip::MAX_FRAME_SIZE];
+  size_t length = 0;
+  while (espNow.poll(frame, length)) {
+    gossip.receive(frame, length, Clock::nowMillis());
+  }
 
-  web.send(200, F("text/html"), page.c_str());
-  yield();
+  doHandleOnOffSwitching();
 }
 
 /**
- * Handles the setting page when a POST method is made with 
- * updates to the settings.
- * This function stores the new settings and reboots the device
- * if needed.
- * 
- */
-void handleSettingsPost() {
-  String newApPwd = web.arg(F("ap_pwd"));
-  String newMaxRssi = web.arg(F("max_rssi"));
-  String newCloseRssi = web.arg(F("close_rssi"));
-  String newMaxSeenMillis = web.arg(F("max_seen"));
-  String newLearnWaitMillis = web.arg(F("learn_wait"));
-  String newLearnTriggerMillis = web.arg(F("learn_trigger"));
-  String newFactoryTriggerMillis = web.arg(F("factory_trigger"));
-  String newWiFiOnTriggerMillis = web.arg(F("wifi_on_trigger"));
-  String newWiFiOffTriggerMillis = web.arg(F("wifi_off_trigger"));
-  
-  if (
-    newApPwd && !newApPwd.isEmpty()
-    && newMaxRssi && !newMaxRssi.isEmpty()
-    && newCloseRssi && !newCloseRssi.isEmpty()
-    && newMaxSeenMillis && !newMaxSeenMillis.isEmpty()
-    && newLearnWaitMillis && !newLearnWaitMillis.isEmpty()
-    && newLearnTriggerMillis && !newLearnTriggerMillis.isEmpty()
-    && newFactoryTriggerMillis && !newFactoryTriggerMillis.isEmpty()
-    && newWiFiOnTriggerMillis && !newWiFiOnTriggerMillis.isEmpty()
-    && newWiFiOffTriggerMillis && !newWiFiOffTriggerMillis.isEmpty()
-  ) {
-    bool needSave = false;
-    bool needReboot = false;
+ * Queues a message for the MQTT broker if publishing is on; It is 
+ * sent with the next batch.
+ * 
+ * @param topic - The topic below the device's prefix as const char*.
+ * @param format - A printf style format for the message as const char*.
+ */
+void doPublishMqtt(const char *topic, const char *format, ...) {
+  if (!mqtt.isRunning()) {
+    return;
+  }
 
-    if (!settings.getApPwd().equals(newApPwd)) {
-      needSave = true;
-      needReboot = true;
-      settings.setApPwd(newApPwd);
-    }
+  char payload[MqttPublisher::PAYLOAD_SIZE];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(payload, sizeof(payload), format, args);
+  va_end(args);
 
-    int intVal = newMaxRssi.toInt();
-    if (settings.getMaxNearRssi() != intVal) {
-      needSave = true;
-      settings.setMaxNearRssi(intVal);
-    }
+  mqtt.publish(topic, payload);
+}
 
-    intVal = newCloseRssi.toInt();
-    if (settings.getCloseRssi() != intVal) {
-      needSave = true;
-      settings.setCloseRssi(intVal);
-    }
+/**
+ * Publishes the paired device's RSSI summary since the last time, 
+ * if it was seen, and the device's health. Run from a timer while
+ * publishing to MQTT.
+ * 
+ */
+void doPublishTelemetry() {
+  if (rssiSummary.samples > 0UL) {
+    doPublishMqtt(
+      "rssi", "{\"last\":%d,\"min\":%d,\"max\":%d,\"samples\":%lu}",
+      rssiSummary.last, rssiSummary.min, rssiSummary.max, rssiSummary.samples
+    );
+    rssiSummary.samples = 0UL;
+  }
 
-    unsigned long ulVal = newMaxSeenMillis.toDouble();
-    if (settings.getMaxNotSeenMillis() != ulVal) {
-      needSave = true;
-      settings.setMaxNotSeenMillis(ulVal);
-    }
+  MqttPublisher::Stats mqttStats = mqtt.getStats();
+  doPublishMqtt(
+    "health", "{\"uptime_ms\":%llu,\"free_heap\":%lu,\"scan_watchdogs\":%lu,\"seen_devices\":%u,\"mqtt_depth\":%u,\"mqtt_dropped\":%lu,\"mqtt_avg_us\":%llu,\"mqtt_worst_us\":%lu}",
+    (unsigned long long)(Clock::nowMillis() - startedMillis),
+    (unsigned long)ESP.getFreeHeap(),
+    btScanWDExpos,
+    (unsigned)seenDevices.size(),
+    (unsigned)mqttStats.depth,
+    mqttStats.dropped,
+    (unsigned long long)(mqttStats.published == 0UL ? 0ULL : mqttStats.totalLatencyMicros / mqttStats.published),
+    (unsigned long)mqttStats.worstLatencyMicros
+  );
+}
 
-    ulVal = newLearnTriggerMillis.toDouble();
-    if (settings.getTriggerLearnMillis() != ulVal) {
-      needSave = true;
-      settings.setTriggerLearnMillis(ulVal);
-    }
+/**
+ * Called from the button's interrupt to signal the button handler
+ * that the button has changed state.
+ * 
+ */
+void IRAM_ATTR handleButtonISR() {
+  scheduler.postFromISR(EVT_BUTTON_EDGE);
+}
 
-    ulVal = newFactoryTriggerMillis.toDouble();
-    if (settings.getTriggerFactoryMillis() != ulVal) {
-      needSave = true;
-      settings.setTriggerFactoryMillis(ulVal);
-    }
+/**
+ * Configures the button's hold thresholds for the functions which
+ * are currently available. With WiFi off the button can trigger 
+ * learning, WiFi on or factory reset, ordered by their hold times.
+ * With WiFi on it can only turn WiFi off.
+ * 
+ */
+void doConfigureButton() {
+  uint64_t thresholds[Button::MAX_LEVELS] = { 0ULL, 0ULL, 0ULL };
+  for (uint8_t i = 0; i <= Button::MAX_LEVELS; i++) {
+    buttonFunctions[i] = BTN_FUNC_NONE;
+  }
 
-    ulVal = newWiFiOnTriggerMillis.toDouble();
-    if (settings.getTriggerWiFiOnMillis() != ulVal) {
-      needSave = true;
-      settings.setTriggerWiFiOnMillis(ulVal);
+  if (triggerWifiIsOn) {
+    // Delay prevents accedental shut off
+    thresholds[0] = std::max(std::min(settings.getTriggerWiFiOnMillis(), settings.getTriggerWiFiOffMillis()), (uint64_t)1ULL); // <-- Zero would end the list
+    buttonFunctions[Button::LONG] = BTN_FUNC_WIFI;
+  } else {
+    struct ButtonHold { uint64_t millis; ButtonFunction function; };
+    ButtonHold holds[Button::MAX_LEVELS] = {
+      { settings.getTriggerLearnMillis(), BTN_FUNC_LEARN },
+      { settings.getTriggerWiFiOnMillis(), BTN_FUNC_WIFI },
+      { settings.getTriggerFactoryMillis(), BTN_FUNC_FACTORY }
+    };
+    std::stable_sort(holds, holds + Button::MAX_LEVELS, [](const ButtonHold& a, const ButtonHold& b) { return a.millis < b.millis; });
+
+    for (uint8_t i = 0; i < Button::MAX_LEVELS; i++) {
+      thresholds[i] = std::max(holds[i].millis, (uint64_t)1ULL); // <-- Zero would end the list
+      buttonFunctions[i + 1] = holds[i].function;
     }
+  }
 
-    ulVal = newWiFiOffTriggerMillis.toDouble();
-    if (settings.getTriggerWiFiOffMillis() != ulVal) {
-      needSave = true;
-      settings.setTriggerWiFiOffMillis(ulVal);
-    }
+  pairButton.setHoldThresholds(thresholds[0], thresholds[1], thresholds[2]);
+}
 
-    ulVal = newLearnWaitMillis.toDouble();
-    if (settings.getLearnDurationMillis() != ulVal) {
-      needSave = true;
-      settings.setLearnDurationMillis(ulVal);
+/**
+ * This function is the sole handler of the learn button's 
+ * functionality. It notifies other functions when various tasks
+ * need to be performed using boolean event flags.
+ * It runs when the button interrupt reports an edge and when the
+ * button needs to settle a debounce or reach a hold threshold.
+ * 
+ * NOTE: Wifi must be off for factory reset or learning to be able
+ * to be triggered. Once factory reset or learning is in progress the
+ * button's functionality is disabled.
+ * 
+ */
+void doHandleButtonPresses() {
+  Button::Event event;
+  while (pairButton.poll(event)) {
+    if (triggerDeviceLearn || triggerFactoryReset) {
+      // Button is disabled while learning or resetting
+      continue;
     }
 
-    if (needSave) {
-      bool ok = settings.saveSettings();
-        if (ok) {
-          settingsUpdateResult = String(SUCCESSFUL);
-          #ifdef DEBUG
-            Serial.println(F("Settings Updated!"));
-          #endif
-        } else {
-          settingsUpdateResult = String(FAILED);
-          #ifdef DEBUG
-            Serial.println(F("Settings update Failed!!!"));
-          #endif
-        }
-      
-      if (needReboot) {
-        settingsUpdateResult = String(REBOOT);
-        #ifdef DEBUG
-          Serial.println(F("Shutting down WiFi to force settings update."));
-        #endif
-        triggerWifiIsOn = false;
-      }
+    switch (event.type) {
+      case Button::BTN_HOLD:
+        doShowButtonFunction(buttonFunctions[event.level]);
+        break;
+      case Button::BTN_RELEASED:
+        doTriggerButtonFunction(buttonFunctions[event.level]);
+        break;
+      default:
+        // Presses and double presses have no function of their own
+        break;
+    }
+  }
+
+  // Wake again for the next debounce or hold threshold
+  int64_t wakeMicros = pairButton.nextWakeMicros();
+  if (wakeMicros < 0LL) {
+    scheduler.stopTimer(buttonTimer);
+  } else {
+    int64_t waitMicros = std::max(wakeMicros - Clock::nowMicros(), (int64_t)0LL);
+    scheduler.startTimer(buttonTimer, (uint64_t)((waitMicros + 999LL) / 1000LL));
+  }
+}
+
+/**
+ * Signals with the LEDs which function will be triggered if the
+ * button is released now.
+ * 
+ * @param function - The function reached by the button hold as ButtonFunction.
+ */
+void doShowButtonFunction(ButtonFunction function) {
+  switch (function) {
+    case BTN_FUNC_LEARN: // <------------------------------------------------------------------------------ [Learn]
+      // Turn on learning LED Solid to signal function triggered if released
+      ledMan.ledOn(LEARN_LED, LEARN_CALLER);
+      break;
+    case BTN_FUNC_WIFI: // <------------------------------------------------------------------------------- [WiFi On/Off]
+      // Flashing Close LED to signal WiFi on/off if released
+      ledMan.ledOff(LEARN_LED, LEARN_CALLER);
+      ledMan.lockLed(CLOSE_LED, WIFI_ENABLE_CALLER);
+      if (!triggerWifiIsOn) {
+        // WiFi is off currently and button press is long enough to switch state
+        ledMan.ledPattern(CLOSE_LED, WIFI_ENABLE_CALLER, WIFI_BLINK_PATTERN);
+      } else {
+        // WiFi is on currently
+        ledMan.lockLed(CLOSE_LED, WIFI_DISABLE_CALLER); // Initial lock state is off; No need to set off state here.
+      }
+      break;
+    case BTN_FUNC_FACTORY: // <---------------------------------------------------------------------------- [Factory Reset]
+      // Button held for longer than needed for factory reset; Disabled if wifi is on
+      ledMan.releaseLed(CLOSE_LED, WIFI_ENABLE_CALLER);
+      ledMan.ledOff(CLOSE_LED, WIFI_ENABLE_CALLER);
+      ledMan.lockLed(LEARN_LED, FACTORY_RESET_CALLER);
+      // Flashing learning LED to signal factory reset on release
+      ledMan.ledPattern(LEARN_LED, FACTORY_RESET_CALLER, BUTTON_FACTORY_PATTERN);
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * Triggers the function reached by a button press once the button
+ * is released, then clears the LED signals of the press.
+ * 
+ * @param function - The function reached by the button hold as ButtonFunction.
+ */
+void doTriggerButtonFunction(ButtonFunction function) {
+  switch (function) {
+    case BTN_FUNC_LEARN: // <------------------------------------------------------------------------------ [TRIGGER: Learn]
+      triggerDeviceLearn = true;
+      break;
+    case BTN_FUNC_WIFI: // <------------------------------------------------------------------------------- [TRIGGER: WiFi On/Off]
+      triggerWifiIsOn = !triggerWifiIsOn;
+      break;
+    case BTN_FUNC_FACTORY: // <---------------------------------------------------------------------------- [TRIGGER: Factory Reset]
+      triggerFactoryReset = true;
+      break;
+    default:
+      break;
+  }
+
+  ledMan.ledOff(LEARN_LED, LEARN_CALLER);
+  ledMan.releaseLed(CLOSE_LED, WIFI_ENABLE_CALLER);
+  if (!isWifiIsOn) {
+    // Leave the WiFi on blink playing if it is on
+    ledMan.ledOff(CLOSE_LED, WIFI_ENABLE_CALLER);
+  }
+  ledMan.releaseLed(LEARN_LED, FACTORY_RESET_CALLER);
+  ledMan.ledOff(LEARN_LED, FACTORY_RESET_CALLER);
+  ledMan.releaseLed(CLOSE_LED, WIFI_DISABLE_CALLER);
+
+  // Act on whatever the press triggered
+  doCheckFactoryReset();
+  doCheckLearnTask();
+  doActivateDeactivateWiFi();
+}
+
+/**
+ * Checks to see if a device is close enough to be a good
+ * pair candidate and if so turns on the close device indicator
+ * LED. If not it ensures the LED is off.
+ * 
+ */
+void doCheckForCloseDevice() {
+  bool wasClose = isCloseDevice;
+  bool isClose = false;
+  for (const auto& pair : seenRssis) {
+    if (pair.second >= settings.getCloseRssi()) {
+      isClose = true;
+      ledMan.ledOn(CLOSE_LED, CLOSE_CALLER);
+
+      break;
+    }
+  }
+
+  if (!isClose) {
+    ledMan.ledOff(CLOSE_LED, CLOSE_CALLER);
+  }
+
+  isCloseDevice = isClose;
+  if (isClose != wasClose) {
+    eventStream.publish(STREAM_CLOSE, isClose ? 1 : 0);
+    doPublishMqtt("close", "{\"close\":%d,\"at\":%llu}", isClose ? 1 : 0, (unsigned long long)Clock::nowMillis());
+  }
+}
+
+/**
+ * Checks for a factory reset condition then starts the reset by
+ * flashing the Learn LED. The reset itself is performed by 
+ * doCompleteFactoryReset() once the flashing is done.
+ * 
+ */
+void doCheckFactoryReset() {
+  if (triggerFactoryReset && !scheduler.isTimerActive(factoryResetTimer)) {
+    #ifdef DEBUG
+      Serial.println(F("Device Factory Reset!"));
+    #endif
+    ledMan.lockLed(LEARN_LED, FACTORY_RESET_CALLER);
+    ledMan.ledPattern(LEARN_LED, FACTORY_RESET_CALLER, FACTORY_RESET_PATTERN);
+    scheduler.startTimer(factoryResetTimer, FACTORY_FLASH_DURATION_MILLIS);
+  }
+}
+
+/**
+ * Performs the factory reset and reboots the device.
+ * 
+ */
+void doCompleteFactoryReset() {
+  ledMan.releaseLed(LEARN_LED, FACTORY_RESET_CALLER);
+  ledMan.ledOff(LEARN_LED, FACTORY_RESET_CALLER);
+    
+  settings.factoryDefault();
+  WarmRestart::clear();
+  #ifdef DEBUG
+    Serial.println(F("Factory reset complete; Rebooting ESP now!"));
+  #endif
+  ESP.restart();
+}
+
+/**
+ * Ends the trial of newly updated firmware once it has been up for 
+ * a while, provided it is scanning. If it isn't, it restarts; Each 
+ * restart counts against the trial and once they run out the 
+ * previous firmware is booted again.
+ * 
+ */
+void doConfirmFirmware() {
+  if (scansCompleted > 0UL) {
+    OtaUpdater::confirmBoot();
+    #ifdef DEBUG
+      Serial.println(F("Updated firmware confirmed."));
+    #endif
+    return;
+  }
+
+  #ifdef DEBUG
+    Serial.println(F("Updated firmware isn't scanning; Restarting!"));
+  #endif
+  settings.saveSettings();
+  ESP.restart();
+}
+
+/**
+ * Restarts into newly installed firmware; Run from a timer so the 
+ * update's response reaches the browser first.
+ * 
+ */
+void doRestartForUpdate() {
+  #ifdef DEBUG
+    Serial.println(F("Firmware update installed; Rebooting ESP now!"));
+  #endif
+  settings.saveSettings();
+  ESP.restart();
+}
+
+/**
+ * Schedules a save of the changed settings, if any. Changes made 
+ * while one is scheduled join it so a burst of them is saved at once,
+ * away from the work which made them.
+ * 
+ */
+void doScheduleSettingsSave() {
+  if (settings.isSavePending() && !scheduler.isTimerActive(settingsSaveTimer)) {
+    scheduler.startTimer(settingsSaveTimer, SETTINGS_SAVE_DELAY_MILLIS);
+  }
+}
+
+/**
+ * Saves the settings changed since the last save. Settings which fail
+ * to save are tried again later.
+ * 
+ */
+void doSaveSettings() {
+  if (!settings.saveSettings()) {
+    #ifdef DEBUG
+      Serial.println(F("Settings save failed; Retrying later."));
+    #endif
+    scheduler.startTimer(settingsSaveTimer, SETTINGS_SAVE_DELAY_MILLIS);
+  }
+}
+
+/**
+ * Starts the counter log and counts this startup in it. A new log
+ * carries on from the startups counted in settings until now. Without
+ * the counters partition, as when the partition table predates it on
+ * a device only ever updated over the air, startups are counted in
+ * settings as before and the other counters aren't kept.
+ *
+ */
+void doStartCounters() {
+  startedMillis = Clock::nowMillis();
+  if (!counterFlash.begin(COUNTERS_PARTITION) || !counterLog.begin(counterFlash, COUNTER_COUNT)) {
+    settings.logStartup();
+    startups = settings.getStartups();
+
+    return;
+  }
+
+  if (counterLog.isFresh()) {
+    counterLog.set(COUNTER_STARTUPS, settings.getStartups());
+  }
+  counterLog.add(COUNTER_STARTUPS);
+  startups = counterLog.get(COUNTER_STARTUPS);
+}
+
+/**
+ * Works out the device ID, from a hash of the MAC address, and the
+ * names made from it. Left until scanning has started as it takes
+ * hashing.
+ *
+ */
+void doIdentifyDevice() {
+  deviceId = Utils::genDeviceIdFromMacAddr(WiFi.macAddress());
+  deviceSsid = "ProxiSwitch_" + deviceId;
+  mqttTopicPrefix = "proxiswitch/" + deviceId;
+}
+
+/**
+ * Gives the BLE task the paired address as the radio reports it, and
+ * the max near RSSI, so that it can stamp the paired device's near
+ * sightings without making a string of every address it hears. Run
+ * whenever the pairing or the settings change; A new pairing starts
+ * its stamps afresh.
+ *
+ */
+void doWatchPairedDevice() {
+  uint8_t address[sizeof(pairedNative)] = { 0 };
+  bool isValid = Utils::parseMacAddress(settings.getParedAddress(), address); // <-- Not while unpaired, as "xx:xx:xx:xx:xx:xx"
+  int nearRssi = settings.getMaxNearRssi();
+
+  portENTER_CRITICAL(&sightingMux);
+  if (isValid != isPairedNative || memcmp(address, pairedNative, sizeof(pairedNative)) != 0) {
+    firstSightingMicros = 0LL;
+    lastSightingMicros = 0LL;
+  }
+  memcpy(pairedNative, address, sizeof(pairedNative));
+  isPairedNative = isValid;
+  pairedNearRssi = nearRssi;
+  portEXIT_CRITICAL(&sightingMux);
+}
+
+/**
+ * Adds the whole seconds the controlled device has been on since last
+ * logged to its time on. Run from a timer while it is on, so that a
+ * restart loses at most that long, and when it is turned off.
+ *
+ */
+void doLogOnTime() {
+  uint64_t seconds = (Clock::nowMillis() - onTimeLoggedMillis) / 1000ULL;
+  onTimeLoggedMillis += seconds * 1000ULL; // <-- The part second is left for next time
+  counterLog.add(COUNTER_ON_SECONDS, (uint32_t)seconds);
+}
+
+/**
+ * Brings the controlled device and the Close LED up to date after 
+ * the set of seen devices has changed.
+ * 
+ */
+void doHandlePresenceChange() {
+  doHandleOnOffSwitching();
+  doCheckForCloseDevice();
+  doCheckpointPresence();
+}
+
+/**
+ * Puts the paired device's presence back as it was checkpointed before
+ * a warm restart, so the controlled device can be turned back on before
+ * scanning has even started. The paired device is given the grace 
+ * period to be seen again before it expires, or as long as it is ever
+ * given, maxNotSeenMillis, where that is shorter.
+ *
+ */
+void doRestorePresence() {
+  WarmRestart::Presence presence;
+  uint8_t address[sizeof(presence.address)];
+  if (
+    !WarmRestart::restore(presence) 
+    || !Utils::parseMacAddress(settings.getParedAddress(), address) 
+    || memcmp(presence.address, address, sizeof(address)) != 0
+  ) {
+    return;
+  }
+  isWarmRestart = true;
+  if (!presence.isPresent) {
+    return;
+  }
+
+  uint64_t maxNotSeenMillis = settings.getMaxNotSeenMillis();
+  uint64_t longestAgoMillis = maxNotSeenMillis > WARM_GRACE_MILLIS ? maxNotSeenMillis - WARM_GRACE_MILLIS : 0ULL;
+  uint64_t seenAgoMillis = presence.seenAgoMillis < longestAgoMillis ? presence.seenAgoMillis : longestAgoMillis;
+  uint64_t nowMillis = presenceClock.nowMillis();
+  seenAgoMillis = seenAgoMillis < nowMillis ? seenAgoMillis : nowMillis; // <-- Not seen before the clock started
+
+  std::string paired = settings.getParedAddress().c_str();
+  seenDevices[paired] = nowMillis - seenAgoMillis;
+  seenRssis[paired] = presence.rssi;
+  settings.setOnState(true);
+  onTimeLoggedMillis = Clock::nowMillis();
+}
+
+/**
+ * Checkpoints the paired device's presence for doRestorePresence() to
+ * put back after a warm restart. Run whenever presence is brought up to
+ * date, which is after every scan.
+ *
+ */
+void doCheckpointPresence() {
+  std::string paired = settings.getParedAddress().c_str();
+  WarmRestart::Presence presence = {};
+  Utils::parseMacAddress(settings.getParedAddress(), presence.address); // <-- Left zeros while unpaired, which no pairing matches
+  presence.isPresent = settings.isOnState();
+
+  auto seen = seenDevices.find(paired);
+  auto rssi = seenRssis.find(paired);
+  if (seen != seenDevices.end()) {
+    presence.seenAgoMillis = (uint32_t)(presenceClock.nowMillis() - seen->second);
+  }
+  if (rssi != seenRssis.end()) {
+    presence.rssi = (int16_t)rssi->second;
+  }
+  WarmRestart::checkpoint(presence);
+}
+
+/**
+ * Used to update the controlledOnState so that it reflects the current
+ * proximity of the paired device.
+ * 
+ */
+void doDeterminePairedDeviceProximity() {
+  bool isSeen = seenDevices.count(settings.getParedAddress().c_str()) > 0;
+  uint32_t identity = Gossip::identityOf(settings.getParedAddress().c_str());
+
+  // When gossiping only the nearest switch turns its device on
+  bool isNearest = !settings.isGossip() || gossip.isNearest(identity, Clock::nowMillis());
+  if (settings.isOnState() != (isSeen && isNearest)) {
+    decisionMicros = Clock::nowMicros();
+  }
+  settings.setOnState(isSeen && isNearest);
+  gossip.setClaiming(identity, settings.isOnState());
+}
+
+/**
+ * This function handles the on/off switching of the controlled device
+ * such that the state of the device is made to match the desired state of the
+ * device.
+ * 
+ */
+void doHandleOnOffSwitching() {
+  doDeterminePairedDeviceProximity();
+
+  if (settings.isOnState() && digitalRead(CONTROLLED_DEVICE_PIN) == LOW) {
+    // Device is off but should be on; Turn it on
+    digitalWrite(CONTROLLED_DEVICE_PIN, HIGH);
+    doRecordLatency(true);
+    counterLog.add(COUNTER_RELAY_CYCLES);
+    onTimeLoggedMillis = Clock::nowMillis();
+    scheduler.startTimer(onTimeTimer, ON_TIME_LOG_MILLIS, ON_TIME_LOG_MILLIS);
+    eventStream.publish(STREAM_PRESENCE, 1);
+    doBroadcastGossip();
+    doCountPresenceChange();
+    doPublishMqtt("presence", "{\"present\":1,\"at\":%llu}", (unsigned long long)Clock::nowMillis());
+    #ifdef DEBUG
+      Serial.println(F("Device: ON!!!"));
+    #endif
+  } else if (!settings.isOnState() && digitalRead(CONTROLLED_DEVICE_PIN) == HIGH) {
+    // Device is on but should be off; Turn it off
+    digitalWrite(CONTROLLED_DEVICE_PIN, LOW);
+    doRecordLatency(false);
+    scheduler.stopTimer(onTimeTimer);
+    doLogOnTime();
+    eventStream.publish(STREAM_PRESENCE, 0);
+    doBroadcastGossip();
+    doCountPresenceChange();
+    doPublishMqtt("presence", "{\"present\":0,\"at\":%llu}", (unsigned long long)Clock::nowMillis());
+    #ifdef DEBUG
+      Serial.println(F("Device: OFF!!!"));
+    #endif
+  }
+}
+
+/**
+ * Counts a presence change for the fleet health, binning how long
+ * presence held before it.
+ * 
+ */
+void doCountPresenceChange() {
+  uint64_t now = Clock::nowMillis();
+  presenceChanges++;
+  dwellHistogram[HealthFrame::dwellBucket((uint32_t)((now - presenceChangedMillis) / 1000ULL))]++;
+  presenceChangedMillis = now;
+}
+
+/**
+ * Records how long the relay took to follow presence, just after it is
+ * switched: From the latest sighting to the decision, from the decision 
+ * to the pin, and from the first sighting to on or the last sighting to
+ * off. Stamps which weren't taken, as when presence was restored after
+ * a warm restart, are left out.
+ * 
+ * @param isOn - Whether the relay was switched on as bool.
+ */
+void doRecordLatency(bool isOn) {
+  int64_t gpioMicros = Clock::nowMicros();
+  portENTER_CRITICAL(&sightingMux);
+  int64_t firstMicros = firstSightingMicros;
+  int64_t lastMicros = lastSightingMicros;
+  firstSightingMicros = 0LL;
+  portEXIT_CRITICAL(&sightingMux);
+
+  if (decisionMicros != 0LL) {
+    decisionGpioMicros.record((uint32_t)(gpioMicros - decisionMicros));
+    if (lastMicros != 0LL && lastMicros <= decisionMicros) {
+      sightingDecisionMillis.record((uint32_t)((decisionMicros - lastMicros) / 1000LL));
+    }
+  }
+
+  if (isOn && firstMicros != 0LL) {
+    firstSightingOnMillis.record((uint32_t)((gpioMicros - firstMicros) / 1000LL));
+  } else if (!isOn && lastMicros != 0LL) {
+    lastSightingOffMillis.record((uint32_t)((gpioMicros - lastMicros) / 1000LL));
+  }
+  decisionMicros = 0LL;
+}
+
+/**
+ * Used to purge expired seen devices which are no longer considered
+ * to be in-range. Ages are measured in presence time, which does not
+ * advance while scanning is suspended, so time spent with WiFi on 
+ * never counts against a device.
+ * This is run periodically from a timer.
+ * 
+ */
+void doPurgeOldSeenDevices() {
+  // Purge seenDevices that are expired
+  int devCount = seenDevices.size();
+  if (devCount > 0 && !presenceClock.isPaused()) {
+    std::vector<std::string> purgeList;
+    uint64_t nowMillis = presenceClock.nowMillis();
+
+    // Locate expired devices which need purged
+    for (const auto& pair : seenDevices) {
+      if (nowMillis - pair.second > settings.getMaxNotSeenMillis()) {
+        purgeList.push_back(pair.first);
+      }
+    }
+
+    // Purge the identified expired devices
+    for (std::string id : purgeList) {
+      seenDevices.erase(id);
+      seenRssis.erase(id);
+      if (settings.getParedAddress().equalsIgnoreCase(String(id.c_str()))) {
+        portENTER_CRITICAL(&sightingMux);
+        firstSightingMicros = 0LL; // <-- Left without turning on, so the next arrival starts afresh
+        portEXIT_CRITICAL(&sightingMux);
+      }
+      #ifdef DEBUG
+        if (
+          settings.getParedAddress().equalsIgnoreCase(F("xx:xx:xx:xx:xx:xx")) 
+          || settings.getParedAddress().equalsIgnoreCase(String(id.c_str()))
+        ) { 
+          Serial.printf("Purged 'seen' device; device=[%s]\n", id.c_str());
+        }
+      #endif
+    }
+    if (!purgeList.empty()) {
+      doHandlePresenceChange();
+    }
+    purgeList.clear();
+  }
+}
+
+/**
+ * Resets the BlueTooth scan, which is done after WiFi has been on
+ * and whenever the scanning watchdog expires. Scanning 
+ * is restarted by doStartBTScan() once the reset wait has passed.
+ * 
+ */
+void doResetBTScan() {
+  scheduler.stopTimer(scanWatchdogTimer);
+  isScanning = false;
+
+  doConfigureBTScan();
+  scheduler.startTimer(scanRestartTimer, SCAN_RESET_WAIT_MILLIS);
+}
+
+/**
+ * Sets the BlueTooth scan up from scratch. At startup the scan is
+ * started straight after, there being nothing to wait out.
+ * 
+ */
+void doConfigureBTScan() {
+  scan = BLEDevice::getScan();
+  scan->clearResults();
+  scan->stop();
+  scan->setActiveScan(true);  //active scan uses more power, but get results faster
+  scan->setInterval(100);
+  scan->setWindow(99);  // less or equal setInterval value
+  // Duplicates stay filtered as the library would otherwise keep every one in its results
+  scan->setAdvertisedDeviceCallbacks(&proxyScanCallbacks, false);
+}
+
+/**
+ * Kicks off a BlueTooth scan and arms the scanning watchdog in
+ * case the scan never reports completion.
+ * 
+ * BlueTooth scanning is suspended while wifi is on to improve 
+ * stability, unless the settings page is streaming live events.
+ */
+void doStartBTScan() {
+  if (!isWifiIsOn || eventStream.getClientCount() > 0) {
+    if (isWifiOffTiming) {
+      wifiOffMicros = Clock::nowMicros() - wifiTransitionMicros;
+      isWifiOffTiming = false;
+    }
+    isScanning = true;
+    scan->start(5, handleBTScanComplete);
+    scheduler.startTimer(scanWatchdogTimer, SCAN_WATCHDOG_MILLIS);
+  }
+}
+
+/**
+ * Handles expiry of the scanning watchdog by resetting the scan.
+ * 
+ */
+void handleScanWatchdog() {
+  btScanWDExpos ++;
+  counterLog.add(COUNTER_SCAN_WATCHDOGS);
+  #ifdef DEBUG
+    Serial.println("WARN: BT Scan watchdog exipred!");
+  #endif
+  doResetBTScan();
+}
+
+/**
+ * Handles the scan complete event by recording the results then
+ * starting the next scan.
+ * 
+ */
+void handleScanCompleteEvent() {
+  scheduler.stopTimer(scanWatchdogTimer);
+  scansCompleted++;
+  handleBTScanResults(scan->getResults());
+  isScanning = false;
+
+  doHandlePresenceChange();
+  doStartBTScan();
+}
+
+/**
+ * This function is called from the BlueTooth stack's task when a 
+ * scan completes. The results are handled from the main loop.
+ * 
+ */
+void handleBTScanComplete(BLEScanResults results) {
+  scheduler.post(EVT_SCAN_COMPLETE);
+}
+
+/**
+ * Handles the learning task. The learning task allows
+ * for the device to identify and track the device which is nearest 
+ * to it at the time the learning is performed.
+ * 
+ */
+void doCheckLearnTask() {
+  if (triggerDeviceLearn && !isLearning) {
+    // Do start of learning tasks
+    ledMan.ledOn(LEARN_LED, LEARN_CALLER);
+    #ifdef DEBUG
+      Serial.println(F("Learning started..."));
+    #endif
+    isLearning = true;
+
+    // Wait to allow nearest discovery then pair with nearest
+    scheduler.startTimer(learnTimer, settings.getLearnDurationMillis());
+  }
+}
+
+/**
+ * Completes the learning task by pairing with the nearest device
+ * seen while learning.
+ * 
+ */
+void doCompleteLearnTask() {
+  if (isLearning) {
+    std::string nearestId = "";
+    int nearestRssi = -999;
+
+    // Check known devices for nearest
+    for (const auto& pair : seenDevices) {
+      if (String(nearestId.c_str()).isEmpty() || seenRssis[pair.first] > nearestRssi) {
+        nearestId = pair.first;
+        nearestRssi = seenRssis[pair.first];
+      }
+    }
+
+    // Pair with identified ID
+    if (!settings.getParedAddress().equalsIgnoreCase(String(nearestId.c_str()))) {
+      settings.setParedAddress(String(nearestId.c_str()));
+      doWatchPairedDevice();
+      doScheduleSettingsSave();
+      #ifdef DEBUG
+        Serial.printf("Learning Complete! Paired Device is '%s', with RSSI of: %d\n\n", nearestId.c_str(), nearestRssi);
+      #endif
+    } else {
+      #ifdef DEBUG
+        Serial.println(F("Learning Complete! Paired Device is same as previous!\n"));
+      #endif
+    }
+
+    // Do end of learning tasks
+    isLearning = false;
+    triggerDeviceLearn = false;
+
+    ledMan.ledOff(LEARN_LED, LEARN_CALLER);
+  }
+}
+
+/**
+ * Registers the routes of the web server. The server itself is only
+ * started while WiFi is on.
+ * 
+ */
+void doRegisterWebRoutes() {
+  for (size_t i = 0; i < WEB_ASSET_COUNT; i++) {
+    web.on(WEB_ASSETS[i].path, HTTP_GET, handleWebAsset);
+  }
+  web.on("/api/status", HTTP_GET, handleStatusApi);
+  web.on("/api/devices", HTTP_GET, handleDevicesApi);
+  web.on("/api/settings", HTTP_GET | HTTP_PUT | HTTP_POST, handleSettingsApi);
+  web.on("/api/schema", HTTP_GET, handleSchemaApi);
+  web.on("/api/profile", HTTP_GET, handleProfileApi);
+  web.on("/update", HTTP_POST, handleUpdateRequest, handleUpdateUpload);
+  web.onNotFound(handleWebAsset); // <-- Captive portal probes get the page
+
+  eventStream.onConnect(handleStreamConnect);
+  web.addHandler(&eventStream); // <-- Admits at most EventStream::MAX_CLIENTS itself
+}
+
+/**
+ * Admits a request if the server isn't already at its limit of open
+ * requests, otherwise answers it with a 503. This caps the memory the
+ * server's connections can use. The async server closes each connection
+ * once its response is sent, there is no keep-alive, so this is a cap on
+ * open connections too. The event stream's connections stay open, so they
+ * are capped apart from these, by the stream's own EventStream::MAX_CLIENTS
+ * slots. Called from the web server's task.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ * @param onDone - Also called once the request has gone, if given, as
+ * ArDisconnectHandler; A request has only the one disconnect handler.
+ * @param isRefusalSent - Whether to answer a refused request now, rather
+ * than once its body is in, as bool.
+ * 
+ * @return Returns true if admitted otherwise false as bool.
+ */
+bool doAdmitRequest(AsyncWebServerRequest *request, ArDisconnectHandler onDone, bool isRefusalSent) {
+  if (openRequests >= MAX_HTTP_REQUESTS) {
+    if (isRefusalSent) {
+      request->send(503, F("text/plain"), F("Busy"));
+    }
+    return false;
+  }
+
+  openRequests++;
+  request->onDisconnect([onDone]() {
+    openRequests--;
+    if (onDone) {
+      onDone();
+    }
+  });
+
+  return true;
+}
+
+/**
+ * Handles serving the static parts of the settings page. These are
+ * gzip compressed in flash at build time and sent as is with their
+ * ETag, so a browser which already has them is answered with a 304.
+ * Any unknown path is answered with the page itself so that captive 
+ * portal checks open it.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ */
+void handleWebAsset(AsyncWebServerRequest *request) {
+  if (!doAdmitRequest(request)) {
+    return;
+  }
+
+  const WebAsset *asset = findWebAsset(WEB_ASSETS, WEB_ASSET_COUNT, request->url().c_str());
+  if (asset == nullptr) {
+    asset = findWebAsset(WEB_ASSETS, WEB_ASSET_COUNT, "/");
+  }
+
+  AsyncWebServerResponse *response;
+  if (request->hasHeader(F("If-None-Match")) && request->getHeader(F("If-None-Match"))->value().equals(asset->etag)) {
+    response = request->beginResponse(304);
+  } else {
+    response = request->beginResponse_P(200, asset->contentType, asset->data, asset->length);
+    response->addHeader(F("Content-Encoding"), F("gzip"));
+  }
+  response->addHeader(F("ETag"), asset->etag);
+  response->addHeader(F("Cache-Control"), asset->cacheControl);
+  request->send(response);
+}
+
+/**
+ * Handles the status API, which reports the runtime state of the
+ * device.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ */
+void handleStatusApi(AsyncWebServerRequest *request) {
+  if (doAdmitRequest(request)) {
+    request->send(new JsonResponse(writeStatusJson));
+  }
+}
+
+/**
+ * Handles the devices API, which lists the seen devices a page at a
+ * time. The page is chosen with the 'offset' and 'limit' arguments.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ */
+void handleDevicesApi(AsyncWebServerRequest *request) {
+  if (!doAdmitRequest(request)) {
+    return;
+  }
+
+  long offset = request->hasParam(F("offset")) ? request->getParam(F("offset"))->value().toInt() : 0L;
+  long limit = request->hasParam(F("limit")) ? request->getParam(F("limit"))->value().toInt() : API_DEVICES_DEFAULT_LIMIT;
+
+  JsonResponse *response = new JsonResponse(writeDevicesJson);
+  response->getCursor().offset = offset < 0L ? 0L : offset;
+  response->getCursor().remaining = limit < 0L ? 0L : (limit > API_DEVICES_MAX_LIMIT ? API_DEVICES_MAX_LIMIT : limit);
+  request->send(response);
+}
+
+/**
+ * Handles the settings API. A GET reports the current settings, a
+ * PUT (or the page's POST) updates them first and reports the result 
+ * in 'message'.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ */
+void handleSettingsApi(AsyncWebServerRequest *request) {
+  if (!doAdmitRequest(request)) {
+    return;
+  }
+
+  if (request->method() == HTTP_PUT || request->method() == HTTP_POST) {
+    Scheduler::Guard guard(scheduler);
+    handleSettingsPost(request);
+  }
+  request->send(new JsonResponse(writeSettingsJson));
+}
+
+/**
+ * Handles the settings schema API, which describes each setting the
+ * settings API reports and takes.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ */
+void handleSchemaApi(AsyncWebServerRequest *request) {
+  if (!doAdmitRequest(request)) {
+    return;
+  }
+
+  request->send(new JsonResponse(writeSchemaJson));
+}
+
+/**
+ * Handles the profile API, which lists the CPU cycles each of the
+ * loop's handlers has taken. Without profiling built in it answers
+ * 404 in JSON rather than falling through to the page.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ */
+void handleProfileApi(AsyncWebServerRequest *request) {
+  if (!doAdmitRequest(request)) {
+    return;
+  }
+
+  #ifdef LOOP_PROFILE
+    request->send(new JsonResponse(writeProfileJson));
+  #else
+    request->send(404, F("application/json"), F("{\"message\":\"Profiling is not built in\"}"));
+  #endif
+}
+
+/**
+ * Called from the web server's task with each piece of an uploaded 
+ * firmware image, which is written to flash as it arrives. The request
+ * that begins the update owns it; Pieces from any other request are
+ * dropped, and the update is abandoned should its owner go away before
+ * the last piece. The request is admitted as its first piece arrives, 
+ * before anything is allocated or written, and one refused is answered
+ * once its upload is in.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ * @param filename - The uploaded file's name as const String&.
+ * @param index - Where in the upload the piece starts as size_t.
+ * @param data - The piece as uint8_t*.
+ * @param length - The length of the piece as size_t.
+ * @param isFinal - Whether this is the last piece as bool.
+ */
+void handleUpdateUpload(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data, size_t length, bool isFinal) {
+  if (index == 0) {
+    if (!doAdmitRequest(request, [request]() { ota.abandon(request); }, false) || !ota.begin(request)) {
+      return;
+    }
+  }
+  if (!ota.isOwner(request)) {
+    return;
+  }
+  if (ota.receive(data, length) && isFinal) {
+    ota.end();
+  }
+}
+
+/**
+ * Handles the firmware update once its upload is complete, reporting
+ * the result and, if the update was installed, restarting into it. A
+ * request that doesn't own the update is refused with a 409, or a 503 
+ * if its upload was refused for the server being at its limit.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ */
+void handleUpdateRequest(AsyncWebServerRequest *request) {
+  if (!ota.isOwner(request)) {
+    if (ota.isBusy()) {
+      request->send(409, F("application/json"), F("{\"message\":\"Update refused: Another is in progress\"}"));
+    } else if (request->hasParam(F("firmware"), true, true)) {
+      request->send(503, F("text/plain"), F("Busy")); // <-- Uploaded, but refused as it began
+    } else {
+      request->send(400, F("application/json"), F("{\"message\":\"Update failed: No firmware was uploaded\"}"));
+    }
+    return;
+  }
+
+  // Admitted as its upload began
+  if (ota.isInstalled()) {
+    Scheduler::Guard guard(scheduler);
+    scheduler.startTimer(otaRestartTimer, OTA_RESTART_WAIT_MILLIS);
+  }
+  request->send(new JsonResponse(writeUpdateJson));
+}
+
+/**
+ * Writes the firmware update's result, all in one step.
+ * 
+ * @param json - The writer as JsonWriter&.
+ * @param cursor - The place in the document as JsonResponse::Cursor&.
+ * 
+ * @return Returns true if there are more steps otherwise false as bool.
+ */
+bool writeUpdateJson(JsonWriter &json, JsonResponse::Cursor &cursor) {
+  String message = ota.isInstalled() 
+    ? String(F("Update installed; Restarting...")) 
+    : String(F("Update failed: ")) + ota.getResult();
+
+  json.beginObject()
+    .field("message", message.c_str())
+    .endObject();
+
+  return false;
+}
+
+/**
+ * Writes the status API's document; The device and its counters, the
+ * loop and the services on the network, the other services, how long
+ * the relay takes to follow presence, then how long starting up took, 
+ * a step each.
+ * 
+ * @param json - The writer as JsonWriter&.
+ * @param cursor - The place in the document as JsonResponse::Cursor&.
+ * 
+ * @return Returns true if there are more steps otherwise false as bool.
+ */
+bool writeStatusJson(JsonWriter &json, JsonResponse::Cursor &cursor) {
+  Scheduler::Guard guard(scheduler);
+
+  if (cursor.step == 0UL) {
+    uint64_t uptimeMillis = Clock::nowMillis() - startedMillis;
+    json.beginObject()
+      .field("version", FIRMWARE_VERSION)
+      .field("uptime", Utils::userFriendlyElapsedTime(uptimeMillis).c_str())
+      .field("uptime_ms", uptimeMillis)
+      .field("warm_restart", isWarmRestart)
+      .field("startups", startups)
+      .field("scan_watchdogs", btScanWDExpos)
+      .field("scan_watchdogs_total", counterLog.get(COUNTER_SCAN_WATCHDOGS))
+      .field("relay_cycles", counterLog.get(COUNTER_RELAY_CYCLES))
+      .field("on_time", Utils::userFriendlyElapsedTime(counterLog.get(COUNTER_ON_SECONDS) * 1000ULL).c_str())
+      .field("counter_log", counterLog.isReady())
+      .field("free_heap", ESP.getFreeHeap())
+      .field("seen_devices", seenDevices.size())
+      .field("seen_rssis", seenRssis.size())
+      .field("on_state", settings.isOnState())
+      .field("learning", isLearning)
+      .field("scanning", isScanning);
+
+    return true;
+  }
+
+  if (cursor.step == 1UL) {
+    uint64_t statsMicros = scheduler.getStatsMicros();
+    json.key("loop_rate").value(statsMicros == 0ULL ? 0.0 : scheduler.getIterations() * 1000000.0 / statsMicros, 1);
+    json.key("loop_idle").value(statsMicros == 0ULL ? 0.0 : scheduler.getIdleMicros() * 100.0 / statsMicros, 1);
+    json.field("loop_worst", scheduler.getWorstHandlerMicros());
+
+    CaptiveDns::Stats dnsStats = captiveDns.getStats();
+    json.field("dns_queries", dnsStats.queries)
+      .field("dns_fast_answers", dnsStats.fastAnswers)
+      .field("dns_dropped", dnsStats.dropped)
+      .field("dns_avg_us", dnsStats.queries == 0UL ? 0ULL : dnsStats.totalMicros / dnsStats.queries)
+      .field("dns_worst_us", dnsStats.worstMicros)
+      .field("wifi_on_ms", wifiOnMicros / 1000LL)
+      .field("wifi_off_ms", wifiOffMicros / 1000LL);
+
+    MqttPublisher::Stats mqttStats = mqtt.getStats();
+    json.field("sta_connected", WiFi.status() == WL_CONNECTED)
+      .field("mqtt_connected", mqttStats.isConnected)
+      .field("mqtt_published", mqttStats.published)
+      .field("mqtt_depth", mqttStats.depth)
+      .field("mqtt_dropped", mqttStats.dropped)
+      .field("mqtt_avg_us", mqttStats.published == 0UL ? 0ULL : mqttStats.totalLatencyMicros / mqttStats.published)
+      .field("mqtt_worst_us", mqttStats.worstLatencyMicros);
+
+    return true;
+  }
+
+  if (cursor.step == 2UL) {
+    Gossip::Stats gossipStats = gossip.getStats();
+    json.field("gossip_peers", gossip.getPeerCount(Clock::nowMillis()))
+      .field("gossip_sent", gossipStats.sent)
+      .field("gossip_received", gossipStats.received)
+      .field("gossip_rejected", gossipStats.rejected + espNow.getDroppedFrames())
+      .field("gossip_nearest", gossip.isNearest(Gossip::identityOf(settings.getParedAddress().c_str()), Clock::nowMillis()));
+
+    AdvertProxy::Stats proxyStats = advertProxy.getStats();
+    json.field("proxy_connected", proxyStats.isConnected)
+      .field("proxy_adverts", proxyStats.adverts)
+      .field("proxy_merged", proxyStats.merged)
+      .field("proxy_batches", proxyStats.sentBatches)
+      .field("proxy_bytes", proxyStats.sentBytes)
+      .field("proxy_depth", proxyStats.depth)
+      .field("proxy_dropped", proxyStats.droppedAdverts);
+
+    OtaUpdater::Stats otaStats = ota.getStats();
+    json.field("firmware_trial", OtaUpdater::isTrialBoot())
+      .field("ota_result", ota.getResult())
+      .field("ota_received", otaStats.received)
+      .field("ota_written", otaStats.written)
+      .field("ota_ms", otaStats.micros / 1000UL);
+
+    return true;
+  }
+
+  if (cursor.step == 3UL) {
+    writeHistogramJson(json, "sighting_decision_ms", sightingDecisionMillis);
+    writeHistogramJson(json, "decision_gpio_us", decisionGpioMicros);
+    writeHistogramJson(json, "first_sighting_on_ms", firstSightingOnMillis);
+    writeHistogramJson(json, "last_sighting_off_ms", lastSightingOffMillis);
+
+    return true;
+  }
+
+  // Each phase of starting up, then when scanning first started, from the start of the app
+  json.key("boot_ms").beginObject();
+  for (uint8_t i = 0; i < bootProfiler.getCount(); i++) {
+    json.key(bootProfiler.getPhase(i).name).value(bootProfiler.getPhaseMicros(i) / 1000.0, 1);
+  }
+  json.endObject();
+  json.key("first_scan_ms").value(bootProfiler.getEndMicros("first_scan") / 1000.0, 1);
+  json.endObject();
+
+  return false;
+}
+
+/**
+ * Writes a histogram as an object of its count, minimum, median, 99th
+ * percentile and maximum.
+ * 
+ * @param json - The writer as JsonWriter&.
+ * @param name - The object's key as const char*.
+ * @param histogram - The histogram as LogHistogram&.
+ */
+void writeHistogramJson(JsonWriter &json, const char *name, LogHistogram &histogram) {
+  json.key(name).beginObject()
+    .field("count", histogram.getCount())
+    .field("min", histogram.getMin())
+    .field("p50", histogram.getPercentile(50))
+    .field("p99", histogram.getPercentile(99))
+    .field("max", histogram.getMax())
+    .endObject();
+}
+
+/**
+ * Writes the devices API's document; The header, then one device per
+ * step. The place is kept by device address so the list may change 
+ * between steps.
+ * 
+ * @param json - The writer as JsonWriter&.
+ * @param cursor - The place in the document as JsonResponse::Cursor&.
+ * 
+ * @return Returns true if there are more steps otherwise false as bool.
+ */
+bool writeDevicesJson(JsonWriter &json, JsonResponse::Cursor &cursor) {
+  Scheduler::Guard guard(scheduler);
+
+  if (cursor.step == 0UL) {
+    json.beginObject()
+      .field("total", seenDevices.size())
+      .field("offset", cursor.offset)
+      .field("limit", cursor.remaining)
+      .key("devices").beginArray();
+
+    return true;
+  }
+
+  auto device = seenDevices.end();
+  if (cursor.step == 1UL) {
+    device = seenDevices.begin();
+    for (long i = 0; i < cursor.offset && device != seenDevices.end(); i++) {
+      device++;
+    }
+  } else {
+    device = seenDevices.upper_bound(cursor.lastKey);
+  }
+
+  if (cursor.remaining <= 0L || device == seenDevices.end()) {
+    json.endArray()
+      .endObject();
+
+    return false;
+  }
+
+  auto rssi = seenRssis.find(device->first);
+  uint64_t ageMillis = presenceClock.nowMillis() - device->second;
+
+  json.beginObject()
+    .field("mac", device->first.c_str());
+  if (rssi == seenRssis.end()) {
+    json.key("rssi").nullValue();
+  } else {
+    json.field("rssi", rssi->second);
+  }
+  json.field("age_ms", ageMillis)
+    .field("present", ageMillis <= settings.getMaxNotSeenMillis())
+    .field("close", rssi != seenRssis.end() && rssi->second >= settings.getCloseRssi())
+    .field("paired", settings.getParedAddress().equalsIgnoreCase(device->first.c_str()))
+    .endObject();
+
+  strlcpy(cursor.lastKey, device->first.c_str(), sizeof(cursor.lastKey));
+  cursor.remaining--;
+
+  return true;
+}
+
+/**
+ * Writes the settings API's document; Any message from an update, 
+ * then one setting per step, each as its schema names it. Any message
+ * is reported once. Secrets are only given as <name>_set, true if one
+ * is set.
+ * 
+ * @param json - The writer as JsonWriter&.
+ * @param cursor - The place in the document as JsonResponse::Cursor&.
+ * 
+ * @return Returns true if there are more steps otherwise false as bool.
+ */
+bool writeSettingsJson(JsonWriter &json, JsonResponse::Cursor &cursor) {
+  Scheduler::Guard guard(scheduler);
+
+  if (cursor.step == 0UL) {
+    json.beginObject()
+      .field("message", settingsUpdateResult.c_str());
+    settingsUpdateResult = "";
+
+    return true;
+  }
+
+  uint8_t field = (uint8_t)(cursor.step - 1UL);
+  if (field >= Settings::FIELD_COUNT) {
+    json.endObject();
+
+    return false;
+  }
+
+  const Settings::FieldInfo &info = Settings::FIELDS[field];
+  if ((info.flags & Settings::FLAG_HIDDEN) != 0) {
+    return true;
+  }
+  if ((info.flags & Settings::FLAG_SECRET) != 0) {
+    // Secrets never leave the device; Only whether one is set
+    char name[32];
+    snprintf(name, sizeof(name), "%s_set", info.name);
+    json.field(name, settings.getText(field)[0] != '\0');
+  } else if (info.type == Settings::TYPE_TEXT) {
+    json.field(info.name, settings.getText(field));
+  } else {
+    json.field(info.name, settings.getNumber(field)); // <-- Bools as 1 or 0, as the form sends them
+  }
+
+  return true;
+}
+
+/**
+ * Writes the settings schema API's document, from which the settings
+ * page builds its form; One setting per step, in schema order.
+ * 
+ * @param json - The writer as JsonWriter&.
+ * @param cursor - The place in the document as JsonResponse::Cursor&.
+ * 
+ * @return Returns true if there are more steps otherwise false as bool.
+ */
+bool writeSchemaJson(JsonWriter &json, JsonResponse::Cursor &cursor) {
+  if (cursor.step == 0UL) {
+    json.beginObject()
+      .key("fields").beginArray();
+
+    return true;
+  }
+
+  uint8_t field = (uint8_t)(cursor.step - 1UL);
+  if (field >= Settings::FIELD_COUNT) {
+    json.endArray()
+      .endObject();
+
+    return false;
+  }
+
+  const Settings::FieldInfo &info = Settings::FIELDS[field];
+  if ((info.flags & Settings::FLAG_HIDDEN) != 0) {
+    return true;
+  }
+
+  static const char *const TYPE_NAMES[] = { "number", "number", "bool", "text" };
+  json.beginObject()
+    .field("name", info.name)
+    .field("label", info.label)
+    .field("type", TYPE_NAMES[info.type])
+    .field("min", info.minimum)
+    .field("max", info.maximum);
+  if (info.type == Settings::TYPE_TEXT) {
+    json.field("default", info.text);
+  } else {
+    json.field("default", info.number);
+  }
+  json.field("read_only", (info.flags & Settings::FLAG_READ_ONLY) != 0)
+    .field("secret", (info.flags & Settings::FLAG_SECRET) != 0)
+    .field("reboot", (info.flags & Settings::FLAG_REBOOT) != 0)
+    .field("section", (info.flags & Settings::FLAG_SECTION) != 0)
+    .endObject();
+
+  return true;
+}
+
+#ifdef LOOP_PROFILE
+  /**
+   * Writes the profile API's document; The header, then one handler
+   * per step, in the order they were registered. Cycles are of the CPU
+   * at cpu_mhz, since the last dump to Serial.
+   * 
+   * @param json - The writer as JsonWriter&.
+   * @param cursor - The place in the document as JsonResponse::Cursor&.
+   * 
+   * @return Returns true if there are more steps otherwise false as bool.
+   */
+  bool writeProfileJson(JsonWriter &json, JsonResponse::Cursor &cursor) {
+    Scheduler::Guard guard(scheduler);
+
+    if (cursor.step == 0UL) {
+      json.beginObject()
+        .field("cpu_mhz", ESP.getCpuFreqMHz())
+        .key("handlers").beginArray();
+
+      return true;
+    }
+
+    uint8_t profile = (uint8_t)(cursor.step - 1UL);
+    if (profile >= scheduler.getProfileCount()) {
+      json.endArray()
+        .endObject();
+
+      return false;
+    }
+
+    LogHistogram cycles = scheduler.getProfile(profile);
+    json.beginObject()
+      .field("name", scheduler.getProfileName(profile))
+      .field("count", cycles.getCount())
+      .field("min", cycles.getMin())
+      .field("p50", cycles.getPercentile(50))
+      .field("p99", cycles.getPercentile(99))
+      .field("max", cycles.getMax())
+      .endObject();
+
+    return true;
+  }
+
+  /**
+   * Prints the time each of the loop's handlers has taken to Serial,
+   * then starts the profiles afresh so that each dump, and the profile
+   * API between them, covers the time since the last. Run from a timer
+   * when profiling.
+   * 
+   */
+  void doDumpLoopProfile() {
+    float cyclesPerMicro = (float)ESP.getCpuFreqMHz();
+    Serial.println(F("Loop profile (us): handler count min p50 p99 max"));
+    for (uint8_t profile = 0; profile < scheduler.getProfileCount(); profile++) {
+      LogHistogram cycles = scheduler.getProfile(profile);
+      if (cycles.getCount() == 0UL) {
+        continue;
+      }
+      Serial.printf(
+        "  %-16s %8lu %9.1f %9.1f %9.1f %9.1f\n",
+        scheduler.getProfileName(profile),
+        (unsigned long)cycles.getCount(),
+        cycles.getMin() / cyclesPerMicro,
+        cycles.getPercentile(50) / cyclesPerMicro,
+        cycles.getPercentile(99) / cyclesPerMicro,
+        cycles.getMax() / cyclesPerMicro
+      );
+    }
+    scheduler.resetProfiles();
+  }
+#endif
+
+/**
+ * Called from the web server's task when a browser opens the live
+ * event stream; The stream is started from the loop.
+ * 
+ */
+void handleStreamConnect() {
+  scheduler.post(EVT_STREAM_CONNECT);
+}
+
+/**
+ * Handles a browser opening the live event stream, which sends 
+ * presence changes, paired device RSSI samples and close device 
+ * changes. Scanning is resumed while anyone is streaming so there 
+ * is something to see.
+ * 
+ */
+void handleStreamConnectEvent() {
+  if (!scheduler.isTimerActive(streamTimer)) {
+    scheduler.startTimer(streamTimer, STREAM_SERVICE_MILLIS, STREAM_SERVICE_MILLIS);
+  }
+  if (isWifiIsOn && !isScanning && !scheduler.isTimerActive(scanRestartTimer)) {
+    doResetBTScan();
+  }
+}
+
+/**
+ * Services the event stream; Run from a timer while there are any
+ * clients.
+ * 
+ */
+void handleStreamService() {
+  eventStream.service();
+  if (eventStream.getClientCount() == 0) {
+    scheduler.stopTimer(streamTimer);
+  }
+}
+
+/**
+ * Gets an argument of a form submitted in the request body, falling
+ * back to the query string.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ * @param name - The name of the argument as const char*.
+ * @param value - Set to its value as String&.
+ * 
+ * @return Returns true if given otherwise false as bool.
+ */
+bool doGetFormArg(AsyncWebServerRequest *request, const char *name, String &value) {
+  if (request->hasParam(name, true)) {
+    value = request->getParam(name, true)->value();
+    return true;
+  }
+  if (request->hasParam(name)) {
+    value = request->getParam(name)->value();
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * Handles the setting page when a POST method is made with 
+ * updates to the settings.
+ * The settings given are read and checked against the settings
+ * schema in one pass, and only if all are valid are they stored.
+ * Settings not given, and numbers left blank, are left as they are.
+ * As secrets aren't sent to the page, a secret left blank is left as
+ * it is too, unless it is asked to be cleared with <name>_clear=1.
+ * The WiFi or the station is then restarted if the changes need it.
+ * It must be called holding the scheduler's lock.
+ * 
+ * @param request - The request as AsyncWebServerRequest*.
+ */
+void handleSettingsPost(AsyncWebServerRequest *request) {
+  String values[Settings::FIELD_COUNT];
+  uint32_t givenFields = 0UL;
+  for (uint8_t field = 0; field < Settings::FIELD_COUNT; field++) {
+    const Settings::FieldInfo &info = Settings::FIELDS[field];
+    if ((info.flags & (Settings::FLAG_HIDDEN | Settings::FLAG_READ_ONLY)) != 0 || !doGetFormArg(request, info.name, values[field])) {
+      continue;
+    }
+    if (info.type != Settings::TYPE_TEXT && values[field].isEmpty()) {
+      continue;
+    }
+    if ((info.flags & Settings::FLAG_SECRET) != 0 && values[field].isEmpty()) {
+      char name[32];
+      String clear;
+      snprintf(name, sizeof(name), "%s_clear", info.name);
+      if (!doGetFormArg(request, name, clear) || !clear.equals("1")) {
+        continue;
+      }
+    }
+    if (!settings.isAcceptable(field, values[field])) {
+      settingsUpdateResult = String(FAILED) + " " + info.label + " (" + values[field] + ")";
+      return;
+    }
+    givenFields |= 1UL << field;
+  }
+
+  bool isChanged = false;
+  uint8_t changeFlags = 0; // <-- What the changes take to apply
+  for (uint8_t field = 0; field < Settings::FIELD_COUNT; field++) {
+    if ((givenFields & (1UL << field)) != 0UL && settings.setFromText(field, values[field])) {
+      isChanged = true;
+      changeFlags |= Settings::FIELDS[field].flags;
+      if (field == Settings::FIELD_GOSSIP_MARGIN_DB) {
+        gossip.setMargin((uint8_t)settings.getGossipMarginDb());
+      }
+    }
+  }
+
+  if (isChanged) {
+    doConfigureButton();
+    doWatchPairedDevice();
+    doScheduleSettingsSave();
+    settingsUpdateResult = String(SUCCESSFUL);
+    #ifdef DEBUG
+      Serial.println(F("Settings Updated!"));
+    #endif
+    
+    if ((changeFlags & Settings::FLAG_STATION) != 0) {
+      scheduler.post(EVT_STATION_CHANGE);
+    }
+
+    if ((changeFlags & Settings::FLAG_REBOOT) != 0) {
+      settingsUpdateResult = String(REBOOT);
+      #ifdef DEBUG
+        Serial.println(F("Shutting down WiFi to force settings update."));
+      #endif
+      triggerWifiIsOn = false;
+      scheduler.post(EVT_WIFI_CHANGE);
     }
   }
 }
@@ -762,6 +2373,23 @@ void handleBTScanResults(BLEScanResults results) {
 
     String btAddress = String(device.getAddress().toString().c_str());
     int rssi = device.getRSSI();
+
+    if (settings.getParedAddress().equalsIgnoreCase(btAddress)) {
+      // Sampled even when out of range to help tune thresholds
+      eventStream.publish(STREAM_RSSI, rssi);
+
+      if (rssiSummary.samples == 0UL || rssi < rssiSummary.min) {
+        rssiSummary.min = rssi;
+      }
+      if (rssiSummary.samples == 0UL || rssi > rssiSummary.max) {
+        rssiSummary.max = rssi;
+      }
+      rssiSummary.last = rssi;
+      rssiSummary.samples++;
+
+      gossip.recordLocal(Gossip::identityOf(btAddress.c_str()), rssi, Clock::nowMillis());
+      rssiHistogram[HealthFrame::rssiBucket(rssi)]++;
+    }
     
     if (rssi > settings.getMaxNearRssi()) {
       // Saw a device that is in-range
@@ -770,14 +2398,14 @@ void handleBTScanResults(BLEScanResults results) {
         #ifdef DEBUG
           Serial.printf("Near device; device=[%s]; rssid=[%d]\n", btAddress.c_str(), rssi);
         #endif
-        seenDevices[btAddress.c_str()] = millis();
+        seenDevices[btAddress.c_str()] = presenceClock.nowMillis();
         seenRssis[btAddress.c_str()] = rssi;
       } else if (settings.getParedAddress().equalsIgnoreCase(btAddress)) {
         // Only record device being tracked
         #ifdef DEBUG
           Serial.printf("Device Checked In! DeviceID=[%s]; RSSI=[%d];\n", btAddress.c_str(), rssi);
         #endif
-        seenDevices[btAddress.c_str()] = millis();
+        seenDevices[btAddress.c_str()] = presenceClock.nowMillis();
         seenRssis[btAddress.c_str()] = rssi;
       }
     } else {
@@ -792,6 +2420,4 @@ void handleBTScanResults(BLEScanResults results) {
       #endif
     }
   }
-
-  isScanning = false;
 }
\ No newline at end of file
@@ -0,0 +1,231 @@
+/*
+  bench - Benchmarks the BLE proxy's batch encoding on a synthetic workload.
+
+  Simulates a room of advertisers, each repeating its advertisement at its own
+  interval with now and then a changed payload, and feeds what a switch would
+  hear through AdvertBatch the way AdvertProxy does, sealing a batch when it
+  fills or its window passes. Reports how fast advertisements are encoded and
+  decoded, how many are merged, and bytes per advertisement against sending
+  each one unbatched (address, RSSI, a four byte time, length and payload).
+  With --host the batches are also sent, paced in real time, as UDP datagrams
+  to a receiver.
+
+  Usage:
+    bench [--devices 40] [--seconds 60] [--interval 100] [--window 1000]
+          [--host 127.0.0.1 --port 47778]
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <AdvertBatch.h>
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <random>
+#include <vector>
+
+#define FRAME_SIZE 1400
+#define UNBATCHED_OVERHEAD (6 + 1 + 4 + 1)
+
+struct Advertiser {
+    uint8_t address[6];
+    bool isRandom;
+    int rssi;
+    uint32_t intervalMillis;
+    uint32_t nextMillis;
+    uint8_t payload[AdvertBatch::MAX_PAYLOAD];
+    uint8_t payloadLength;
+};
+
+struct Heard {
+    uint32_t millis;
+    size_t advertiser;
+    int rssi;
+};
+
+static double nowSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void countEntry(const AdvertBatch::Advert &advert, void *context) {
+    *(uint64_t *)context += advert.count;
+}
+
+int main(int argc, char **argv) {
+    int deviceCount = 40;
+    double seconds = 60.0;
+    uint32_t meanIntervalMillis = 100UL;
+    uint32_t windowMillis = 1000UL;
+    const char *host = nullptr;
+    uint16_t port = 47778;
+
+    const struct option longOptions[] = {
+        { "devices", required_argument, nullptr, 'd' },
+        { "seconds", required_argument, nullptr, 's' },
+        { "interval", required_argument, nullptr, 'i' },
+        { "window", required_argument, nullptr, 'w' },
+        { "host", required_argument, nullptr, 'h' },
+        { "port", required_argument, nullptr, 'p' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+        switch (option) {
+            case 'd': deviceCount = atoi(optarg); break;
+            case 's': seconds = atof(optarg); break;
+            case 'i': meanIntervalMillis = (uint32_t)atoi(optarg); break;
+            case 'w': windowMillis = (uint32_t)atoi(optarg); break;
+            case 'h': host = optarg; break;
+            case 'p': port = (uint16_t)atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: bench [--devices N] [--seconds S] [--interval MILLIS] [--window MILLIS] [--host ADDR --port N]\n");
+                return 2;
+        }
+    }
+    if (deviceCount <= 0 || seconds <= 0.0 || meanIntervalMillis == 0 || windowMillis == 0) {
+        return 2;
+    }
+
+    // Build the room; Beacons, trackers with random addresses and a few chatty sensors
+    std::mt19937 random(4242);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::vector<Advertiser> advertisers(deviceCount);
+    for (Advertiser &advertiser : advertisers) {
+        for (uint8_t &octet : advertiser.address) {
+            octet = (uint8_t)random();
+        }
+        advertiser.isRandom = chance(random) < 0.6;
+        advertiser.rssi = -95 + (int)(chance(random) * 60.0);
+        advertiser.intervalMillis = (uint32_t)(meanIntervalMillis * (0.5 + chance(random)));
+        advertiser.nextMillis = (uint32_t)(chance(random) * advertiser.intervalMillis);
+        advertiser.payloadLength = (uint8_t)(chance(random) < 0.3 ? 62 : 20 + random() % 12);
+        for (uint8_t i = 0; i < advertiser.payloadLength; i++) {
+            advertiser.payload[i] = (uint8_t)random();
+        }
+    }
+
+    // Work out what is heard up front so only encoding is timed
+    std::vector<Heard> heard;
+    uint64_t unbatchedBytes = 0ULL;
+    uint32_t endMillis = (uint32_t)(seconds * 1000.0);
+    for (uint32_t millis = 0; millis < endMillis; millis++) {
+        for (size_t i = 0; i < advertisers.size(); i++) {
+            Advertiser &advertiser = advertisers[i];
+            if (millis < advertiser.nextMillis) {
+                continue;
+            }
+            advertiser.nextMillis = millis + advertiser.intervalMillis;
+            if (chance(random) < 0.1) {
+                continue; // <-- Missed by the radio
+            }
+            heard.push_back({ millis, i, advertiser.rssi + (int)(chance(random) * 8.0) - 4 });
+            unbatchedBytes += UNBATCHED_OVERHEAD + advertiser.payloadLength;
+        }
+    }
+
+    int fd = -1;
+    struct sockaddr_in target = {};
+    if (host != nullptr) {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        target.sin_family = AF_INET;
+        target.sin_port = htons(port);
+        if (fd < 0 || inet_pton(AF_INET, host, &target.sin_addr) != 1) {
+            fprintf(stderr, "bad host %s\n", host);
+            return 1;
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<uint32_t> sealedMillis;
+    uint8_t buffer[FRAME_SIZE];
+    AdvertBatch batch;
+    uint16_t sequence = 0;
+    uint64_t merged = 0ULL;
+    uint32_t openedMillis = 0UL;
+    batch.begin(buffer, sizeof(buffer), 0x5A000001UL, sequence++, openedMillis);
+
+    double start = nowSeconds();
+    for (const Heard &advert : heard) {
+        Advertiser &advertiser = advertisers[advert.advertiser];
+        if (advert.millis - openedMillis >= windowMillis && batch.getEntryCount() > 0) {
+            frames.push_back(std::vector<uint8_t>(buffer, buffer + batch.getLength()));
+            sealedMillis.push_back(advert.millis);
+            openedMillis = advert.millis;
+            batch.begin(buffer, sizeof(buffer), 0x5A000001UL, sequence++, openedMillis);
+        }
+
+        AdvertBatch::Result result = batch.add(advertiser.address, advertiser.isRandom, advert.rssi, advertiser.payload, advertiser.payloadLength, advert.millis);
+        if (result == AdvertBatch::FULL) {
+            frames.push_back(std::vector<uint8_t>(buffer, buffer + batch.getLength()));
+            sealedMillis.push_back(advert.millis);
+            openedMillis = advert.millis;
+            batch.begin(buffer, sizeof(buffer), 0x5A000001UL, sequence++, openedMillis);
+            result = batch.add(advertiser.address, advertiser.isRandom, advert.rssi, advertiser.payload, advertiser.payloadLength, advert.millis);
+        }
+        if (result == AdvertBatch::MERGED) {
+            merged++;
+        }
+
+        // Now and then an advertiser changes what it says
+        if (chance(random) < 0.02) {
+            advertiser.payload[advertiser.payloadLength - 1]++;
+        }
+    }
+    if (batch.getEntryCount() > 0) {
+        frames.push_back(std::vector<uint8_t>(buffer, buffer + batch.getLength()));
+        sealedMillis.push_back(endMillis);
+    }
+    double encodeSeconds = nowSeconds() - start;
+
+    uint64_t batchedBytes = 0ULL;
+    uint64_t decodedAdverts = 0ULL;
+    start = nowSeconds();
+    for (const std::vector<uint8_t> &frame : frames) {
+        uint32_t node = 0;
+        uint16_t frameSequence = 0;
+        if (!AdvertBatch::decode(frame.data(), frame.size(), node, frameSequence, countEntry, &decodedAdverts)) {
+            fprintf(stderr, "decode failed\n");
+            return 1;
+        }
+        batchedBytes += frame.size();
+    }
+    double decodeSeconds = nowSeconds() - start;
+
+    printf("devices=%d seconds=%.0f window_ms=%u adverts=%zu adverts_per_sec=%.0f batches=%zu merged=%.1f%%\n",
+        deviceCount, seconds, windowMillis, heard.size(), heard.size() / seconds, frames.size(),
+        heard.empty() ? 0.0 : 100.0 * merged / heard.size());
+    printf("encode=%.0f ns/advert (%.2f M/s) decode=%.0f ns/advert\n",
+        1e9 * encodeSeconds / heard.size(), heard.size() / encodeSeconds / 1e6, 1e9 * decodeSeconds / heard.size());
+    printf("bytes_per_advert batched=%.2f unbatched=%.2f saving=%.1f%% decoded_ok=%s\n",
+        (double)batchedBytes / heard.size(), (double)unbatchedBytes / heard.size(),
+        100.0 - 100.0 * batchedBytes / unbatchedBytes, decodedAdverts == heard.size() ? "yes" : "NO");
+
+    if (fd >= 0) {
+        double sendStart = nowSeconds();
+        for (size_t i = 0; i < frames.size(); i++) {
+            double due = sendStart + sealedMillis[i] / 1000.0;
+            double now = nowSeconds();
+            if (due > now) {
+                usleep((useconds_t)((due - now) * 1e6));
+            }
+            sendto(fd, frames[i].data(), frames[i].size(), 0, (struct sockaddr *)&target, sizeof(target));
+        }
+        printf("sent %zu batches to %s:%u\n", frames.size(), host, port);
+        close(fd);
+    }
+
+    return decodedAdverts == heard.size() ? 0 : 1;
+}
@@ -0,0 +1,258 @@
+/*
+  receiver - Receives the advertisement batches sent by switches in BLE proxy mode.
+
+  Listens on UDP, or with --tcp for length prefixed batches over TCP, decodes
+  each batch with the firmware's own AdvertBatch and once a second prints the
+  advertisements and batches received per second, bytes on the wire per
+  advertisement, batches missed going by each switch's sequence and any that
+  failed to decode. With --print every entry is printed as it arrives.
+
+  Usage:
+    receiver [--port 47778] [--tcp] [--print]
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <AdvertBatch.h>
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <map>
+#include <vector>
+
+struct Totals {
+    uint64_t batches;
+    uint64_t entries;
+    uint64_t adverts;
+    uint64_t bytes;
+    uint64_t missed;
+    uint64_t malformed;
+};
+
+struct Connection {
+    int fd;
+    std::vector<uint8_t> pending;
+};
+
+static volatile sig_atomic_t isStopping = 0;
+static bool isPrinting = false;
+static Totals totals = {};
+static std::map<uint32_t, uint16_t> lastSequences;
+
+static void handleSignal(int) {
+    isStopping = 1;
+}
+
+static double nowSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Counts, and when asked prints, one decoded entry.
+ *
+ * @param advert - The entry as const AdvertBatch::Advert&.
+ * @param context - The sending switch's id as void*.
+ */
+static void countEntry(const AdvertBatch::Advert &advert, void *context) {
+    totals.entries++;
+    totals.adverts += advert.count;
+
+    if (isPrinting) {
+        uint32_t node = *(const uint32_t *)context;
+        printf("%08x %02x:%02x:%02x:%02x:%02x:%02x%s rssi=%d count=%u t=%u ",
+            node,
+            advert.address[0], advert.address[1], advert.address[2],
+            advert.address[3], advert.address[4], advert.address[5],
+            advert.isRandom ? "/r" : "", advert.rssi, advert.count, advert.millis);
+        for (uint8_t i = 0; i < advert.payloadLength; i++) {
+            printf("%02x", advert.payload[i]);
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * Decodes one batch, counting it and any batches missed before it.
+ *
+ * @param frame - The batch as const uint8_t*.
+ * @param length - The length of the batch as size_t.
+ */
+static void receiveBatch(const uint8_t *frame, size_t length) {
+    uint32_t node = 0;
+    uint16_t sequence = 0;
+    if (!AdvertBatch::decode(frame, length, node, sequence, countEntry, &node)) {
+        totals.malformed++;
+        return;
+    }
+
+    totals.batches++;
+    totals.bytes += length;
+
+    std::map<uint32_t, uint16_t>::iterator last = lastSequences.find(node);
+    if (last != lastSequences.end()) {
+        uint16_t gap = (uint16_t)(sequence - last->second);
+        if (gap > 1 && gap < 0x8000) {
+            totals.missed += gap - 1;
+        }
+    }
+    lastSequences[node] = sequence;
+}
+
+/**
+ * Takes whole length prefixed batches off the front of a TCP
+ * connection's pending bytes.
+ *
+ * @param connection - The connection as Connection&.
+ */
+static void receiveStream(Connection &connection) {
+    size_t offset = 0;
+    while (connection.pending.size() - offset >= 2) {
+        size_t length = ((size_t)connection.pending[offset] << 8) | connection.pending[offset + 1];
+        if (connection.pending.size() - offset - 2 < length) {
+            break;
+        }
+        receiveBatch(connection.pending.data() + offset + 2, length);
+        offset += 2 + length;
+    }
+    connection.pending.erase(connection.pending.begin(), connection.pending.begin() + offset);
+}
+
+int main(int argc, char **argv) {
+    uint16_t port = 47778;
+    bool isTcp = false;
+
+    const struct option longOptions[] = {
+        { "port", required_argument, nullptr, 'p' },
+        { "tcp", no_argument, nullptr, 't' },
+        { "print", no_argument, nullptr, 'v' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+        switch (option) {
+            case 'p': port = (uint16_t)atoi(optarg); break;
+            case 't': isTcp = true; break;
+            case 'v': isPrinting = true; break;
+            default:
+                fprintf(stderr, "usage: receiver [--port N] [--tcp] [--print]\n");
+                return 2;
+        }
+    }
+
+    int listenFd = socket(AF_INET, isTcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    int bufferSize = 4 << 20;
+    setsockopt(listenFd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(listenFd, (struct sockaddr *)&address, sizeof(address)) != 0 || (isTcp && listen(listenFd, 16) != 0)) {
+        perror("bind");
+        return 1;
+    }
+
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+    fprintf(stderr, "listening on %s port %u\n", isTcp ? "TCP" : "UDP", port);
+
+    std::vector<Connection> connections;
+    uint8_t buffer[65536];
+    Totals reported = {};
+    double start = nowSeconds();
+    double lastReport = start;
+
+    while (!isStopping) {
+        std::vector<struct pollfd> polled;
+        polled.push_back({ listenFd, POLLIN, 0 });
+        for (const Connection &connection : connections) {
+            polled.push_back({ connection.fd, POLLIN, 0 });
+        }
+        int ready = poll(polled.data(), polled.size(), 200);
+
+        if (ready > 0 && (polled[0].revents & POLLIN) != 0) {
+            if (isTcp) {
+                int fd = accept(listenFd, nullptr, nullptr);
+                if (fd >= 0) {
+                    connections.push_back({ fd, {} });
+                }
+            } else {
+                ssize_t length;
+                while ((length = recv(listenFd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+                    receiveBatch(buffer, (size_t)length);
+                }
+            }
+        }
+
+        for (size_t i = 1; ready > 0 && i < polled.size(); i++) {
+            if (polled[i].revents == 0) {
+                continue;
+            }
+            Connection &connection = connections[i - 1];
+            ssize_t length = recv(connection.fd, buffer, sizeof(buffer), 0);
+            if (length <= 0) {
+                close(connection.fd);
+                connection.fd = -1;
+                continue;
+            }
+            connection.pending.insert(connection.pending.end(), buffer, buffer + length);
+            receiveStream(connection);
+        }
+        for (size_t i = connections.size(); i > 0; i--) {
+            if (connections[i - 1].fd < 0) {
+                connections.erase(connections.begin() + (i - 1));
+            }
+        }
+
+        double now = nowSeconds();
+        if (now - lastReport >= 1.0) {
+            double elapsed = now - lastReport;
+            uint64_t adverts = totals.adverts - reported.adverts;
+            uint64_t bytes = totals.bytes - reported.bytes;
+            printf("adverts=%.0f/s entries=%.0f/s batches=%.0f/s bytes_per_advert=%.2f missed=%llu malformed=%llu nodes=%zu\n",
+                adverts / elapsed,
+                (totals.entries - reported.entries) / elapsed,
+                (totals.batches - reported.batches) / elapsed,
+                adverts == 0 ? 0.0 : (double)bytes / adverts,
+                (unsigned long long)totals.missed,
+                (unsigned long long)totals.malformed,
+                lastSequences.size());
+            fflush(stdout);
+            reported = totals;
+            lastReport = now;
+        }
+    }
+
+    printf("total adverts=%llu entries=%llu batches=%llu bytes=%llu bytes_per_advert=%.2f missed=%llu malformed=%llu\n",
+        (unsigned long long)totals.adverts,
+        (unsigned long long)totals.entries,
+        (unsigned long long)totals.batches,
+        (unsigned long long)totals.bytes,
+        totals.adverts == 0 ? 0.0 : (double)totals.bytes / totals.adverts,
+        (unsigned long long)totals.missed,
+        (unsigned long long)totals.malformed);
+
+    for (const Connection &connection : connections) {
+        close(connection.fd);
+    }
+    close(listenFd);
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*
+  button_check - Host test of the Button's debounce filter and gesture state
+  machine.
+
+  Feeds the firmware's own Button sequences of raw edges with feedEdge(), at
+  virtual times, and polls it as the firmware does: when an edge is fed, as the
+  interrupt's notifier would have it, and whenever nextWakeMicros() asks. The
+  events it gives, and when, are checked against what each sequence should give:
+
+    - a press and release, with and without waiting for a double press;
+    - a bouncing press and a glitch shorter than the debounce time;
+    - holds past one, two and all three thresholds;
+    - a double press, and a tap followed by a hold, which must still report each
+      threshold passed and its release, with and without double presses;
+    - a burst of edges overflowing the queue, which must leave the button at
+      its final level.
+
+  Usage:
+    button_check
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <Button.h>
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+int64_t virtualMicros = 0LL;
+
+static const uint32_t DEBOUNCE_MILLIS = 30UL;
+static const uint32_t DOUBLE_GAP_MILLIS = 400UL;
+static const int64_t NO_EDGE = -1LL;
+
+struct EdgeAt {
+    int64_t atMillis;
+    bool isDown;
+};
+
+static int failures = 0;
+
+static void check(const char *name, const std::string &got, const std::string &expected) {
+    bool isPassed = got == expected;
+    printf("%-44s %s\n", name, isPassed ? "ok" : "FAILED");
+    if (!isPassed) {
+        printf("  expected: %s\n  got:      %s\n", expected.c_str(), got.c_str());
+    }
+    failures += isPassed ? 0 : 1;
+}
+
+/**
+ * Describes an event and when it was polled, such as "hold1@1000".
+ *
+ * @param event - The event as const Button::Event&.
+ *
+ * @return Returns the description as std::string.
+ */
+static std::string describe(const Button::Event &event) {
+    const char *names[] = { "none", "press", "hold", "release", "double" };
+    std::string text = names[event.type];
+    if (event.type == Button::BTN_HOLD || event.type == Button::BTN_RELEASED) {
+        text += std::to_string(event.level);
+    }
+
+    return text + "@" + std::to_string(virtualMicros / 1000LL);
+}
+
+/**
+ * Runs a sequence of edges through a new Button, polling it as the
+ * firmware would until the given time.
+ *
+ * @param edges - The edges, in time order, as const std::vector<EdgeAt>&.
+ * @param doubleGapMillis - The double press gap, 0 for none, as uint32_t.
+ * @param endMillis - When to stop as int64_t.
+ * @param isHeldAtEnd - Set to whether the button was held at the end as bool*.
+ *
+ * @return Returns the events given, space separated, as std::string.
+ */
+static std::string run(const std::vector<EdgeAt> &edges, uint32_t doubleGapMillis, int64_t endMillis, bool *isHeldAtEnd = nullptr) {
+    Button button;
+    button.setTimings(DEBOUNCE_MILLIS, doubleGapMillis);
+    button.setHoldThresholds(1000ULL, 3000ULL, 6000ULL);
+
+    std::string events;
+    size_t next = 0;
+    virtualMicros = 0LL;
+    while (true) {
+        int64_t edgeMicros = next < edges.size() ? edges[next].atMillis * 1000LL : NO_EDGE;
+        int64_t wakeMicros = button.nextWakeMicros();
+        int64_t atMicros = edgeMicros;
+        if (atMicros == NO_EDGE || (wakeMicros >= 0LL && wakeMicros < atMicros)) {
+            atMicros = wakeMicros;
+        }
+        if (atMicros < 0LL || atMicros > endMillis * 1000LL) {
+            break;
+        }
+
+        virtualMicros = std::max(atMicros, virtualMicros);
+        while (next < edges.size() && edges[next].atMillis * 1000LL <= virtualMicros) {
+            button.feedEdge(edges[next].isDown, edges[next].atMillis * 1000LL);
+            next++;
+        }
+
+        Button::Event event;
+        while (button.poll(event)) {
+            events += (events.empty() ? "" : " ") + describe(event);
+        }
+    }
+    if (isHeldAtEnd != nullptr) {
+        *isHeldAtEnd = button.isHeld();
+    }
+
+    return events;
+}
+
+int main() {
+    Clock::setSource(esp_timer_get_time);
+
+    check("press and release",
+        run({ { 0, true }, { 200, false } }, 0UL, 10000),
+        "press@30 release0@230");
+    check("  held back for the double press gap",
+        run({ { 0, true }, { 200, false } }, DOUBLE_GAP_MILLIS, 10000),
+        "press@30 release0@600");
+    check("bouncing press counts once, from its start",
+        run({ { 0, true }, { 5, false }, { 10, true }, { 12, false }, { 15, true }, { 500, false } }, 0UL, 10000),
+        "press@45 release0@530");
+    check("glitch shorter than the debounce is ignored",
+        run({ { 0, true }, { 10, false } }, 0UL, 10000),
+        "");
+    check("hold past the first threshold",
+        run({ { 0, true }, { 1500, false } }, DOUBLE_GAP_MILLIS, 10000),
+        "press@30 hold1@1000 release1@1530");
+    check("hold past the second threshold",
+        run({ { 0, true }, { 3500, false } }, DOUBLE_GAP_MILLIS, 10000),
+        "press@30 hold1@1000 hold2@3000 release2@3530");
+    check("hold past all three thresholds",
+        run({ { 0, true }, { 7000, false } }, DOUBLE_GAP_MILLIS, 10000),
+        "press@30 hold1@1000 hold2@3000 hold3@6000 release3@7030");
+    check("double press",
+        run({ { 0, true }, { 100, false }, { 300, true }, { 400, false } }, DOUBLE_GAP_MILLIS, 10000),
+        "press@30 double@330");
+    check("tap then hold reports its holds and release",
+        run({ { 0, true }, { 100, false }, { 300, true }, { 4000, false } }, DOUBLE_GAP_MILLIS, 10000),
+        "press@30 double@330 hold1@1300 hold2@3300 release2@4030");
+    check("  and without double presses",
+        run({ { 0, true }, { 100, false }, { 300, true }, { 4000, false } }, 0UL, 10000),
+        "press@30 release0@130 press@330 hold1@1300 hold2@3300 release2@4030");
+    check("second press after the gap is a press",
+        run({ { 0, true }, { 100, false }, { 600, true }, { 700, false } }, DOUBLE_GAP_MILLIS, 10000),
+        "press@30 release0@500 press@630 release0@1100");
+
+    {
+        // Far more edges than the queue holds, all before the loop gets to them
+        std::vector<EdgeAt> burst;
+        for (int i = 0; i < 41; i++) {
+            burst.push_back({ 0, i % 2 == 0 });
+        }
+        bool isHeld = false;
+        std::string events = run(burst, 0UL, 500, &isHeld);
+        check("overflowing burst leaves the final level", events + (isHeld ? " held" : " up"), "press@30 held");
+    }
+
+    Clock::setSource(nullptr);
+    printf("%s\n", failures == 0 ? "all passed" : "FAILURES");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+/*
+  Host stand-in for the parts of Arduino.h the Button uses. The pin always
+  reads up and the interrupt is never attached; Edges are fed in instead.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef ButtonCheckArduino_h
+    #define ButtonCheckArduino_h
+
+    #include <stdint.h>
+    #include <esp_timer.h>
+
+    #define IRAM_ATTR
+    #define HIGH 0x1
+    #define LOW 0x0
+    #define INPUT 0x01
+    #define CHANGE 0x03
+
+    struct HostMux {
+        int depth;
+    };
+    typedef HostMux portMUX_TYPE;
+    #define portMUX_INITIALIZER_UNLOCKED { 0 }
+    #define portENTER_CRITICAL(mux) ((mux)->depth++)
+    #define portEXIT_CRITICAL(mux) ((mux)->depth--)
+    #define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+    #define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+
+    inline void pinMode(uint8_t, uint8_t) {}
+    inline int digitalRead(uint8_t) { return LOW; }
+    inline uint8_t digitalPinToInterrupt(uint8_t pin) { return pin; }
+    inline void attachInterruptArg(uint8_t, void (*)(void*), void*, int) {}
+#endif
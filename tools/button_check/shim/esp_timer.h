@@ -0,0 +1,15 @@
+/*
+  Host stand-in for esp_timer.h, giving the test's virtual time.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef ButtonCheckEspTimer_h
+    #define ButtonCheckEspTimer_h
+
+    #include <stdint.h>
+
+    extern int64_t virtualMicros;
+
+    inline int64_t esp_timer_get_time() { return virtualMicros; }
+#endif
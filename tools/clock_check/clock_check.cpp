@@ -0,0 +1,173 @@
+/*
+  clock_check - Host test of the firmware's Clock, ClockDomain and Deadline
+  across the point where millis() used to roll over.
+
+  Runs the firmware's own Clock against a virtual time source, set with
+  Clock::setSource(), from boot to past 50 simulated days:
+
+    - The clock keeps counting past 2^32 ms, where the 32-bit millis() wraps
+      to zero after about 49.7 days, and never goes backwards.
+    - Deadlines started before, across and after that point expire when they
+      should, no sooner and no later, and their remaining and elapsed times
+      are right throughout. A deadline restarted every 5 s for the 50 days
+      expires exactly as many times as it should.
+    - A ClockDomain paused across that point stands still while paused and
+      leaves the time spent paused out afterwards, so the age of a device
+      seen before the pause, taken by subtraction as the firmware does, and
+      Deadlines measured against the domain come out right.
+
+  Usage:
+    clock_check
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <Clock.h>
+
+#include <stdio.h>
+
+static const int64_t MILLIS = 1000LL;              // <-- In microseconds
+static const int64_t SECONDS = 1000LL * MILLIS;
+static const int64_t DAYS = 86400LL * SECONDS;
+static const int64_t ROLLOVER = 4294967296LL * MILLIS; // <-- Where millis() wraps, 2^32 ms
+
+static int64_t virtualMicros = 0LL;
+static int failures = 0;
+
+static int64_t virtualNow() {
+    return virtualMicros;
+}
+
+static void check(const char *name, bool isPassed) {
+    printf("%-52s %s\n", name, isPassed ? "ok" : "FAILED");
+    failures += isPassed ? 0 : 1;
+}
+
+/**
+ * Starts a deadline at the given time and follows it, a millisecond at
+ * a time, to a little past when it should expire.
+ *
+ * @param startMicros - When it is started as int64_t.
+ * @param durationMillis - How long it runs as uint64_t.
+ *
+ * @return Returns true if it expired right on time and its remaining
+ * and elapsed times were right the whole way otherwise false as bool.
+ */
+static bool expiresOnTime(int64_t startMicros, uint64_t durationMillis) {
+    virtualMicros = startMicros;
+    Deadline deadline;
+    deadline.start(durationMillis);
+
+    bool isRight = deadline.isActive();
+    for (uint64_t elapsed = 0ULL; elapsed <= durationMillis + 50ULL; elapsed++) {
+        virtualMicros = startMicros + (int64_t)elapsed * MILLIS;
+        bool shouldExpire = elapsed >= durationMillis;
+        uint64_t remaining = shouldExpire ? 0ULL : durationMillis - elapsed;
+        isRight = isRight
+            && deadline.isExpired() == shouldExpire
+            && deadline.remainingMillis() == remaining
+            && deadline.elapsedMillis() == elapsed;
+    }
+
+    return isRight;
+}
+
+int main() {
+    Clock::setSource(virtualNow);
+
+    // Counting past 2^32 ms
+    {
+        virtualMicros = ROLLOVER - MILLIS;
+        uint64_t before = Clock::nowMillis();
+        virtualMicros = ROLLOVER + MILLIS;
+        uint64_t after = Clock::nowMillis();
+        check("clock counts on past 2^32 ms", before == 4294967295ULL && after == 4294967297ULL);
+        check("  where a 32-bit millis() would have wrapped", (uint32_t)after < (uint32_t)before);
+
+        bool isMonotonic = true;
+        uint64_t last = 0ULL;
+        for (virtualMicros = 0LL; virtualMicros <= 50LL * DAYS; virtualMicros += 997LL * MILLIS) {
+            uint64_t now = Clock::nowMillis();
+            isMonotonic = isMonotonic && now >= last;
+            last = now;
+        }
+        check("clock never goes backwards over 50 days", isMonotonic && last > 4294967296ULL);
+    }
+
+    // Deadlines around the rollover
+    check("deadline started well before it", expiresOnTime(ROLLOVER - 20LL * DAYS, 15000ULL));
+    check("deadline started 10 s before it, running across", expiresOnTime(ROLLOVER - 10LL * SECONDS, 30000ULL));
+    check("deadline expiring exactly on it", expiresOnTime(ROLLOVER - 5LL * SECONDS, 5000ULL));
+    check("deadline started on it", expiresOnTime(ROLLOVER, 15000ULL));
+    check("deadline started after it", expiresOnTime(ROLLOVER + 3LL * DAYS, 15000ULL));
+    {
+        virtualMicros = 0LL;
+        Deadline longDeadline;
+        longDeadline.start((uint64_t)(60LL * DAYS / MILLIS));
+        virtualMicros = ROLLOVER + SECONDS;
+        bool isRunning = !longDeadline.isExpired() && longDeadline.remainingMillis() > 0ULL;
+        virtualMicros = 60LL * DAYS;
+        check("60 day deadline started at boot outlasts it", isRunning && longDeadline.isExpired());
+
+        longDeadline.stop();
+        check("a stopped deadline never expires", !longDeadline.isActive() && !longDeadline.isExpired() && longDeadline.remainingMillis() == 0ULL);
+    }
+    {
+        // As the firmware's watchdogs and timers do, restarted each time it expires
+        const uint64_t periodMillis = 5000ULL;
+        Deadline periodic;
+        virtualMicros = 0LL;
+        periodic.start(periodMillis);
+
+        uint64_t expiries = 0ULL;
+        bool isOnTime = true;
+        for (virtualMicros = 0LL; virtualMicros <= 50LL * DAYS; virtualMicros += 250LL * MILLIS) {
+            if (periodic.isExpired()) {
+                expiries++;
+                isOnTime = isOnTime && periodic.elapsedMillis() == periodMillis;
+                periodic.start(periodMillis);
+            }
+        }
+        check("5 s deadline restarted for 50 days expires on time",
+            isOnTime && expiries == (uint64_t)(50LL * DAYS / MILLIS) / periodMillis);
+    }
+
+    // A paused domain across the rollover, as presence time is while WiFi is on
+    {
+        ClockDomain presence;
+        Deadline notSeen(&presence);
+
+        virtualMicros = ROLLOVER - 30LL * SECONDS;
+        uint64_t seenMillis = presence.nowMillis(); // <-- As seenDevices keeps it
+        notSeen.start(60000ULL);
+
+        virtualMicros = ROLLOVER - 20LL * SECONDS;
+        presence.pause();
+        uint64_t pausedMillis = presence.nowMillis();
+        virtualMicros = ROLLOVER + 2LL * 3600LL * SECONDS;
+        bool isFrozen = presence.isPaused() && presence.nowMillis() == pausedMillis && !notSeen.isExpired();
+        check("paused domain stands still across it", isFrozen && notSeen.remainingMillis() == 50000ULL);
+
+        presence.resume();
+        virtualMicros += 15LL * SECONDS;
+        uint64_t ageMillis = presence.nowMillis() - seenMillis;
+        check("  and leaves the pause out of ages after", !presence.isPaused() && ageMillis == 25000ULL);
+        check("  and out of deadlines measured against it", !notSeen.isExpired() && notSeen.remainingMillis() == 35000ULL);
+
+        virtualMicros += 35LL * SECONDS;
+        check("  which then expire on time", notSeen.isExpired() && notSeen.elapsedMillis() == 60000ULL);
+
+        presence.pause();
+        presence.pause(); // <-- Pausing again changes nothing
+        virtualMicros += 10LL * SECONDS;
+        presence.resume();
+        presence.resume();
+        check("  pausing and resuming twice counts once", presence.nowMillis() - seenMillis == 60000ULL);
+    }
+
+    Clock::setSource(nullptr);
+    printf("%s\n", failures == 0 ? "all passed" : "FAILURES");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,437 @@
+/*
+  collector - Fleet telemetry collector for presence-aware-switch.
+
+  Listens for the switches' binary health frames (see lib/HealthFrame) on a UDP
+  multicast group and stores each one, stamped with when it arrived, in a rolling
+  memory-mapped time-series file. Everything runs on one thread from an epoll loop;
+  Frames are taken a batch at a time with recvmmsg() and written straight into the
+  mapped file, so thousands per second from many devices cost very little.
+
+  Once a summary interval it prints frames per second, devices heard, frames lost
+  (gaps in each device's sequence) and the devices with the most scan watchdog
+  expirations and presence changes.
+
+  Usage:
+    collector [--port 47777] [--group 239.255.77.77] [--bind 0.0.0.0]
+              [--file health.tsdb] [--capacity 1000000] [--summary 10]
+    collector --dump [--file health.tsdb]
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <HealthFrame.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#define FILE_MAGIC "PXHLTH01"
+#define FILE_HEADER_SIZE 4096
+#define RECEIVE_BATCH 64
+#define SOCKET_BUFFER_BYTES (4 * 1024 * 1024)
+#define TOP_DEVICES 5
+
+// One stored frame; Fixed size so the file is a plain ring of them
+struct Record {
+    uint64_t receivedMillis;
+    uint32_t device;
+    uint32_t sequence;
+    uint32_t fieldMask;
+    uint32_t values[HealthFrame::FIELD_COUNT];
+    uint32_t rssiHistogram[HealthFrame::MAX_BUCKETS];
+    uint32_t dwellHistogram[HealthFrame::MAX_BUCKETS];
+    uint32_t sourceAddress;
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t recordSize;
+    uint32_t reserved;
+    uint64_t capacity;
+    uint64_t written; // <-- Total ever written; The next goes at written % capacity
+};
+
+struct Device {
+    uint32_t lastSequence;
+    uint64_t frames;
+    uint64_t lost;
+    uint32_t watchdogs;
+    uint32_t presenceChanges;
+    uint32_t freeHeap;
+};
+
+struct Options {
+    uint16_t port = 47777;
+    const char *group = "239.255.77.77";
+    const char *bind = "0.0.0.0";
+    const char *file = "health.tsdb";
+    uint64_t capacity = 1000000ULL;
+    int summarySeconds = 10;
+    bool isDump = false;
+};
+
+struct Series {
+    int fd = -1;
+    size_t mappedSize = 0;
+    FileHeader *header = nullptr;
+    Record *records = nullptr;
+};
+
+static uint64_t nowMillis() {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    return (uint64_t)now.tv_sec * 1000ULL + (uint64_t)now.tv_nsec / 1000000ULL;
+}
+
+/**
+ * Opens the time-series file, creating or recreating it if it
+ * doesn't match the record layout or capacity, and maps it.
+ *
+ * @param path - The file's path as const char*.
+ * @param capacity - The number of records kept as uint64_t.
+ * @param isReadOnly - Whether only reading, for --dump, as bool.
+ * @param series - Set to the mapped file as Series&.
+ *
+ * @return Returns true if opened otherwise false as bool.
+ */
+static bool openSeries(const char *path, uint64_t capacity, bool isReadOnly, Series &series) {
+    series.fd = open(path, isReadOnly ? O_RDONLY : (O_RDWR | O_CREAT), 0644);
+    if (series.fd < 0) {
+        perror("open");
+        return false;
+    }
+
+    FileHeader existing = {};
+    bool isValid = pread(series.fd, &existing, sizeof(existing), 0) == (ssize_t)sizeof(existing)
+        && memcmp(existing.magic, FILE_MAGIC, sizeof(existing.magic)) == 0
+        && existing.recordSize == sizeof(Record);
+
+    if (isReadOnly) {
+        if (!isValid) {
+            fprintf(stderr, "%s is not a health time-series file\n", path);
+            return false;
+        }
+        capacity = existing.capacity;
+    } else if (!isValid || existing.capacity != capacity) {
+        fprintf(stderr, "Creating %s for %llu records\n", path, (unsigned long long)capacity);
+        FileHeader fresh = {};
+        memcpy(fresh.magic, FILE_MAGIC, sizeof(fresh.magic));
+        fresh.recordSize = sizeof(Record);
+        fresh.capacity = capacity;
+        if (
+            ftruncate(series.fd, 0) != 0
+            || ftruncate(series.fd, FILE_HEADER_SIZE + capacity * sizeof(Record)) != 0
+            || pwrite(series.fd, &fresh, sizeof(fresh), 0) != (ssize_t)sizeof(fresh)
+        ) {
+            perror("ftruncate");
+            return false;
+        }
+    }
+
+    series.mappedSize = FILE_HEADER_SIZE + capacity * sizeof(Record);
+    void *mapped = mmap(nullptr, series.mappedSize, isReadOnly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, series.fd, 0);
+    if (mapped == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+    series.header = (FileHeader *)mapped;
+    series.records = (Record *)((uint8_t *)mapped + FILE_HEADER_SIZE);
+
+    return true;
+}
+
+/**
+ * Opens the UDP socket, joining the multicast group so frames from
+ * the switches arrive; Frames sent straight to the port, such as
+ * from simulated senders on loopback, arrive too.
+ *
+ * @param options - The options as const Options&.
+ *
+ * @return Returns the socket or -1 on failure as int.
+ */
+static int openSocket(const Options &options) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    int yes = 1;
+    int bufferBytes = SOCKET_BUFFER_BYTES;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+
+    struct sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(options.port);
+    local.sin_addr.s_addr = INADDR_ANY;
+    if (bind(fd, (struct sockaddr *)&local, sizeof(local)) != 0) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+
+    struct ip_mreq membership = {};
+    membership.imr_multiaddr.s_addr = inet_addr(options.group);
+    membership.imr_interface.s_addr = inet_addr(options.bind);
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) {
+        // Still useful for unicast, e.g. testing on loopback
+        perror("IP_ADD_MEMBERSHIP");
+    }
+
+    return fd;
+}
+
+/**
+ * Prints every stored record, oldest first, as CSV.
+ *
+ * @param series - The mapped file as const Series&.
+ */
+static void dumpSeries(const Series &series) {
+    uint64_t capacity = series.header->capacity;
+    uint64_t written = series.header->written;
+    uint64_t first = written > capacity ? written - capacity : 0ULL;
+
+    printf("received_ms,device,sequence,source,uptime_s,startups,free_heap,min_free_heap,scan_watchdogs,scans,presence_changes,seen_devices,mqtt_dropped,gossip_peers,rssi_histogram,dwell_histogram\n");
+    for (uint64_t i = first; i < written; i++) {
+        const Record &record = series.records[i % capacity];
+        struct in_addr source = { record.sourceAddress };
+        printf("%llu,%08x,%u,%s", (unsigned long long)record.receivedMillis, record.device, record.sequence, inet_ntoa(source));
+        for (int field = HealthFrame::FIELD_UPTIME_SECONDS; field <= HealthFrame::FIELD_GOSSIP_PEERS; field++) {
+            printf(",%u", record.values[field]);
+        }
+        printf(",");
+        for (int b = 0; b < HealthFrame::RSSI_BUCKETS; b++) {
+            printf("%s%u", b == 0 ? "" : " ", record.rssiHistogram[b]);
+        }
+        printf(",");
+        for (int b = 0; b < HealthFrame::DWELL_BUCKETS; b++) {
+            printf("%s%u", b == 0 ? "" : " ", record.dwellHistogram[b]);
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * Prints the summary for the interval just ended.
+ *
+ * @param devices - The devices heard as const std::unordered_map&.
+ * @param frames - Frames stored this interval as uint64_t.
+ * @param invalid - Frames rejected this interval as uint64_t.
+ * @param seconds - The length of the interval as int.
+ */
+static void printSummary(const std::unordered_map<uint32_t, Device> &devices, uint64_t frames, uint64_t invalid, int seconds) {
+    uint64_t lost = 0ULL;
+    std::vector<std::pair<uint32_t, const Device *>> ranked;
+    for (const auto &entry : devices) {
+        lost += entry.second.lost;
+        ranked.push_back({ entry.first, &entry.second });
+    }
+
+    printf("%.1f frames/s; devices=%zu; lost=%llu; invalid=%llu\n",
+        (double)frames / seconds, devices.size(), (unsigned long long)lost, (unsigned long long)invalid);
+
+    size_t top = std::min(ranked.size(), (size_t)TOP_DEVICES);
+    std::partial_sort(ranked.begin(), ranked.begin() + top, ranked.end(), [](const auto &a, const auto &b) {
+        return a.second->watchdogs + a.second->presenceChanges > b.second->watchdogs + b.second->presenceChanges;
+    });
+    for (size_t i = 0; i < top; i++) {
+        const Device &device = *ranked[i].second;
+        printf("  %08x: watchdogs=%u presence_changes=%u free_heap=%u lost=%llu\n",
+            ranked[i].first, device.watchdogs, device.presenceChanges, device.freeHeap, (unsigned long long)device.lost);
+    }
+    fflush(stdout);
+}
+
+static void printUsage() {
+    fprintf(stderr,
+        "usage: collector [--port N] [--group ADDR] [--bind ADDR] [--file PATH]\n"
+        "                 [--capacity RECORDS] [--summary SECONDS]\n"
+        "       collector --dump [--file PATH]\n");
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    const struct option longOptions[] = {
+        { "port", required_argument, nullptr, 'p' },
+        { "group", required_argument, nullptr, 'g' },
+        { "bind", required_argument, nullptr, 'b' },
+        { "file", required_argument, nullptr, 'f' },
+        { "capacity", required_argument, nullptr, 'c' },
+        { "summary", required_argument, nullptr, 's' },
+        { "dump", no_argument, nullptr, 'd' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+        switch (option) {
+            case 'p': options.port = (uint16_t)atoi(optarg); break;
+            case 'g': options.group = optarg; break;
+            case 'b': options.bind = optarg; break;
+            case 'f': options.file = optarg; break;
+            case 'c': options.capacity = strtoull(optarg, nullptr, 10); break;
+            case 's': options.summarySeconds = atoi(optarg); break;
+            case 'd': options.isDump = true; break;
+            default: printUsage(); return 2;
+        }
+    }
+    if (options.capacity == 0ULL || options.summarySeconds <= 0) {
+        printUsage();
+        return 2;
+    }
+
+    Series series;
+    if (!openSeries(options.file, options.capacity, options.isDump, series)) {
+        return 1;
+    }
+    if (options.isDump) {
+        dumpSeries(series);
+        return 0;
+    }
+
+    int socketFd = openSocket(options);
+    if (socketFd < 0) {
+        return 1;
+    }
+
+    // Stop cleanly on Ctrl-C or a kill so the file is synced
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+    int signalFd = signalfd(-1, &signals, SFD_NONBLOCK);
+
+    int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    struct itimerspec interval = {};
+    interval.it_interval.tv_sec = options.summarySeconds;
+    interval.it_value.tv_sec = options.summarySeconds;
+    timerfd_settime(timerFd, 0, &interval, nullptr);
+
+    int epollFd = epoll_create1(0);
+    int watched[] = { socketFd, signalFd, timerFd };
+    for (int fd : watched) {
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    fprintf(stderr, "Collecting on port %u (group %s) into %s\n", options.port, options.group, options.file);
+
+    static uint8_t buffers[RECEIVE_BATCH][HealthFrame::MAX_FRAME_SIZE];
+    struct mmsghdr messages[RECEIVE_BATCH];
+    struct iovec vectors[RECEIVE_BATCH];
+    struct sockaddr_in sources[RECEIVE_BATCH];
+
+    std::unordered_map<uint32_t, Device> devices;
+    uint64_t intervalFrames = 0ULL;
+    uint64_t intervalInvalid = 0ULL;
+    bool isRunning = true;
+
+    while (isRunning) {
+        struct epoll_event events[4];
+        int ready = epoll_wait(epollFd, events, 4, -1);
+        if (ready < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int e = 0; e < ready; e++) {
+            int fd = events[e].data.fd;
+
+            if (fd == signalFd) {
+                isRunning = false;
+            } else if (fd == timerFd) {
+                uint64_t expirations;
+                if (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+                    printSummary(devices, intervalFrames, intervalInvalid, options.summarySeconds);
+                    intervalFrames = 0ULL;
+                    intervalInvalid = 0ULL;
+                    msync(series.header, series.mappedSize, MS_ASYNC);
+                }
+            } else if (fd == socketFd) {
+                // Drain the socket a batch at a time
+                while (true) {
+                    for (int i = 0; i < RECEIVE_BATCH; i++) {
+                        vectors[i] = { buffers[i], sizeof(buffers[i]) };
+                        messages[i].msg_hdr = {};
+                        messages[i].msg_hdr.msg_iov = &vectors[i];
+                        messages[i].msg_hdr.msg_iovlen = 1;
+                        messages[i].msg_hdr.msg_name = &sources[i];
+                        messages[i].msg_hdr.msg_namelen = sizeof(sources[i]);
+                    }
+
+                    int received = recvmmsg(socketFd, messages, RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+                    if (received <= 0) {
+                        break;
+                    }
+
+                    uint64_t now = nowMillis();
+                    for (int i = 0; i < received; i++) {
+                        HealthFrame::Decoded decoded;
+                        if (!HealthFrame::decode(buffers[i], messages[i].msg_len, decoded)) {
+                            intervalInvalid++;
+                            continue;
+                        }
+
+                        Record &record = series.records[series.header->written % series.header->capacity];
+                        record.receivedMillis = now;
+                        record.device = decoded.device;
+                        record.sequence = decoded.sequence;
+                        record.fieldMask = decoded.fieldMask;
+                        memcpy(record.values, decoded.values, sizeof(record.values));
+                        memcpy(record.rssiHistogram, decoded.rssiHistogram, sizeof(record.rssiHistogram));
+                        memcpy(record.dwellHistogram, decoded.dwellHistogram, sizeof(record.dwellHistogram));
+                        record.sourceAddress = sources[i].sin_addr.s_addr;
+                        series.header->written++;
+                        intervalFrames++;
+
+                        auto found = devices.find(decoded.device);
+                        if (found == devices.end()) {
+                            found = devices.emplace(decoded.device, Device{ decoded.sequence, 0ULL, 0ULL, 0U, 0U, 0U }).first;
+                        } else if (decoded.sequence > found->second.lastSequence + 1) {
+                            found->second.lost += decoded.sequence - found->second.lastSequence - 1;
+                        }
+                        Device &device = found->second;
+                        device.lastSequence = decoded.sequence;
+                        device.frames++;
+                        device.watchdogs = decoded.values[HealthFrame::FIELD_SCAN_WATCHDOGS];
+                        device.presenceChanges = decoded.values[HealthFrame::FIELD_PRESENCE_CHANGES];
+                        device.freeHeap = decoded.values[HealthFrame::FIELD_FREE_HEAP];
+                    }
+                }
+            }
+        }
+    }
+
+    uint64_t written = series.header->written;
+    msync(series.header, series.mappedSize, MS_SYNC);
+    munmap(series.header, series.mappedSize);
+    close(series.fd);
+    close(socketFd);
+    fprintf(stderr, "Stopped after %llu records\n", (unsigned long long)written);
+
+    return 0;
+}
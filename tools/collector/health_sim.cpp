@@ -0,0 +1,158 @@
+/*
+  health_sim - Simulated switches for testing the telemetry collector.
+
+  Sends health frames, built with the firmware's own HealthFrame encoder, as if
+  from the given number of switches. Each simulated switch keeps its own sequence
+  and counters, now and then drops a frame to exercise the collector's loss
+  accounting, and all of them share the requested total rate.
+
+  Usage:
+    health_sim [--host 127.0.0.1] [--port 47777] [--devices 50] [--rate 2000]
+               [--seconds 10] [--loss 0.01]
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <HealthFrame.h>
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <random>
+#include <vector>
+
+struct SimulatedDevice {
+    uint32_t id;
+    uint32_t sequence;
+    uint32_t watchdogs;
+    uint32_t presenceChanges;
+    uint32_t dwellHistogram[HealthFrame::DWELL_BUCKETS];
+};
+
+static double nowSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+    const char *host = "127.0.0.1";
+    uint16_t port = 47777;
+    int deviceCount = 50;
+    double rate = 2000.0;
+    double seconds = 10.0;
+    double loss = 0.01;
+
+    const struct option longOptions[] = {
+        { "host", required_argument, nullptr, 'h' },
+        { "port", required_argument, nullptr, 'p' },
+        { "devices", required_argument, nullptr, 'd' },
+        { "rate", required_argument, nullptr, 'r' },
+        { "seconds", required_argument, nullptr, 's' },
+        { "loss", required_argument, nullptr, 'l' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+        switch (option) {
+            case 'h': host = optarg; break;
+            case 'p': port = (uint16_t)atoi(optarg); break;
+            case 'd': deviceCount = atoi(optarg); break;
+            case 'r': rate = atof(optarg); break;
+            case 's': seconds = atof(optarg); break;
+            case 'l': loss = atof(optarg); break;
+            default:
+                fprintf(stderr, "usage: health_sim [--host ADDR] [--port N] [--devices N] [--rate FRAMES_PER_SEC] [--seconds S] [--loss FRACTION]\n");
+                return 2;
+        }
+    }
+    if (deviceCount <= 0 || rate <= 0.0) {
+        return 2;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in target = {};
+    target.sin_family = AF_INET;
+    target.sin_port = htons(port);
+    if (fd < 0 || inet_pton(AF_INET, host, &target.sin_addr) != 1) {
+        fprintf(stderr, "bad host %s\n", host);
+        return 1;
+    }
+
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::vector<SimulatedDevice> devices(deviceCount);
+    for (int i = 0; i < deviceCount; i++) {
+        devices[i] = { (uint32_t)(0x5A000000UL + i), 0UL, 0UL, 0UL, {} };
+    }
+
+    uint8_t buffer[HealthFrame::MAX_FRAME_SIZE];
+    HealthFrame frame(buffer, sizeof(buffer));
+    uint64_t sent = 0ULL;
+    uint64_t skipped = 0ULL;
+    double start = nowSeconds();
+
+    for (uint64_t n = 0; ; n++) {
+        // Keep to the rate
+        double due = start + n / rate;
+        double now = nowSeconds();
+        if (now - start >= seconds) {
+            break;
+        }
+        if (due > now) {
+            usleep((useconds_t)((due - now) * 1e6));
+        }
+
+        SimulatedDevice &device = devices[n % deviceCount];
+        device.sequence++;
+        if (chance(random) < 0.002) {
+            device.watchdogs++;
+        }
+        if (chance(random) < 0.05) {
+            device.presenceChanges++;
+            device.dwellHistogram[HealthFrame::dwellBucket((uint32_t)(chance(random) * 7200.0))]++;
+        }
+
+        uint32_t rssiHistogram[HealthFrame::RSSI_BUCKETS] = {};
+        for (int sample = 0; sample < 6; sample++) {
+            rssiHistogram[HealthFrame::rssiBucket(-95 + (int)(chance(random) * 70.0))]++;
+        }
+
+        uint32_t uptime = (uint32_t)(now - start) + 3600UL;
+        frame.begin(device.id, device.sequence);
+        frame.value(HealthFrame::FIELD_UPTIME_SECONDS, uptime);
+        frame.value(HealthFrame::FIELD_STARTUPS, 3UL);
+        frame.value(HealthFrame::FIELD_FREE_HEAP, 120000UL - (uint32_t)(chance(random) * 20000.0));
+        frame.value(HealthFrame::FIELD_MIN_FREE_HEAP, 90000UL);
+        frame.value(HealthFrame::FIELD_SCAN_WATCHDOGS, device.watchdogs);
+        frame.value(HealthFrame::FIELD_SCANS, uptime / 5UL);
+        frame.value(HealthFrame::FIELD_PRESENCE_CHANGES, device.presenceChanges);
+        frame.value(HealthFrame::FIELD_SEEN_DEVICES, 1UL);
+        frame.histogram(HealthFrame::FIELD_RSSI_HISTOGRAM, rssiHistogram, HealthFrame::RSSI_BUCKETS);
+        frame.histogram(HealthFrame::FIELD_DWELL_HISTOGRAM, device.dwellHistogram, HealthFrame::DWELL_BUCKETS);
+
+        if (chance(random) < loss) {
+            skipped++;
+            continue;
+        }
+        if (sendto(fd, buffer, frame.getLength(), 0, (struct sockaddr *)&target, sizeof(target)) > 0) {
+            sent++;
+        }
+    }
+
+    double elapsed = nowSeconds() - start;
+    printf("sent=%llu skipped=%llu frame_bytes=%zu rate=%.1f/s\n",
+        (unsigned long long)sent, (unsigned long long)skipped, frame.getLength(), sent / elapsed);
+    close(fd);
+
+    return 0;
+}
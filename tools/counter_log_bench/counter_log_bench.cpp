@@ -0,0 +1,315 @@
+/*
+  counter_log_bench - Host test of the CounterLog keeping counters in flash.
+
+  First cuts the power at every step of a run of changes, against an
+  emulated NOR flash (see nor_flash.h), and after each cut starts the log
+  again to check that the change cut short reads back as it was before or
+  after it and every other counter exactly, then that the log carries on
+  from there. No write may ever need a bit set again without an erase.
+
+  Then replays years of a device's life, a start a day with its relay
+  cycles, time on and the odd scan watchdog, through the CounterLog as the
+  firmware keeps them, and the same changes as NVS keys (see
+  tools/settings_bench/flash_sim.h) for comparison. Reports the erase
+  cycles, the worst worn sector, the flash time per change and what is read
+  at each start.
+
+  Usage:
+    counter_log_bench [--days 3650] [--pages 4] [--cycles 10] [--hours 10]
+                      [--nvs-pages 5] [--ops 1300] [--seed 1]
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <nor_flash.h>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// As src/main.cpp keeps them
+enum Counter : uint8_t {
+    COUNTER_STARTUPS,
+    COUNTER_SCAN_WATCHDOGS,
+    COUNTER_RELAY_CYCLES,
+    COUNTER_ON_SECONDS,
+    COUNTER_COUNT
+};
+
+static const char *COUNTER_KEYS[COUNTER_COUNT] = { "startups", "scanWatchdogs", "relayCycles", "onSeconds" };
+
+struct Change {
+    uint8_t counter;
+    uint32_t amount;
+};
+
+struct SweepResults {
+    unsigned long cuts = 0UL;
+    unsigned long failures = 0UL;
+    unsigned long skippedRecords = 0UL;
+    uint64_t faults = 0ULL;
+};
+
+struct Wear {
+    uint64_t changes = 0ULL;
+    uint64_t maxChangeMicros = 0ULL;
+    uint64_t maxBootBytes = 0ULL;
+};
+
+/**
+ * Checks what the log holds against what is expected.
+ *
+ * @param log - The log as CounterLog&.
+ * @param expected - The counters expected as const uint32_t*.
+ *
+ * @return Returns true if the same otherwise false as bool.
+ */
+static bool isSame(CounterLog &log, const uint32_t *expected) {
+    for (uint8_t counter = 0; counter < COUNTER_COUNT; counter++) {
+        if (log.get(counter) != expected[counter]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Runs the changes with the power cut after a number of steps, then starts
+ * the log again and checks it, then runs the rest and checks them too.
+ *
+ * @param changes - The changes as const std::vector<Change>&.
+ * @param cutAfter - The steps before the power is cut as long.
+ * @param results - What is found, added to, as SweepResults&.
+ *
+ * @return Returns true if the power was cut otherwise false, the changes
+ * all having been made first, as bool.
+ */
+static bool cutPower(const std::vector<Change> &changes, long cutAfter, SweepResults &results) {
+    NorFlash flash(2, (uint32_t)cutAfter);
+    CounterLog log;
+    if (!log.begin(flash, COUNTER_COUNT)) {
+        results.failures++;
+        return false;
+    }
+
+    uint32_t expected[COUNTER_COUNT] = {};
+    size_t cut = changes.size();
+    flash.cutPowerAfter(cutAfter);
+    try {
+        for (size_t i = 0; i < changes.size(); i++) {
+            cut = i;
+            log.add(changes[i].counter, changes[i].amount);
+            expected[changes[i].counter] += changes[i].amount;
+        }
+        cut = changes.size();
+    } catch (const PowerLoss&) {
+    }
+    flash.restorePower();
+    if (cut == changes.size()) {
+        return false;
+    }
+    results.cuts++;
+
+    // The change cut short is kept whole or not at all, the rest exactly
+    CounterLog restarted;
+    const Change &change = changes[cut];
+    uint32_t before = expected[change.counter];
+    if (!restarted.begin(flash, COUNTER_COUNT) || restarted.isFresh()) {
+        results.failures++;
+        return true;
+    }
+    uint32_t found = restarted.get(change.counter);
+    if (found != before && found != before + change.amount) {
+        results.failures++;
+    }
+    expected[change.counter] = found;
+    if (!isSame(restarted, expected)) {
+        results.failures++;
+    }
+    results.skippedRecords += restarted.getSkippedRecords();
+
+    for (size_t i = cut + 1; i < changes.size(); i++) {
+        restarted.add(changes[i].counter, changes[i].amount);
+        expected[changes[i].counter] += changes[i].amount;
+    }
+    CounterLog last;
+    if (!last.begin(flash, COUNTER_COUNT) || !isSame(last, expected)) {
+        results.failures++;
+    }
+    results.faults += flash.faults;
+
+    return true;
+}
+
+/**
+ * Makes a change to the log, timing it.
+ *
+ * @param flash - The log's flash as NorFlash&.
+ * @param log - The log as CounterLog&.
+ * @param expected - The counters expected, changed too, as uint32_t*.
+ * @param counter - Which counter as uint8_t.
+ * @param amount - How much to add as uint32_t.
+ * @param wear - What is found, added to, as Wear&.
+ *
+ * @return Returns true if kept otherwise false as bool.
+ */
+static bool addToLog(NorFlash &flash, CounterLog &log, uint32_t *expected, uint8_t counter, uint32_t amount, Wear &wear) {
+    uint64_t before = flash.wear.micros;
+    expected[counter] += amount;
+    bool isKept = log.add(counter, amount);
+    wear.changes++;
+    wear.maxChangeMicros = std::max(wear.maxChangeMicros, flash.wear.micros - before);
+
+    return isKept;
+}
+
+/**
+ * Makes the same change as an NVS key, timing it.
+ *
+ * @param nvs - The NVS as NvsSim&.
+ * @param expected - The counters expected, changed too, as uint32_t*.
+ * @param counter - Which counter as uint8_t.
+ * @param amount - How much to add as uint32_t.
+ * @param wear - What is found, added to, as Wear&.
+ *
+ * @return Returns true if kept otherwise false as bool.
+ */
+static bool addToNvs(NvsSim &nvs, uint32_t *expected, uint8_t counter, uint32_t amount, Wear &wear) {
+    uint64_t before = nvs.flash.micros;
+    expected[counter] += amount;
+    bool isKept = nvs.set("counters", COUNTER_KEYS[counter], NvsSim::ITEM_U32, &expected[counter], sizeof(uint32_t));
+    wear.changes++;
+    wear.maxChangeMicros = std::max(wear.maxChangeMicros, nvs.flash.micros - before);
+
+    return isKept;
+}
+
+/**
+ * Prints a line of results.
+ *
+ * @param name - What was measured as const char*.
+ * @param flash - Its flash as const FlashSim&.
+ * @param wear - Its changes as const Wear&.
+ */
+static void report(const char *name, const FlashSim &flash, const Wear &wear) {
+    printf("%-16s erases=%-6llu worst_sector=%-6u programmed=%-9llu change_ms avg=%.3f max=%.1f",
+        name, (unsigned long long)flash.totalErases(), flash.maxErases(), (unsigned long long)flash.programmed,
+        flash.micros / 1000.0 / wear.changes, wear.maxChangeMicros / 1000.0);
+    if (wear.maxBootBytes > 0ULL) {
+        printf(" boot_read=%llu bytes", (unsigned long long)wear.maxBootBytes);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    int days = 3650; // <-- A start a day for ten years
+    uint32_t pages = 4; // <-- The counters partition in partitions.csv
+    int cycles = 10;
+    int hours = 10;
+    uint32_t nvsPages = 5; // <-- The nvs partition in partitions.csv
+    int ops = 1300; // <-- Enough to fill a page twice over
+    uint32_t seed = 1;
+
+    const struct option longOptions[] = {
+        { "days", required_argument, nullptr, 'd' },
+        { "pages", required_argument, nullptr, 'g' },
+        { "cycles", required_argument, nullptr, 'c' },
+        { "hours", required_argument, nullptr, 'h' },
+        { "nvs-pages", required_argument, nullptr, 'n' },
+        { "ops", required_argument, nullptr, 'o' },
+        { "seed", required_argument, nullptr, 's' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+        switch (option) {
+            case 'd': days = atoi(optarg); break;
+            case 'g': pages = (uint32_t)atoi(optarg); break;
+            case 'c': cycles = atoi(optarg); break;
+            case 'h': hours = atoi(optarg); break;
+            case 'n': nvsPages = (uint32_t)atoi(optarg); break;
+            case 'o': ops = atoi(optarg); break;
+            case 's': seed = (uint32_t)atoi(optarg); break;
+            default:
+                optind = argc + 1;
+                break;
+        }
+    }
+    if (optind != argc || days < 1 || pages < 2 || cycles < 1 || hours < 0 || hours > 24 || nvsPages < 2 || ops < 1) {
+        fprintf(stderr, "usage: counter_log_bench [--days N] [--pages N] [--cycles N] [--hours N] [--nvs-pages N] [--ops N] [--seed N]\n");
+        return 2;
+    }
+
+    // Power cut at every step of a run of changes
+    std::mt19937 random(seed);
+    std::vector<Change> changes;
+    for (int i = 0; i < ops; i++) {
+        uint8_t counter = (uint8_t)(random() % COUNTER_COUNT);
+        changes.push_back({ counter, counter == COUNTER_ON_SECONDS ? (uint32_t)(1UL + random() % 900UL) : 1U });
+    }
+    SweepResults sweep;
+    for (long cutAfter = 0L; cutPower(changes, cutAfter, sweep); cutAfter++) {
+    }
+    printf("power cuts: changes=%d cuts=%lu skipped_records=%lu rewrite_faults=%llu failures=%lu\n",
+        ops, sweep.cuts, sweep.skippedRecords, (unsigned long long)sweep.faults, sweep.failures);
+
+    // Years of starts, relay cycles and time on
+    NorFlash flash(pages);
+    NvsSim nvs(nvsPages);
+    nvs.flash.resetCounts();
+    Wear logWear;
+    Wear nvsWear;
+    uint32_t expected[COUNTER_COUNT] = {};
+    uint32_t nvsExpected[COUNTER_COUNT] = {};
+    unsigned long failures = 0UL;
+    uint32_t firstGeneration = 0UL;
+    CounterLog log;
+    for (int day = 0; day < days; day++) {
+        uint64_t bytesRead = flash.bytesRead;
+        if (!log.begin(flash, COUNTER_COUNT) || !isSame(log, expected)) {
+            failures++;
+        }
+        logWear.maxBootBytes = std::max(logWear.maxBootBytes, flash.bytesRead - bytesRead);
+        firstGeneration = day == 0 ? log.getGeneration() : firstGeneration;
+
+        addToLog(flash, log, expected, COUNTER_STARTUPS, 1UL, logWear);
+        addToNvs(nvs, nvsExpected, COUNTER_STARTUPS, 1UL, nvsWear);
+        if (random() % 30 == 0) {
+            addToLog(flash, log, expected, COUNTER_SCAN_WATCHDOGS, 1UL, logWear);
+            addToNvs(nvs, nvsExpected, COUNTER_SCAN_WATCHDOGS, 1UL, nvsWear);
+        }
+
+        // Time on is split over the cycles, logged each quarter hour and at turning off
+        uint32_t onSeconds = (uint32_t)hours * 3600UL / (uint32_t)cycles;
+        for (int cycle = 0; cycle < cycles; cycle++) {
+            addToLog(flash, log, expected, COUNTER_RELAY_CYCLES, 1UL, logWear);
+            addToNvs(nvs, nvsExpected, COUNTER_RELAY_CYCLES, 1UL, nvsWear);
+            for (uint32_t left = onSeconds; left > 0UL;) {
+                uint32_t logged = std::min(left, (uint32_t)900UL);
+                addToLog(flash, log, expected, COUNTER_ON_SECONDS, logged, logWear);
+                addToNvs(nvs, nvsExpected, COUNTER_ON_SECONDS, logged, nvsWear);
+                left -= logged;
+            }
+        }
+    }
+    CounterLog last;
+    if (!last.begin(flash, COUNTER_COUNT) || !isSame(last, expected)) {
+        failures++;
+    }
+
+    printf("life: days=%d cycles/day=%d hours_on/day=%d changes=%llu counter_pages=%u nvs_pages=%u\n",
+        days, cycles, hours, (unsigned long long)logWear.changes, pages, nvsPages);
+    report("counter log", flash.wear, logWear);
+    report("nvs keys", nvs.flash, nvsWear);
+    printf("pages_started=%lu rewrite_faults=%llu counters_intact=%s\n",
+        (unsigned long)(last.getGeneration() - firstGeneration), (unsigned long long)flash.faults, failures == 0UL ? "yes" : "NO");
+
+    return sweep.failures == 0UL && sweep.faults == 0ULL && failures == 0UL && flash.faults == 0ULL ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/*
+  Host stand-in for a partition of the ESP32's SPI NOR flash which holds
+  what is written to it, for the CounterLog to keep its log in.
+
+  As NOR flash does, an erase sets every bit of a 4K sector and a write can
+  only clear bits; Any write which would need a bit set again is counted as
+  a fault. Wear and flash time are counted by a FlashSim (see
+  tools/settings_bench/flash_sim.h).
+
+  Power can be cut after a given number of steps, a step being a byte
+  written or 256 bytes erased. The byte being written when it is cut gets
+  only some of its bits cleared, and the sector being erased keeps what
+  wasn't erased yet. The write or erase then throws PowerLoss.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef NorFlash_h
+    #define NorFlash_h
+
+    #include <CounterLog.h>
+    #include <flash_sim.h>
+
+    #include <stdint.h>
+    #include <string.h>
+
+    #include <random>
+    #include <vector>
+
+    struct PowerLoss {};
+
+    class NorFlash : public CounterLog::Flash {
+    public:
+        static const size_t ERASE_STEP = 256U;
+
+        explicit NorFlash(uint32_t sectors, uint32_t seed = 1U)
+            : wear(sectors), bytes(sectors * FlashSim::SECTOR_SIZE, 0xFF), random(seed) {}
+
+        size_t getSize() override {
+            return bytes.size();
+        }
+
+        bool read(size_t offset, void *data, size_t length) override {
+            if (offset + length > bytes.size()) {
+                return false;
+            }
+            memcpy(data, bytes.data() + offset, length);
+            bytesRead += length;
+
+            return true;
+        }
+
+        bool write(size_t offset, const void *data, size_t length) override {
+            if (offset + length > bytes.size()) {
+                return false;
+            }
+            const uint8_t *source = (const uint8_t*)data;
+            wear.program((uint32_t)offset, (uint32_t)length);
+            for (size_t i = 0; i < length; i++) {
+                uint8_t &cell = bytes[offset + i];
+                if ((source[i] & ~cell) != 0) {
+                    faults++; // <-- Would need a bit set again
+                }
+                if (step()) {
+                    cell &= source[i] | (uint8_t)random(); // <-- Only some of its bits cleared
+                    throw PowerLoss();
+                }
+                cell &= source[i];
+            }
+
+            return true;
+        }
+
+        bool eraseSector(size_t offset) override {
+            if (offset % FlashSim::SECTOR_SIZE != 0 || offset >= bytes.size()) {
+                return false;
+            }
+            wear.erase((uint32_t)(offset / FlashSim::SECTOR_SIZE));
+            for (size_t done = 0; done < FlashSim::SECTOR_SIZE; done += ERASE_STEP) {
+                if (step()) {
+                    throw PowerLoss();
+                }
+                memset(bytes.data() + offset + done, 0xFF, ERASE_STEP);
+            }
+
+            return true;
+        }
+
+        void cutPowerAfter(long steps) {
+            stepsLeft = steps;
+        }
+
+        void restorePower() {
+            stepsLeft = -1L;
+        }
+
+        FlashSim wear;
+        std::vector<uint8_t> bytes;
+        uint64_t bytesRead = 0ULL;
+        uint64_t faults = 0ULL;
+        uint64_t steps = 0ULL;
+
+    private:
+        std::mt19937 random;
+        long stepsLeft = -1L; // <-- Until power is cut; Negative for never
+
+        bool step() {
+            steps++;
+            if (stepsLeft < 0L) {
+                return false;
+            }
+
+            return stepsLeft-- == 0L;
+        }
+    };
+#endif
@@ -0,0 +1,362 @@
+/*
+  gossip_sim - Simulated switches for testing the gossip protocol and its
+  nearest switch arbitration.
+
+  Runs three switches, A, B and C, each with the firmware's own Gossip, over a
+  simulated transport in virtual time. The switches stand in a line 6 m apart
+  and sample a beacon's RSSI once a second from a log-distance path loss model
+  with Gaussian noise. Each runs the firmware's decision: its device is on when
+  it sees the beacon and Gossip says it is nearest. Each broadcasts every two
+  seconds, and at once when its device turns on or off, as the firmware does.
+  Frames reach the other switches a few milliseconds later, or are lost.
+
+  Each scenario is checked for which switches end up with their device on, and
+  in what order:
+
+    - the switches converge on the one nearest the beacon, with or without
+      lost frames, and without two left on;
+    - with the beacon at the same distance from two switches for half an hour,
+      the margin keeps the one which has its device on, handing over once at
+      most, where no margin flaps;
+    - a beacon carried slowly past all three is handed from each to the next
+      once, and carried past at a walk ends with the last;
+    - a switch which goes silent hands over once its sightings go stale;
+    - a tie goes to the lower node id.
+
+  Usage:
+    gossip_sim [--seed 1]
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <Gossip.h>
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// As the firmware runs it
+static const uint64_t GOSSIP_INTERVAL_MILLIS = 2000ULL;
+static const uint32_t GOSSIP_MAX_AGE_MILLIS = 15000UL;
+static const uint64_t MAX_NOT_SEEN_MILLIS = 15000ULL;
+
+static const uint64_t STEP_MILLIS = 10ULL;
+static const uint64_t SAMPLE_MILLIS = 1000ULL;
+static const uint64_t DELIVERY_MILLIS = 6ULL;
+static const uint64_t START_MILLIS = 1000ULL; // <-- Sightings at zero would read as none
+static const int SENSITIVITY_RSSI = -95;
+static const uint8_t NODE_COUNT = 3;
+static const double SPACING_METERS = 6.0;
+
+static int failures = 0;
+
+static void check(const char *name, bool isPassed) {
+    printf("%-56s %s\n", name, isPassed ? "ok" : "FAILED");
+    failures += isPassed ? 0 : 1;
+}
+
+struct Frame {
+    uint64_t deliverMillis;
+    uint8_t from;
+    std::vector<uint8_t> bytes;
+};
+
+/**
+ * The air between the switches; Frames sent are heard by every other
+ * switch after the delivery time, unless lost.
+ */
+class Air {
+public:
+    Air(std::mt19937 &random, double loss) : random(random), loss(loss) {}
+
+    void put(uint8_t from, uint64_t nowMillis, const uint8_t *frame, size_t length) {
+        sent++;
+        bytes += length;
+        inFlight.push_back({ nowMillis + DELIVERY_MILLIS, from, std::vector<uint8_t>(frame, frame + length) });
+    }
+
+    bool isLost() {
+        return chance(random) < loss;
+    }
+
+    std::vector<Frame> inFlight;
+    unsigned long sent = 0UL;
+    unsigned long bytes = 0UL;
+
+private:
+    std::mt19937 &random;
+    std::uniform_real_distribution<double> chance { 0.0, 1.0 };
+    double loss;
+};
+
+class SimTransport : public Gossip::Transport {
+public:
+    SimTransport(Air &air, uint8_t from, const uint64_t &nowMillis) : air(air), from(from), nowMillis(nowMillis) {}
+
+    bool send(const uint8_t *frame, size_t length) override {
+        air.put(from, nowMillis, frame, length);
+
+        return true;
+    }
+
+private:
+    Air &air;
+    uint8_t from;
+    const uint64_t &nowMillis;
+};
+
+struct Node {
+    Node(Air &air, uint8_t index, const uint64_t &nowMillis)
+        : transport(air, index, nowMillis), gossip(transport), position(index * SPACING_METERS) {}
+
+    SimTransport transport;
+    Gossip gossip;
+    double position;
+    bool isOn = false;
+    bool isSilent = false;
+    uint64_t seenMillis = 0ULL;
+};
+
+struct Scenario {
+    uint8_t marginDb;
+    double noiseDb;
+    double loss;
+    uint64_t seconds;
+    double (*beaconAt)(uint64_t millis); // <-- Where the beacon is along the line
+    int silentNode;                      // <-- Goes silent at silentAtMillis, -1 for none
+    uint64_t silentAtMillis;
+};
+
+struct Results {
+    uint64_t convergeMillis;   // <-- Until exactly one device was on, once each switch had sampled
+    std::string owners;        // <-- Each switch which had the only device on, in turn
+    unsigned long handovers;
+    uint64_t overlapMillis;    // <-- After converging, with more than one on
+    uint64_t gapMillis;        // <-- After converging, with none on though the beacon was seen
+    unsigned long frames;
+    unsigned long frameBytes;
+};
+
+/**
+ * Samples the beacon's RSSI at a distance, as a log-distance path loss
+ * with a path loss exponent of 2.5 and -59 dBm at a meter.
+ *
+ * @param meters - The distance as double.
+ * @param noise - Gives the noise in dB as std::normal_distribution<double>&.
+ * @param random - The random source as std::mt19937&.
+ *
+ * @return Returns the RSSI as int.
+ */
+static int sampleRssi(double meters, std::normal_distribution<double> &noise, std::mt19937 &random) {
+    double rssi = -59.0 - 25.0 * log10(std::max(meters, 0.5)) + noise(random);
+
+    return (int)lround(rssi);
+}
+
+/**
+ * Makes a switch's decision as doDeterminePairedDeviceProximity() does,
+ * broadcasting at once when its device turns on or off.
+ *
+ * @param node - The switch as Node&.
+ * @param identity - The beacon's identity as uint32_t.
+ * @param nowMillis - The current time as uint64_t.
+ */
+static void decide(Node &node, uint32_t identity, uint64_t nowMillis) {
+    bool isSeen = node.seenMillis != 0ULL && nowMillis - node.seenMillis <= MAX_NOT_SEEN_MILLIS;
+    bool isOn = isSeen && node.gossip.isNearest(identity, nowMillis);
+    bool isChanged = isOn != node.isOn;
+    node.isOn = isOn;
+    node.gossip.setClaiming(identity, isOn);
+    if (isChanged) {
+        node.gossip.broadcast(nowMillis);
+    }
+}
+
+/**
+ * Runs a scenario in virtual time.
+ *
+ * @param scenario - The scenario as const Scenario&.
+ * @param seed - Seeds the noise and loss as unsigned.
+ *
+ * @return Returns what happened as Results.
+ */
+static Results run(const Scenario &scenario, unsigned seed) {
+    std::mt19937 random(seed);
+    std::normal_distribution<double> noise(0.0, scenario.noiseDb > 0.0 ? scenario.noiseDb : 1e-9);
+    Air air(random, scenario.loss);
+    uint64_t nowMillis = START_MILLIS;
+    const uint32_t identity = Gossip::identityOf("a4:c1:38:0b:1e:77");
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    for (uint8_t i = 0; i < NODE_COUNT; i++) {
+        nodes.emplace_back(new Node(air, i, nowMillis));
+        nodes[i]->gossip.begin(i + 1UL, scenario.marginDb, GOSSIP_MAX_AGE_MILLIS);
+    }
+
+    Results results = {};
+    bool isConverged = false;
+    int owner = -1;
+    uint64_t endMillis = START_MILLIS + scenario.seconds * 1000ULL;
+    for (; nowMillis < endMillis; nowMillis += STEP_MILLIS) {
+        uint64_t elapsed = nowMillis - START_MILLIS;
+        if (scenario.silentNode >= 0 && elapsed == scenario.silentAtMillis) {
+            nodes[scenario.silentNode]->isSilent = true;
+            nodes[scenario.silentNode]->isOn = false;
+        }
+
+        // Frames due are heard by every other switch still running
+        for (size_t i = 0; i < air.inFlight.size();) {
+            Frame &frame = air.inFlight[i];
+            if (frame.deliverMillis > nowMillis) {
+                i++;
+                continue;
+            }
+            for (uint8_t to = 0; to < NODE_COUNT; to++) {
+                if (to != frame.from && !nodes[to]->isSilent && !air.isLost()) {
+                    nodes[to]->gossip.receive(frame.bytes.data(), frame.bytes.size(), nowMillis);
+                }
+            }
+            air.inFlight.erase(air.inFlight.begin() + i);
+        }
+
+        double beacon = scenario.beaconAt(elapsed);
+        bool isSeenByAny = false;
+        for (uint8_t i = 0; i < NODE_COUNT; i++) {
+            Node &node = *nodes[i];
+            if (node.isSilent) {
+                continue;
+            }
+
+            // Each switch on its own schedule, as their clocks don't agree
+            if ((elapsed + i * 330ULL) % SAMPLE_MILLIS == 0ULL) {
+                int rssi = sampleRssi(fabs(beacon - node.position), noise, random);
+                if (rssi > SENSITIVITY_RSSI) {
+                    node.gossip.recordLocal(identity, rssi, nowMillis);
+                    node.seenMillis = nowMillis;
+                }
+            }
+            decide(node, identity, nowMillis);
+            if ((elapsed + i * 700ULL) % GOSSIP_INTERVAL_MILLIS == 0ULL) {
+                node.gossip.broadcast(nowMillis);
+            }
+            isSeenByAny = isSeenByAny || (node.seenMillis != 0ULL && nowMillis - node.seenMillis <= MAX_NOT_SEEN_MILLIS);
+        }
+
+        int onCount = 0;
+        int onNode = -1;
+        for (uint8_t i = 0; i < NODE_COUNT; i++) {
+            if (nodes[i]->isOn) {
+                onCount++;
+                onNode = i;
+            }
+        }
+        if (!isConverged && onCount == 1 && elapsed >= SAMPLE_MILLIS) {
+            isConverged = true;
+            results.convergeMillis = elapsed;
+        }
+        if (!isConverged) {
+            continue;
+        }
+
+        if (onCount > 1) {
+            results.overlapMillis += STEP_MILLIS;
+        } else if (onCount == 0 && isSeenByAny) {
+            results.gapMillis += STEP_MILLIS;
+        } else if (onCount == 1 && onNode != owner) {
+            results.handovers += owner < 0 ? 0UL : 1UL;
+            results.owners += std::string(results.owners.empty() ? "" : " ") + (char)('A' + onNode);
+            owner = onNode;
+        }
+    }
+    results.frames = air.sent;
+    results.frameBytes = air.bytes;
+
+    return results;
+}
+
+static double nearB(uint64_t) { return 5.0; }
+static double nearerB(uint64_t) { return 4.5; }
+static double betweenAandB(uint64_t) { return SPACING_METERS / 2.0; }
+
+// Carried from A to C over two minutes, then left there
+static double walkAtoC(uint64_t millis) {
+    return std::min(millis / 120000.0, 1.0) * SPACING_METERS * (NODE_COUNT - 1);
+}
+
+// Carried from A to C at a walk, in 12 seconds
+static double hurryAtoC(uint64_t millis) {
+    return std::min(millis / 12000.0, 1.0) * SPACING_METERS * (NODE_COUNT - 1);
+}
+
+static void print(const char *name, const Results &results) {
+    printf("%-22s %10llu %-8s %9lu %11llu %8llu %8lu %9.1f\n",
+        name, (unsigned long long)results.convergeMillis, results.owners.size() > 8 ? "..." : results.owners.c_str(),
+        results.handovers, (unsigned long long)results.overlapMillis, (unsigned long long)results.gapMillis,
+        results.frames, results.frames == 0UL ? 0.0 : (double)results.frameBytes / results.frames);
+}
+
+int main(int argc, char **argv) {
+    unsigned seed = 1U;
+
+    const struct option longOptions[] = {
+        { "seed", required_argument, nullptr, 's' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+        switch (option) {
+            case 's': seed = (unsigned)strtoul(optarg, nullptr, 10); break;
+            default:
+                fprintf(stderr, "usage: gossip_sim [--seed N]\n");
+                return 2;
+        }
+    }
+
+    Results nearest = run({ 4, 2.0, 0.0, 60ULL, nearB, -1, 0ULL }, seed);
+    Results lossy = run({ 4, 2.0, 0.3, 60ULL, nearB, -1, 0ULL }, seed);
+    Results held = run({ 4, 3.0, 0.0, 1800ULL, betweenAandB, -1, 0ULL }, seed);
+    Results flapping = run({ 0, 3.0, 0.0, 1800ULL, betweenAandB, -1, 0ULL }, seed);
+    Results walked = run({ 4, 2.0, 0.0, 180ULL, walkAtoC, -1, 0ULL }, seed);
+    Results hurried = run({ 4, 2.0, 0.0, 60ULL, hurryAtoC, -1, 0ULL }, seed);
+    Results silenced = run({ 4, 2.0, 0.0, 120ULL, nearerB, 1, 60000ULL }, seed);
+    Results tied = run({ 4, 0.0, 0.0, 60ULL, betweenAandB, -1, 0ULL }, seed);
+
+    printf("%-22s %10s %-8s %9s %11s %8s %8s %9s\n",
+        "scenario", "converge", "owners", "handovers", "overlap ms", "gap ms", "frames", "bytes/fr");
+    print("nearest", nearest);
+    print("nearest, 30% loss", lossy);
+    print("same distance, 4 dB", held);
+    print("same distance, 0 dB", flapping);
+    print("walk A to C", walked);
+    print("hurry A to C", hurried);
+    print("B goes silent", silenced);
+    print("tie, no noise", tied);
+    printf("\n");
+
+    const uint64_t convergeMillis = SAMPLE_MILLIS + GOSSIP_INTERVAL_MILLIS + DELIVERY_MILLIS;
+    check("converge on the nearest within a sample and a broadcast",
+        nearest.owners == "B" && nearest.convergeMillis <= convergeMillis);
+    check("  and never leave two on after", nearest.overlapMillis == 0ULL && nearest.gapMillis == 0ULL);
+    check("  and with 30% of frames lost", lossy.owners == "B" && lossy.overlapMillis == 0ULL);
+    check("margin holds at the same distance, a handover at most",
+        held.handovers <= 1UL && held.overlapMillis <= held.handovers * GOSSIP_INTERVAL_MILLIS);
+    check("  where no margin flaps", flapping.handovers > 10UL);
+    check("walk hands over from each switch to the next once", walked.owners == "A B C");
+    check("  leaving two on no longer than a broadcast", walked.overlapMillis <= walked.handovers * GOSSIP_INTERVAL_MILLIS);
+    check("  and carried past at a walk ends at the last", hurried.owners.back() == 'C' && hurried.overlapMillis <= hurried.handovers * GOSSIP_INTERVAL_MILLIS);
+    check("silent switch hands over once its sightings are stale",
+        silenced.owners == "B A" && silenced.gapMillis <= GOSSIP_MAX_AGE_MILLIS + GOSSIP_INTERVAL_MILLIS);
+    check("tie goes to the lower node id", tied.owners == "A" && tied.handovers == 0UL);
+
+    printf("%s\n", failures == 0 ? "all passed" : "FAILURES");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+/*
+  histogram_check - Host test of the LogHistogram the loop profile keeps each
+  handler's CPU cycles in.
+
+  The bucket math is checked over the whole uint32_t range:
+
+    - every bucket's top is one below the next bucket's bottom, from 0 to
+      2^32-1, so each value has exactly one bucket;
+    - no bucket spans more than half of its lowest value;
+    - values either side of every power of two and a million random ones
+      land in the bucket whose range holds them.
+
+  Then spreads of values, uniform, log-uniform and with a long tail, are
+  recorded and each percentile from 1 to 100 compared with the exact one
+  from the sorted values; It must be at or above it and no higher than the
+  top of its bucket. The count, minimum and maximum must be exact, and a
+  reset must forget everything.
+
+  Last it times recording.
+
+  Usage:
+    histogram_check
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <LogHistogram.h>
+
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+static void check(const char *name, bool isPassed) {
+    printf("%-52s %s\n", name, isPassed ? "ok" : "FAILED");
+    failures += isPassed ? 0 : 1;
+}
+
+static double nowNanos() {
+    using namespace std::chrono;
+
+    return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Works out the smallest value which goes in a bucket.
+ *
+ * @param bucket - The bucket as uint8_t.
+ *
+ * @return Returns the value as uint64_t.
+ */
+static uint64_t bucketBottom(uint8_t bucket) {
+    return bucket == 0 ? 0ULL : (uint64_t)LogHistogram::bucketTop(bucket - 1) + 1ULL;
+}
+
+/**
+ * Checks a value lands in the bucket whose range holds it.
+ *
+ * @param value - The value as uint32_t.
+ *
+ * @return Returns true if it does otherwise false as bool.
+ */
+static bool isInItsBucket(uint32_t value) {
+    uint8_t bucket = LogHistogram::bucketOf(value);
+
+    return bucket < LogHistogram::BUCKETS
+        && bucketBottom(bucket) <= value
+        && value <= LogHistogram::bucketTop(bucket);
+}
+
+/**
+ * Records values in a histogram and checks every percentile against the
+ * exact one, along with the count, minimum and maximum.
+ *
+ * @param values - The values as std::vector<uint32_t>.
+ *
+ * @return Returns true if all of them are right otherwise false as bool.
+ */
+static bool isMatchingExact(std::vector<uint32_t> values) {
+    LogHistogram histogram;
+    for (uint32_t value : values) {
+        histogram.record(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    bool isMatching = histogram.getCount() == values.size()
+        && histogram.getMin() == values.front()
+        && histogram.getMax() == values.back();
+    for (uint8_t percent = 1; percent <= 100; percent++) {
+        size_t rank = (values.size() * percent + 99) / 100;
+        uint32_t exact = values[rank - 1];
+        uint32_t got = histogram.getPercentile(percent);
+        isMatching = isMatching && exact <= got && got <= LogHistogram::bucketTop(LogHistogram::bucketOf(exact));
+    }
+
+    return isMatching && histogram.getPercentile(100) == values.back();
+}
+
+int main() {
+    std::mt19937 random(4242);
+
+    // The buckets
+    bool isJoined = LogHistogram::bucketTop(0) == 0UL;
+    bool isNarrow = true;
+    for (uint8_t bucket = 1; bucket < LogHistogram::BUCKETS; bucket++) {
+        uint64_t bottom = bucketBottom(bucket);
+        uint64_t top = LogHistogram::bucketTop(bucket);
+        isJoined = isJoined && top >= bottom && LogHistogram::bucketOf((uint32_t)bottom) == bucket;
+        isNarrow = isNarrow && (bucket < 2 || top - bottom <= bottom / 2);
+    }
+    isJoined = isJoined && LogHistogram::bucketTop(LogHistogram::BUCKETS - 1) == UINT32_MAX;
+    check("buckets join up from 0 to 2^32-1", isJoined);
+    check("  none spans more than half its lowest value", isNarrow);
+
+    bool isPlaced = isInItsBucket(0UL) && isInItsBucket(1UL) && isInItsBucket(UINT32_MAX);
+    for (uint8_t power = 1; power < 32; power++) {
+        uint32_t value = 1UL << power;
+        isPlaced = isPlaced && isInItsBucket(value - 1UL) && isInItsBucket(value) && isInItsBucket(value + 1UL);
+    }
+    check("values either side of each power of two placed", isPlaced);
+
+    isPlaced = true;
+    for (int i = 0; i < 1000000; i++) {
+        isPlaced = isPlaced && isInItsBucket((uint32_t)random());
+    }
+    check("  and a million random values", isPlaced);
+
+    // Percentiles
+    std::vector<uint32_t> values;
+    std::uniform_int_distribution<uint32_t> uniform(1000UL, 50000UL);
+    for (int i = 0; i < 10000; i++) {
+        values.push_back(uniform(random));
+    }
+    check("percentiles of a uniform spread", isMatchingExact(values));
+
+    values.clear();
+    std::uniform_real_distribution<double> exponent(0.0, 32.0);
+    for (int i = 0; i < 10000; i++) {
+        values.push_back((uint32_t)std::min(exp2(exponent(random)), (double)UINT32_MAX));
+    }
+    check("  of a log-uniform spread", isMatchingExact(values));
+
+    values.clear();
+    std::exponential_distribution<double> tail(1.0 / 3000.0);
+    for (int i = 0; i < 10000; i++) {
+        values.push_back(i % 500 == 0 ? 4000000UL : 2000UL + (uint32_t)tail(random));
+    }
+    check("  of handlers with a rare slow run", isMatchingExact(values));
+
+    check("  of one value", isMatchingExact({ 12345UL }));
+    check("  of 0 and 2^32-1", isMatchingExact({ 0UL, UINT32_MAX, UINT32_MAX }));
+
+    // Empty and reset
+    LogHistogram histogram;
+    bool isEmpty = histogram.getCount() == 0UL && histogram.getPercentile(50) == 0UL && histogram.getMax() == 0UL;
+    check("an empty histogram gives 0", isEmpty);
+    histogram.record(7UL);
+    histogram.record(900UL);
+    histogram.reset();
+    histogram.record(40UL);
+    check("reset forgets what was recorded", histogram.getCount() == 1UL && histogram.getMin() == 40UL
+        && histogram.getMax() == 40UL && histogram.getPercentile(1) == 40UL && histogram.getPercentile(100) == 40UL);
+
+    // Timing
+    const unsigned long records = 50000000UL;
+    histogram.reset();
+    uint32_t value = 1UL;
+    double start = nowNanos();
+    for (unsigned long i = 0; i < records; i++) {
+        value = value * 1664525UL + 1013904223UL;
+        histogram.record(value >> (i & 31));
+    }
+    double recordNanos = (nowNanos() - start) / records;
+    check("count exact after 50 million records", histogram.getCount() == records);
+
+    printf("\n%.2f ns/record on the host (%lu records, p50 %lu)\n", recordNanos, records, (unsigned long)histogram.getPercentile(50));
+
+    printf("%s\n", failures == 0 ? "all passed" : "FAILURES");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,373 @@
+/*
+  json_check - Host test of the JsonWriter and the JsonResponse the web APIs
+  stream their documents with.
+
+  The writer's output is checked exactly for:
+
+    - escaping of quotes, backslashes, newlines and other control characters
+      in both keys and values, with UTF-8 passed through untouched;
+    - integers at the limits of each type and decimals, with NaN and values
+      too large for a double's digits written as null;
+    - commas and colons through nested objects and arrays, empty ones too;
+    - every buffer size from 1 byte up, so that each token and each escape is
+      split across a flush somewhere, giving the same document every time.
+
+  The response is checked by pulling a paged device list from it as the async
+  server does, a socket's worth at a time, from 1 byte up:
+
+    - the cursor's offset and limit page the list, and pages join up with
+      no device missing or repeated;
+    - devices added or dropped between steps, as the scan does while a page
+      is being sent, neither repeat nor skip the devices that stay;
+    - a step writing more than the pending buffer holds ends the document
+      rather than sending it corrupted.
+
+  Last it times the writer over a long document.
+
+  Usage:
+    json_check
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <JsonWriter.h>
+#include <JsonResponse.h>
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <map>
+#include <string>
+
+static int failures = 0;
+
+static void check(const char *name, const std::string &got, const std::string &expected) {
+    bool isPassed = got == expected;
+    printf("%-56s %s\n", name, isPassed ? "ok" : "FAILED");
+    if (!isPassed) {
+        printf("  expected: %s\n  got:      %s\n", expected.c_str(), got.c_str());
+    }
+    failures += isPassed ? 0 : 1;
+}
+
+static void check(const char *name, bool isPassed) {
+    check(name, isPassed ? "true" : "false", "true");
+}
+
+static void appendTo(const char *data, size_t length, void *context) {
+    ((std::string *)context)->append(data, length);
+}
+
+/**
+ * Writes a document through a writer with the given buffer size.
+ *
+ * @param bufferSize - The size of the writer's buffer as size_t.
+ * @param document - Writes the document as void (*)(JsonWriter&).
+ *
+ * @return Returns what was handed to the sink as std::string.
+ */
+static std::string write(size_t bufferSize, void (*document)(JsonWriter&)) {
+    std::string output;
+    char buffer[256];
+    JsonWriter json(buffer, bufferSize, appendTo, &output);
+    document(json);
+    json.flush();
+
+    return json.getTotalBytes() == output.size() ? output : std::string("<byte count wrong>");
+}
+
+static void writeEscapes(JsonWriter &json) {
+    json.beginObject()
+        .field("quote\"d", "say \"hi\"")
+        .field("back\\slash", "C:\\temp\\")
+        .field("lines", "one\ntwo\r\n")
+        .field("controls", "\x01\t\x1f\x7f")
+        .field("utf8", "caf\xc3\xa9 \xe2\x9c\x93")
+        .field("empty", "")
+        .field("none", (const char *)nullptr)
+        .endObject();
+}
+
+static void writeNumbers(JsonWriter &json) {
+    json.beginArray()
+        .value(0)
+        .value(INT_MIN)
+        .value(UINT_MAX)
+        .value(LLONG_MIN)
+        .value(LLONG_MAX)
+        .value(ULLONG_MAX)
+        .value(-12.345)
+        .value(2.5, 0)
+        .value(1.0 / 3.0, 4)
+        .value((double)NAN)
+        .value(1.0e16)
+        .value(true)
+        .value(false)
+        .nullValue()
+        .endArray();
+}
+
+static void writeNesting(JsonWriter &json) {
+    json.beginObject()
+        .key("empty_object").beginObject().endObject()
+        .key("empty_array").beginArray().endArray()
+        .key("rows").beginArray()
+            .beginArray().value(1).value(2).endArray()
+            .beginObject().field("a", 1).key("b").beginArray().beginObject().endObject().endArray().endObject()
+            .beginArray().endArray()
+        .endArray()
+        .field("last", "x")
+        .endObject();
+}
+
+// The device list the paging producer reads, as seenDevices is
+static std::map<std::string, int> devices;
+static void (*betweenSteps)(uint32_t step) = nullptr;
+
+/**
+ * Pages the device list just as writeDevicesJson() does; The header,
+ * then one device per step, the place kept by address.
+ */
+static bool writeDevices(JsonWriter &json, JsonResponse::Cursor &cursor) {
+    if (betweenSteps != nullptr) {
+        betweenSteps(cursor.step);
+    }
+
+    if (cursor.step == 0UL) {
+        json.beginObject()
+            .field("total", devices.size())
+            .field("offset", cursor.offset)
+            .field("limit", cursor.remaining)
+            .key("devices").beginArray();
+
+        return true;
+    }
+
+    auto device = devices.end();
+    if (cursor.step == 1UL) {
+        device = devices.begin();
+        for (long i = 0; i < cursor.offset && device != devices.end(); i++) {
+            device++;
+        }
+    } else {
+        device = devices.upper_bound(cursor.lastKey);
+    }
+
+    if (cursor.remaining <= 0L || device == devices.end()) {
+        json.endArray()
+            .endObject();
+
+        return false;
+    }
+
+    json.beginObject()
+        .field("mac", device->first.c_str())
+        .field("rssi", device->second)
+        .endObject();
+
+    strlcpy(cursor.lastKey, device->first.c_str(), sizeof(cursor.lastKey));
+    cursor.remaining--;
+
+    return true;
+}
+
+static bool writeOversizedStep(JsonWriter &json, JsonResponse::Cursor &cursor) {
+    if (cursor.step == 0UL) {
+        json.beginArray();
+
+        return true;
+    }
+
+    std::string big(JsonResponse::PENDING_BUFFER_SIZE, 'x');
+    json.value(big.c_str());
+
+    return true; // <-- Would go on forever were it not ended
+}
+
+/**
+ * Pulls the whole body from a response, as the server does, a socket's
+ * worth at a time.
+ *
+ * @param response - The response as JsonResponse&.
+ * @param socketSize - How much the socket takes each time as size_t.
+ *
+ * @return Returns the body as std::string.
+ */
+static std::string pull(JsonResponse &response, size_t socketSize) {
+    std::string body;
+    uint8_t buffer[2048];
+    size_t length;
+    int calls = 0;
+    while ((length = response._fillBuffer(buffer, std::min(socketSize, sizeof(buffer)))) > 0 && calls++ < 1000000) {
+        body.append((const char *)buffer, length);
+    }
+
+    return body;
+}
+
+static std::string pullDevices(long offset, long limit, size_t socketSize) {
+    JsonResponse response(writeDevices);
+    response.getCursor().offset = offset;
+    response.getCursor().remaining = limit;
+
+    return pull(response, socketSize);
+}
+
+static std::string mac(int i) {
+    char text[18];
+    snprintf(text, sizeof(text), "aa:bb:cc:00:%02x:%02x", (i >> 8) & 0xFF, i & 0xFF);
+
+    return text;
+}
+
+static std::string deviceJson(const std::string &address, int rssi) {
+    return "{\"mac\":\"" + address + "\",\"rssi\":" + std::to_string(rssi) + "}";
+}
+
+static std::string page(long total, long offset, long limit, const std::string &items) {
+    return "{\"total\":" + std::to_string(total) + ",\"offset\":" + std::to_string(offset)
+        + ",\"limit\":" + std::to_string(limit) + ",\"devices\":[" + items + "]}";
+}
+
+// Every third step drops a device ahead of the place, and adds one behind it and one ahead
+static void churn(uint32_t step) {
+    if (step >= 2UL && step % 3UL == 0UL) {
+        devices.erase(mac(60 + (int)step));
+        devices["aa:bb:00:00:00:00"] = -99;                               // <-- Behind every address
+        devices["aa:bb:cc:ff:ff:" + std::to_string(10 + step % 90)] = -98; // <-- Ahead of every address
+    }
+}
+
+int main() {
+    // Writer
+    const std::string escapes =
+        "{\"quote\\\"d\":\"say \\\"hi\\\"\",\"back\\\\slash\":\"C:\\\\temp\\\\\",\"lines\":\"one\\ntwo\\u000d\\n\","
+        "\"controls\":\"\\u0001\\u0009\\u001f\x7f\",\"utf8\":\"caf\xc3\xa9 \xe2\x9c\x93\",\"empty\":\"\",\"none\":null}";
+    const std::string numbers =
+        "[0,-2147483648,4294967295,-9223372036854775808,9223372036854775807,18446744073709551615,"
+        "-12.35,2,0.3333,null,null,true,false,null]";
+    const std::string nesting =
+        "{\"empty_object\":{},\"empty_array\":[],\"rows\":[[1,2],{\"a\":1,\"b\":[{}]},[]],\"last\":\"x\"}";
+    check("escapes quotes, backslashes and control characters", write(256, writeEscapes), escapes);
+    check("writes integers at their limits, decimals and null", write(256, writeNumbers), numbers);
+    check("places commas and colons through nesting", write(256, writeNesting), nesting);
+
+    bool isSame = true;
+    for (size_t bufferSize = 1; bufferSize <= 256; bufferSize++) {
+        isSame = isSame
+            && write(bufferSize, writeEscapes) == escapes
+            && write(bufferSize, writeNumbers) == numbers
+            && write(bufferSize, writeNesting) == nesting;
+    }
+    check("same documents through buffers of 1 to 256 bytes", isSame);
+
+    // Response
+    {
+        JsonResponse response(writeDevices);
+        check("response is chunked JSON that isn't cached",
+            response._code == 200 && std::string(response._contentType.c_str()) == "application/json"
+            && response._chunked && !response._sendContentLength && response.headers == "Cache-Control: no-store\n");
+    }
+
+    devices.clear();
+    std::string all;
+    for (int i = 0; i < 120; i++) {
+        devices[mac(i)] = -40 - i % 50;
+        all += (i == 0 ? "" : ",") + deviceJson(mac(i), -40 - i % 50);
+    }
+    check("whole list in one page", pullDevices(0L, 500L, 1460), page(120, 0, 500, all));
+
+    std::string joined;
+    bool isPaged = true;
+    for (long offset = 0L; offset < 120L; offset += 50L) {
+        std::string body = pullDevices(offset, 50L, 1460);
+        size_t start = body.find('[') + 1;
+        std::string items = body.substr(start, body.rfind(']') - start);
+        joined += (joined.empty() || items.empty() ? "" : ",") + items;
+        isPaged = isPaged && body.find("\"offset\":" + std::to_string(offset) + ",\"limit\":50,") != std::string::npos;
+    }
+    check("pages of 50 join up with none missing or repeated", isPaged && joined == all);
+    check("offset past the end gives an empty page", pullDevices(500L, 50L, 1460), page(120, 500, 50, ""));
+    check("zero limit gives an empty page", pullDevices(0L, 0L, 1460), page(120, 0, 0, ""));
+
+    isSame = true;
+    std::string expected = pullDevices(10L, 80L, 2048);
+    for (size_t socketSize = 1; socketSize <= 1500 && isSame; socketSize += socketSize < 64 ? 1 : 37) {
+        isSame = pullDevices(10L, 80L, socketSize) == expected;
+    }
+    check("same page through sockets of 1 to 1500 bytes", isSame);
+
+    {
+        // The list changing while the page is sent
+        std::map<std::string, int> before = devices;
+        betweenSteps = churn;
+        std::string body = pullDevices(0L, 500L, 97);
+        betweenSteps = nullptr;
+
+        bool isInOrder = true;
+        bool isEachOnce = true;
+        std::string last;
+        size_t at = 0;
+        std::map<std::string, int> sent;
+        while ((at = body.find("\"mac\":\"", at)) != std::string::npos) {
+            std::string address = body.substr(at + 7, 17);
+            isInOrder = isInOrder && address > last;
+            isEachOnce = isEachOnce && sent.count(address) == 0;
+            sent[address] = 1;
+            last = address;
+            at += 7;
+        }
+        bool isNoneSkipped = true;
+        bool isDroppedLeftOut = true;
+        size_t dropped = 0;
+        for (const auto &device : before) {
+            bool isKept = devices.count(device.first) == 1;
+            dropped += isKept ? 0 : 1;
+            isNoneSkipped = isNoneSkipped && (!isKept || sent.count(device.first) == 1);
+            isDroppedLeftOut = isDroppedLeftOut && (isKept || sent.count(device.first) == 0);
+        }
+        check("list changing mid-page skips and repeats no device", isInOrder && isEachOnce && isNoneSkipped
+            && isDroppedLeftOut && dropped > 0 && sent.count("aa:bb:00:00:00:00") == 0
+            && sent.count("aa:bb:cc:ff:ff:13") == 1 && body.back() == '}');
+        devices = before;
+    }
+
+    {
+        JsonResponse response(writeOversizedStep);
+        std::string body = pull(response, 1460);
+        check("oversized step ends the document", body.size() == 1 + JsonResponse::PENDING_BUFFER_SIZE && body[0] == '[');
+    }
+
+    // Throughput, as the devices API writes a device
+    {
+        std::string sink;
+        sink.reserve(1 << 20);
+        char buffer[JsonResponse::WRITER_BUFFER_SIZE];
+        const int count = 1000000;
+        auto start = std::chrono::steady_clock::now();
+        size_t bytes = 0;
+        for (int i = 0; i < count; i++) {
+            JsonWriter json(buffer, sizeof(buffer), [](const char *, size_t, void *) {});
+            json.beginObject()
+                .field("mac", "a4:c1:38:5e:2b:07")
+                .field("rssi", -61)
+                .field("age_ms", 1234ULL + i)
+                .field("present", true)
+                .field("close", false)
+                .field("paired", false)
+                .endObject();
+            json.flush();
+            bytes += json.getTotalBytes();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("\nwriter: %.0f ns per device, %.1f MB/s (%d devices of %lu bytes)\n",
+            seconds * 1e9 / count, bytes / seconds / 1e6, count, (unsigned long)(bytes / count));
+    }
+
+    printf("%s\n", failures == 0 ? "all passed" : "FAILURES");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+/*
+  Host stand-in for the parts of Arduino.h JsonResponse and the test use.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef JsonCheckArduino_h
+    #define JsonCheckArduino_h
+
+    #include <stddef.h>
+    #include <stdint.h>
+    #include <string.h>
+
+    #include <algorithm>
+    #include <string>
+
+    #define F(text) (text)
+
+    #if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+        static inline size_t strlcpy(char *destination, const char *source, size_t size) {
+            size_t length = strlen(source);
+            if (size > 0) {
+                size_t count = length < size - 1 ? length : size - 1;
+                memcpy(destination, source, count);
+                destination[count] = '\0';
+            }
+
+            return length;
+        }
+    #endif
+
+    class String {
+    public:
+        String(const char *text = "") : text(text) {}
+
+        const char* c_str() const { return text.c_str(); }
+
+    private:
+        std::string text;
+    };
+#endif
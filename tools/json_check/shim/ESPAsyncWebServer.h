@@ -0,0 +1,36 @@
+/*
+  Host stand-in for the response base class of ESPAsyncWebServer, holding
+  what JsonResponse sets so the test can check it. The test pulls the body
+  with _fillBuffer() as the server would as the socket has room.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef JsonCheckESPAsyncWebServer_h
+    #define JsonCheckESPAsyncWebServer_h
+
+    #include <Arduino.h>
+
+    class AsyncWebServerResponse {
+    public:
+        virtual ~AsyncWebServerResponse() {}
+
+        void addHeader(const String &name, const String &value) {
+            headers += std::string(name.c_str()) + ": " + value.c_str() + "\n";
+        }
+
+        virtual bool _sourceValid() const { return false; }
+
+        int _code = 0;
+        String _contentType;
+        size_t _contentLength = 0;
+        bool _sendContentLength = true;
+        bool _chunked = false;
+        std::string headers;
+    };
+
+    class AsyncAbstractResponse : public AsyncWebServerResponse {
+    public:
+        virtual size_t _fillBuffer(uint8_t *, size_t) { return 0; }
+    };
+#endif
@@ -0,0 +1,407 @@
+/*
+  ledman_bench - Host bench of the firmware's LedMan against the LedMan it was
+  released with, which kept each caller's state in nested std::map tables keyed
+  by String and worked out every LED on each pass of the loop with loop().
+
+  First it checks the two agree and that the current one is safe to share:
+
+    - a long random run of the firmware's lock, release, on, off and toggle
+      calls, on the LEDs and callers the firmware uses, with the priorities
+      setup() gave the released one, lights every LED the same in both;
+    - patterns play their edges on time, hand the LED back when preempted or
+      done, and stop their timer when they lose the LED, and a pattern given
+      a higher priority than its caller's shows over the callers between;
+    - no pin is written and no timer armed or stopped inside the spinlock,
+      and a change made by another task while a pin is being written, which
+      returns at once, is still shown once the writer is done.
+
+  Then it times the same random calls through each, and the released one's
+  loop() pass, counting the heap allocations and pin reads they make.
+
+  These are host figures. The ESP32 is much slower than the host, which
+  changes the times but not the allocations, reads or writes counted.
+
+  Usage:
+    ledman_bench [--calls 1000000] [--seed 1]
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <LedMan.h>
+#include "released_ledman.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <new>
+#include <random>
+#include <vector>
+
+// The firmware's LEDs and callers, as main.cpp has them
+enum Led : uint8_t {
+    LEARN_LED,
+    CLOSE_LED,
+    LED_COUNT
+};
+
+enum LedCaller : uint8_t {
+    FACTORY_RESET_CALLER,
+    WIFI_DISABLE_CALLER,
+    LEARN_CALLER,
+    WIFI_ENABLE_CALLER,
+    CLOSE_CALLER,
+    LED_CALLER_COUNT
+};
+
+typedef LedMan<Led, LED_COUNT, LedCaller, LED_CALLER_COUNT> CurrentLedMan;
+
+static const uint8_t CURRENT_PINS[LED_COUNT] = { 2, 4 };
+static const int RELEASED_PINS[LED_COUNT] = { 12, 14 };
+static const char *LED_IDS[LED_COUNT] = { "learn_led", "close_led" };
+static const char *CALLER_IDS[LED_CALLER_COUNT] = { "factory", "wifi_off", "learn", "wifi", "close" };
+
+// Which LED each caller drives
+static const Led CALLER_LEDS[LED_CALLER_COUNT] = { LEARN_LED, CLOSE_LED, LEARN_LED, CLOSE_LED, CLOSE_LED };
+
+enum Op : uint8_t {
+    OP_LOCK,
+    OP_RELEASE,
+    OP_ON,
+    OP_OFF,
+    OP_TOGGLE,
+    OP_COUNT
+};
+
+struct Call {
+    Op op;
+    LedCaller caller;
+};
+
+static unsigned long allocations = 0UL;
+static int failures = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void *memory = malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+void operator delete(void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+    free(memory);
+}
+
+static void check(const char *name, bool isPassed) {
+    printf("%-56s %s\n", name, isPassed ? "ok" : "FAILED");
+    failures += isPassed ? 0 : 1;
+}
+
+static double nowNanos() {
+    using namespace std::chrono;
+
+    return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Gives the released LedMan its LEDs and the caller priorities setup()
+ * gave it; Lower is higher priority and each LED had its own.
+ *
+ * @param ledMan - The LedMan to set up as ReleasedLedMan&.
+ */
+static void setUpReleased(ReleasedLedMan &ledMan) {
+    for (uint8_t led = 0; led < LED_COUNT; led++) {
+        pinMode(RELEASED_PINS[led], OUTPUT);
+        ledMan.addLed(RELEASED_PINS[led], LED_IDS[led]);
+    }
+    ledMan.setCallerPriority("factory", 1);
+    ledMan.setCallerPriority("learn", 2);
+    ledMan.setCallerPriority("wifi_off", 1);
+    ledMan.setCallerPriority("wifi", 2);
+    ledMan.setCallerPriority("close", 3);
+}
+
+static std::vector<Call> randomCalls(size_t count, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> op(0, OP_COUNT - 1);
+    std::uniform_int_distribution<int> caller(0, LED_CALLER_COUNT - 1);
+
+    std::vector<Call> calls(count);
+    for (Call &call : calls) {
+        call = { (Op)op(random), (LedCaller)caller(random) };
+    }
+
+    return calls;
+}
+
+static void makeCall(CurrentLedMan &ledMan, const Call &call) {
+    Led led = CALLER_LEDS[call.caller];
+    switch (call.op) {
+        case OP_LOCK: ledMan.lockLed(led, call.caller); break;
+        case OP_RELEASE: ledMan.releaseLed(led, call.caller); break;
+        case OP_ON: ledMan.ledOn(led, call.caller); break;
+        case OP_OFF: ledMan.ledOff(led, call.caller); break;
+        default: ledMan.ledToggle(led, call.caller); break;
+    }
+}
+
+static void makeCall(ReleasedLedMan &ledMan, const Call &call) {
+    String led = LED_IDS[CALLER_LEDS[call.caller]];
+    String caller = CALLER_IDS[call.caller];
+    switch (call.op) {
+        case OP_LOCK: ledMan.lockLed(led, caller); break;
+        case OP_RELEASE: ledMan.releaseLed(led, caller); break;
+        case OP_ON: ledMan.ledOn(led, caller); break;
+        case OP_OFF: ledMan.ledOff(led, caller); break;
+        default: ledMan.ledToggle(led, caller); break;
+    }
+}
+
+/**
+ * Makes the same calls through both LedMans, the released one's loop()
+ * run after each as the firmware's loop would, and compares their pins.
+ *
+ * @param calls - The calls as const std::vector<Call>&.
+ *
+ * @return Returns true if every LED was lit the same after every call
+ * otherwise false as bool.
+ */
+static bool isLitTheSame(const std::vector<Call> &calls) {
+    CurrentLedMan current(CURRENT_PINS);
+    current.begin();
+    ReleasedLedMan released;
+    setUpReleased(released);
+
+    for (const Call &call : calls) {
+        makeCall(current, call);
+        makeCall(released, call);
+        released.loop();
+        for (uint8_t led = 0; led < LED_COUNT; led++) {
+            if (hostPins[CURRENT_PINS[led]] != hostPins[RELEASED_PINS[led]]) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Edges written to the close LED's pin by the pattern checks
+static std::vector<int64_t> closeEdges;
+static uint8_t closeLevel = LOW;
+
+static void recordCloseEdge() {
+    if (hostPins[CURRENT_PINS[CLOSE_LED]] != closeLevel) {
+        closeLevel = hostPins[CURRENT_PINS[CLOSE_LED]];
+        closeEdges.push_back(virtualMicros);
+    }
+}
+
+static void checkPatterns() {
+    hostTimerCount = 0;
+    virtualMicros = 0LL;
+    CurrentLedMan ledMan(CURRENT_PINS);
+    ledMan.begin();
+    HostTimer &closeTimer = hostTimers[CLOSE_LED];
+    HostTimer &learnTimer = hostTimers[LEARN_LED];
+
+    // The WiFi blink over a close device, as doWiFiOn() gives it
+    ledMan.ledOn(CLOSE_LED, CLOSE_CALLER);
+    ledMan.lockLed(CLOSE_LED, WIFI_ENABLE_CALLER);
+    ledMan.ledPattern(CLOSE_LED, WIFI_ENABLE_CALLER, { 100UL, 50, 0, 0 });
+    closeEdges.clear();
+    closeLevel = hostPins[CURRENT_PINS[CLOSE_LED]];
+    hostWriteHook = recordCloseEdge;
+    runTimersUntil(1000000LL);
+    bool isOnTime = closeEdges.size() == 20;
+    for (size_t i = 0; i < closeEdges.size(); i++) {
+        isOnTime = isOnTime && closeEdges[i] == (int64_t)(i + 1) * 50000LL;
+    }
+    check("blink plays an edge every 50 ms", isOnTime);
+
+    ledMan.lockLed(CLOSE_LED, WIFI_DISABLE_CALLER);
+    check("  preempted by a lock, stops its timer", hostPins[CURRENT_PINS[CLOSE_LED]] == LOW && closeTimer.dueMicros < 0LL);
+    runTimersUntil(1500000LL);
+    check("  and stays stopped", hostPins[CURRENT_PINS[CLOSE_LED]] == LOW && closeEdges.size() == 21);
+
+    ledMan.releaseLed(CLOSE_LED, WIFI_DISABLE_CALLER);
+    int64_t regainedMicros = virtualMicros;
+    runTimersUntil(regainedMicros + 50000LL);
+    check("  starts over when it regains the LED", closeEdges.size() == 23 && closeEdges[21] == regainedMicros && closeEdges.back() == regainedMicros + 50000LL);
+
+    ledMan.releaseLed(CLOSE_LED, WIFI_ENABLE_CALLER);
+    ledMan.ledOff(CLOSE_LED, WIFI_ENABLE_CALLER);
+    hostWriteHook = nullptr;
+    check("  taken away, hands the LED back to the close device", hostPins[CURRENT_PINS[CLOSE_LED]] == HIGH && closeTimer.dueMicros < 0LL);
+
+    // A pattern with repeats under a lock, over the learn LED being on
+    ledMan.ledOn(LEARN_LED, LEARN_CALLER);
+    ledMan.lockLed(LEARN_LED, FACTORY_RESET_CALLER);
+    ledMan.ledPattern(LEARN_LED, FACTORY_RESET_CALLER, { 200UL, 50, 3, 0 });
+    int64_t startMicros = virtualMicros;
+    runTimersUntil(startMicros + 599000LL);
+    bool isPlaying = learnTimer.dueMicros >= 0LL;
+    runTimersUntil(startMicros + 600000LL);
+    check("three repeats play for 600 ms", isPlaying && learnTimer.dueMicros < 0LL);
+    check("  then the lock holds the LED off", hostPins[CURRENT_PINS[LEARN_LED]] == LOW);
+    ledMan.releaseLed(LEARN_LED, FACTORY_RESET_CALLER);
+    check("  until released", hostPins[CURRENT_PINS[LEARN_LED]] == HIGH);
+
+    // A pattern given a priority above its caller's
+    ledMan.lockLed(CLOSE_LED, WIFI_DISABLE_CALLER);
+    ledMan.ledPattern(CLOSE_LED, CLOSE_CALLER, { 100UL, 50, 0, WIFI_DISABLE_CALLER + 1 });
+    check("pattern raised to a lock's priority gives way to it", hostPins[CURRENT_PINS[CLOSE_LED]] == LOW && closeTimer.dueMicros < 0LL);
+    ledMan.ledPattern(CLOSE_LED, CLOSE_CALLER, { 100UL, 50, 0, FACTORY_RESET_CALLER + 1 });
+    check("  raised above it, plays over the lock", hostPins[CURRENT_PINS[CLOSE_LED]] == HIGH && closeTimer.dueMicros >= 0LL);
+    ledMan.ledOff(CLOSE_LED, CLOSE_CALLER);
+    check("  taken away, hands the LED back to the lock", hostPins[CURRENT_PINS[CLOSE_LED]] == LOW && closeTimer.dueMicros < 0LL);
+    ledMan.ledPattern(CLOSE_LED, CLOSE_CALLER, { 100UL, 50, 0, LED_CALLER_COUNT });
+    check("  and can't be lowered below its caller", hostPins[CURRENT_PINS[CLOSE_LED]] == LOW);
+    ledMan.releaseLed(CLOSE_LED, WIFI_DISABLE_CALLER);
+    check("  which shows it once the lock is released", hostPins[CURRENT_PINS[CLOSE_LED]] == HIGH && closeTimer.dueMicros >= 0LL);
+}
+
+// Makes a change from "another task" the first time a pin is written
+static CurrentLedMan *preemptingLedMan = nullptr;
+static unsigned long writesSeenByPreempter = 0UL;
+
+static void preemptWrite() {
+    hostWriteHook = nullptr;
+    unsigned long writes = hostPinWrites;
+    preemptingLedMan->ledOff(CLOSE_LED, CLOSE_CALLER);
+    writesSeenByPreempter = hostPinWrites - writes;
+}
+
+static void checkLocking() {
+    hostTimerCount = 0;
+    virtualMicros = 0LL;
+    hostCallsInCritical = 0UL;
+    CurrentLedMan ledMan(CURRENT_PINS);
+    ledMan.begin();
+
+    std::vector<Call> calls = randomCalls(20000, 7U);
+    for (size_t i = 0; i < calls.size(); i++) {
+        makeCall(ledMan, calls[i]);
+        if (i % 100 == 0) {
+            ledMan.ledPattern(CALLER_LEDS[calls[i].caller], calls[i].caller, { 100UL, 50, 2, 0 });
+            runTimersUntil(virtualMicros + 30000LL);
+        }
+    }
+    check("no pin written or timer called inside the spinlock", hostCallsInCritical == 0UL && hostCriticalDepth == 0);
+
+    ledMan.releaseLed(CLOSE_LED, WIFI_DISABLE_CALLER);
+    ledMan.releaseLed(CLOSE_LED, WIFI_ENABLE_CALLER);
+    ledMan.ledOff(CLOSE_LED, WIFI_DISABLE_CALLER);
+    ledMan.ledOff(CLOSE_LED, WIFI_ENABLE_CALLER);
+    ledMan.ledOff(CLOSE_LED, CLOSE_CALLER);
+
+    preemptingLedMan = &ledMan;
+    hostWriteHook = preemptWrite;
+    unsigned long writes = hostPinWrites;
+    ledMan.ledOn(CLOSE_LED, CLOSE_CALLER);
+    check("change made during a write returns without writing", writesSeenByPreempter == 0UL);
+    check("  and is written by the writer after", hostPins[CURRENT_PINS[CLOSE_LED]] == LOW && hostPinWrites - writes == 2UL);
+}
+
+/**
+ * Times the calls through the given LedMan.
+ *
+ * @param ledMan - The LedMan as LedManType&.
+ * @param calls - The calls as const std::vector<Call>&.
+ * @param callAllocations - Set to the allocations made as unsigned long&.
+ *
+ * @return Returns nanoseconds per call as double.
+ */
+template <typename LedManType>
+static double timeCalls(LedManType &ledMan, const std::vector<Call> &calls, unsigned long &callAllocations) {
+    unsigned long before = allocations;
+    double start = nowNanos();
+    for (const Call &call : calls) {
+        makeCall(ledMan, call);
+    }
+    double took = nowNanos() - start;
+    callAllocations = allocations - before;
+
+    return took / calls.size();
+}
+
+int main(int argc, char **argv) {
+    size_t callCount = 1000000;
+    unsigned seed = 1U;
+
+    const struct option longOptions[] = {
+        { "calls", required_argument, nullptr, 'c' },
+        { "seed", required_argument, nullptr, 'r' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+        switch (option) {
+            case 'c': callCount = (size_t)atol(optarg); break;
+            case 'r': seed = (unsigned)atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: ledman_bench [--calls N] [--seed N]\n");
+                return 2;
+        }
+    }
+    if (callCount == 0) {
+        fprintf(stderr, "ledman_bench: --calls must be at least 1\n");
+        return 2;
+    }
+
+    std::vector<Call> calls = randomCalls(callCount, seed);
+    check("random calls light every LED the same as released", isLitTheSame(std::vector<Call>(calls.begin(), calls.begin() + std::min(callCount, (size_t)200000))));
+    checkPatterns();
+    checkLocking();
+
+    // Calls, then the released one's per-pass work with its state as the calls left it
+    hostTimerCount = 0;
+    CurrentLedMan current(CURRENT_PINS);
+    current.begin();
+    ReleasedLedMan released;
+    setUpReleased(released);
+
+    unsigned long currentAllocations = 0UL;
+    unsigned long releasedAllocations = 0UL;
+    unsigned long writes = hostPinWrites;
+    double currentNanos = timeCalls(current, calls, currentAllocations);
+    unsigned long currentWrites = hostPinWrites - writes;
+    double releasedNanos = timeCalls(released, calls, releasedAllocations);
+
+    const unsigned long passes = 100000UL;
+    unsigned long reads = hostPinReads;
+    writes = hostPinWrites;
+    unsigned long passAllocations = allocations;
+    double start = nowNanos();
+    for (unsigned long pass = 0; pass < passes; pass++) {
+        released.loop();
+    }
+    double passNanos = (nowNanos() - start) / passes;
+    passAllocations = allocations - passAllocations;
+    reads = hostPinReads - reads;
+
+    printf("\n%-9s %9s %12s %11s %12s %11s %12s\n",
+        "ledman", "ns/call", "allocs/call", "writes/call", "ns/pass", "allocs/pass", "reads/pass");
+    printf("%-9s %9.1f %12.2f %11s %12.1f %11.2f %12.2f\n",
+        "released", releasedNanos, (double)releasedAllocations / callCount, "-",
+        passNanos, (double)passAllocations / passes, (double)reads / passes);
+    printf("%-9s %9.1f %12.2f %11.2f %12s %11s %12s\n",
+        "current", currentNanos, (double)currentAllocations / callCount, (double)currentWrites / callCount,
+        "none", "-", "-");
+    printf("(%lu random calls, seed %u; the released LedMan also needs loop() on every pass of the firmware's loop)\n",
+        (unsigned long)callCount, seed);
+
+    printf("%s\n", failures == 0 ? "all passed" : "FAILURES");
+
+    return failures == 0 ? 0 : 1;
+}
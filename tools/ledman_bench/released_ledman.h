@@ -0,0 +1,219 @@
+/*
+  released_ledman.h
+  The LedMan the firmware was released with, for ledman_bench to compare the
+  current one against. Its code is unchanged but for the class being renamed
+  ReleasedLedMan and its functions being made inline to live in one header.
+
+  Written by: ... Scott Griffis
+  Date: ......... 07/07/2025
+*/
+#ifndef ReleasedLedMan_h
+    #define ReleasedLedMan_h
+
+    #include <Arduino.h>
+    #include <WString.h>
+    #include <map>
+    #include <algorithm>
+    #include <string>
+
+    class ReleasedLedMan {
+    public:
+        void addLed(int ledPin, String ledId);
+        void setCallerPriority(String caller, int priority);
+        void lockLed(String ledId, String caller);
+        void releaseLed(String ledId, String caller);
+        void ledOn(String ledId, String caller);
+        void ledOff(String ledId, String caller);
+        void ledToggle(String ledId, String caller);
+        int currentState(String ledId, String caller);
+        void loop();
+
+    private:
+        std::map<std::string/*LedId*/, int/*PinNumber*/> registeredLeds;
+        std::map<std::string/*Caller*/, int/*Priority*/> priorities;
+        std::map<std::string/*Caller*/, std::map<std::string/*LedId*/, int/*Junk*/>> locks;
+        std::map<std::string/*Caller*/, std::map<std::string/*LedId*/, int/*CallerState*/>> callerStates;
+    };
+
+    /**
+     * Used to Register an LED with this class so that it can be 
+     * controlled by users of this class.
+     * 
+     * @param ledPin - This is the device pin for the LED as int.
+     */
+    inline void ReleasedLedMan::addLed(int ledPin, String ledId) {
+        registeredLeds[ledId.c_str()] = ledPin;
+    }
+
+    /**
+     * Used to set the priority for a caller function/process.
+     * The lower the priority value the more priority the caller
+     * process has.
+     * 
+     * @param caller - The ID of the caller as String.
+     * @param priority - The priority of the caller as int.
+     */
+    inline void ReleasedLedMan::setCallerPriority(String caller, int priority) {
+        priorities[caller.c_str()] = priority;
+    }
+
+    /**
+     * Used to obtain a lock for an LED. 
+     * This isn't an exclusive access kind of lock, it is more of a lock that 
+     * says both on and off states of the LED are important to this process/caller
+     * so as long as it has the priority to do so it may force the LED to be off 
+     * even if a lower priority processs/caller wants it on. Without a lock, when 
+     * a process sets the led to off another lower priority process can turn it on.
+     * 
+     * @param ledId - The ID of the LED to check caller state for as String.
+     * @param caller - The ID of the caller to check LED state for as String.
+     */
+    inline void ReleasedLedMan::lockLed(String ledId, String caller) {
+        if (locks.count(caller.c_str()) == 0 || locks[caller.c_str()].count(ledId.c_str()) == 0) {
+            // An existing lock wasn't found, so create it.
+            locks[caller.c_str()][ledId.c_str()] = 1; // Value doesn't matter.
+            if (
+                callerStates.count(caller.c_str()) == 0
+                || callerStates[caller.c_str()].count(ledId.c_str()) == 0
+            ) {
+                // No caller state for LED so create an off/low state.
+                callerStates[caller.c_str()][ledId.c_str()] = LOW;
+            }
+        }
+    }
+
+    /**
+     * Releases a lock on an LED for a given caller.
+     * 
+     * @param ledId - The ID of the LED to check caller state for as String.
+     * @param caller - The ID of the caller to check LED state for as String.
+     */
+    inline void ReleasedLedMan::releaseLed(String ledId, String caller) {
+        if (locks.count(caller.c_str()) > 0 && locks[caller.c_str()].count(ledId.c_str()) > 0) {
+            // Locked on specified LED.
+            locks[caller.c_str()].erase(ledId.c_str());
+            if (
+                callerStates.count(caller.c_str()) > 0 
+                && callerStates[caller.c_str()].count(ledId.c_str()) > 0 
+                && callerStates[caller.c_str()][ledId.c_str()] == LOW
+            ) {
+                // Erase LOW state because lock has been released.
+                callerStates[caller.c_str()].erase(ledId.c_str());
+            }
+        }
+    }
+
+    /**
+     * Sets the LED state for a given caller to on/high.
+     * 
+     * @param ledId - The ID of the LED to check caller state for as String.
+     * @param caller - The ID of the caller to check LED state for as String.
+     */
+    inline void ReleasedLedMan::ledOn(String ledId, String caller) {
+        callerStates[caller.c_str()][ledId.c_str()] = HIGH; 
+    }
+
+    /**
+     * Sets the LED state for a given caller to off/low.
+     * If the caller is locked on the LED then a LOW state
+     * is created/maintained, otherwise the LED state is
+     * removed so any other caller may turn the LED on if
+     * so desired.
+     * 
+     * @param ledId - The ID of the LED to check caller state for as String.
+     * @param caller - The ID of the caller to check LED state for as String.
+     */
+    inline void ReleasedLedMan::ledOff(String ledId, String caller) {
+        if (
+            locks.count(caller.c_str()) > 0 
+            && locks[caller.c_str()].count(ledId.c_str()) > 0
+        ) {
+            // If locked on LED then we need to set a LOW state
+            callerStates[caller.c_str()][ledId.c_str()] = LOW;
+        } else {
+            // If not locked then delete state for LED for LOW
+            if (callerStates.count(caller.c_str()) > 0) {
+                // Caller exists so attempt to erase the state for the LED
+                callerStates[caller.c_str()].erase(ledId.c_str());
+            }
+        }
+    }
+
+    /**
+     * This function must be called repeatedly and ideally as quickly
+     * as possible. It contains the code to manage the state of the 
+     * device's LEDs. Ideally a call to this would go in the 
+     * firmware's main loop method.
+     */
+    inline void ReleasedLedMan::loop() {
+        for (const auto& regLed : registeredLeds) {
+            // Determine current status for each LED
+            int ledPin = regLed.second;
+            std::string ledId = regLed.first;
+
+            int calcState = LOW;
+            int lastPriority = INT_MAX;
+
+            for (const auto& callerState : callerStates) {
+                // Iterate caller states to see what each wants state to be
+                if (callerState.second.count(ledId.c_str()) > 0) {
+                    // Caller has a state for current LED
+                    std::string caller = callerState.first;
+                    if (
+                        lastPriority == INT_MAX
+                        || (
+                            priorities.count(caller.c_str()) > 0
+                            && priorities[caller.c_str()] <= lastPriority
+                        )
+                    ) {
+                        // Caller priority is higher (less) or same to referenced one
+                        lastPriority = priorities[caller.c_str()];
+                        std::map<std::string/*LedId*/, int/*HighLow*/> ledStates = callerState.second;
+                        calcState = ledStates[ledId];
+                    }
+                }
+            }
+
+            // Set LED to desired State
+            if (digitalRead(ledPin) != calcState) {
+                digitalWrite(ledPin, calcState);
+            }
+        }
+    }
+
+    /**
+     * Toggles the LED state for a given LED and Caller.
+     * 
+     * @param ledId - The ID of the LED to check caller state for as String.
+     * @param caller - The ID of the caller to check LED state for as String.
+     */
+    inline void ReleasedLedMan::ledToggle(String ledId, String caller) {
+        if (currentState(ledId, caller) == HIGH) {
+            ledOff(ledId, caller);
+        } else {
+            ledOn(ledId, caller);
+        }
+    }
+
+    /**
+     * Returns the current on/off state for a given caller on a
+     * given LED. This may or not reflect the LED's actual state.
+     * 
+     * @param ledId - The ID of the LED to check caller state for as String.
+     * @param caller - The ID of the caller to check LED state for as String.
+     * 
+     * @return Returns the High/Low state as int.
+     */
+    inline int ReleasedLedMan::currentState(String ledId, String caller) {
+        if (
+            callerStates.count(caller.c_str()) > 0
+            && callerStates[caller.c_str()].count(ledId.c_str()) > 0
+        ) {
+            // Return whatever we found
+            return callerStates[caller.c_str()][ledId.c_str()];
+        }
+        // Finding nothing is same as LOW
+
+        return LOW;
+    }
+#endif
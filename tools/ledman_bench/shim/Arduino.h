@@ -0,0 +1,44 @@
+/*
+  Host stand-in for the parts of Arduino.h the LedMans use. Pins are kept in
+  memory and their reads and writes counted, as are writes made inside a
+  critical section; A hook may be set to run inside a write, as another task
+  would that preempted the writer.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef LedManBenchArduino_h
+    #define LedManBenchArduino_h
+
+    #include <limits.h>
+    #include <stdint.h>
+    #include <WString.h>
+    #include <esp_timer.h>
+
+    #define HIGH 0x1
+    #define LOW 0x0
+    #define OUTPUT 0x03
+    #define bit(b) (1UL << (b)) // <-- As Arduino.h has it, so LedMan must not use the name
+
+    inline uint8_t hostPins[40] = {};
+    inline unsigned long hostPinReads = 0UL;
+    inline unsigned long hostPinWrites = 0UL;
+    inline void (*hostWriteHook)() = nullptr;
+
+    inline void pinMode(uint8_t, uint8_t) {}
+
+    inline int digitalRead(uint8_t pin) {
+        hostPinReads++;
+
+        return hostPins[pin];
+    }
+
+    inline void digitalWrite(uint8_t pin, uint8_t level) {
+        hostPinWrites++;
+        hostCallsInCritical += hostCriticalDepth > 0 ? 1UL : 0UL;
+        hostPins[pin] = level;
+        if (hostWriteHook != nullptr) {
+            hostWriteHook();
+        }
+    }
+#endif
@@ -0,0 +1,22 @@
+/*
+  Host stand-in for the little of Arduino's String class the released LedMan
+  uses, backed by std::string so that it allocates as the real one does.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef LedManBenchWString_h
+    #define LedManBenchWString_h
+
+    #include <string>
+
+    class String {
+    public:
+        String(const char *text = "") : text(text) {}
+
+        const char* c_str() const { return text.c_str(); }
+
+    private:
+        std::string text;
+    };
+#endif
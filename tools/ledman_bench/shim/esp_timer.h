@@ -0,0 +1,91 @@
+/*
+  Host stand-in for the one-shot esp_timers LedMan plays patterns with, and
+  for its spinlock. Time is virtual; runTimersUntil() moves it on, firing each
+  timer as it comes due, in order, from the caller's thread as the esp_timer
+  task would. Timer calls made inside a critical section are counted.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef LedManBenchEspTimer_h
+    #define LedManBenchEspTimer_h
+
+    #include <stdint.h>
+
+    #define ESP_TIMER_TASK 0
+
+    inline int hostCriticalDepth = 0;
+    inline unsigned long hostCallsInCritical = 0UL;
+
+    struct HostMux {
+        int unused;
+    };
+    typedef HostMux portMUX_TYPE;
+    #define portMUX_INITIALIZER_UNLOCKED { 0 }
+    #define portENTER_CRITICAL(mux) ((void)(mux), hostCriticalDepth++)
+    #define portEXIT_CRITICAL(mux) ((void)(mux), hostCriticalDepth--)
+
+    struct HostTimer {
+        void (*callback)(void*);
+        void *arg;
+        int64_t dueMicros; // <-- Negative while stopped
+    };
+    typedef HostTimer* esp_timer_handle_t;
+
+    struct esp_timer_create_args_t {
+        void (*callback)(void*);
+        void *arg;
+        int dispatch_method;
+        const char *name;
+    };
+
+    inline int64_t virtualMicros = 0LL;
+    inline unsigned long hostTimerCalls = 0UL;
+    inline HostTimer hostTimers[8] = {};
+    inline uint8_t hostTimerCount = 0;
+
+    inline int64_t esp_timer_get_time() { return virtualMicros; }
+
+    inline int esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *handle) {
+        HostTimer *timer = &hostTimers[hostTimerCount++];
+        *timer = { args->callback, args->arg, -1LL };
+        *handle = timer;
+
+        return 0;
+    }
+
+    inline int esp_timer_start_once(esp_timer_handle_t timer, uint64_t micros) {
+        hostTimerCalls++;
+        hostCallsInCritical += hostCriticalDepth > 0 ? 1UL : 0UL;
+        timer->dueMicros = virtualMicros + (int64_t)micros;
+
+        return 0;
+    }
+
+    inline int esp_timer_stop(esp_timer_handle_t timer) {
+        hostTimerCalls++;
+        hostCallsInCritical += hostCriticalDepth > 0 ? 1UL : 0UL;
+        timer->dueMicros = -1LL;
+
+        return 0;
+    }
+
+    inline void runTimersUntil(int64_t micros) {
+        while (true) {
+            HostTimer *next = nullptr;
+            for (uint8_t i = 0; i < hostTimerCount; i++) {
+                HostTimer *timer = &hostTimers[i];
+                if (timer->dueMicros >= 0LL && timer->dueMicros <= micros && (next == nullptr || timer->dueMicros < next->dueMicros)) {
+                    next = timer;
+                }
+            }
+            if (next == nullptr) {
+                break;
+            }
+            virtualMicros = next->dueMicros;
+            next->dueMicros = -1LL;
+            next->callback(next->arg);
+        }
+        virtualMicros = micros;
+    }
+#endif
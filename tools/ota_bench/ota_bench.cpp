@@ -0,0 +1,201 @@
+/*
+  ota_bench - Host test of the OTA update's decompress and verify pipeline.
+
+  Streams a packed image (see scripts/pack_firmware.py), or a plain one,
+  through the firmware's own OtaStream in upload sized pieces, the way the
+  config portal's upload handler does, into a sink standing in for the flash.
+  Checks the output against the original image when given, that a corrupted
+  and a truncated upload are both rejected, and reports throughput in MB/s of
+  image written and the pipeline's RAM, all of which is the OtaStream itself.
+
+  Usage:
+    ota_bench firmware.ota [--image firmware.bin] [--piece 1436] [--random]
+              [--repeat 5]
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <OtaStream.h>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include <random>
+#include <vector>
+
+class CheckingSink : public OtaStream::Sink {
+public:
+    const std::vector<uint8_t> *expected = nullptr;
+    size_t written = 0;
+    size_t chunks = 0;
+    size_t largestChunk = 0;
+    bool isMatching = true;
+
+    bool write(const uint8_t *data, size_t length) override {
+        if (expected != nullptr) {
+            isMatching = isMatching
+                && written + length <= expected->size()
+                && memcmp(expected->data() + written, data, length) == 0;
+        }
+        written += length;
+        chunks++;
+        if (length > largestChunk) {
+            largestChunk = length;
+        }
+
+        return true;
+    }
+};
+
+static double nowSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static bool readFile(const char *path, std::vector<uint8_t> &content) {
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint8_t buffer[65536];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        content.insert(content.end(), buffer, buffer + length);
+    }
+    fclose(file);
+
+    return true;
+}
+
+/**
+ * Streams an upload through the pipeline in pieces, as the upload
+ * handler would.
+ *
+ * @param stream - The pipeline as OtaStream&.
+ * @param sink - Where the image goes as CheckingSink&.
+ * @param upload - The upload as const std::vector<uint8_t>&.
+ * @param piece - The size of each piece as size_t.
+ * @param isRandom - Whether to vary the pieces up to that size as bool.
+ *
+ * @return Returns true if the pipeline accepted the image otherwise false as bool.
+ */
+static bool streamUpload(OtaStream &stream, CheckingSink &sink, const std::vector<uint8_t> &upload, size_t piece, bool isRandom) {
+    std::mt19937 random(7);
+    stream.begin(sink);
+
+    size_t offset = 0;
+    while (offset < upload.size()) {
+        size_t length = isRandom ? 1 + random() % piece : piece;
+        if (length > upload.size() - offset) {
+            length = upload.size() - offset;
+        }
+        if (!stream.write(upload.data() + offset, length)) {
+            break;
+        }
+        offset += length;
+    }
+
+    return stream.finish();
+}
+
+int main(int argc, char **argv) {
+    const char *imagePath = nullptr;
+    size_t piece = 1436; // <-- A TCP segment's worth
+    bool isRandom = false;
+    int repeat = 5;
+
+    const struct option longOptions[] = {
+        { "image", required_argument, nullptr, 'i' },
+        { "piece", required_argument, nullptr, 'p' },
+        { "random", no_argument, nullptr, 'r' },
+        { "repeat", required_argument, nullptr, 'n' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+        switch (option) {
+            case 'i': imagePath = optarg; break;
+            case 'p': piece = (size_t)atoi(optarg); break;
+            case 'r': isRandom = true; break;
+            case 'n': repeat = atoi(optarg); break;
+            default:
+                optind = argc + 1;
+                break;
+        }
+    }
+    if (optind != argc - 1 || piece == 0 || repeat <= 0) {
+        fprintf(stderr, "usage: ota_bench UPLOAD [--image ORIGINAL] [--piece BYTES] [--random] [--repeat N]\n");
+        return 2;
+    }
+
+    std::vector<uint8_t> upload;
+    std::vector<uint8_t> image;
+    if (!readFile(argv[optind], upload) || upload.empty() || (imagePath != nullptr && !readFile(imagePath, image))) {
+        fprintf(stderr, "unable to read the upload or image\n");
+        return 1;
+    }
+
+    static OtaStream stream; // <-- As the updater allocates it, not on the stack
+    CheckingSink sink;
+    sink.expected = image.empty() ? nullptr : &image;
+
+    double best = 0.0;
+    bool ok = true;
+    for (int i = 0; i < repeat; i++) {
+        sink = CheckingSink();
+        sink.expected = image.empty() ? nullptr : &image;
+
+        double start = nowSeconds();
+        bool isAccepted = streamUpload(stream, sink, upload, piece, isRandom);
+        double elapsed = nowSeconds() - start;
+
+        if (!isAccepted || !sink.isMatching || (!image.empty() && sink.written != image.size())) {
+            fprintf(stderr, "pipeline failed: error=%d matching=%d written=%zu\n", (int)stream.getError(), (int)sink.isMatching, sink.written);
+            ok = false;
+            break;
+        }
+        if (best == 0.0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    // A corrupted and a truncated upload must both be turned away
+    std::vector<uint8_t> corrupted = upload;
+    corrupted[corrupted.size() / 2] ^= 0x5A;
+    CheckingSink discard;
+    bool isCorruptRejected = !streamUpload(stream, discard, corrupted, piece, isRandom);
+    int corruptError = (int)stream.getError();
+
+    std::vector<uint8_t> truncated(upload.begin(), upload.begin() + upload.size() * 3 / 4);
+    bool isTruncatedRejected = !streamUpload(stream, discard, truncated, piece, isRandom);
+    int truncatedError = (int)stream.getError();
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    if (ok) {
+        printf("upload=%zu image=%zu packed=%s ratio=%.1f%% piece=%zu%s chunks=%zu largest_chunk=%zu\n",
+            upload.size(), sink.written, stream.isPacked() ? "yes" : "no",
+            100.0 * upload.size() / sink.written, piece, isRandom ? " (random)" : "", sink.chunks, sink.largestChunk);
+        printf("throughput=%.1f MB/s of image (%.1f MB/s uploaded) best of %d\n",
+            sink.written / best / 1e6, upload.size() / best / 1e6, repeat);
+    }
+    printf("pipeline_ram=%zu bytes (OtaStream, no heap) process_max_rss=%ld KB\n", sizeof(OtaStream), usage.ru_maxrss);
+    if (!stream.isPacked()) {
+        // A plain image carries its own digest, which the OTA partition checks
+        printf("plain image; corruption is left to esp_ota_end()\n");
+        return ok ? 0 : 1;
+    }
+    printf("corrupted_rejected=%s (error %d) truncated_rejected=%s (error %d)\n",
+        isCorruptRejected ? "yes" : "NO", corruptError, isTruncatedRejected ? "yes" : "NO", truncatedError);
+
+    return ok && isCorruptRejected && isTruncatedRejected ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+/*
+  Host stand-in for the few mbedtls SHA-256 calls OtaStream makes, backed by
+  OpenSSL, so that the pipeline builds unchanged off the device.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef OtaBenchSha256_h
+    #define OtaBenchSha256_h
+
+    #include <openssl/sha.h>
+
+    typedef SHA256_CTX mbedtls_sha256_context;
+
+    static inline void mbedtls_sha256_init(mbedtls_sha256_context *context) { (void)context; }
+    static inline void mbedtls_sha256_free(mbedtls_sha256_context *context) { (void)context; }
+    static inline int mbedtls_sha256_starts(mbedtls_sha256_context *context, int is224) { (void)is224; return SHA256_Init(context) == 1 ? 0 : -1; }
+    static inline int mbedtls_sha256_update(mbedtls_sha256_context *context, const unsigned char *input, size_t length) { return SHA256_Update(context, input, length) == 1 ? 0 : -1; }
+    static inline int mbedtls_sha256_finish(mbedtls_sha256_context *context, unsigned char output[32]) { return SHA256_Final(output, context) == 1 ? 0 : -1; }
+#endif
@@ -0,0 +1,378 @@
+/*
+  scheduler_bench - Host model of the main loop before and after the event
+  scheduler, for the loop's iterations per second, the time it spends idle and
+  its worst handler, the figures /api/status reports from the device.
+
+  Both loops get the same work, each piece costing the CPU time given below:
+
+    - a scan's results every 3 s, a purge of seen devices every 1 s, a gossip
+      frame every 2 s and a health frame every 10 s;
+    - button edges from an "ISR" thread every 0.5 to 3 s, whose latency is
+      measured from the edge to its handler starting;
+    - a settings save asked for from a "web server" thread every 4 s, 200 ms
+      out, as doScheduleSettingsSave() does, whose lateness is measured;
+    - WiFi turned on a third of the way through and off two thirds through,
+      the time from turning it off until scanning starts again measured.
+
+  "before" polls for all of it as loop() did, including the blocking waits the
+  released firmware had when turning WiFi off: delay(2000) in the shutdown and
+  delay(500) in the scan reset. Time blocked in them is counted as idle, though
+  nothing else is done meanwhile. "after" runs the firmware's own Scheduler,
+  with those waits as timers, and reads its own statistics. "drain" does the
+  same with the WiFi shutdown the firmware has now: a 250 ms drain of the AP
+  and scanning started again straight after, with no scan reset wait.
+
+  These are host figures. The host's CPU is much faster than the ESP32's, which
+  changes the polling loop's rate but neither loop's idle time or latencies,
+  which the work's costs and waits decide.
+
+  Usage:
+    scheduler_bench [--seconds 20] [--seed 1]
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <Scheduler.h>
+#include <LogHistogram.h>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <random>
+#include <thread>
+
+struct Work {
+    const char *name;
+    uint64_t periodMillis;
+    uint32_t costMicros;
+};
+
+static const Work WORK[] = {
+    { "scan_results", 3000ULL, 1500UL },
+    { "purge", 1000ULL, 30UL },
+    { "gossip", 2000ULL, 100UL },
+    { "health", 10000ULL, 200UL }
+};
+static const uint8_t WORK_COUNT = sizeof(WORK) / sizeof(WORK[0]);
+static const uint32_t BUTTON_COST_MICROS = 20UL;
+static const uint32_t SAVE_COST_MICROS = 800UL;
+static const uint32_t WIFI_COST_MICROS = 300UL;
+static const uint64_t SAVE_DELAY_MILLIS = 200ULL;
+static const uint64_t WIFI_SHUTDOWN_MILLIS = 2000ULL;
+static const uint64_t SCAN_RESET_MILLIS = 500ULL;
+static const uint64_t WIFI_DRAIN_MILLIS = 250ULL;
+
+struct Results {
+    unsigned long iterations;
+    uint64_t idleMicros;
+    uint64_t runMicros;
+    uint32_t worstHandlerMicros;
+    LogHistogram buttonLatency;
+    LogHistogram saveLateness;
+    int64_t wifiOffMicros;
+};
+
+static std::atomic<bool> isRunning(false);
+static std::atomic<int64_t> edgeMicros(0LL);  // <-- When the pending edge happened, 0 for none
+static std::atomic<int64_t> saveDueMicros(0LL);
+
+static Scheduler *scheduler = nullptr;
+static Results *results = nullptr;
+static uint8_t saveTimer = Scheduler::NO_TIMER;
+
+static void busy(uint32_t micros) {
+    int64_t until = Clock::nowMicros() + (int64_t)micros;
+    while (Clock::nowMicros() < until) {
+    }
+}
+
+static void sleepMillis(uint64_t millis) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(millis));
+}
+
+/**
+ * Stands in for the button's ISR, from a thread of its own, until the
+ * run ends.
+ *
+ * @param seed - Seeds the edges' timing as unsigned.
+ * @param isScheduled - Whether to post to the scheduler rather than set
+ * a flag for polling as bool.
+ */
+static void buttonTask(unsigned seed, bool isScheduled) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> gap(500, 3000);
+    while (isRunning) {
+        sleepMillis((uint64_t)gap(random));
+        int64_t none = 0LL;
+        if (edgeMicros.compare_exchange_strong(none, Clock::nowMicros()) && isScheduled) {
+            scheduler->postFromISR(0);
+        }
+    }
+}
+
+/**
+ * Stands in for the web server asking for a settings save, from a 
+ * thread of its own, until the run ends.
+ *
+ * @param isScheduled - Whether to start the scheduler's timer rather
+ * than set a time for polling as bool.
+ */
+static void webTask(bool isScheduled) {
+    int64_t nextSave = Clock::nowMicros() + 3050000LL; // <-- Just after the purge, so not woken by it in time
+    while (isRunning) {
+        sleepMillis(10ULL);
+        int64_t now = Clock::nowMicros();
+        if (now >= nextSave) {
+            nextSave += 4000000LL;
+            saveDueMicros = now + (int64_t)SAVE_DELAY_MILLIS * 1000LL;
+            if (isScheduled) {
+                Scheduler::Guard guard(*scheduler);
+                scheduler->startTimer(saveTimer, SAVE_DELAY_MILLIS);
+            }
+        }
+    }
+}
+
+static void handleButton() {
+    int64_t edge = edgeMicros.exchange(0LL);
+    if (edge != 0LL) {
+        results->buttonLatency.record((uint32_t)(Clock::nowMicros() - edge));
+    }
+    busy(BUTTON_COST_MICROS);
+}
+
+static void handleSave() {
+    results->saveLateness.record((uint32_t)std::max(Clock::nowMicros() - saveDueMicros.load(), (int64_t)0LL));
+    busy(SAVE_COST_MICROS);
+}
+
+template <uint8_t WORK_INDEX>
+static void handleWork() {
+    busy(WORK[WORK_INDEX].costMicros);
+}
+
+static void handleWiFi() {
+    busy(WIFI_COST_MICROS);
+}
+
+/**
+ * Runs the loop as released: Every check on every pass, and WiFi shut
+ * down with blocking waits.
+ *
+ * @param seconds - How long to run as double.
+ * @param seed - Seeds the edges' timing as unsigned.
+ * @param out - Set to what was measured as Results&.
+ */
+static void runBefore(double seconds, unsigned seed, Results &out) {
+    results = &out;
+    edgeMicros = 0LL;
+    saveDueMicros = 0LL;
+    isRunning = true;
+    std::thread button(buttonTask, seed, false);
+    std::thread web(webTask, false);
+
+    int64_t start = Clock::nowMicros();
+    int64_t end = start + (int64_t)(seconds * 1e6);
+    int64_t lastRun[WORK_COUNT];
+    for (uint8_t i = 0; i < WORK_COUNT; i++) {
+        lastRun[i] = start;
+    }
+    bool isWiFiOn = false;
+    bool isWiFiDone = false;
+
+    // One pass of loop(); A check which finds work does it there and then
+    auto timed = [&out](void (*handler)()) {
+        int64_t handlerStart = Clock::nowMicros();
+        handler();
+        uint32_t took = (uint32_t)(Clock::nowMicros() - handlerStart);
+        out.worstHandlerMicros = std::max(out.worstHandlerMicros, took);
+    };
+    while (Clock::nowMicros() < end) {
+        out.iterations++;
+        int64_t now = Clock::nowMicros();
+        if (edgeMicros != 0LL) {
+            timed(handleButton);
+        }
+        for (uint8_t i = 0; i < WORK_COUNT; i++) {
+            if (now - lastRun[i] >= (int64_t)WORK[i].periodMillis * 1000LL) {
+                lastRun[i] = now;
+                int64_t handlerStart = Clock::nowMicros();
+                busy(WORK[i].costMicros);
+                out.worstHandlerMicros = std::max(out.worstHandlerMicros, (uint32_t)(Clock::nowMicros() - handlerStart));
+            }
+        }
+        int64_t saveDue = saveDueMicros;
+        if (saveDue != 0LL && now >= saveDue) {
+            timed(handleSave);
+            saveDueMicros = 0LL;
+        }
+        if (!isWiFiOn && !isWiFiDone && now - start >= (end - start) / 3) {
+            isWiFiOn = true;
+            timed(handleWiFi);
+        } else if (isWiFiOn && now - start >= (end - start) * 2 / 3) {
+            // WiFi shut down, then the scan reset, each waiting as it did
+            isWiFiOn = false;
+            isWiFiDone = true;
+            int64_t handlerStart = Clock::nowMicros();
+            handleWiFi();
+            sleepMillis(WIFI_SHUTDOWN_MILLIS);
+            sleepMillis(SCAN_RESET_MILLIS);
+            int64_t took = Clock::nowMicros() - handlerStart;
+            out.idleMicros += (uint64_t)(WIFI_SHUTDOWN_MILLIS + SCAN_RESET_MILLIS) * 1000ULL;
+            out.wifiOffMicros = took;
+            out.worstHandlerMicros = std::max(out.worstHandlerMicros, (uint32_t)took);
+        }
+    }
+    out.runMicros = (uint64_t)(Clock::nowMicros() - start);
+
+    isRunning = false;
+    button.join();
+    web.join();
+}
+
+// The scheduled WiFi shutdown, as the firmware's timers run it
+static uint8_t wifiOnTimer = Scheduler::NO_TIMER;
+static uint8_t wifiOffTimer = Scheduler::NO_TIMER;
+static uint8_t wifiShutdownTimer = Scheduler::NO_TIMER;
+static uint8_t scanResetTimer = Scheduler::NO_TIMER;
+static uint64_t shutdownMillis = 0ULL;
+static uint64_t scanResetMillis = 0ULL;
+static int64_t wifiOffStartMicros = 0LL;
+
+static void handleScanStart() {
+    handleWiFi();
+    results->wifiOffMicros = Clock::nowMicros() - wifiOffStartMicros;
+}
+
+static void handleWiFiOff() {
+    wifiOffStartMicros = Clock::nowMicros();
+    handleWiFi();
+    scheduler->startTimer(wifiShutdownTimer, shutdownMillis);
+}
+
+static void handleWiFiShutdown() {
+    handleWiFi();
+    if (scanResetMillis == 0ULL) {
+        handleScanStart();
+    } else {
+        scheduler->startTimer(scanResetTimer, scanResetMillis);
+    }
+}
+
+/**
+ * Runs the same work from the firmware's Scheduler, the loop sleeping
+ * whenever there is nothing to do.
+ *
+ * @param seconds - How long to run as double.
+ * @param seed - Seeds the edges' timing as unsigned.
+ * @param shutdown - How long WiFi takes to shut down as uint64_t.
+ * @param scanReset - How long scanning then waits to start, 0 for not
+ * at all, as uint64_t.
+ * @param out - Set to what was measured as Results&.
+ */
+static void runAfter(double seconds, unsigned seed, uint64_t shutdown, uint64_t scanReset, Results &out) {
+    Scheduler runScheduler;
+    scheduler = &runScheduler;
+    results = &out;
+    shutdownMillis = shutdown;
+    scanResetMillis = scanReset;
+    scheduler->begin();
+    scheduler->on(0, handleButton, "button_edge");
+    uint8_t workTimers[WORK_COUNT] = {
+        scheduler->addTimer(handleWork<0>, WORK[0].name),
+        scheduler->addTimer(handleWork<1>, WORK[1].name),
+        scheduler->addTimer(handleWork<2>, WORK[2].name),
+        scheduler->addTimer(handleWork<3>, WORK[3].name)
+    };
+    saveTimer = scheduler->addTimer(handleSave, "settings_save");
+    wifiOnTimer = scheduler->addTimer(handleWiFi, "wifi_on");
+    wifiOffTimer = scheduler->addTimer(handleWiFiOff, "wifi_off");
+    wifiShutdownTimer = scheduler->addTimer(handleWiFiShutdown, "wifi_shutdown");
+    scanResetTimer = scheduler->addTimer(handleScanStart, "scan_start");
+    for (uint8_t i = 0; i < WORK_COUNT; i++) {
+        scheduler->startTimer(workTimers[i], WORK[i].periodMillis, WORK[i].periodMillis);
+    }
+    scheduler->startTimer(wifiOnTimer, (uint64_t)(seconds * 1000.0 / 3.0));
+    scheduler->startTimer(wifiOffTimer, (uint64_t)(seconds * 2000.0 / 3.0));
+    scheduler->resetStats();
+
+    edgeMicros = 0LL;
+    saveDueMicros = 0LL;
+    isRunning = true;
+    std::thread button(buttonTask, seed, true);
+    std::thread web(webTask, true);
+    int64_t end = Clock::nowMicros() + (int64_t)(seconds * 1e6);
+    while (Clock::nowMicros() < end) {
+        scheduler->runOnce();
+    }
+    out.iterations = scheduler->getIterations();
+    out.idleMicros = scheduler->getIdleMicros();
+    out.runMicros = scheduler->getStatsMicros();
+    out.worstHandlerMicros = scheduler->getWorstHandlerMicros();
+
+    isRunning = false;
+    scheduler->post(0); // <-- Wakes the loop should it be sleeping still
+    button.join();
+    web.join();
+    scheduler = nullptr;
+}
+
+static void report(const char *name, Results &out) {
+    printf("%-7s %12.0f %7.1f %12lu %6lu %8lu %8lu %8lu %9lu %9lu %11lu\n",
+        name,
+        out.iterations * 1e6 / out.runMicros,
+        out.idleMicros * 100.0 / out.runMicros,
+        (unsigned long)out.worstHandlerMicros,
+        (unsigned long)out.buttonLatency.getCount(),
+        (unsigned long)out.buttonLatency.getPercentile(50),
+        (unsigned long)out.buttonLatency.getPercentile(99),
+        (unsigned long)out.buttonLatency.getMax(),
+        (unsigned long)out.saveLateness.getPercentile(99),
+        (unsigned long)out.saveLateness.getMax(),
+        (unsigned long)(out.wifiOffMicros / 1000LL));
+}
+
+int main(int argc, char **argv) {
+    double seconds = 20.0;
+    unsigned seed = 1U;
+
+    const struct option longOptions[] = {
+        { "seconds", required_argument, nullptr, 's' },
+        { "seed", required_argument, nullptr, 'r' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+        switch (option) {
+            case 's': seconds = atof(optarg); break;
+            case 'r': seed = (unsigned)atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: scheduler_bench [--seconds S] [--seed N]\n");
+                return 2;
+        }
+    }
+    if (seconds < 6.0) {
+        fprintf(stderr, "scheduler_bench: run for at least 6 s so WiFi goes on and off\n");
+        return 2;
+    }
+
+    Results before = {};
+    Results after = {};
+    Results drain = {};
+    runBefore(seconds, seed, before);
+    runAfter(seconds, seed, WIFI_SHUTDOWN_MILLIS, SCAN_RESET_MILLIS, after);
+    runAfter(seconds, seed, WIFI_DRAIN_MILLIS, 0ULL, drain);
+
+    printf("%-7s %12s %7s %12s %6s %8s %8s %8s %9s %9s %11s\n",
+        "loop", "loop/s", "idle %", "worst us", "edges", "btn p50", "btn p99", "btn max", "save p99", "save max", "wifi off ms");
+    report("before", before);
+    report("after", after);
+    report("drain", drain);
+    printf("(button latency from edge to handler and settings save lateness in us, %.0f s each)\n", seconds);
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+/*
+  Host stand-in for the parts of Arduino.h and FreeRTOS the Scheduler uses.
+  Each thread is a task with a notification count; Spinlocks and the mutex
+  are std::mutex, and a tick is a millisecond as on the ESP32.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef SchedulerBenchArduino_h
+    #define SchedulerBenchArduino_h
+
+    #include <stdint.h>
+    #include <algorithm>
+    #include <chrono>
+    #include <condition_variable>
+    #include <mutex>
+
+    #define IRAM_ATTR
+    #define pdTRUE 1
+    #define pdFALSE 0
+    #define portMAX_DELAY 0xFFFFFFFFUL
+    #define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+    #define portYIELD_FROM_ISR(woken) (void)(woken)
+
+    typedef uint32_t TickType_t;
+    typedef int BaseType_t;
+
+    struct HostTask {
+        std::mutex mutex;
+        std::condition_variable woken;
+        uint32_t notifications = 0;
+    };
+    typedef HostTask* TaskHandle_t;
+
+    struct HostMux {
+        std::mutex mutex;
+    };
+    typedef HostMux portMUX_TYPE;
+    #define portMUX_INITIALIZER_UNLOCKED {}
+    #define portENTER_CRITICAL(mux) (mux)->mutex.lock()
+    #define portEXIT_CRITICAL(mux) (mux)->mutex.unlock()
+    #define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+    #define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+
+    typedef std::mutex* SemaphoreHandle_t;
+    inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new std::mutex(); }
+    inline BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t) { mutex->lock(); return pdTRUE; }
+    inline BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex) { mutex->unlock(); return pdTRUE; }
+
+    inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+        static thread_local HostTask task;
+
+        return &task;
+    }
+
+    inline void xTaskNotifyGive(TaskHandle_t task) {
+        std::lock_guard<std::mutex> hold(task->mutex);
+        task->notifications++;
+        task->woken.notify_one();
+    }
+
+    inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+        xTaskNotifyGive(task);
+        *woken = pdFALSE;
+    }
+
+    inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+        TaskHandle_t task = xTaskGetCurrentTaskHandle();
+        std::unique_lock<std::mutex> hold(task->mutex);
+        auto isNotified = [task]() { return task->notifications > 0; };
+        if (ticks == portMAX_DELAY) {
+            task->woken.wait(hold, isNotified);
+        } else {
+            task->woken.wait_for(hold, std::chrono::milliseconds(ticks), isNotified);
+        }
+        uint32_t taken = task->notifications;
+        task->notifications = clear ? 0 : (taken > 0 ? taken - 1 : 0);
+
+        return taken;
+    }
+#endif
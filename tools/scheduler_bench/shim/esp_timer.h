@@ -0,0 +1,19 @@
+/*
+  Host stand-in for esp_timer.h, giving the monotonic clock's microseconds.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef SchedulerBenchEspTimer_h
+    #define SchedulerBenchEspTimer_h
+
+    #include <stdint.h>
+    #include <chrono>
+
+    inline int64_t esp_timer_get_time() {
+        using namespace std::chrono;
+        static const steady_clock::time_point boot = steady_clock::now();
+
+        return duration_cast<microseconds>(steady_clock::now() - boot).count();
+    }
+#endif
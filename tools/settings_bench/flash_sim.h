@@ -0,0 +1,303 @@
+/*
+  Host stand-in for the ESP32's SPI NOR flash and, on top of it, a model of
+  how ESP-IDF's NVS library lays its items out in that flash.
+
+  FlashSim counts the erase cycles of each 4K sector and the program
+  operations made, charging each the typical time the flash takes for it, so
+  that wear and the time a save blocks for can both be read off afterwards.
+
+  NvsSim follows NVS closely enough to wear the flash the way it does: Each
+  sector is a page of 126 entries of 32 bytes. Items are appended to the
+  active page, a number or bool taking one entry and text or a blob one plus
+  one per 32 bytes; The entries an item replaces are only marked erased. Once
+  the active page is full the next free one is used, and when only the spare
+  page is left the full page with the most erased entries has its live items
+  moved to the spare and is itself erased. As NVS does, an item written with
+  the value it already holds is left alone. Each item is written whole or not
+  at all, and writesLeft cuts the power after as many writes as it is given.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef FlashSim_h
+    #define FlashSim_h
+
+    #include <stdint.h>
+    #include <string.h>
+
+    #include <map>
+    #include <string>
+    #include <vector>
+
+    class FlashSim {
+    public:
+        static const uint32_t SECTOR_SIZE = 4096U;
+        static const uint32_t PROGRAM_PAGE_SIZE = 256U;
+        static const uint32_t ERASE_MICROS = 45000U;   // <-- Typical 4K sector erase
+        static const uint32_t PROGRAM_MICROS = 400U;   // <-- Typical program of up to a 256 byte page
+
+        explicit FlashSim(uint32_t sectors) : erases(sectors, 0U) {}
+
+        void erase(uint32_t sector) {
+            erases[sector]++;
+            micros += ERASE_MICROS;
+        }
+
+        void program(uint32_t offset, uint32_t length) {
+            // A program can't cross a 256 byte page, so is split where it would
+            uint32_t end = offset + length;
+            while (offset < end) {
+                uint32_t pageEnd = (offset / PROGRAM_PAGE_SIZE + 1U) * PROGRAM_PAGE_SIZE;
+                uint32_t piece = (end < pageEnd ? end : pageEnd) - offset;
+                programs++;
+                programmed += piece;
+                micros += PROGRAM_MICROS;
+                offset += piece;
+            }
+        }
+
+        void resetCounts() {
+            erases.assign(erases.size(), 0U);
+            programs = 0ULL;
+            programmed = 0ULL;
+            micros = 0ULL;
+        }
+
+
+        uint64_t totalErases() const {
+            uint64_t total = 0ULL;
+            for (uint32_t count : erases) {
+                total += count;
+            }
+
+            return total;
+        }
+
+        uint32_t maxErases() const {
+            uint32_t most = 0U;
+            for (uint32_t count : erases) {
+                most = count > most ? count : most;
+            }
+
+            return most;
+        }
+
+        std::vector<uint32_t> erases;
+        uint64_t programs = 0ULL;
+        uint64_t programmed = 0ULL;
+        uint64_t micros = 0ULL; // <-- Time spent erasing and programming
+    };
+
+    class NvsSim {
+    public:
+        enum ItemType : uint8_t {
+            ITEM_U8,
+            ITEM_I32,
+            ITEM_U32,
+            ITEM_U64,
+            ITEM_STR,
+            ITEM_BLOB
+        };
+
+        static const uint32_t ENTRY_SIZE = 32U;
+        static const uint32_t ENTRIES_PER_PAGE = 126U;
+        static const uint32_t ENTRIES_OFFSET = 64U; // <-- After the page header and entry state bitmap
+
+        static inline NvsSim *active = nullptr; // <-- What the Preferences and EEPROM stand-ins use
+
+        explicit NvsSim(uint32_t pageCount) : flash(pageCount), pages(pageCount) {
+            for (uint32_t page = 0U; page < pageCount; page++) {
+                pages[page].isFree = page != 0U;
+            }
+            flash.program(0U, ENTRIES_OFFSET); // <-- Page header of the first active page
+        }
+
+        bool set(const std::string &ns, const std::string &key, ItemType type, const void *data, size_t length) {
+            std::string name = ns + "/" + key;
+            auto found = items.find(name);
+            if (found != items.end() && found->second.type == type && found->second.value.size() == length
+                && memcmp(found->second.value.data(), data, length) == 0) {
+                return true;
+            }
+
+            if (writesLeft == 0L) {
+                return false; // <-- The power is cut
+            }
+
+            Item item;
+            item.type = type;
+            item.value.assign((const uint8_t*)data, (const uint8_t*)data + length);
+            item.span = spanOf(type, length);
+            if (!place(item)) {
+                return false;
+            }
+            if (found != items.end()) {
+                release(found->second);
+            }
+            items[name] = item;
+            writes++;
+            writesLeft -= writesLeft > 0L ? 1L : 0L;
+
+            return true;
+        }
+
+        bool get(const std::string &ns, const std::string &key, ItemType type, std::vector<uint8_t> &value) const {
+            auto found = items.find(ns + "/" + key);
+            if (found == items.end() || found->second.type != type) {
+                return false;
+            }
+            value = found->second.value;
+
+            return true;
+        }
+
+        bool peek(const std::string &ns, const std::string &key, ItemType &type, std::vector<uint8_t> &value) const {
+            auto found = items.find(ns + "/" + key);
+            if (found == items.end()) {
+                return false;
+            }
+            type = found->second.type;
+            value = found->second.value;
+
+            return true;
+        }
+
+        std::vector<std::string> keys(const std::string &ns) const {
+            std::vector<std::string> names;
+            std::string prefix = ns + "/";
+            for (const auto &pair : items) {
+                if (pair.first.compare(0, prefix.size(), prefix) == 0) {
+                    names.push_back(pair.first.substr(prefix.size()));
+                }
+            }
+
+            return names;
+        }
+
+        bool has(const std::string &ns, const std::string &key) const {
+            return items.count(ns + "/" + key) > 0;
+        }
+
+        bool remove(const std::string &ns, const std::string &key) {
+            auto found = items.find(ns + "/" + key);
+            if (found == items.end() || writesLeft == 0L) {
+                return false;
+            }
+            release(found->second);
+            items.erase(found);
+            writesLeft -= writesLeft > 0L ? 1L : 0L;
+
+            return true;
+        }
+
+        FlashSim flash;
+        uint64_t writes = 0ULL; // <-- Items actually written
+        long writesLeft = -1L;  // <-- Writes and removals until the power is cut, -1 for never
+
+    private:
+        struct Page {
+            uint32_t used = 0U;   // <-- Entries written, live or erased
+            uint32_t erased = 0U; // <-- Entries since replaced
+            bool isFree = true;
+        };
+
+        struct Item {
+            ItemType type;
+            std::vector<uint8_t> value;
+            uint32_t span = 0U;
+            uint32_t page = 0U;
+            uint32_t entry = 0U;
+        };
+
+        std::vector<Page> pages;
+        std::map<std::string, Item> items;
+        uint32_t activePage = 0U;
+
+        static uint32_t spanOf(ItemType type, size_t length) {
+            uint32_t dataEntries = (uint32_t)((length + ENTRY_SIZE - 1U) / ENTRY_SIZE);
+            switch (type) {
+                case ITEM_STR: return 1U + dataEntries;
+                case ITEM_BLOB: return 2U + dataEntries; // <-- Its index and its data chunk's header
+                default: return 1U;
+            }
+        }
+
+        /*
+          Writes the item's entries to the active page, moving on to another
+          page, and collecting garbage to get one, as needed.
+        */
+        bool place(Item &item) {
+            while (pages[activePage].used + item.span > ENTRIES_PER_PAGE) {
+                if (!nextPage()) {
+                    return false;
+                }
+            }
+            Page &page = pages[activePage];
+            item.page = activePage;
+            item.entry = page.used;
+            page.used += item.span;
+
+            uint32_t base = activePage * FlashSim::SECTOR_SIZE;
+            flash.program(base + ENTRIES_OFFSET + item.entry * ENTRY_SIZE, item.span * ENTRY_SIZE);
+            flash.program(base + 32U, 4U); // <-- Marks its entries written in the bitmap
+
+            return true;
+        }
+
+        void release(const Item &item) {
+            pages[item.page].erased += item.span;
+            flash.program(item.page * FlashSim::SECTOR_SIZE + 32U, 4U); // <-- Marks its entries erased
+        }
+
+        bool nextPage() {
+            uint32_t freePages = 0U;
+            uint32_t freePage = 0U;
+            for (uint32_t page = 0U; page < pages.size(); page++) {
+                if (pages[page].isFree) {
+                    freePages++;
+                    freePage = page;
+                }
+            }
+
+            if (freePages > 1U) {
+                usePage(freePage);
+                return true;
+            }
+            if (freePages == 0U) {
+                return false;
+            }
+
+            // Only the spare is left; Move the most erased page's live items into it
+            uint32_t victim = activePage;
+            for (uint32_t page = 0U; page < pages.size(); page++) {
+                if (!pages[page].isFree && pages[page].erased > pages[victim].erased) {
+                    victim = page;
+                }
+            }
+            if (pages[victim].erased == 0U) {
+                return false; // <-- Truly full
+            }
+
+            usePage(freePage);
+            for (auto &pair : items) {
+                Item &item = pair.second;
+                if (item.page == victim) {
+                    item.page = activePage;
+                    item.entry = pages[activePage].used;
+                    pages[activePage].used += item.span;
+                    flash.program(activePage * FlashSim::SECTOR_SIZE + ENTRIES_OFFSET + item.entry * ENTRY_SIZE, item.span * ENTRY_SIZE);
+                }
+            }
+            flash.erase(victim);
+            pages[victim] = Page();
+
+            return true;
+        }
+
+        void usePage(uint32_t page) {
+            pages[page].isFree = false;
+            activePage = page;
+            flash.program(page * FlashSim::SECTOR_SIZE, ENTRIES_OFFSET); // <-- Its header
+        }
+    };
+#endif
@@ -0,0 +1,252 @@
+/*
+  The EEPROM record released firmware kept its settings in, and what the
+  settings tools share for filling and comparing them.
+
+  The record is laid out with unsigned longs as wide as given, so it can be
+  built as on this host, for Settings to read, or as on the ESP32, for its
+  size there.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef SettingsBenchRecords_h
+    #define SettingsBenchRecords_h
+
+    #include <Settings.h>
+
+    #include <stddef.h>
+    #include <string.h>
+
+    /* The EEPROM record released firmware kept, the only one a device can have */
+    template <typename ULong>
+    struct EepromRecord {
+        int maxNearRssi;
+        int closeRssi;
+        ULong startups;
+        ULong lastStartMillis;
+        ULong maxNotSeenMillis;
+        ULong learnDurationMillis;
+        ULong triggerLearnMillis;
+        ULong triggerFactoryMillis;
+        ULong triggerWiFiOnMillis;
+        ULong triggerWiFiOffMillis;
+        char pairedAddress[18];
+        char apPwd[64];
+        char sentinel[33];
+    };
+
+    typedef EepromRecord<unsigned long> HostRecord;  // <-- As laid out on this host, for Settings to read
+    typedef EepromRecord<uint32_t> DeviceRecord;     // <-- As laid out on the ESP32, for its size
+
+    /* Every setting Settings keeps, the released record's first and in its order */
+    struct SettingsValues {
+        int maxNearRssi;
+        int closeRssi;
+        unsigned long startups;
+        unsigned long lastStartMillis;
+        unsigned long maxNotSeenMillis;
+        unsigned long learnDurationMillis;
+        unsigned long triggerLearnMillis;
+        unsigned long triggerFactoryMillis;
+        unsigned long triggerWiFiOnMillis;
+        unsigned long triggerWiFiOffMillis;
+        char pairedAddress[18];
+        char apPwd[64];
+        char staSsid[33];
+        char staPwd[64];
+        char mqttHost[64];
+        unsigned long mqttPort;
+        bool gossip;
+        int gossipMarginDb;
+        char proxyHost[64];
+        unsigned long proxyPort;
+        bool proxyUdp;
+    };
+
+    /**
+     * Builds up the text the record's sentinel is the MD5 of.
+     *
+     * @param record - The record as const EepromRecord<ULong>&.
+     *
+     * @return Returns the text as String.
+     */
+    template <typename ULong>
+    static String sentinelContent(const EepromRecord<ULong> &record) {
+        String content = "";
+        content = content + String(record.maxNearRssi);
+        content = content + String(record.closeRssi);
+        content = content + String((unsigned long)record.maxNotSeenMillis);
+        content = content + String((unsigned long)record.learnDurationMillis);
+        content = content + String((unsigned long)record.triggerLearnMillis);
+        content = content + String((unsigned long)record.triggerFactoryMillis);
+        content = content + String((unsigned long)record.triggerWiFiOnMillis);
+        content = content + String((unsigned long)record.triggerWiFiOffMillis);
+        content = content + record.pairedAddress;
+        content = content + record.apPwd;
+
+        return content;
+    }
+
+    /**
+     * Works out the sentinel the EEPROM record carried.
+     *
+     * @param record - The record as const EepromRecord<ULong>&.
+     *
+     * @return Returns the MD5 in hex as String.
+     */
+    template <typename ULong>
+    static String sentinelOf(const EepromRecord<ULong> &record) {
+        MD5Builder builder;
+        builder.begin();
+        builder.add(sentinelContent(record));
+        builder.calculate();
+
+        return builder.toString();
+    }
+
+    /**
+     * Gives the given settings as the released EEPROM record held them,
+     * with its sentinel.
+     *
+     * @param values - The settings as const SettingsValues&.
+     *
+     * @return Returns the record as EepromRecord<ULong>.
+     */
+    template <typename ULong>
+    static EepromRecord<ULong> releasedRecordOf(const SettingsValues &values) {
+        EepromRecord<ULong> record = {};
+        record.maxNearRssi = values.maxNearRssi;
+        record.closeRssi = values.closeRssi;
+        record.startups = (ULong)values.startups;
+        record.lastStartMillis = (ULong)values.lastStartMillis;
+        record.maxNotSeenMillis = (ULong)values.maxNotSeenMillis;
+        record.learnDurationMillis = (ULong)values.learnDurationMillis;
+        record.triggerLearnMillis = (ULong)values.triggerLearnMillis;
+        record.triggerFactoryMillis = (ULong)values.triggerFactoryMillis;
+        record.triggerWiFiOnMillis = (ULong)values.triggerWiFiOnMillis;
+        record.triggerWiFiOffMillis = (ULong)values.triggerWiFiOffMillis;
+        strlcpy(record.pairedAddress, values.pairedAddress, sizeof(record.pairedAddress));
+        strlcpy(record.apPwd, values.apPwd, sizeof(record.apPwd));
+        strlcpy(record.sentinel, sentinelOf(record).c_str(), sizeof(record.sentinel));
+
+        return record;
+    }
+
+    /**
+     * Gives the settings the released EEPROM record holds, the others
+     * being as given.
+     *
+     * @param values - The settings as const SettingsValues&.
+     * @param others - Those the record doesn't have as const SettingsValues&.
+     *
+     * @return Returns the settings as SettingsValues.
+     */
+    static inline SettingsValues releasedOnly(const SettingsValues &values, const SettingsValues &others) {
+        SettingsValues released = others;
+        memcpy(&released, &values, offsetof(SettingsValues, staSsid));
+
+        return released;
+    }
+
+    /**
+     * Reads what Settings holds.
+     *
+     * @param settings - The settings as Settings&.
+     *
+     * @return Returns the settings as SettingsValues.
+     */
+    static inline SettingsValues valuesOf(Settings &settings) {
+        SettingsValues values = {};
+        values.maxNearRssi = settings.getMaxNearRssi();
+        values.closeRssi = settings.getCloseRssi();
+        values.startups = settings.getStartups();
+        values.lastStartMillis = settings.getLastStartMillis();
+        values.maxNotSeenMillis = settings.getMaxNotSeenMillis();
+        values.learnDurationMillis = settings.getLearnDurationMillis();
+        values.triggerLearnMillis = settings.getTriggerLearnMillis();
+        values.triggerFactoryMillis = settings.getTriggerFactoryMillis();
+        values.triggerWiFiOnMillis = settings.getTriggerWiFiOnMillis();
+        values.triggerWiFiOffMillis = settings.getTriggerWiFiOffMillis();
+        strlcpy(values.pairedAddress, settings.getParedAddress().c_str(), sizeof(values.pairedAddress));
+        strlcpy(values.apPwd, settings.getApPwd().c_str(), sizeof(values.apPwd));
+        strlcpy(values.staSsid, settings.getStaSsid().c_str(), sizeof(values.staSsid));
+        strlcpy(values.staPwd, settings.getStaPwd().c_str(), sizeof(values.staPwd));
+        strlcpy(values.mqttHost, settings.getMqttHost().c_str(), sizeof(values.mqttHost));
+        values.mqttPort = settings.getMqttPort();
+        values.gossip = settings.isGossip();
+        values.gossipMarginDb = settings.getGossipMarginDb();
+        strlcpy(values.proxyHost, settings.getProxyHost().c_str(), sizeof(values.proxyHost));
+        values.proxyPort = settings.getProxyPort();
+        values.proxyUdp = settings.isProxyUdp();
+
+        return values;
+    }
+
+    /**
+     * Used to determine if two sets of settings are the same.
+     *
+     * @param left - One as const SettingsValues&.
+     * @param right - The other as const SettingsValues&.
+     *
+     * @return Returns true if the same otherwise false as bool.
+     */
+    static inline bool isSame(const SettingsValues &left, const SettingsValues &right) {
+        return left.maxNearRssi == right.maxNearRssi
+            && left.closeRssi == right.closeRssi
+            && left.startups == right.startups
+            && left.lastStartMillis == right.lastStartMillis
+            && left.maxNotSeenMillis == right.maxNotSeenMillis
+            && left.learnDurationMillis == right.learnDurationMillis
+            && left.triggerLearnMillis == right.triggerLearnMillis
+            && left.triggerFactoryMillis == right.triggerFactoryMillis
+            && left.triggerWiFiOnMillis == right.triggerWiFiOnMillis
+            && left.triggerWiFiOffMillis == right.triggerWiFiOffMillis
+            && strcmp(left.pairedAddress, right.pairedAddress) == 0
+            && strcmp(left.apPwd, right.apPwd) == 0
+            && strcmp(left.staSsid, right.staSsid) == 0
+            && strcmp(left.staPwd, right.staPwd) == 0
+            && strcmp(left.mqttHost, right.mqttHost) == 0
+            && left.mqttPort == right.mqttPort
+            && left.gossip == right.gossip
+            && left.gossipMarginDb == right.gossipMarginDb
+            && strcmp(left.proxyHost, right.proxyHost) == 0
+            && left.proxyPort == right.proxyPort
+            && left.proxyUdp == right.proxyUdp;
+    }
+
+    /**
+     * Used to determine if two EEPROM records hold the same settings.
+     *
+     * @param left - One record as const HostRecord&.
+     * @param right - The other as const HostRecord&.
+     *
+     * @return Returns true if the same otherwise false as bool.
+     */
+    static inline bool isSame(const HostRecord &left, const HostRecord &right) {
+        return left.maxNearRssi == right.maxNearRssi
+            && left.closeRssi == right.closeRssi
+            && left.startups == right.startups
+            && left.lastStartMillis == right.lastStartMillis
+            && left.maxNotSeenMillis == right.maxNotSeenMillis
+            && left.learnDurationMillis == right.learnDurationMillis
+            && left.triggerLearnMillis == right.triggerLearnMillis
+            && left.triggerFactoryMillis == right.triggerFactoryMillis
+            && left.triggerWiFiOnMillis == right.triggerWiFiOnMillis
+            && left.triggerWiFiOffMillis == right.triggerWiFiOffMillis
+            && strcmp(left.pairedAddress, right.pairedAddress) == 0
+            && strcmp(left.apPwd, right.apPwd) == 0;
+    }
+
+    /**
+     * Keeps an EEPROM record, as the EEPROM library does, as a blob in the
+     * active NvsSim.
+     *
+     * @param record - The record as const Record&.
+     *
+     * @return Returns true if kept otherwise false as bool.
+     */
+    template <typename Record>
+    static bool keepEepromRecord(const Record &record) {
+        return NvsSim::active->set("eeprom", "eeprom", NvsSim::ITEM_BLOB, &record, sizeof(record));
+    }
+#endif
@@ -0,0 +1,294 @@
+/*
+  settings_bench - Host test of how saving settings wears the flash.
+
+  Replays years of a device's life, its boots, learns and settings page
+  saves, against an emulated flash (see flash_sim.h). First the way settings
+  were saved before moving to NVS, the whole EEPROM record at every change,
+  both as arduino-esp32 1.x kept it, in a raw flash sector, and as 2.x does,
+  as an NVS blob. Then through the firmware's own Settings, which writes only
+  the keys which changed and is saved after the change rather than at it.
+  Reports the erase cycles, the worst worn sector, the flash time per save and
+  how long the work making the change is held up by it.
+
+  It also checks that the settings come back intact at each boot, starting
+  from those a device moving up from earlier firmware kept in its EEPROM
+  record. See settings_check for the integrity check and migrations.
+
+  Usage:
+    settings_bench [--boots 3650] [--learns 40] [--posts 120] [--pages 5]
+                   [--seed 1]
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <records.h>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+struct Totals {
+    uint64_t saves = 0ULL;
+    uint64_t blockedMicros = 0ULL;     // <-- Flash time spent where the change is made
+    uint64_t maxBlockedMicros = 0ULL;
+    uint64_t saveMicros = 0ULL;        // <-- Flash time spent saving, wherever it is
+    uint64_t maxSaveMicros = 0ULL;
+};
+
+enum Event : uint8_t {
+    EVENT_BOOT,
+    EVENT_LEARN,
+    EVENT_POST
+};
+
+/**
+ * Makes a change a settings page save would, to both the settings and
+ * the record kept of what they should be.
+ *
+ * @param random - Where changes come from as std::mt19937&.
+ * @param settings - The settings as Settings&.
+ * @param expected - What they should be as SettingsValues&.
+ */
+static void changeSettings(std::mt19937 &random, Settings &settings, SettingsValues &expected) {
+    int changes = 1 + random() % 3;
+    for (int i = 0; i < changes; i++) {
+        switch (random() % 6) {
+            case 0:
+                expected.maxNearRssi = -95 + (int)(random() % 40);
+                settings.setMaxNearRssi(expected.maxNearRssi);
+                break;
+            case 1:
+                expected.closeRssi = -60 + (int)(random() % 25);
+                settings.setCloseRssi(expected.closeRssi);
+                break;
+            case 2:
+                expected.maxNotSeenMillis = 30000UL + (random() % 10) * 10000UL;
+                settings.setMaxNotSeenMillis(expected.maxNotSeenMillis);
+                break;
+            case 3:
+                snprintf(expected.mqttHost, sizeof(expected.mqttHost), "broker-%u.lan", (unsigned)(random() % 100));
+                settings.setMqttHost(expected.mqttHost);
+                break;
+            case 4:
+                expected.gossip = !expected.gossip;
+                settings.setGossip(expected.gossip);
+                break;
+            default:
+                snprintf(expected.apPwd, sizeof(expected.apPwd), "pass-%08x", (unsigned)random());
+                settings.setApPwd(expected.apPwd);
+                break;
+        }
+    }
+}
+
+/**
+ * Learns a device, to both the settings and the record kept of what they
+ * should be.
+ *
+ * @param random - Where addresses come from as std::mt19937&.
+ * @param settings - The settings as Settings&.
+ * @param expected - What they should be as SettingsValues&.
+ */
+static void learnDevice(std::mt19937 &random, Settings &settings, SettingsValues &expected) {
+    snprintf(expected.pairedAddress, sizeof(expected.pairedAddress), "a4:c1:38:%02x:%02x:%02x",
+        (unsigned)(random() % 256), (unsigned)(random() % 256), (unsigned)(random() % 256));
+    settings.setParedAddress(expected.pairedAddress);
+}
+
+/**
+ * Counts a save and the flash time it took.
+ *
+ * @param totals - Where it is counted as Totals&.
+ * @param micros - The flash time as uint64_t.
+ * @param isBlocking - Whether it held up the change as bool.
+ */
+static void count(Totals &totals, uint64_t micros, bool isBlocking) {
+    totals.saves++;
+    totals.saveMicros += micros;
+    totals.maxSaveMicros = std::max(totals.maxSaveMicros, micros);
+    if (isBlocking) {
+        totals.blockedMicros += micros;
+        totals.maxBlockedMicros = std::max(totals.maxBlockedMicros, micros);
+    }
+}
+
+/**
+ * Prints a line of results.
+ *
+ * @param name - What was measured as const char*.
+ * @param flash - Its flash as const FlashSim&.
+ * @param totals - Its saves as const Totals&.
+ * @param writes - The keys written, if counted, as uint64_t.
+ */
+static void report(const char *name, const FlashSim &flash, const Totals &totals, uint64_t writes) {
+    printf("%-22s erases=%-6llu worst_sector=%-6u programmed=%-9llu save_ms avg=%.2f max=%.1f blocked_ms avg=%.2f max=%.1f",
+        name, (unsigned long long)flash.totalErases(), flash.maxErases(), (unsigned long long)flash.programmed,
+        totals.saveMicros / 1000.0 / totals.saves, totals.maxSaveMicros / 1000.0,
+        totals.blockedMicros / 1000.0 / totals.saves, totals.maxBlockedMicros / 1000.0);
+    if (writes > 0ULL) {
+        printf(" keys/save=%.2f", (double)writes / totals.saves);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    int boots = 3650; // <-- A restart a day for ten years
+    int learns = 40;
+    int posts = 120;
+    uint32_t pages = 5; // <-- The nvs partition in partitions.csv
+    uint32_t seed = 1;
+
+    const struct option longOptions[] = {
+        { "boots", required_argument, nullptr, 'b' },
+        { "learns", required_argument, nullptr, 'l' },
+        { "posts", required_argument, nullptr, 'p' },
+        { "pages", required_argument, nullptr, 'g' },
+        { "seed", required_argument, nullptr, 's' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+        switch (option) {
+            case 'b': boots = atoi(optarg); break;
+            case 'l': learns = atoi(optarg); break;
+            case 'p': posts = atoi(optarg); break;
+            case 'g': pages = (uint32_t)atoi(optarg); break;
+            case 's': seed = (uint32_t)atoi(optarg); break;
+            default:
+                optind = argc + 1;
+                break;
+        }
+    }
+    if (optind != argc || boots < 1 || learns < 0 || posts < 0 || pages < 2) {
+        fprintf(stderr, "usage: settings_bench [--boots N] [--learns N] [--posts N] [--pages N] [--seed N]\n");
+        return 2;
+    }
+
+    // A life of events, starting with a boot
+    std::mt19937 random(seed);
+    std::vector<Event> events;
+    events.insert(events.end(), boots - 1, EVENT_BOOT);
+    events.insert(events.end(), learns, EVENT_LEARN);
+    events.insert(events.end(), posts, EVENT_POST);
+    std::shuffle(events.begin(), events.end(), random);
+    events.insert(events.begin(), EVENT_BOOT);
+
+    // The device comes from earlier firmware with some settings of its own
+    SettingsValues start;
+    {
+        Settings defaults;
+        start = valuesOf(defaults);
+    }
+    strlcpy(start.pairedAddress, "a4:c1:38:12:34:56", sizeof(start.pairedAddress));
+    strlcpy(start.apPwd, "Upgrade-Me-42", sizeof(start.apPwd));
+    start.maxNearRssi = -72;
+    start.startups = 57UL;
+
+    // Before: the whole record is saved where each change is made
+    FlashSim sector(1);
+    NvsSim blobNvs(pages);
+    Totals sectorTotals;
+    Totals blobTotals;
+    {
+        NvsSim::active = &blobNvs;
+        DeviceRecord record = releasedRecordOf<uint32_t>(start);
+        keepEepromRecord(record);
+        blobNvs.flash.resetCounts();
+
+        std::mt19937 changes(seed + 1);
+        SettingsValues expected = start;
+        Settings scratch; // <-- Only to share changeSettings()
+        for (Event event : events) {
+            switch (event) {
+                case EVENT_BOOT:
+                    expected.startups++;
+                    expected.lastStartMillis = 200UL + changes() % 800UL;
+                    break;
+                case EVENT_LEARN:
+                    learnDevice(changes, scratch, expected);
+                    break;
+                case EVENT_POST:
+                    changeSettings(changes, scratch, expected);
+                    break;
+            }
+            record = releasedRecordOf<uint32_t>(expected);
+
+            uint64_t before = sector.micros;
+            sector.erase(0);
+            sector.program(0, sizeof(DeviceRecord));
+            count(sectorTotals, sector.micros - before, true);
+
+            before = blobNvs.flash.micros;
+            keepEepromRecord(record); // <-- A commit writes the whole blob again
+            count(blobTotals, blobNvs.flash.micros - before, true);
+        }
+    }
+
+    // After: only changed keys are written, by a save run after the change
+    NvsSim keyNvs(pages);
+    Totals keyTotals;
+    uint64_t keyWrites = 0ULL;
+    int failures = 0;
+    bool isImported = false;
+    {
+        NvsSim::active = &keyNvs;
+        keepEepromRecord(releasedRecordOf<unsigned long>(start));
+        keyNvs.flash.resetCounts();
+
+        std::mt19937 changes(seed + 1);
+        SettingsValues expected = start;
+        std::unique_ptr<Settings> settings;
+        for (Event event : events) {
+            switch (event) {
+                case EVENT_BOOT: {
+                    settings.reset(new Settings());
+                    bool isLoaded = settings->loadSettings();
+                    if (!isLoaded || !isSame(valuesOf(*settings), expected)) {
+                        failures++;
+                    }
+                    isImported = isImported || (isLoaded && settings->getStartups() == start.startups && !keyNvs.has("settings", "startups"));
+
+                    expected.startups++;
+                    expected.lastStartMillis = 200UL + changes() % 800UL;
+                    Clock::millis = expected.lastStartMillis;
+                    settings->logStartup();
+                    break;
+                }
+                case EVENT_LEARN:
+                    learnDevice(changes, *settings, expected);
+                    break;
+                case EVENT_POST:
+                    changeSettings(changes, *settings, expected);
+                    break;
+            }
+
+            uint64_t before = keyNvs.flash.micros;
+            uint64_t writes = keyNvs.writes;
+            if (!settings->saveSettings()) {
+                failures++;
+            }
+            count(keyTotals, keyNvs.flash.micros - before, false);
+            keyWrites += keyNvs.writes - writes;
+        }
+
+        settings.reset(new Settings());
+        if (!settings->loadSettings() || !isSame(valuesOf(*settings), expected)) {
+            failures++;
+        }
+    }
+
+    printf("events: boots=%d learns=%d posts=%d nvs_pages=%u record=%zu bytes (as on the ESP32)\n",
+        boots, learns, posts, pages, sizeof(DeviceRecord));
+    report("before: eeprom sector", sector, sectorTotals, 0ULL);
+    report("before: eeprom blob", blobNvs.flash, blobTotals, 0ULL);
+    report("after: nvs keys", keyNvs.flash, keyTotals, keyWrites);
+    printf("settings_intact=%s imported_from_eeprom=%s\n", failures == 0 ? "yes" : "NO", isImported ? "yes" : "NO");
+
+    return failures == 0 && isImported ? 0 : 1;
+}
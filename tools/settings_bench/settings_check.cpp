@@ -0,0 +1,504 @@
+/*
+  settings_check - Host test of the settings' integrity check and schema
+  migrations.
+
+  Runs the firmware's own Settings against the emulated NVS (see flash_sim.h):
+
+    - Settings kept in the EEPROM record as released are loaded, saved in
+      the current schema on the next save, and come back intact after.
+      Those outside the range the schema now gives them are brought within
+      it, so that the web form accepts them.
+      Settings left by a later schema, as after a rollback, are kept too.
+    - A power cut after each write of a save, and of a migration, leaves
+      each setting whole, as it was or as the save made it.
+    - Every single bit flip in every stored key, CRC included, and every
+      missing key is either caught or leaves the settings as they were. The
+      same flips in the released EEPROM record are tried against its MD5
+      sentinel for comparison, as is a corrupt EEPROM record.
+    - Values from the web are refused outside the range the schema gives
+      them, and every default is within it.
+    - How long checking the settings takes, MD5 sentinel against CRC-32.
+
+  Usage:
+    settings_check
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+
+#include <records.h>
+
+#include <stdio.h>
+#include <time.h>
+
+static int failures = 0;
+
+static void check(const char *name, bool isPassed) {
+    printf("%-46s %s\n", name, isPassed ? "ok" : "FAILED");
+    failures += isPassed ? 0 : 1;
+}
+
+static double nowSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Gives settings of a device's own, none of them the factory defaults.
+ *
+ * @return Returns the settings as SettingsValues.
+ */
+static SettingsValues ownSettings() {
+    SettingsValues record = {};
+    record.maxNearRssi = -71;
+    record.closeRssi = -47;
+    record.startups = 1234UL;
+    record.lastStartMillis = 321UL;
+    record.maxNotSeenMillis = 90000UL;
+    record.learnDurationMillis = 12000UL;
+    record.triggerLearnMillis = 4000UL;
+    record.triggerFactoryMillis = 25000UL;
+    record.triggerWiFiOnMillis = 9000UL;
+    record.triggerWiFiOffMillis = 4500UL;
+    strlcpy(record.pairedAddress, "a4:c1:38:0b:1e:77", sizeof(record.pairedAddress));
+    strlcpy(record.apPwd, "Kept-Across-Upgrades", sizeof(record.apPwd));
+    strlcpy(record.staSsid, "HomeNet", sizeof(record.staSsid));
+    strlcpy(record.staPwd, "station-secret", sizeof(record.staPwd));
+    strlcpy(record.mqttHost, "broker.lan", sizeof(record.mqttHost));
+    record.mqttPort = 8883UL;
+    record.gossip = true;
+    record.gossipMarginDb = 4;
+    strlcpy(record.proxyHost, "proxy.lan", sizeof(record.proxyHost));
+    record.proxyPort = 47000UL;
+    record.proxyUdp = false;
+
+    return record;
+}
+
+/**
+ * Saves the given settings through Settings, in the current schema.
+ *
+ * @param record - The settings as const SettingsValues&.
+ *
+ * @return Returns true if saved otherwise false as bool.
+ */
+static bool saveThrough(const SettingsValues &record) {
+    Settings settings;
+    settings.loadSettings();
+    settings.setMaxNearRssi(record.maxNearRssi);
+    settings.setCloseRssi(record.closeRssi);
+    settings.setMaxNotSeenMillis(record.maxNotSeenMillis);
+    settings.setLearnDurationMillis(record.learnDurationMillis);
+    settings.setTriggerLearnMillis(record.triggerLearnMillis);
+    settings.setTriggerFactoryMillis(record.triggerFactoryMillis);
+    settings.setTriggerWiFiOnMillis(record.triggerWiFiOnMillis);
+    settings.setTriggerWiFiOffMillis(record.triggerWiFiOffMillis);
+    settings.setParedAddress(record.pairedAddress);
+    settings.setApPwd(record.apPwd);
+    settings.setStaSsid(record.staSsid);
+    settings.setStaPwd(record.staPwd);
+    settings.setMqttHost(record.mqttHost);
+    settings.setMqttPort(record.mqttPort);
+    settings.setGossip(record.gossip);
+    settings.setGossipMarginDb(record.gossipMarginDb);
+    settings.setProxyHost(record.proxyHost);
+    settings.setProxyPort(record.proxyPort);
+    settings.setProxyUdp(record.proxyUdp);
+    Clock::millis = record.lastStartMillis;
+    while (settings.getStartups() < record.startups) {
+        settings.logStartup();
+    }
+
+    return settings.saveSettings();
+}
+
+/**
+ * Loads the settings as a booting device would, then saves them, as the
+ * save scheduled at boot would, and loads them again.
+ *
+ * @param expected - What they should be as const SettingsValues&.
+ * @param isResaved - Set to whether anything needed saving as bool&.
+ *
+ * @return Returns true if they were as expected both times otherwise
+ * false as bool.
+ */
+static bool migrates(const SettingsValues &expected, bool &isResaved) {
+    Settings settings;
+    if (!settings.loadSettings() || !isSame(valuesOf(settings), expected)) {
+        return false;
+    }
+    isResaved = settings.isSavePending();
+    if (!settings.saveSettings()) {
+        return false;
+    }
+
+    Settings rebooted;
+    return rebooted.loadSettings() && !rebooted.isSavePending() && isSame(valuesOf(rebooted), expected);
+}
+
+/**
+ * Flips each bit of each of the settings' keys in turn, and takes away
+ * each key in turn, loading the settings each time.
+ *
+ * @param nvs - Where the settings are as NvsSim&.
+ * @param saved - What they are as const SettingsValues&.
+ * @param tries - Set to how many corruptions were tried as int&.
+ *
+ * @return Returns how many were loaded as different settings as int.
+ */
+static int corruptKeys(NvsSim &nvs, const SettingsValues &saved, int &tries) {
+    int missed = 0;
+    for (const std::string &key : nvs.keys("settings")) {
+        NvsSim::ItemType type = NvsSim::ITEM_U8;
+        std::vector<uint8_t> value;
+        nvs.peek("settings", key, type, value);
+
+        // Text keeps its terminator, which isn't part of the value
+        size_t length = type == NvsSim::ITEM_STR ? value.size() - 1 : value.size();
+        for (size_t bit = 0; bit < length * 8; bit++) {
+            std::vector<uint8_t> flipped = value;
+            flipped[bit / 8] ^= (uint8_t)(1U << (bit % 8));
+            nvs.set("settings", key, type, flipped.data(), flipped.size());
+
+            Settings settings;
+            bool isLoaded = settings.loadSettings();
+            missed += isLoaded && !isSame(valuesOf(settings), saved) ? 1 : 0;
+            tries++;
+        }
+
+        nvs.remove("settings", key);
+        Settings settings;
+        bool isLoaded = settings.loadSettings();
+        missed += isLoaded && !isSame(valuesOf(settings), saved) ? 1 : 0;
+        tries++;
+
+        nvs.set("settings", key, type, value.data(), value.size());
+    }
+
+    return missed;
+}
+
+/**
+ * Flips each bit of the released EEPROM record's settings in turn,
+ * checking its sentinel each time as Settings did.
+ *
+ * @param record - The record as const HostRecord&.
+ * @param tries - Set to how many flips changed the settings as int&.
+ *
+ * @return Returns how many of those the sentinel missed as int.
+ */
+static int corruptEepromRecord(const HostRecord &record, int &tries) {
+    int missed = 0;
+    for (size_t bit = 0; bit < offsetof(HostRecord, sentinel) * 8; bit++) {
+        HostRecord flipped = record;
+        ((uint8_t*)&flipped)[bit / 8] ^= (uint8_t)(1U << (bit % 8));
+        if (isSame(flipped, record)) {
+            continue; // <-- Padding or past the end of some text
+        }
+        tries++;
+        missed += strcmp(sentinelOf(flipped).c_str(), record.sentinel) == 0 ? 1 : 0;
+    }
+
+    return missed;
+}
+
+/**
+ * Changes some of the settings, text among them, as a post from the web
+ * would.
+ *
+ * @param settings - The settings as Settings&.
+ */
+static void changeSome(Settings &settings) {
+    settings.setCloseRssi(-44);
+    settings.setApPwd("Changed-By-The-Web");
+    settings.setStaSsid("OtherNet");
+    settings.setMqttPort(1883UL);
+    settings.setGossip(false);
+}
+
+/**
+ * Used to determine if each setting changeSome() changes is as it was or
+ * as it was changed to, the others being as they were.
+ *
+ * @param loaded - The settings as const SettingsValues&.
+ * @param before - Them before the change as const SettingsValues&.
+ * @param after - Them after it as const SettingsValues&.
+ *
+ * @return Returns true if so otherwise false as bool.
+ */
+static bool isEachWhole(const SettingsValues &loaded, const SettingsValues &before, const SettingsValues &after) {
+    for (int changed = 0; changed < 32; changed++) {
+        SettingsValues mix = before;
+        mix.closeRssi = (changed & 0x01) != 0 ? after.closeRssi : before.closeRssi;
+        strlcpy(mix.apPwd, (changed & 0x02) != 0 ? after.apPwd : before.apPwd, sizeof(mix.apPwd));
+        strlcpy(mix.staSsid, (changed & 0x04) != 0 ? after.staSsid : before.staSsid, sizeof(mix.staSsid));
+        mix.mqttPort = (changed & 0x08) != 0 ? after.mqttPort : before.mqttPort;
+        mix.gossip = (changed & 0x10) != 0 ? after.gossip : before.gossip;
+        if (isSame(loaded, mix)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Cuts the power after each write of a save in turn, then boots again,
+ * until the save completes.
+ *
+ * @param keep - Puts what is kept before the save as void (*)().
+ * @param before - The settings before the save as const SettingsValues&.
+ * @param after - The settings the save makes as const SettingsValues&.
+ * @param cuts - Set to how many cuts were tried as int&.
+ *
+ * @return Returns how many boots after a cut didn't load each setting
+ * whole, or weren't then saved cleanly, as int.
+ */
+static int cutThroughSave(void (*keep)(), const SettingsValues &before, const SettingsValues &after, int &cuts) {
+    int failed = 0;
+    for (long writes = 0L; ; writes++) {
+        NvsSim nvs(5);
+        NvsSim::active = &nvs;
+        keep();
+
+        Settings settings;
+        settings.loadSettings();
+        changeSome(settings);
+        nvs.writesLeft = writes;
+        bool isDone = settings.saveSettings();
+        nvs.writesLeft = -1L;
+        if (isDone) {
+            break;
+        }
+        cuts++;
+
+        Settings rebooted;
+        bool isLoaded = rebooted.loadSettings();
+        SettingsValues loaded = valuesOf(rebooted);
+        bool isWhole = isEachWhole(loaded, before, after);
+        bool isSaved = rebooted.saveSettings();
+
+        Settings again;
+        isSaved = isSaved && again.loadSettings() && !again.isSavePending() && isSame(valuesOf(again), loaded);
+        failed += isLoaded && isWhole && isSaved ? 0 : 1;
+    }
+
+    return failed;
+}
+
+static void keepOwn() {
+    saveThrough(ownSettings());
+}
+
+static void keepReleased() {
+    keepEepromRecord(releasedRecordOf<unsigned long>(ownSettings()));
+}
+
+int main() {
+    SettingsValues own = ownSettings();
+    HostRecord ownRecord = releasedRecordOf<unsigned long>(own);
+    SettingsValues defaults;
+    {
+        Settings settings;
+        defaults = valuesOf(settings);
+    }
+
+    const char *digits = "123456789";
+    check("crc32 of \"123456789\" is 0xCBF43926", Crc32::calculate(digits, 9) == 0xCBF43926UL);
+    check("crc32 carries on across pieces", Crc32::calculate(digits + 4, 5, Crc32::calculate(digits, 4)) == 0xCBF43926UL);
+
+    // Nothing kept yet
+    {
+        NvsSim nvs(5);
+        NvsSim::active = &nvs;
+        Settings settings;
+        bool isLoaded = settings.loadSettings();
+        check("new device starts from the defaults", !isLoaded && isSame(valuesOf(settings), defaults) && settings.isSavePending());
+    }
+
+    // The EEPROM record as released, which knew nothing of the later settings
+    {
+        NvsSim nvs(5);
+        NvsSim::active = &nvs;
+        keepEepromRecord(ownRecord);
+
+        SettingsValues expected = releasedOnly(own, defaults);
+        bool isResaved = false;
+        check("migrates from the released eeprom record", migrates(expected, isResaved) && isResaved);
+        check("  leaves the record for a rolled back firmware", nvs.has("eeprom", "eeprom"));
+    }
+
+    // The EEPROM record as released, with values the schema now refuses
+    {
+        NvsSim nvs(5);
+        NvsSim::active = &nvs;
+        SettingsValues outOfRange = own;
+        outOfRange.triggerFactoryMillis = 5000UL;
+        outOfRange.triggerWiFiOnMillis = 3000UL;
+        strlcpy(outOfRange.apPwd, "short", sizeof(outOfRange.apPwd));
+        keepEepromRecord(releasedRecordOf<unsigned long>(outOfRange));
+
+        SettingsValues expected = releasedOnly(own, defaults);
+        expected.triggerFactoryMillis = 10000UL;
+        expected.triggerWiFiOnMillis = 6000UL;
+        strlcpy(expected.apPwd, defaults.apPwd, sizeof(expected.apPwd));
+        bool isResaved = false;
+        bool isMigrated = migrates(expected, isResaved) && isResaved;
+
+        Settings settings;
+        bool isAcceptable = settings.loadSettings();
+        for (uint8_t field = 0; field < Settings::FIELD_COUNT; field++) {
+            bool isText = Settings::FIELDS[field].type == Settings::TYPE_TEXT;
+            String value = isText ? String(settings.getText(field)) : String((long)settings.getNumber(field));
+            isAcceptable = isAcceptable && settings.isAcceptable(field, value);
+        }
+        check("brings migrated settings within range", isMigrated && isAcceptable);
+    }
+
+    // Already in the current schema
+    {
+        NvsSim nvs(5);
+        NvsSim::active = &nvs;
+        saveThrough(own);
+
+        bool isResaved = true;
+        check("loads the current schema without saving", migrates(own, isResaved) && !isResaved);
+    }
+
+    // Left by a later schema, as after rolling back an update
+    {
+        NvsSim nvs(5);
+        NvsSim::active = &nvs;
+        saveThrough(own);
+        uint8_t later = 9;
+        uint32_t unknown = 77;
+        nvs.set("settings", "schema", NvsSim::ITEM_U8, &later, 1);
+        nvs.set("settings", "laterSetting", NvsSim::ITEM_U32, &unknown, 4);
+
+        bool isResaved = false;
+        check("keeps settings left by a later schema", migrates(own, isResaved) && isResaved && nvs.has("settings", "laterSetting"));
+    }
+
+    // A corrupt EEPROM record
+    {
+        NvsSim nvs(5);
+        NvsSim::active = &nvs;
+        HostRecord released = ownRecord;
+        released.closeRssi = -30; // <-- Changed after its sentinel was worked out
+        keepEepromRecord(released);
+        Settings settings;
+        bool isLoaded = settings.loadSettings();
+        check("corrupt released eeprom record gives defaults", !isLoaded && isSame(valuesOf(settings), defaults));
+    }
+
+    // Every single bit flip and missing key in the current schema
+    {
+        NvsSim nvs(5);
+        NvsSim::active = &nvs;
+        saveThrough(own);
+
+        int tries = 0;
+        int missed = corruptKeys(nvs, own, tries);
+        char name[64];
+        snprintf(name, sizeof(name), "%d corruptions caught or harmless", tries);
+        check(name, missed == 0);
+
+        int sentinelTries = 0;
+        int sentinelMissed = corruptEepromRecord(ownRecord, sentinelTries);
+        printf("  (the md5 sentinel missed %d of %d, all in startups and lastStartMillis)\n", sentinelMissed, sentinelTries);
+    }
+
+    // A power cut at each write of a save, and of the save migrating the released record
+    {
+        SettingsValues changed = own;
+        changed.closeRssi = -44;
+        strlcpy(changed.apPwd, "Changed-By-The-Web", sizeof(changed.apPwd));
+        strlcpy(changed.staSsid, "OtherNet", sizeof(changed.staSsid));
+        changed.mqttPort = 1883UL;
+        changed.gossip = false;
+
+        int cuts = 0;
+        int failed = cutThroughSave(keepOwn, own, changed, cuts);
+        char name[64];
+        snprintf(name, sizeof(name), "%d power cuts through a save keep each whole", cuts);
+        check(name, failed == 0 && cuts >= 5); // <-- A cut before each setting changeSome() changes
+
+        SettingsValues released = releasedOnly(own, defaults);
+        SettingsValues migrated = released;
+        migrated.closeRssi = changed.closeRssi;
+        strlcpy(migrated.apPwd, changed.apPwd, sizeof(migrated.apPwd));
+        strlcpy(migrated.staSsid, changed.staSsid, sizeof(migrated.staSsid));
+        migrated.mqttPort = changed.mqttPort;
+        migrated.gossip = changed.gossip;
+
+        cuts = 0;
+        failed = cutThroughSave(keepReleased, released, migrated, cuts);
+        snprintf(name, sizeof(name), "  and %d through a migration", cuts);
+        check(name, failed == 0 && cuts > (int)Settings::FIELD_COUNT);
+    }
+
+    // Values from the web, checked against the schema
+    {
+        NvsSim nvs(5);
+        NvsSim::active = &nvs;
+        Settings settings;
+        settings.loadSettings();
+        char longSsid[34];
+        memset(longSsid, 's', 33);
+        longSsid[33] = '\0';
+
+        check("rssi in range is accepted", settings.isAcceptable(Settings::FIELD_MAX_NEAR_RSSI, "-75"));
+        check("rssi out of range is refused",
+            !settings.isAcceptable(Settings::FIELD_MAX_NEAR_RSSI, "5") && !settings.isAcceptable(Settings::FIELD_MAX_NEAR_RSSI, "-101"));
+        check("a number that isn't is refused",
+            !settings.isAcceptable(Settings::FIELD_MQTT_PORT, "") && !settings.isAcceptable(Settings::FIELD_MQTT_PORT, "18x3")
+            && !settings.isAcceptable(Settings::FIELD_MQTT_PORT, "99999999999999999999"));
+        check("a bool is 0 or 1", settings.isAcceptable(Settings::FIELD_GOSSIP, "1") && !settings.isAcceptable(Settings::FIELD_GOSSIP, "2"));
+        check("text is refused outside its length",
+            !settings.isAcceptable(Settings::FIELD_AP_PWD, "short") && !settings.isAcceptable(Settings::FIELD_STA_SSID, longSsid)
+            && settings.isAcceptable(Settings::FIELD_STA_SSID, ""));
+
+        settings.saveSettings();
+        bool isChanged = settings.setFromText(Settings::FIELD_MQTT_PORT, "8883");
+        bool isSame = !settings.setFromText(Settings::FIELD_MQTT_PORT, "8883");
+        check("a change is reported only once", isChanged && isSame && settings.getMqttPort() == 8883UL && settings.isSavePending());
+        check("a refused value leaves the setting", !settings.setFromText(Settings::FIELD_CLOSE_RSSI, "-200") && settings.getCloseRssi() == -50);
+        check("text is set whole", settings.setFromText(Settings::FIELD_STA_SSID, "home") && settings.getStaSsid().equals("home"));
+
+        bool isInRange = true;
+        for (uint8_t field = 0; field < Settings::FIELD_COUNT; field++) {
+            const Settings::FieldInfo &info = Settings::FIELDS[field];
+            long long value = info.type == Settings::TYPE_TEXT ? (long long)strlen(info.text) : info.number;
+            isInRange = isInRange && value >= info.minimum && value <= info.maximum;
+        }
+        check("every default is within its range", isInRange);
+    }
+
+    // What checking the settings costs
+    {
+        const int rounds = 20000;
+        volatile uint32_t sink = 0;
+
+        double start = nowSeconds();
+        for (int i = 0; i < rounds; i++) {
+            sink += sentinelOf(ownRecord).length();
+        }
+        double md5Nanos = (nowSeconds() - start) / rounds * 1e9;
+
+        start = nowSeconds();
+        for (int i = 0; i < rounds; i++) {
+            sink += Crc32::calculate(&ownRecord, offsetof(HostRecord, sentinel));
+        }
+        double crcNanos = (nowSeconds() - start) / rounds * 1e9;
+        (void)sink;
+
+        printf("check cost: md5 sentinel %.0f ns, crc32 %.0f ns (%.0fx less), record of %zu bytes on this host\n",
+            md5Nanos, crcNanos, md5Nanos / crcNanos, offsetof(HostRecord, sentinel));
+    }
+
+    printf("%s\n", failures == 0 ? "all passed" : "FAILURES");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+/*
+  Host stand-in for the firmware's Clock, whose time the bench sets.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef SettingsBenchClock_h
+    #define SettingsBenchClock_h
+
+    #include <stdint.h>
+
+    class Clock {
+    public:
+        static inline uint64_t millis = 0ULL;
+
+        static uint64_t nowMillis() { return millis; }
+    };
+#endif
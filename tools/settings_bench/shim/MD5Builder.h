@@ -0,0 +1,34 @@
+/*
+  Host stand-in for the arduino-esp32 MD5Builder, backed by OpenSSL, for the
+  sentinel of the EEPROM record Settings reads from earlier firmware.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef SettingsBenchMD5Builder_h
+    #define SettingsBenchMD5Builder_h
+
+    #include <WString.h>
+    #include <openssl/md5.h>
+    #include <stdio.h>
+
+    class MD5Builder {
+    public:
+        void begin() { MD5_Init(&context); }
+        void add(const String &text) { MD5_Update(&context, text.c_str(), text.length()); }
+        void calculate() { MD5_Final(digest, &context); }
+
+        String toString() {
+            char hex[33];
+            for (int i = 0; i < 16; i++) {
+                snprintf(hex + i * 2, 3, "%02x", digest[i]);
+            }
+
+            return String(hex);
+        }
+
+    private:
+        MD5_CTX context;
+        uint8_t digest[16];
+    };
+#endif
@@ -0,0 +1,95 @@
+/*
+  Host stand-in for the arduino-esp32 Preferences library, keeping its keys
+  in the active NvsSim so that their writes wear the emulated flash as they
+  would the real one. Types are sized as on the ESP32, where an unsigned long
+  is 32 bits.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef SettingsBenchPreferences_h
+    #define SettingsBenchPreferences_h
+
+    #include <WString.h>
+    #include <flash_sim.h>
+
+    class Preferences {
+    public:
+        bool begin(const char *name, bool readOnly = false, const char *partition = nullptr) {
+            (void)partition;
+            ns = name;
+            isReadOnly = readOnly;
+
+            return NvsSim::active != nullptr;
+        }
+
+        void end() {}
+
+        bool isKey(const char *key) { return NvsSim::active->has(ns, key); }
+        bool remove(const char *key) { return !isReadOnly && NvsSim::active->remove(ns, key); }
+
+        size_t putUChar(const char *key, uint8_t value) { return put(key, NvsSim::ITEM_U8, &value, 1); }
+        size_t putBool(const char *key, bool value) { return putUChar(key, value ? 1 : 0); }
+        size_t putInt(const char *key, int32_t value) { return put(key, NvsSim::ITEM_I32, &value, 4); }
+        size_t putUInt(const char *key, uint32_t value) { return put(key, NvsSim::ITEM_U32, &value, 4); }
+        size_t putULong(const char *key, unsigned long value) { return putUInt(key, (uint32_t)value); }
+        size_t putULong64(const char *key, uint64_t value) { return put(key, NvsSim::ITEM_U64, &value, 8); }
+        size_t putBytes(const char *key, const void *value, size_t length) { return put(key, NvsSim::ITEM_BLOB, value, length); }
+
+        size_t putString(const char *key, const char *value) {
+            return put(key, NvsSim::ITEM_STR, value, strlen(value) + 1) > 0 ? strlen(value) : 0;
+        }
+
+        uint8_t getUChar(const char *key, uint8_t fallback = 0) { return get<uint8_t>(key, NvsSim::ITEM_U8, fallback); }
+        bool getBool(const char *key, bool fallback = false) { return getUChar(key, fallback ? 1 : 0) != 0; }
+        int32_t getInt(const char *key, int32_t fallback = 0) { return get<int32_t>(key, NvsSim::ITEM_I32, fallback); }
+        uint32_t getUInt(const char *key, uint32_t fallback = 0) { return get<uint32_t>(key, NvsSim::ITEM_U32, fallback); }
+        unsigned long getULong(const char *key, unsigned long fallback = 0) { return getUInt(key, (uint32_t)fallback); }
+        uint64_t getULong64(const char *key, uint64_t fallback = 0) { return get<uint64_t>(key, NvsSim::ITEM_U64, fallback); }
+
+        size_t getBytes(const char *key, void *buffer, size_t length) {
+            std::vector<uint8_t> value;
+            if (!NvsSim::active->get(ns, key, NvsSim::ITEM_BLOB, value) || value.size() > length) {
+                return 0;
+            }
+            memcpy(buffer, value.data(), value.size());
+
+            return value.size();
+        }
+
+        size_t getBytesLength(const char *key) {
+            std::vector<uint8_t> value;
+            return NvsSim::active->get(ns, key, NvsSim::ITEM_BLOB, value) ? value.size() : 0;
+        }
+
+        size_t getString(const char *key, char *buffer, size_t length) {
+            std::vector<uint8_t> value;
+            if (!NvsSim::active->get(ns, key, NvsSim::ITEM_STR, value) || value.size() > length) {
+                return 0;
+            }
+            memcpy(buffer, value.data(), value.size());
+
+            return value.size();
+        }
+
+    private:
+        std::string ns;
+        bool isReadOnly = false;
+
+        size_t put(const char *key, NvsSim::ItemType type, const void *value, size_t length) {
+            return !isReadOnly && NvsSim::active->set(ns, key, type, value, length) ? length : 0;
+        }
+
+        template <typename T>
+        T get(const char *key, NvsSim::ItemType type, T fallback) {
+            std::vector<uint8_t> value;
+            if (!NvsSim::active->get(ns, key, type, value) || value.size() != sizeof(T)) {
+                return fallback;
+            }
+            T result;
+            memcpy(&result, value.data(), sizeof(T));
+
+            return result;
+        }
+    };
+#endif
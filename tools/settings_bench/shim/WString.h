@@ -0,0 +1,49 @@
+/*
+  Host stand-in for the little of Arduino's String class Settings uses,
+  backed by std::string, so that it builds unchanged off the device.
+
+  Written by: ... Scott Griffis
+  Date: ......... 10/16/2026
+*/
+#ifndef SettingsBenchWString_h
+    #define SettingsBenchWString_h
+
+    #include <stddef.h>
+    #include <stdint.h>
+    #include <string.h>
+
+    #include <string>
+
+    #if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+        static inline size_t strlcpy(char *destination, const char *source, size_t size) {
+            size_t length = strlen(source);
+            if (size > 0) {
+                size_t count = length < size - 1 ? length : size - 1;
+                memcpy(destination, source, count);
+                destination[count] = '\0';
+            }
+
+            return length;
+        }
+    #endif
+
+    class String {
+    public:
+        String(const char *text = "") : text(text) {}
+        String(int value) : text(std::to_string(value)) {}
+        String(unsigned int value) : text(std::to_string(value)) {}
+        String(long value) : text(std::to_string(value)) {}
+        String(unsigned long value) : text(std::to_string(value)) {}
+
+        const char* c_str() const { return text.c_str(); }
+        unsigned int length() const { return (unsigned int)text.size(); }
+        bool isEmpty() const { return text.empty(); }
+        bool equals(const String &other) const { return text == other.text; }
+
+        friend String operator+(const String &left, const String &right) { return String((left.text + right.text).c_str()); }
+        friend String operator+(const String &left, const char *right) { return String((left.text + right).c_str()); }
+
+    private:
+        std::string text;
+    };
+#endif
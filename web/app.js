@@ -0,0 +1,193 @@
+/*
+  Fills the settings page shell from the device's status and settings
+  APIs and puts updates back without reloading the page. The settings
+  form is built from the device's settings schema. Live events
+  from the device are shown and the paired device's RSSI is charted
+  against the RSSI thresholds being tuned.
+*/
+(function () {
+  var form = document.getElementById('settings');
+
+  function show(data) {
+    Object.keys(data).forEach(function (key) {
+      var secret = /_set$/.test(key) && document.getElementById(key.replace(/_set$/, ''));
+      if (secret) {
+        // Secrets aren't sent, only whether one is set; Left blank they're kept
+        secret.value = '';
+        secret.placeholder = data[key] ? 'Set; leave blank to keep' : 'Not set';
+        return;
+      }
+      var element = document.getElementById(key);
+      if (!element) {
+        return;
+      }
+      if (element.type === 'checkbox') {
+        element.checked = Boolean(data[key]);
+      } else if (data[key] !== null && typeof data[key] === 'object') {
+        element.textContent = Object.keys(data[key]).map(function (name) {
+          return name + ' ' + data[key][name];
+        }).join('; ');
+      } else if (element.tagName === 'INPUT') {
+        element.value = data[key];
+      } else {
+        element.textContent = data[key];
+      }
+    });
+    if (data.message) {
+      alert(data.message);
+    }
+  }
+
+  function request(url, init) {
+    fetch(url, init)
+      .then(function (response) { return response.json(); })
+      .then(show)
+      .catch(function () { alert('Unable to reach the device!'); });
+  }
+
+  function row(table, label, element) {
+    var cells = table.insertRow();
+    cells.insertCell().textContent = label;
+    cells.insertCell().appendChild(element);
+  }
+
+  function input(field) {
+    if (field.read_only) {
+      return document.createElement('span');
+    }
+    var element = document.createElement('input');
+    if (field.type === 'bool') {
+      element.type = 'checkbox';
+      element.value = '1';
+    } else if (field.type === 'number') {
+      element.type = 'number';
+      element.min = field.min;
+      element.max = field.max;
+      element.step = 1;
+    } else {
+      element.type = field.secret ? 'password' : 'text';
+      element.minLength = field.min;
+      element.maxLength = field.max;
+    }
+    element.name = field.name;
+
+    return element;
+  }
+
+  function build(schema) {
+    var table = document.getElementById('fields');
+    schema.fields.forEach(function (field, index) {
+      if (field.section && index > 0) {
+        var rule = table.insertRow().insertCell();
+        rule.colSpan = 2;
+        rule.appendChild(document.createElement('hr'));
+      }
+      var element = input(field);
+      element.id = field.name;
+      row(table, field.label + ':', element);
+      if (field.secret && field.min === 0 && !field.read_only) {
+        // A blank secret is kept, so one that may be empty needs a way to clear it
+        var clear = document.createElement('input');
+        clear.type = 'checkbox';
+        clear.value = '1';
+        clear.name = clear.id = field.name + '_clear';
+        row(table, 'Clear ' + field.label + ':', clear);
+      }
+    });
+  }
+
+  form.addEventListener('submit', function (event) {
+    event.preventDefault();
+    var body = new URLSearchParams(new FormData(form));
+    form.querySelectorAll('input[type=checkbox]').forEach(function (box) {
+      body.set(box.name, box.checked ? '1' : '0'); // <-- Unchecked boxes aren't sent otherwise
+    });
+    request('/api/settings', { method: 'PUT', body: body });
+  });
+
+  var firmware = document.getElementById('firmware');
+  firmware.addEventListener('submit', function (event) {
+    event.preventDefault();
+    request('/update', { method: 'POST', body: new FormData(firmware) });
+  });
+
+  var CHART_POINTS = 120;
+  var chart = document.getElementById('chart');
+  var samples = [];
+
+  function draw() {
+    var context = chart.getContext('2d');
+    var y = function (rssi) { return chart.height * -rssi / 100; };
+    var x = function (index) { return chart.width * index / (CHART_POINTS - 1); };
+
+    context.clearRect(0, 0, chart.width, chart.height);
+    [['max_rssi', '#58ADB0'], ['close_rssi', '#CF0202']].forEach(function (threshold) {
+      var setting = document.getElementById(threshold[0]);
+      if (!setting) {
+        return;
+      }
+      var level = y(Number(setting.value));
+      context.strokeStyle = threshold[1];
+      context.beginPath();
+      context.moveTo(0, level);
+      context.lineTo(chart.width, level);
+      context.stroke();
+    });
+
+    context.strokeStyle = '#0d2c4a';
+    context.beginPath();
+    samples.forEach(function (rssi, index) {
+      context[index === 0 ? 'moveTo' : 'lineTo'](x(index), y(rssi));
+    });
+    context.stroke();
+  }
+
+  // Only firmware built to profile its loop has the profile API
+  function profile(data) {
+    var table = document.getElementById('profile');
+    data.handlers.forEach(function (handler) {
+      var cells = table.insertRow();
+      cells.insertCell().textContent = handler.name;
+      cells.insertCell().textContent = handler.count;
+      ['min', 'p50', 'p99', 'max'].forEach(function (key) {
+        cells.insertCell().textContent = (handler[key] / data.cpu_mhz).toFixed(1);
+      });
+    });
+    table.hidden = false;
+  }
+
+  function listen(name, handle) {
+    events.addEventListener(name, function (event) {
+      handle(JSON.parse(event.data).value);
+    });
+  }
+
+  var events = new EventSource('/events');
+  listen('rssi', function (rssi) {
+    document.getElementById('live_rssi').textContent = rssi;
+    samples.push(rssi);
+    if (samples.length > CHART_POINTS) {
+      samples.shift();
+    }
+    draw();
+  });
+  listen('presence', function (on) {
+    document.getElementById('live_presence').textContent = on ? 'Yes' : 'No';
+  });
+  listen('close', function (close) {
+    document.getElementById('live_close').textContent = close ? 'Yes' : 'No';
+  });
+
+  request('/api/status', { cache: 'no-store' });
+  fetch('/api/profile', { cache: 'no-store' })
+    .then(function (response) { return response.ok ? response.json() : null; })
+    .then(function (data) { return data && profile(data); })
+    .catch(function () {});
+  fetch('/api/schema')
+    .then(function (response) { return response.json(); })
+    .then(function (schema) {
+      build(schema);
+      request('/api/settings', { cache: 'no-store' });
+    })
+    .catch(function () { alert('Unable to reach the device!'); });
+})();